@@ -36,9 +36,17 @@
 #define PSIMPL_DETAIL_ALGO
 
 
-#include <queue>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
 #include <stack>
+#include <utility>
+#include <vector>
+#include "counters.h"
 #include "math.h"
+#include "spatial.h"
+#include "trace.h"
 #include "util.h"
 
 
@@ -48,6 +56,12 @@ namespace psimpl {
 
     namespace detail
     {
+        /*!
+            \brief Number of points after which the single pass routines report their work, and
+            check if they should stop.
+        */
+        static const unsigned progress_block = 1 << 12;
+
         /*!
             \brief Key finder.
         */
@@ -89,6 +103,30 @@ namespace psimpl {
                 RandomAccessIterator poly,
                 diff_type first,
                 diff_type last)
+            {
+                return apply (poly, first, last, first + DIM, last);
+            }
+
+            /*!
+                \brief Finds the key amongst a range of the internal points of a sub polyline.
+
+                Only the points with a coordinate index in [begin, end) are tested. Splitting the
+                internal points into ranges, and keeping the range key with the highest distance
+                (the last one on ties), gives the same key as testing all points at once.
+
+                \param[in] poly     the first coordinate of the first polyline point
+                \param[in] first    the first coordinate index of the first point of the sub polyline
+                \param[in] last     the first coordinate index of the last point of the sub polyline
+                \param[in] begin    the first coordinate index of the first point to test
+                \param[in] end      one beyond the first coordinate index of the last point to test
+                \return             the found key between poly [begin] and poly [end]
+            */
+            static key apply (
+                RandomAccessIterator poly,
+                diff_type first,
+                diff_type last,
+                diff_type begin,
+                diff_type end)
             {
                 key result;
                 // define segment S (s1, s2)
@@ -97,11 +135,11 @@ namespace psimpl {
                 std::advance (s1, first);
                 std::advance (s2, last);
                 // (coord)index of the current test point
-                diff_type index = first + DIM;
-                std::advance (poly, first + DIM);
+                diff_type index = begin;
+                std::advance (poly, begin);
 
                 // test all internal points against segment S (s1, s2)
-                while (index < last) {
+                while (index < end) {
                     calc_type d2 = math::segment_distance2 <DIM> (s1, s2, poly);
 
                     if (result.dist2 <= d2) {
@@ -115,6 +153,262 @@ namespace psimpl {
                 return result;
             }
         };
+
+        /*!
+            \brief Key finder that uses a spatial::box_tree to skip blocks of points.
+
+            The distance to a segment is convex, so the largest distance of any point inside a
+            box is found at one of its corners. A block of points is skipped when this bound
+            does not exceed the tolerance, or when it is below the distance of the key found so
+            far. Ties are resolved like find_key does, so the key is the same as that of
+            find_key whenever its distance exceeds the tolerance.
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename T,
+            typename Counters = util::no_counters
+        >
+        struct find_key_pruned
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+            typedef typename util::select_calculation_type <RandomAccessIterator>::type calc_type;
+            typedef typename find_key <DIM, RandomAccessIterator>::key key;
+
+            /*!
+                \brief Finds the key in a sub polyline, if its distance exceeds the tolerance.
+
+                \param[in] poly     the first coordinate of the first polyline point
+                \param[in] tree     the box tree over the polyline
+                \param[in] first    the first coordinate index of the first point of the sub polyline
+                \param[in] last     the first coordinate index of the last point of the sub polyline
+                \param[in] tol2     the squared distance tolerance
+                \param[in] stats    counts the distance evaluations
+                \return             the found key, or a key with a distance <= tol2
+            */
+            static key apply (
+                RandomAccessIterator poly,
+                const spatial::box_tree <DIM, T>& tree,
+                diff_type first,
+                diff_type last,
+                calc_type tol2,
+                Counters stats = Counters ())
+            {
+                key result;
+                std::ptrdiff_t begin = static_cast <std::ptrdiff_t> (first / DIM) + 1;    // first internal point
+                std::ptrdiff_t end = static_cast <std::ptrdiff_t> (last / DIM);           // one beyond the last
+                if (end <= begin || !tree.levels ()) {
+                    return result;
+                }
+                // short sub polylines are cheaper to scan than to prune
+                if (end - begin <= 4 * tree.leaf_size ()) {
+                    stats.distance (static_cast <unsigned long long> (end - begin));
+                    return find_key <DIM, RandomAccessIterator>::apply (poly, first, last);
+                }
+                RandomAccessIterator s1 = poly + first;
+                RandomAccessIterator s2 = poly + last;
+
+                // start at the lowest node that bounds all internal points
+                unsigned level = 0;
+                std::ptrdiff_t node = begin / tree.leaf_size ();
+                std::ptrdiff_t other = std::min ((end - 1) / tree.leaf_size (), tree.nodes (0) - 1);
+                while (node != other) {
+                    node >>= 1;
+                    other >>= 1;
+                    ++level;
+                }
+
+                // depth first, the node with the largest bound first
+                struct entry {
+                    unsigned level;
+                    std::ptrdiff_t node;
+                    calc_type bound;
+                };
+                entry stack [2 * (std::numeric_limits <std::ptrdiff_t>::digits + 1)];
+                unsigned size = 0;
+                entry start = {level, node, bound (tree, level, node, s1, s2, stats)};
+                stack [size++] = start;
+
+                while (size) {
+                    entry e = stack [--size];
+                    if (e.bound <= tol2 || e.bound < result.dist2) {
+                        continue;
+                    }
+                    if (e.level == 0) {
+                        // test the internal points of the leaf
+                        std::ptrdiff_t from = std::max (tree.first_point (0, e.node), begin);
+                        std::ptrdiff_t to = std::min (tree.last_point (0, e.node) + 1, end);
+                        stats.distance (static_cast <unsigned long long> (to - from));
+                        key k = find_key <DIM, RandomAccessIterator>::apply (
+                            poly, first, last, static_cast <diff_type> (from * DIM), static_cast <diff_type> (to * DIM));
+                        if (result.dist2 < k.dist2 || (result.dist2 == k.dist2 && result.index < k.index)) {
+                            result = k;
+                        }
+                        continue;
+                    }
+                    unsigned child_level = e.level - 1;
+                    entry children [2];
+                    unsigned count = 0;
+                    for (std::ptrdiff_t child_node = 2 * e.node;
+                         child_node < 2 * e.node + 2 && child_node < tree.nodes (child_level);
+                         ++child_node)
+                    {
+                        // only nodes that contain internal points
+                        if (tree.first_point (child_level, child_node) < end && begin <= tree.last_point (child_level, child_node)) {
+                            entry child = {child_level, child_node, bound (tree, child_level, child_node, s1, s2, stats)};
+                            children [count++] = child;
+                        }
+                    }
+                    if (count == 2 && children [1].bound < children [0].bound) {
+                        std::swap (children [0], children [1]);
+                    }
+                    for (unsigned c = 0; c < count; ++c) {
+                        stack [size++] = children [c];
+                    }
+                }
+                return result;
+            }
+
+        private:
+            //! \brief Returns the largest squared distance between a node and segment (s1, s2).
+            static calc_type bound (
+                const spatial::box_tree <DIM, T>& tree,
+                unsigned level,
+                std::ptrdiff_t node,
+                RandomAccessIterator s1,
+                RandomAccessIterator s2,
+                Counters stats)
+            {
+                stats.distance (1u << DIM);
+                const T* box = tree.box (level, node);
+                calc_type result = 0;
+                for (unsigned c = 0; c < (1u << DIM); ++c) {
+                    T corner [DIM];
+                    for (unsigned d = 0; d < DIM; ++d) {
+                        corner [d] = box [(c >> d) & 1 ? DIM + d : d];
+                    }
+                    result = std::max (result, static_cast <calc_type> (math::segment_distance2 <DIM> (s1, s2, corner)));
+                }
+                return result;
+            }
+        };
+
+        /*!
+            \brief Cone of 2d directions from an apex, bounded by a right and a left direction.
+
+            Initially the cone is open and contains every direction. Narrowing it with a point
+            keeps only the directions of rays from the apex that pass within tolerance of that
+            point. A narrowed cone always spans less than pi, so that all containment tests
+            reduce to cross products.
+        */
+        template
+        <
+            typename T
+        >
+        struct wedge
+        {
+            wedge () :
+                open (true),
+                empty (false),
+                left (),
+                right ()
+            {}
+
+            void reset () {
+                open = true;
+                empty = false;
+            }
+
+            /*!
+                \brief Tests if the direction (dx, dy) lies within the cone.
+
+                The zero direction only lies within an open cone.
+            */
+            bool contains (
+                T dx,
+                T dy) const
+            {
+                if (open || empty) {
+                    return open;
+                }
+                if (dx == 0 && dy == 0) {
+                    return false;
+                }
+                return contains (right, left, dx, dy);
+            }
+
+            /*!
+                \brief Narrows the cone for the point at offset (dx, dy) from the apex.
+
+                \param[in] dx      x offset of the point
+                \param[in] dy      y offset of the point
+                \param[in] d2      squared length of (dx, dy)
+                \param[in] tol2    squared distance tolerance
+                \return            false when the cone became empty
+            */
+            bool narrow (
+                T dx,
+                T dy,
+                T d2,
+                T tol2)
+            {
+                if (empty) {
+                    return false;
+                }
+                if (d2 <= tol2) {
+                    // any direction passes within tolerance
+                    return true;
+                }
+                // rotate (dx, dy) by +-asin (tol / d), scaled by d
+                T c = std::sqrt (d2 - tol2);
+                T s = std::sqrt (tol2);
+                T l [2] = {dx * c - dy * s, dx * s + dy * c};
+                T r [2] = {dx * c + dy * s, dy * c - dx * s};
+
+                if (open) {
+                    std::copy (l, l + 2, left);
+                    std::copy (r, r + 2, right);
+                    open = false;
+                    return true;
+                }
+                // both cones are convex, so each bound of the intersection is a bound of one of them
+                bool rightValid = contains (right, left, r [0], r [1]);
+                bool leftValid = contains (right, left, l [0], l [1]);
+                if (!rightValid && !contains (r, l, right [0], right [1])) {
+                    empty = true;
+                    return false;
+                }
+                if (!leftValid && !contains (r, l, left [0], left [1])) {
+                    empty = true;
+                    return false;
+                }
+                if (rightValid) {
+                    std::copy (r, r + 2, right);
+                }
+                if (leftValid) {
+                    std::copy (l, l + 2, left);
+                }
+                return true;
+            }
+
+            bool open;      //!< indicates if the cone still contains all directions
+            bool empty;     //!< indicates if the cone no longer contains any direction
+            T left [2];     //!< counter-clockwise bound
+            T right [2];    //!< clockwise bound
+
+        private:
+            // tests if (dx, dy) lies within the cone [r, l]
+            static bool contains (
+                const T* r,
+                const T* l,
+                T dx,
+                T dy)
+            {
+                return r [0] * dy - r [1] * dx >= 0 &&
+                       dx * l [1] - dy * l [0] >= 0;
+            }
+        };
     }
 
     /*!
@@ -173,7 +467,8 @@ namespace psimpl {
         unsigned DIM,
         typename ForwardIterator,
         typename Distance,
-        typename OutputIterator
+        typename OutputIterator,
+        typename Counters = util::no_counters
     >
     struct radial_distance
     {
@@ -186,7 +481,8 @@ namespace psimpl {
             ForwardIterator first,
             ForwardIterator last,
             Distance tol,
-            OutputIterator result)
+            OutputIterator result,
+            Counters stats = Counters ())
         {
             diff_type coordCount = std::distance (first, last);
             diff_type pointCount = DIM          // protect against zero DIM
@@ -206,12 +502,20 @@ namespace psimpl {
             util::copy_key_advance <DIM> (next, result);
 
             // Skip first and last point, because they are always part of the simplification
-            for (diff_type index = 1; index < pointCount - 1; ++index) {
-                if (tol2 <= math::point_distance2 <DIM> (current, next)) {
-                    current = next;
-                    util::copy_key <DIM> (next, result);
+            for (diff_type index = 1; index < pointCount - 1; ) {
+                // report the work per block, and stop in between blocks if requested
+                diff_type end = std::min (index + static_cast <diff_type> (detail::progress_block), pointCount - 1);
+                stats.distance (static_cast <unsigned long long> (end - index));
+                if (stats.stopped ()) {
+                    return result;
+                }
+                for (; index < end; ++index) {
+                    if (tol2 <= math::point_distance2 <DIM> (current, next)) {
+                        current = next;
+                        util::copy_key <DIM> (next, result);
+                    }
+                    std::advance (next, DIM);
                 }
-                std::advance (next, DIM);
             }
             // the last point is always part of the simplification
             util::copy_key <DIM> (next, result);
@@ -219,6 +523,162 @@ namespace psimpl {
         }
     };
 
+    namespace detail
+    {
+        /*!
+            \brief Writes the coordinates of the keys of a level.
+        */
+        template <unsigned DIM>
+        struct key_output
+        {
+            //! \brief Copies the key at point.
+            template <typename ForwardIterator, typename Index, typename OutputIterator>
+            static void key (ForwardIterator point, Index, OutputIterator& result) {
+                util::copy_key <DIM> (point, result);
+            }
+
+            //! \brief Copies the range [first, last), used for invalid input.
+            template <typename ForwardIterator, typename Index, typename OutputIterator>
+            static void copy (ForwardIterator first, ForwardIterator last, Index, OutputIterator& result) {
+                result = std::copy (first, last, result);
+            }
+        };
+
+        /*!
+            \brief Writes the point indices of the keys of a level.
+        */
+        template <unsigned DIM>
+        struct index_output
+        {
+            //! \brief Writes the index of the key at point.
+            template <typename ForwardIterator, typename Index, typename OutputIterator>
+            static void key (ForwardIterator, Index index, OutputIterator& result) {
+                *result = index;
+                ++result;
+            }
+
+            //! \brief Writes the indices of all complete points, used for invalid input.
+            template <typename ForwardIterator, typename Index, typename OutputIterator>
+            static void copy (ForwardIterator, ForwardIterator, Index pointCount, OutputIterator& result) {
+                for (Index index = 0; index < pointCount; ++index) {
+                    *result = index;
+                    ++result;
+                }
+            }
+        };
+    }
+
+    /*!
+        \brief Radial distance routine (RD) for multiple tolerances at once.
+
+        Each tolerance keeps a copy of its own current key, so that all levels are produced
+        while the input is read only once. The keys of each level are written by the Output policy.
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator,
+        typename DistanceIterator,
+        typename ResultIterator,
+        typename Output,
+        typename Counters = util::no_counters
+    >
+    struct radial_distance_multi
+    {
+        typedef typename std::iterator_traits <ForwardIterator>::difference_type diff_type;
+        typedef typename std::iterator_traits <DistanceIterator>::value_type Distance;
+        typedef typename std::iterator_traits <ResultIterator>::value_type OutputIterator;
+        typedef typename util::select_calculation_type <ForwardIterator>::type calc_type;
+
+        /*!
+            \brief Performs the radial distance simplification routine for each tolerance.
+        */
+        static ResultIterator simplify (
+            ForwardIterator first,
+            ForwardIterator last,
+            DistanceIterator tol_first,
+            DistanceIterator tol_last,
+            ResultIterator results,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM          // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+
+            std::vector <Distance> tol2;        // squared distance tolerance of each level
+            std::vector <OutputIterator> outputs;
+            for (ResultIterator it = results; tol_first != tol_last; ++tol_first, ++it) {
+                tol2.push_back (*tol_first * *tol_first);
+                outputs.push_back (*it);
+            }
+            std::size_t levels = tol2.size ();
+
+            // validate input and check if simplification required
+            if (coordCount % DIM || pointCount < 3) {
+                for (std::size_t level = 0; level < levels; ++level) {
+                    Output::copy (first, last, pointCount, outputs [level]);
+                }
+                return store (outputs, results);
+            }
+
+            // a level with tol <= 0 keeps every point, just like a copy
+            std::vector <calc_type> current (levels * DIM);     // the current key of each level
+            ForwardIterator next = first;       // used to find the next key
+            calc_type point [DIM];              // the coordinates of next
+
+            // the first point is always part of the simplification
+            load (next, point);
+            for (std::size_t level = 0; level < levels; ++level) {
+                std::copy (point, point + DIM, &current [level * DIM]);
+                Output::key (next, diff_type (0), outputs [level]);
+            }
+            std::advance (next, DIM);
+
+            // Skip first and last point, because they are always part of the simplification
+            for (diff_type index = 1; index < pointCount - 1; ) {
+                // report the work per block, and stop in between blocks if requested
+                diff_type end = std::min (index + static_cast <diff_type> (detail::progress_block), pointCount - 1);
+                stats.distance (static_cast <unsigned long long> (end - index) * levels);
+                if (stats.stopped ()) {
+                    return store (outputs, results);
+                }
+                for (; index < end; ++index) {
+                    load (next, point);
+                    for (std::size_t level = 0; level < levels; ++level) {
+                        calc_type* key = &current [level * DIM];
+                        if (tol2 [level] <= math::point_distance2 <DIM> (key, point)) {
+                            std::copy (point, point + DIM, key);
+                            Output::key (next, index, outputs [level]);
+                        }
+                    }
+                    std::advance (next, DIM);
+                }
+            }
+            // the last point is always part of the simplification
+            for (std::size_t level = 0; level < levels; ++level) {
+                Output::key (next, pointCount - 1, outputs [level]);
+            }
+            return store (outputs, results);
+        }
+
+    private:
+        //! \brief Copies the coordinates of a point.
+        static void load (ForwardIterator it, calc_type* point) {
+            for (unsigned d = 0; d < DIM; ++d, ++it) {
+                point [d] = static_cast <calc_type> (*it);
+            }
+        }
+
+        //! \brief Stores the advanced output iterators, returns one beyond the last level.
+        static ResultIterator store (const std::vector <OutputIterator>& outputs, ResultIterator results) {
+            for (std::size_t level = 0; level < outputs.size (); ++level, ++results) {
+                *results = outputs [level];
+            }
+            return results;
+        }
+    };
+
     /*!
         \brief Perpendicular distance routine (PD).
     */
@@ -227,7 +687,8 @@ namespace psimpl {
         unsigned DIM,
         typename ForwardIterator,
         typename Distance,
-        typename OutputIterator
+        typename OutputIterator,
+        typename Counters = util::no_counters
     >
     struct perpendicular_distance
     {
@@ -242,7 +703,8 @@ namespace psimpl {
             ForwardIterator first,
             ForwardIterator last,
             Distance tol,
-            OutputIterator result)
+            OutputIterator result,
+            Counters stats = Counters ())
         {
             diff_type coordCount = std::distance (first, last);
             diff_type pointCount = DIM      // protect against zero DIM
@@ -266,6 +728,10 @@ namespace psimpl {
 
             while (p2 != last) {
                 // test p1 against line segment S(p0, p2)
+                stats.distance ();
+                if (stats.stopped ()) {
+                    return result;
+                }
                 if (math::segment_distance2 <DIM> (p0, p2, p1) < tol2) {
                     util::copy_key <DIM> (p2, result);
                     // move up by two points
@@ -302,7 +768,8 @@ namespace psimpl {
         typename ForwardIterator,
         typename Distance,
         typename Size,
-        typename OutputIterator
+        typename OutputIterator,
+        typename Counters = util::no_counters
     >
     struct perpendicular_distance_repeat
     {
@@ -317,7 +784,8 @@ namespace psimpl {
             ForwardIterator last,
             Distance tol,
             Size repeat,
-            OutputIterator result)
+            OutputIterator result,
+            Counters stats = Counters ())
         {
             if (repeat == 1) {
                 // single pass
@@ -326,8 +794,9 @@ namespace psimpl {
                         DIM,
                         ForwardIterator,
                         Distance,
-                        OutputIterator
-                    >::simplify (first, last, tol, result);
+                        OutputIterator,
+                        Counters
+                    >::simplify (first, last, tol, result, stats);
             }
             // only validate repeat; other input is validated by simplify_perpendicular_distance
             if (repeat < 1) {
@@ -345,9 +814,13 @@ namespace psimpl {
                         DIM,
                         ForwardIterator,
                         Distance,
-                        value_type*
-                    >::simplify (first, last, tol, tempPoly.get ()));
+                        value_type*,
+                        Counters
+                    >::simplify (first, last, tol, tempPoly.get (), stats));
 
+            if (stats.stopped ()) {
+                return result;
+            }
             // check if simplification did not improve
             if (coordCount == tempCoordCount) {
                 return std::copy (tempPoly.get (), tempPoly.get () + coordCount, result);
@@ -367,9 +840,13 @@ namespace psimpl {
                                 DIM,
                                 value_type*,
                                 Distance,
-                                value_type*
-                            >::simplify (tempPoly.get (), tempPoly.get () + coordCount, tol, tempResult.get ()));
+                                value_type*,
+                                Counters
+                            >::simplify (tempPoly.get (), tempPoly.get () + coordCount, tol, tempResult.get (), stats));
 
+                    if (stats.stopped ()) {
+                        return result;
+                    }
                     // check if simplification did not improve
                     if (coordCount == tempCoordCount) {
                         return std::copy (tempPoly.get (), tempPoly.get () + coordCount, result);
@@ -385,8 +862,9 @@ namespace psimpl {
                     DIM,
                     value_type*,
                     Distance,
-                    OutputIterator
-                >::simplify (tempPoly.get (), tempPoly.get () + coordCount, tol, result);
+                    OutputIterator,
+                    Counters
+                >::simplify (tempPoly.get (), tempPoly.get () + coordCount, tol, result, stats);
         }
     };
 
@@ -398,7 +876,8 @@ namespace psimpl {
         unsigned DIM,
         typename ForwardIterator,
         typename Distance,
-        typename OutputIterator
+        typename OutputIterator,
+        typename Counters = util::no_counters
     >
     struct reumann_witkam
     {
@@ -413,7 +892,8 @@ namespace psimpl {
             ForwardIterator first,
             ForwardIterator last,
             Distance tol,
-            OutputIterator result)
+            OutputIterator result,
+            Counters stats = Counters ())
         {
             diff_type coordCount = std::distance (first, last);
             diff_type pointCount = DIM      // protect against zero DIM
@@ -439,18 +919,26 @@ namespace psimpl {
             util::copy_key <DIM> (p0, result);
 
             // check each point pj against L(p0, p1)
-            for (diff_type j = 2; j < pointCount; ++j) {
-                pi = pj;
-                std::advance (pj, DIM);
+            for (diff_type j = 2; j < pointCount; ) {
+                // report the work per block, and stop in between blocks if requested
+                diff_type end = std::min (j + static_cast <diff_type> (detail::progress_block), pointCount);
+                stats.distance (static_cast <unsigned long long> (end - j));
+                if (stats.stopped ()) {
+                    return result;
+                }
+                for (; j < end; ++j) {
+                    pi = pj;
+                    std::advance (pj, DIM);
 
-                if (math::line_distance2 <DIM> (p0, p1, pj) < tol2) {
-                    continue;
+                    if (math::line_distance2 <DIM> (p0, p1, pj) < tol2) {
+                        continue;
+                    }
+                    // found the next key at pi
+                    util::copy_key <DIM> (pi, result);
+                    // define new line L(pi, pj)
+                    p0 = pi;
+                    p1 = pj;
                 }
-                // found the next key at pi
-                util::copy_key <DIM> (pi, result);
-                // define new line L(pi, pj)
-                p0 = pi;
-                p1 = pj;
             }
             // the last point is always part of the simplification
             util::copy_key <DIM> (pj, result);
@@ -467,7 +955,8 @@ namespace psimpl {
         unsigned DIM,
         typename ForwardIterator,
         typename Distance,
-        typename OutputIterator
+        typename OutputIterator,
+        typename Counters = util::no_counters
     >
     struct opheim
     {
@@ -483,7 +972,8 @@ namespace psimpl {
             ForwardIterator last,
             Distance min_tol,
             Distance max_tol,
-            OutputIterator result)
+            OutputIterator result,
+            Counters stats = Counters ())
         {
             diff_type coordCount = std::distance (first, last);
             diff_type pointCount = DIM              // protect against zero DIM
@@ -511,11 +1001,15 @@ namespace psimpl {
             util::copy_key <DIM> (r0, result);
 
             for (diff_type j = 2; j < pointCount; ++j) {
+                if (stats.stopped ()) {
+                    return result;
+                }
                 pi = pj;
                 std::advance (pj, DIM);
 
                 if (!rayDefined) {
                     // discard each point within minimum tolerance
+                    stats.distance ();
                     if (math::point_distance2 <DIM> (r0, pj) < min_tol2) {
                         continue;
                     }
@@ -525,10 +1019,12 @@ namespace psimpl {
                 }
 
                 // check each point pj against R(r0, r1)
-                if (math::point_distance2 <DIM> (r0, pj) < max_tol2 &&
-                    math::ray_distance2 <DIM> (r0, r1, pj) < min_tol2)
-                {
-                    continue;
+                stats.distance ();
+                if (math::point_distance2 <DIM> (r0, pj) < max_tol2) {
+                    stats.distance ();
+                    if (math::ray_distance2 <DIM> (r0, r1, pj) < min_tol2) {
+                        continue;
+                    }
                 }
                 // found the next key at pi
                 util::copy_key <DIM> (pi, result);
@@ -552,7 +1048,8 @@ namespace psimpl {
         typename BidirectionalIterator,
         typename Distance,
         typename Size,
-        typename OutputIterator
+        typename OutputIterator,
+        typename Counters = util::no_counters
     >
     struct lang
     {
@@ -568,7 +1065,8 @@ namespace psimpl {
             BidirectionalIterator last,
             Distance tol,
             Size look_ahead,
-            OutputIterator result)
+            OutputIterator result,
+            Counters stats = Counters ())
         {
             diff_type coordCount = std::distance (first, last);
             diff_type pointCount = DIM              // protect against zero DIM
@@ -591,11 +1089,15 @@ namespace psimpl {
             util::copy_key <DIM> (current, result);
 
             while (moved) {
+                if (stats.stopped ()) {
+                    return result;
+                }
                 calc_type d2 = 0;
                 BidirectionalIterator p = current;
                 std::advance (p, DIM);
 
                 while (p != next) {
+                    stats.distance ();
                     d2 = std::max (d2, math::segment_distance2 <DIM> (current, next, p));
                     if (tol2 < d2) {
                         break;
@@ -608,8 +1110,8 @@ namespace psimpl {
                     moved = util::forward <DIM> (next, static_cast <diff_type> (look_ahead), remaining);
                 }
                 else {
-                    int iremaining = static_cast<int>(remaining) ; // pass by ref
-                    util::backward <DIM> (next, 1, iremaining);
+                    util::backward <DIM> (next, static_cast <diff_type> (1), remaining);
+                    stats.backtrack ();
                 }
             }
             return result;
@@ -617,83 +1119,590 @@ namespace psimpl {
     };
 
     /*!
-        \brief Douglas-Peucker approximation (DPc).
+        \brief Incremental sleeve-fitting approximation (SF) of a 2d polyline.
+
+        Points are pushed one at a time; keys are written to the output as soon as they are
+        known. Only the current key, the previous point, the angular sleeve and the minimum
+        segment length are stored.
     */
     template
     <
-        unsigned DIM,
-        typename RandomAccessIterator,
-        typename Distance,
-        typename OutputIterator
+        typename T,
+        typename OutputIterator,
+        typename Counters = util::no_counters
     >
-    struct douglas_peucker_classic
+    class sleeve_fitting_stream
     {
-        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
-        typedef typename std::iterator_traits <RandomAccessIterator>::value_type value_type;
-        typedef typename util::select_calculation_type <RandomAccessIterator>::type calc_type;
-        typedef typename detail::find_key <DIM, RandomAccessIterator> key_finder;
-        typedef typename detail::find_key <DIM, RandomAccessIterator>::key key_type;
+    public:
+        typedef typename util::select_calculation_type <T*>::type calc_type;
+
+        sleeve_fitting_stream (
+            calc_type tol,
+            OutputIterator result,
+            Counters stats = Counters ()) :
+            mTol2 (tol * tol),
+            mResult (result),
+            mCount (0),
+            mKey (),
+            mPrev (),
+            mReach2 (0),
+            mStats (stats)
+        {}
 
         /*!
-            \brief Performs Douglas-Peucker approximation.
+            \brief Adds the next point (x, y) of the polyline.
         */
-        static OutputIterator simplify (
-            RandomAccessIterator first,
-            RandomAccessIterator last,
-            Distance tol,
-            OutputIterator result)
+        void push (
+            T x,
+            T y)
         {
-            diff_type coordCount = std::distance (first, last);
-            diff_type pointCount = DIM      // protect against zero DIM
-                                   ? coordCount / DIM
-                                   : 0;
-            Distance tol2 = tol * tol;      // squared distance tolerance
-
-            // validate input and check if simplification required
-            if (coordCount % DIM || pointCount < 3 || tol2 <= 0) {
-                return std::copy (first, last, result);
+            if (mCount == 0 || mTol2 <= 0) {
+                // the first point is always part of the simplification
+                emit (x, y);
+                reset (x, y);
             }
+            else if (!extend (x, y)) {
+                // found the next key at the previous point
+                emit (mPrev [0], mPrev [1]);
+                reset (mPrev [0], mPrev [1]);
+                extend (x, y);
+            }
+            mPrev [0] = x;
+            mPrev [1] = y;
+            ++mCount;
+        }
 
-            // keep track of what points are part of the simplification (key)
-            util::scoped_array <unsigned char> keys (static_cast<unsigned>(pointCount));
-            std::fill_n (keys.get (), pointCount, 0);
-            keys [0] = 1;                   // the first point is always a key
-            keys [static_cast<int>(pointCount - 1)] = 1;      // the last point is always a key
-
-            // keep track of all sub polylines that still need to be processed
-            std::stack <sub_poly> stack;    // LIFO job-queue
-            sub_poly poly (0, coordCount-DIM);
-            stack.push (poly);              // add complete poly
-
-            while (!stack.empty ()) {
-                poly = stack.top ();    // take a sub poly
-                stack.pop ();           // and find its key
+        /*!
+            \brief Flushes the last point and returns one beyond the last output coordinate.
 
-                key_type key = key_finder::apply (first, poly.first, poly.last);
-                if (key.index && tol2 < key.dist2) {
-                    // store the key if valid
-                    keys [static_cast<int>(key.index / DIM)] = 1;
-                    // split the polyline at the key and recurse
-                    stack.push (sub_poly (key.index, poly.last));
-                    stack.push (sub_poly (poly.first, key.index));
-                }
+            The stream can be reused for a new polyline afterwards.
+        */
+        OutputIterator finish () {
+            // the last point is always part of the simplification
+            if (mCount > 1 && mTol2 > 0) {
+                emit (mPrev [0], mPrev [1]);
             }
-            // copy keys
-            util::copy_keys <DIM> (first, last, keys.get (), result);
-            return result;
+            mCount = 0;
+            return mResult;
         }
 
     private:
+        void emit (
+            T x,
+            T y)
+        {
+            *mResult = x;
+            ++mResult;
+            *mResult = y;
+            ++mResult;
+        }
+
+        // starts a new sleeve at the key (x, y)
+        void reset (
+            T x,
+            T y)
+        {
+            mKey [0] = x;
+            mKey [1] = y;
+            mReach2 = 0;
+            mSleeve.reset ();
+        }
+
         /*!
-            \brief Defines a sub polyline.
+            \brief Tries to extend the segment from the current key to (x, y).
+
+            The point is accepted when its direction lies within the sleeve, which keeps all
+            points since the key within tolerance of the ray through the point, and when its
+            squared distance to the key is at least mReach2. A point p within tolerance of the
+            ray is within tolerance of the segment when the segment length l satisfies
+            l^2 >= |p|^2 - tol^2, so points that the polyline passed before doubling back stay
+            within tolerance too. The sleeve is then narrowed to the directions that keep the
+            point itself within tolerance.
         */
-        struct sub_poly {
+        bool extend (
+            T x,
+            T y)
+        {
+            calc_type dx = static_cast <calc_type> (x) - mKey [0];
+            calc_type dy = static_cast <calc_type> (y) - mKey [1];
+            calc_type d2 = dx * dx + dy * dy;
+
+            mStats.distance ();
+            if (d2 < mReach2 || !mSleeve.contains (dx, dy)) {
+                return false;
+            }
+            mSleeve.narrow (dx, dy, d2, mTol2);
+            mReach2 = std::max (mReach2, d2 - mTol2);
+            return true;
+        }
+
+        calc_type mTol2;                        //!< squared distance tolerance
+        OutputIterator mResult;                 //!< destination of the simplified polyline
+        size_t mCount;                          //!< number of points pushed since the first point
+        calc_type mKey [2];                     //!< the current key
+        T mPrev [2];                            //!< the previous point
+        detail::wedge <calc_type> mSleeve;      //!< directions within tolerance of all points since the key
+        calc_type mReach2;                      //!< minimum squared segment length for all points since the key
+        Counters mStats;                        //!< counts the sleeve tests
+    };
+
+    /*!
+        \brief Sleeve-fitting approximation (SF).
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator,
+        typename Distance,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct sleeve_fitting
+    {
+        typedef typename std::iterator_traits <ForwardIterator>::difference_type diff_type;
+        typedef typename std::iterator_traits <ForwardIterator>::value_type value_type;
+
+        static_assert (DIM == 2, "sleeve fitting only supports 2d polylines");
+
+        /*!
+            \brief Performs sleeve-fitting approximation.
+        */
+        static OutputIterator simplify (
+            ForwardIterator first,
+            ForwardIterator last,
+            Distance tol,
+            OutputIterator result,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = coordCount / DIM;
+
+            // validate input and check if simplification required
+            if (coordCount % DIM || pointCount < 3 || tol <= 0) {
+                return std::copy (first, last, result);
+            }
+
+            sleeve_fitting_stream <value_type, OutputIterator, Counters> stream (tol, result, stats);
+            while (first != last) {
+                if (stats.stopped ()) {
+                    return stream.finish ();
+                }
+                value_type x = *first;
+                ++first;
+                value_type y = *first;
+                ++first;
+                stream.push (x, y);
+            }
+            return stream.finish ();
+        }
+    };
+
+    /*!
+        \brief Optimal min-# approximation (OPT) of a 2d polyline.
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator,
+        typename Distance,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct optimal
+    {
+        typedef typename std::iterator_traits <ForwardIterator>::difference_type diff_type;
+        typedef typename std::iterator_traits <ForwardIterator>::value_type value_type;
+        typedef typename util::select_calculation_type <ForwardIterator>::type calc_type;
+
+        static_assert (DIM == 2, "optimal simplification only supports 2d polylines");
+
+        /*!
+            \brief Performs optimal min-# approximation.
+
+            \param[in] window   maximum number of points per sub problem, 0 for unbounded
+        */
+        static OutputIterator simplify (
+            ForwardIterator first,
+            ForwardIterator last,
+            Distance tol,
+            diff_type window,
+            OutputIterator result,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = coordCount / DIM;
+            calc_type tol2 = static_cast <calc_type> (tol) * static_cast <calc_type> (tol);
+
+            // validate input and check if simplification required
+            if (coordCount % DIM || pointCount < 3 || tol2 <= 0 || (window && window < 3)) {
+                return std::copy (first, last, result);
+            }
+            if (!window || pointCount < window) {
+                window = pointCount;
+            }
+
+            // random access to the coordinates in the calculation type
+            util::scoped_array <calc_type> coords (static_cast <unsigned> (coordCount));
+            std::copy (first, last, coords.get ());
+
+            util::scoped_array <unsigned char> keys (static_cast <unsigned> (pointCount));
+            std::fill_n (keys.get (), pointCount, 0);
+            keys [0] = 1;
+
+            util::scoped_array <diff_type> parent (static_cast <unsigned> (pointCount));
+            util::scoped_array <diff_type> hops (static_cast <unsigned> (pointCount));
+
+            diff_type begin = 0;
+            while (begin < pointCount - 1) {
+                diff_type end = std::min (begin + window, pointCount) - 1;
+                shortest_path (coords.get (), begin, end, tol2, parent.get (), hops.get (), stats);
+                if (stats.stopped ()) {
+                    return result;
+                }
+
+                // only the keys in the first half of a window are final, unless it is the last
+                diff_type commit = end;
+                if (end < pointCount - 1 && parent [end] > begin) {
+                    commit = parent [end];
+                    while (commit > begin + window / 2 && parent [commit] > begin) {
+                        commit = parent [commit];
+                    }
+                }
+                for (diff_type key = commit; key > begin; key = parent [key]) {
+                    keys [key] = 1;
+                }
+                begin = commit;
+            }
+            util::copy_keys <DIM> (first, last, keys.get (), result);
+            return result;
+        }
+
+    private:
+        /*!
+            \brief Finds the fewest shortcuts from begin to end (Chan-Chin).
+
+            A shortcut (i, j) is valid when all points in between lie within tolerance of the
+            segment (i, j). This is the case when the direction of j lies in the forward wedge
+            of i, and the direction of i lies in the backward wedge of j. The forward wedges are
+            stored as one row of flags per point, up to where the wedge becomes empty. The
+            backward wedges are computed on the fly while relaxing the shortest paths in order.
+        */
+        static void shortest_path (
+            const calc_type* coords,
+            diff_type begin,
+            diff_type end,
+            calc_type tol2,
+            diff_type* parent,
+            diff_type* hops,
+            Counters stats)
+        {
+            std::vector <std::vector <bool> > forward (static_cast <size_t> (end - begin));
+            detail::wedge <calc_type> wedge;
+
+            for (diff_type i = begin; i < end; ++i) {
+                if (stats.stopped ()) {
+                    return;
+                }
+                std::vector <bool>& row = forward [static_cast <size_t> (i - begin)];
+                const calc_type* pi = coords + i * DIM;
+                wedge.reset ();
+                for (diff_type j = i + 1; j <= end; ++j) {
+                    calc_type dx = coords [j * DIM] - pi [0];
+                    calc_type dy = coords [j * DIM + 1] - pi [1];
+                    row.push_back (wedge.contains (dx, dy));
+                    stats.distance ();
+                    if (!wedge.narrow (dx, dy, dx * dx + dy * dy, tol2)) {
+                        break;
+                    }
+                }
+            }
+
+            hops [begin] = 0;
+            for (diff_type j = begin + 1; j <= end; ++j) {
+                if (stats.stopped ()) {
+                    return;
+                }
+                const calc_type* pj = coords + j * DIM;
+                // the direct neighbour is always valid
+                parent [j] = j - 1;
+                hops [j] = hops [j - 1] + 1;
+                wedge.reset ();
+                for (diff_type i = j - 1; i >= begin; --i) {
+                    calc_type dx = coords [i * DIM] - pj [0];
+                    calc_type dy = coords [i * DIM + 1] - pj [1];
+                    const std::vector <bool>& row = forward [static_cast <size_t> (i - begin)];
+                    size_t offset = static_cast <size_t> (j - i - 1);
+
+                    if (hops [i] + 1 < hops [j] && offset < row.size () && row [offset] &&
+                        wedge.contains (dx, dy))
+                    {
+                        parent [j] = i;
+                        hops [j] = hops [i] + 1;
+                    }
+                    stats.distance ();
+                    if (!wedge.narrow (dx, dy, dx * dx + dy * dy, tol2)) {
+                        break;
+                    }
+                }
+            }
+        }
+    };
+
+    /*!
+        \brief Douglas-Peucker approximation (DPc).
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct douglas_peucker_classic
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+        typedef typename std::iterator_traits <RandomAccessIterator>::value_type value_type;
+        typedef typename util::select_calculation_type <RandomAccessIterator>::type calc_type;
+        typedef typename detail::find_key <DIM, RandomAccessIterator> key_finder;
+        typedef typename detail::find_key <DIM, RandomAccessIterator>::key key_type;
+
+        /*!
+            \brief Defines a sub polyline.
+        */
+        struct sub_poly {
             sub_poly (diff_type first=0, diff_type last=0) :
                 first (first), last (last) {}
 
             diff_type first;    //!< coord index of the first point
             diff_type last;     //!< coord index of the last point
         };
+
+        /*!
+            \brief The working storage of a simplification, which a caller can keep between
+            calls to simplify many polylines without allocating for each.
+        */
+        struct buffers {
+            std::vector <unsigned char> keys;   //!< the key flags of the current polyline
+            std::vector <sub_poly> stack;       //!< LIFO job-queue
+        };
+
+        /*!
+            \brief Performs Douglas-Peucker approximation.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Distance tol,
+            OutputIterator result,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM      // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            Distance tol2 = tol * tol;      // squared distance tolerance
+
+            // validate input and check if simplification required
+            if (coordCount % DIM || pointCount < 3 || tol2 <= 0) {
+                return std::copy (first, last, result);
+            }
+            util::trace_scope trace ("douglas_peucker_classic");
+            util::trace_scope stage ("find keys");
+            buffers storage;
+            if (!find_keys (first, coordCount, tol2, storage, stats)) {
+                return result;
+            }
+            // copy keys
+            stage.next ("copy keys");
+            util::copy_keys <DIM> (first, last, storage.keys.begin (), result);
+            return result;
+        }
+
+        /*!
+            \brief Performs Douglas-Peucker approximation, using the storage of the caller.
+
+            Unlike the overload above, no stages are traced, so that a batch of polylines is
+            traced as a whole.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Distance tol,
+            buffers& storage,
+            OutputIterator result,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM      // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            Distance tol2 = tol * tol;      // squared distance tolerance
+
+            // validate input and check if simplification required
+            if (coordCount % DIM || pointCount < 3 || tol2 <= 0) {
+                return std::copy (first, last, result);
+            }
+            if (!find_keys (first, coordCount, tol2, storage, stats)) {
+                return result;
+            }
+            util::copy_keys <DIM> (first, last, storage.keys.begin (), result);
+            return result;
+        }
+
+    private:
+        /*!
+            \brief Flags the keys of the polyline in storage.keys.
+
+            \return false when stats stopped the search
+        */
+        static bool find_keys (
+            RandomAccessIterator first,
+            diff_type coordCount,
+            Distance tol2,
+            buffers& storage,
+            Counters stats)
+        {
+            // keep track of what points are part of the simplification (key)
+            std::vector <unsigned char>& keys = storage.keys;
+            keys.assign (static_cast <std::size_t> (coordCount / DIM), 0);
+            keys.front () = 1;              // the first point is always a key
+            keys.back () = 1;               // the last point is always a key
+
+            // keep track of all sub polylines that still need to be processed
+            std::vector <sub_poly>& stack = storage.stack;
+            stack.clear ();
+            sub_poly poly (0, coordCount-DIM);
+            stack.push_back (poly);         // add complete poly
+            stats.depth (1);
+
+            while (!stack.empty ()) {
+                poly = stack.back ();   // take a sub poly
+                stack.pop_back ();      // and find its key
+
+                stats.key_search (static_cast <unsigned long long> ((poly.last - poly.first) / DIM + 1));
+                stats.distance (static_cast <unsigned long long> ((poly.last - poly.first) / DIM - 1));
+                if (stats.stopped ()) {
+                    return false;
+                }
+                key_type key = key_finder::apply (first, poly.first, poly.last);
+                if (key.index && tol2 < key.dist2) {
+                    // store the key if valid
+                    keys [static_cast <std::size_t> (key.index / DIM)] = 1;
+                    // split the polyline at the key and recurse
+                    stack.push_back (sub_poly (key.index, poly.last));
+                    stack.push_back (sub_poly (poly.first, key.index));
+                    stats.depth (stack.size ());
+                }
+            }
+            return true;
+        }
+    };
+
+    /*!
+        \brief Douglas-Peucker approximation (DPc), using a box tree to prune the key searches.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct douglas_peucker_pruned
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+        typedef typename util::select_calculation_type <RandomAccessIterator>::type calc_type;
+
+        /*!
+            \brief Performs Douglas-Peucker approximation, building a box tree first.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Distance tol,
+            OutputIterator result,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM      // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+
+            // validate input and check if simplification required
+            if (coordCount % DIM || pointCount < 3 || tol * tol <= 0) {
+                return std::copy (first, last, result);
+            }
+            util::trace_scope stage ("build tree");
+            spatial::box_tree <DIM, calc_type> tree (first, pointCount);
+            stage.end ();
+            return simplify (first, last, tol, tree, result, stats);
+        }
+
+        /*!
+            \brief Performs Douglas-Peucker approximation, using a box tree that was built over
+            [first, last).
+        */
+        template <typename T>
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Distance tol,
+            const spatial::box_tree <DIM, T>& tree,
+            OutputIterator result,
+            Counters stats = Counters ())
+        {
+            typedef detail::find_key_pruned <DIM, RandomAccessIterator, T, Counters> key_finder;
+            typedef typename key_finder::key key_type;
+
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM      // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            calc_type tol2 = static_cast <calc_type> (tol * tol);  // squared distance tolerance
+
+            // validate input and check if simplification required
+            if (coordCount % DIM || pointCount < 3 || tol2 <= 0 || tree.point_count () != pointCount) {
+                return std::copy (first, last, result);
+            }
+            util::trace_scope trace ("douglas_peucker_pruned");
+            util::trace_scope stage ("find keys");
+
+            // keep track of what points are part of the simplification (key)
+            util::scoped_array <unsigned char> keys (static_cast<unsigned>(pointCount));
+            std::fill_n (keys.get (), pointCount, 0);
+            keys [0] = 1;                   // the first point is always a key
+            keys [static_cast<int>(pointCount - 1)] = 1;      // the last point is always a key
+
+            // keep track of all sub polylines that still need to be processed
+            std::stack <std::pair <diff_type, diff_type> > stack;     // LIFO job-queue
+            stack.push (std::make_pair (diff_type (0), coordCount - DIM));
+            stats.depth (1);
+
+            while (!stack.empty ()) {
+                std::pair <diff_type, diff_type> poly = stack.top ();    // take a sub poly
+                stack.pop ();                                           // and find its key
+
+                stats.key_search (static_cast <unsigned long long> ((poly.second - poly.first) / DIM + 1));
+                if (stats.stopped ()) {
+                    return result;
+                }
+                key_type key = key_finder::apply (first, tree, poly.first, poly.second, tol2, stats);
+                if (key.index && tol2 < key.dist2) {
+                    // store the key if valid
+                    keys [static_cast<int>(key.index / DIM)] = 1;
+                    // split the polyline at the key and recurse
+                    stack.push (std::make_pair (key.index, poly.second));
+                    stack.push (std::make_pair (poly.first, key.index));
+                    stats.depth (stack.size ());
+                }
+            }
+            // copy keys
+            stage.next ("copy keys");
+            util::copy_keys <DIM> (first, last, keys.get (), result);
+            return result;
+        }
     };
 
     /*!
@@ -704,7 +1713,8 @@ namespace psimpl {
         unsigned DIM,
         typename ForwardIterator,
         typename Distance,
-        typename OutputIterator
+        typename OutputIterator,
+        typename Counters = util::no_counters
     >
     struct douglas_peucker
     {
@@ -719,7 +1729,8 @@ namespace psimpl {
             ForwardIterator first,
             ForwardIterator last,
             Distance tol,
-            OutputIterator result)
+            OutputIterator result,
+            Counters stats = Counters ())
         {
             diff_type coordCount = std::distance (first, last);
             diff_type pointCount = DIM      // protect against zero DIM
@@ -729,6 +1740,9 @@ namespace psimpl {
             if (coordCount % DIM || pointCount < 3 || tol <= 0) {
                 return std::copy (first, last, result);
             }
+            util::trace_scope trace ("douglas_peucker");
+            util::trace_scope stage ("radial distance");
+
             // radial distance simplification routine
             util::scoped_array <value_type> reduced (static_cast<unsigned>(coordCount));    // radial distance results
             diff_type reducedCoordCount = std::distance (
@@ -738,8 +1752,13 @@ namespace psimpl {
                         DIM,
                         ForwardIterator,
                         Distance,
-                        value_type*
-                    >::simplify (first, last, tol, reduced.get ()));
+                        value_type*,
+                        Counters
+                    >::simplify (first, last, tol, reduced.get (), stats));
+            stage.end ();
+            if (stats.stopped ()) {
+                return result;
+            }
 
             // douglas-peucker approximation
             result =
@@ -748,90 +1767,175 @@ namespace psimpl {
                     DIM,
                     value_type*,
                     Distance,
-                    OutputIterator
-                >::simplify (reduced.get (), reduced.get () + reducedCoordCount, tol, result);
+                    OutputIterator,
+                    Counters
+                >::simplify (reduced.get (), reduced.get () + reducedCoordCount, tol, result, stats);
 
             return result;
         }
     };
 
     /*!
-        \brief Douglas-Peucker approximation, but with a point count tolerance (DPn).
+        \brief Resumable Douglas-Peucker approximation with a point count tolerance (DPn).
+
+        Instead of considering one polyline segment at a time, all segments of the current
+        simplified polyline are evaluated at each step, and only the vertex with the maximum
+        distance from its segment is added as key. The pending sub polylines are kept in a
+        priority queue between calls, so that the simplification can be refined step by step:
+        by a number of keys with refine, or until a deadline with refine_until. The current
+        keys can be read at any time, and refining further never repeats earlier work.
+
+        After adding count - 2 keys, the keys are identical to the result of
+        simplify_douglas_peucker_n with count. The polyline [first, last) must remain valid and
+        unchanged for the lifetime of the refiner.
+
+        Input that does not contain complete vertices only, or less than 3 vertices, is
+        considered fully refined; reading the keys then copies the entire input, or gives the
+        indices of all complete vertices.
+
+        A Counters policy that stops, see util::progress_ref, ends refine and refine_until
+        early. The keys added until then remain valid.
     */
     template
     <
         unsigned DIM,
         typename RandomAccessIterator,
-        typename Size,
-        typename OutputIterator
+        typename Counters = util::no_counters
     >
-    struct douglas_peucker_n
+    class douglas_peucker_n_refiner
     {
+    public:
         typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
-        typedef typename std::iterator_traits <RandomAccessIterator>::value_type value_type;
         typedef typename util::select_calculation_type <RandomAccessIterator>::type calc_type;
         typedef typename detail::find_key <DIM, RandomAccessIterator> key_finder;
         typedef typename detail::find_key <DIM, RandomAccessIterator>::key key_type;
 
         /*!
-            \brief Performs Douglas-Peucker approximation, but uses a point count tolerance.
+            \brief Starts the refinement of [first, last) with only its end points as keys.
+
+            The key of the complete polyline is searched right away, which is O(n).
         */
-        static OutputIterator simplify (
+        douglas_peucker_n_refiner (
             RandomAccessIterator first,
             RandomAccessIterator last,
-            Size tol,
-            OutputIterator result)
+            Counters stats = Counters ()) :
+            mFirst (first),
+            mLast (last),
+            mKeyCount (0),
+            mStats (stats)
         {
             diff_type coordCount = std::distance (first, last);
             diff_type pointCount = DIM      // protect against zero DIM
                                    ? coordCount / DIM
                                    : 0;
-            // validate input and check if simplification required
-            if (coordCount % DIM || pointCount <= static_cast <diff_type> (tol) || tol < 2) {
-                return std::copy (first, last, result);
+            // validate input
+            mValid = DIM && coordCount % DIM == 0 && pointCount >= 3;
+            if (!mValid) {
+                mKeyCount = static_cast <std::size_t> (pointCount);
+                return;
             }
-
             // keep track of what points are part of the simplification (keys)
-            util::scoped_array <unsigned char> keys (static_cast<unsigned>(pointCount));
-            std::fill_n (keys.get (), pointCount, 0);
-            keys [0] = 1;                   // the first point is always a key
-            keys [static_cast<int>(pointCount - 1)] = 1;      // the last point is always a key
-            Size keyCount = 2;
+            mKeys.assign (static_cast <std::size_t> (pointCount), 0);
+            mKeys.front () = 1;         // the first point is always a key
+            mKeys.back () = 1;          // the last point is always a key
+            mKeyCount = 2;
 
-            if (tol == 2) {
-                util::copy_keys <DIM> (first, last, keys.get (), result);
-                return result;
+            sub_poly poly (0, coordCount-DIM);
+            poly.key = find (poly);
+            mQueue.push (poly);         // add complete poly
+            mStats.depth (1);
+        }
+
+        /*!
+            \brief Adds at most count keys, returns the number of added keys.
+        */
+        std::size_t refine (std::size_t count) {
+            std::size_t added = 0;
+            while (added < count && !mQueue.empty () && !mStats.stopped ()) {
+                step ();
+                ++added;
             }
+            return added;
+        }
 
-            // keep track of all sub polylines that still need to be processed
-            std::priority_queue <sub_poly> queue;    // sorted (max key dist2) job queue
-            sub_poly poly (0, coordCount-DIM);
-            poly.key = key_finder::apply (first, poly.first, poly.last);
-            queue.push (poly);                       // add complete poly
-
-            while (!queue.empty ()) {
-                poly = queue.top ();                 // take a sub poly
-                queue.pop ();
-                // store the key
-                keys [static_cast<int>(poly.key.index / DIM)] = 1;
-                // check point count tolerance
-                if (++keyCount == tol) {
-                    break;
-                }
-                // split the polyline at the key and recurse
-                sub_poly left (poly.first, poly.key.index);
-                left.key = key_finder::apply (first, left.first, left.last);
-                if (left.key.index) {
-                    queue.push (left);
-                }
-                sub_poly right (poly.key.index, poly.last);
-                right.key = key_finder::apply (first, right.first, right.last);
-                if (right.key.index) {
-                    queue.push (right);
+        /*!
+            \brief Adds the next key without searching the halves of its sub polyline, after
+            which the refiner is done; returns the number of added keys.
+
+            A one-shot simplification uses this for its last key, which is never refined.
+        */
+        std::size_t refine_last () {
+            if (mQueue.empty () || mStats.stopped ()) {
+                return 0;
+            }
+            mKeys [static_cast <std::size_t> (mQueue.top ().key.index / DIM)] = 1;
+            ++mKeyCount;
+            mQueue = util::dary_heap <sub_poly> ();
+            return 1;
+        }
+
+        /*!
+            \brief Adds keys until the deadline has passed, returns the number of added keys.
+
+            The deadline is a std::chrono::time_point; its clock is read before each key is
+            added. A single step takes at most O(n), and much less once the simplification
+            contains more than a few keys.
+        */
+        template <typename TimePoint>
+        std::size_t refine_until (const TimePoint& deadline) {
+            std::size_t added = 0;
+            while (!mQueue.empty () && !mStats.stopped () && TimePoint::clock::now () < deadline) {
+                step ();
+                ++added;
+            }
+            return added;
+        }
+
+        //! \brief Indicates if no more keys can be added.
+        bool done () const {
+            return mQueue.empty ();
+        }
+
+        //! \brief Returns the current number of keys, including the end points.
+        std::size_t key_count () const {
+            return mKeyCount;
+        }
+
+        /*!
+            \brief Returns the squared distance of the next key to the current simplification,
+            which is the largest positional error of the current simplification; 0 when done.
+        */
+        calc_type max_distance2 () const {
+            return mQueue.empty () ? calc_type (0) : mQueue.top ().key.dist2;
+        }
+
+        /*!
+            \brief Copies the coordinates of the current keys to result, which is O(n).
+        */
+        template <typename OutputIterator>
+        OutputIterator copy_keys (OutputIterator result) const {
+            if (!mValid) {
+                return std::copy (mFirst, mLast, result);
+            }
+            util::copy_keys <DIM> (mFirst, mLast, mKeys.begin (), result);
+            return result;
+        }
+
+        /*!
+            \brief Copies the point indices of the current keys to result, which is O(n).
+        */
+        template <typename OutputIterator>
+        OutputIterator copy_key_indices (OutputIterator result) const {
+            for (std::size_t index = 0; index < mKeyCount && !mValid; ++index) {
+                *result = static_cast <diff_type> (index);      // all complete points
+                ++result;
+            }
+            for (std::size_t index = 0; index < mKeys.size (); ++index) {
+                if (mKeys [index]) {
+                    *result = static_cast <diff_type> (index);
+                    ++result;
                 }
             }
-            // copy keys
-            util::copy_keys <DIM> (first, last, keys.get (), result);
             return result;
         }
 
@@ -847,10 +1951,428 @@ namespace psimpl {
             diff_type last;     //!< coord index of the last point
             key_type key;       //!< key of this sub poly
 
+            //! \brief Orders on key dist2; ties go to the sub poly that comes first.
             bool operator< (const sub_poly& other) const {
-                return key.dist2 < other.key.dist2;
+                return key.dist2 < other.key.dist2 ||
+                       (key.dist2 == other.key.dist2 && other.first < first);
+            }
+        };
+
+        //! \brief Adds the key of the top sub poly, and queues both its halves.
+        void step () {
+            sub_poly poly = mQueue.top ();      // take a sub poly
+            mQueue.pop ();
+            // store the key
+            mKeys [static_cast <std::size_t> (poly.key.index / DIM)] = 1;
+            ++mKeyCount;
+            // split the polyline at the key and recurse
+            sub_poly left (poly.first, poly.key.index);
+            left.key = find (left);
+            if (left.key.index) {
+                mQueue.push (left);
+            }
+            sub_poly right (poly.key.index, poly.last);
+            right.key = find (right);
+            if (right.key.index) {
+                mQueue.push (right);
+            }
+            mStats.depth (mQueue.size ());
+        }
+
+        //! \brief Finds the key of a sub poly.
+        key_type find (const sub_poly& poly) {
+            mStats.key_search (static_cast <unsigned long long> ((poly.last - poly.first) / DIM + 1));
+            mStats.distance (static_cast <unsigned long long> ((poly.last - poly.first) / DIM - 1));
+            return key_finder::apply (mFirst, poly.first, poly.last);
+        }
+
+        RandomAccessIterator mFirst;            //!< the first coordinate of the polyline
+        RandomAccessIterator mLast;             //!< one beyond the last coordinate of the polyline
+        bool mValid;                            //!< indicates if the polyline can be simplified
+        std::size_t mKeyCount;                  //!< the number of keys
+        std::vector <unsigned char> mKeys;      //!< indicates which points are keys
+        util::dary_heap <sub_poly> mQueue;      //!< sorted (max key dist2) job queue
+        Counters mStats;                        //!< counts the key searches
+    };
+
+    /*!
+        \brief Douglas-Peucker approximation, but with a point count tolerance (DPn).
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Size,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct douglas_peucker_n
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+        /*!
+            \brief Performs Douglas-Peucker approximation, but uses a point count tolerance.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Size tol,
+            OutputIterator result,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM      // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            // validate input and check if simplification required
+            if (coordCount % DIM || pointCount <= static_cast <diff_type> (tol) || tol < 2) {
+                return std::copy (first, last, result);
+            }
+
+            // only the end points, no key search needed
+            if (tol == 2) {
+                util::copy_key <DIM> (first, result);
+                util::copy_key <DIM> (first + (coordCount - DIM), result);
+                return result;
+            }
+
+            util::trace_scope trace ("douglas_peucker_n");
+            util::trace_scope stage ("find keys");
+            douglas_peucker_n_refiner <DIM, RandomAccessIterator, Counters> refiner (first, last, stats);
+            refiner.refine (static_cast <std::size_t> (tol - 3));
+            refiner.refine_last ();
+            if (stats.stopped ()) {
+                return result;
+            }
+            stage.next ("copy keys");
+            return refiner.copy_keys (result);
+        }
+    };
+
+    namespace detail
+    {
+        /*!
+            \brief The complete DPc recursion of a polyline, as importance of each point.
+
+            The DPc recursion is run without a tolerance, until no sub polyline has internal
+            points left. The importance of a key is the smallest squared distance of itself and
+            all the keys that were found before it, along its path in the recursion. DPc with
+            tolerance tol keeps exactly the end points and the points with tol * tol below their
+            importance.
+
+            Optionally, the positional error is tracked: the sum of the positional errors of the
+            internal points of each sub polyline is computed while its key is searched. The error
+            delta of a key is the change of the total positional error when its sub polyline is
+            split at that key.
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename Counters = util::no_counters
+        >
+        struct douglas_peucker_hierarchy
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+            typedef typename util::select_calculation_type <RandomAccessIterator>::type calc_type;
+
+            /*!
+                \brief Runs the DPc recursion over pointCount points.
+
+                \param[in] first        the first coordinate of the first polyline point
+                \param[in] pointCount   the number of points, at least 2
+                \param[in] errors       indicates if the error deltas should be computed
+                \param[in] stats        counts the key searches
+            */
+            douglas_peucker_hierarchy (RandomAccessIterator first, diff_type pointCount, bool errors, Counters stats = Counters ()) :
+                importance (static_cast <std::size_t> (pointCount), calc_type (0)),
+                base (0)
+            {
+                if (errors) {
+                    delta.assign (static_cast <std::size_t> (pointCount), 0.0);
+                }
+                std::stack <sub_poly> stack;    // LIFO job-queue
+                stack.push (sub_poly (0, pointCount - 1, -1, std::numeric_limits <calc_type>::max ()));
+                stats.depth (1);
+
+                while (!stack.empty () && !stats.stopped ()) {
+                    sub_poly poly = stack.top ();
+                    stack.pop ();
+                    if (poly.last - poly.first < 2) {
+                        continue;
+                    }
+                    RandomAccessIterator s1 = first + poly.first * DIM;
+                    RandomAccessIterator s2 = first + poly.last * DIM;
+                    RandomAccessIterator p = s1 + DIM;
+                    stats.key_search (static_cast <unsigned long long> (poly.last - poly.first + 1));
+                    stats.distance (static_cast <unsigned long long> (poly.last - poly.first - 1));
+
+                    // find the key like find_key does: the last point with the largest distance
+                    diff_type key = 0;
+                    calc_type dist2 = 0;
+                    double sum = 0;
+                    for (diff_type index = poly.first + 1; index < poly.last; ++index, p += DIM) {
+                        calc_type d2 = math::segment_distance2 <DIM> (s1, s2, p);
+                        if (dist2 <= d2) {
+                            key = index;
+                            dist2 = d2;
+                        }
+                        if (errors) {
+                            sum += std::sqrt (static_cast <double> (d2));
+                        }
+                    }
+                    if (errors) {
+                        if (poly.parent < 0) {
+                            base = sum;
+                        }
+                        else {
+                            delta [static_cast <std::size_t> (poly.parent)] += sum;
+                        }
+                        delta [static_cast <std::size_t> (key)] -= sum;
+                    }
+                    calc_type value = std::min (dist2, poly.importance);
+                    importance [static_cast <std::size_t> (key)] = value;
+                    stack.push (sub_poly (key, poly.last, key, value));
+                    stack.push (sub_poly (poly.first, key, key, value));
+                    stats.depth (stack.size ());
+                }
+            }
+
+            std::vector <calc_type> importance; //!< importance of each point, 0 for the end points
+            std::vector <double> delta;         //!< error delta of each point, when requested
+            double base;                        //!< positional error sum when only the end points are kept
+
+        private:
+            /*!
+                \brief Defines a sub polyline.
+            */
+            struct sub_poly {
+                sub_poly (diff_type first, diff_type last, diff_type parent, calc_type importance) :
+                    first (first), last (last), parent (parent), importance (importance) {}
+
+                diff_type first;        //!< index of the first point
+                diff_type last;         //!< index of the last point
+                diff_type parent;       //!< index of the key that split off this sub poly, or -1
+                calc_type importance;   //!< importance of that key
+            };
+        };
+
+        /*!
+            \brief Returns the smallest tolerance tol with threshold <= tol * tol, for which DPc
+            keeps no point with an importance up to threshold.
+
+            Rounding may make tol * tol exceed the importance of points just above threshold,
+            which are then dropped as well.
+
+            \param[in] threshold    squared distance threshold
+            \param[in] smallest     smallest positive importance, or 0 if there is none
+        */
+        inline double tolerance_for_importance (double threshold, double smallest) {
+            if (threshold <= 0) {
+                // any tolerance below the smallest positive importance
+                return smallest > 0 ? std::sqrt (smallest) / 2 : 1.0;
+            }
+            double tol = std::sqrt (threshold);
+            while (tol * tol < threshold) {
+                tol = std::nextafter (tol, std::numeric_limits <double>::max ());
+            }
+            return tol;
+        }
+    }
+
+    /*!
+        \brief Douglas-Peucker approximation (DPc), solving for a tolerance that meets a target.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct douglas_peucker_solver
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+        typedef typename util::select_calculation_type <RandomAccessIterator>::type calc_type;
+        typedef detail::douglas_peucker_hierarchy <DIM, RandomAccessIterator, Counters> hierarchy;
+
+        /*!
+            \brief Finds the smallest tolerance for which DPc keeps at most count points.
+        */
+        template <typename Size>
+        static OutputIterator simplify_to_count (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Size count,
+            OutputIterator result,
+            double* tol,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM      // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            if (tol) {
+                *tol = 0;
+            }
+            // validate input and check if simplification required
+            if (coordCount % DIM || pointCount < 3 || count < 2 ||
+                pointCount <= static_cast <diff_type> (count))
+            {
+                return std::copy (first, last, result);
+            }
+            util::trace_scope trace ("douglas_peucker_to_count");
+            util::trace_scope stage ("hierarchy");
+            hierarchy h (first, pointCount, false, stats);
+            if (stats.stopped ()) {
+                return result;
+            }
+            stage.next ("solve");
+
+            // the threshold is the (count - 1)th largest importance of the internal points
+            std::vector <calc_type> sorted (h.importance.begin () + 1, h.importance.end () - 1);
+            typename std::vector <calc_type>::iterator nth = sorted.begin () + (static_cast <diff_type> (count) - 2);
+            std::nth_element (sorted.begin (), nth, sorted.end (), std::greater <calc_type> ());
+            double threshold = static_cast <double> (*nth);
+
+            stage.next ("copy keys");
+            return copy (first, last, h, detail::tolerance_for_importance (threshold, smallest (h)), result, tol);
+        }
+
+        /*!
+            \brief Finds the largest tolerance for which the mean positional error of DPc does not
+            exceed a target.
+        */
+        static OutputIterator simplify_to_error (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            double error,
+            OutputIterator result,
+            double* tol,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM      // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            if (tol) {
+                *tol = 0;
             }
+            // validate input and check if simplification required
+            if (coordCount % DIM || pointCount < 3 || error < 0) {
+                return std::copy (first, last, result);
+            }
+            util::trace_scope trace ("douglas_peucker_to_error");
+            util::trace_scope stage ("hierarchy");
+            hierarchy h (first, pointCount, true, stats);
+            if (stats.stopped ()) {
+                return result;
+            }
+            stage.next ("solve");
+
+            // add the keys by decreasing importance, until the mean error is small enough
+            std::vector <diff_type> order;
+            order.reserve (static_cast <std::size_t> (pointCount - 2));
+            for (diff_type index = 1; index < pointCount - 1; ++index) {
+                if (0 < h.importance [static_cast <std::size_t> (index)]) {
+                    order.push_back (index);
+                }
+            }
+            std::sort (order.begin (), order.end (), by_importance (h.importance));
+
+            double limit = error * static_cast <double> (pointCount);
+            double sum = h.base;
+            std::size_t i = 0;
+            while (i < order.size () && limit < sum) {
+                // all keys with an equal importance are added at once
+                calc_type value = h.importance [static_cast <std::size_t> (order [i])];
+                while (i < order.size () && h.importance [static_cast <std::size_t> (order [i])] == value) {
+                    sum += h.delta [static_cast <std::size_t> (order [i++])];
+                }
+            }
+            double low = smallest (h);
+            double t = tolerance (h, order, i, low);
+
+            // the tolerance is rounded up, so that DPc may drop keys just above the threshold
+            // whose error deltas were counted; add groups until the kept keys meet the limit
+            sum = h.base;
+            std::size_t kept = 0;
+            while (i < order.size ()) {
+                double tol2 = t * t;
+                for (; kept < order.size () && tol2 < h.importance [static_cast <std::size_t> (order [kept])]; ++kept) {
+                    sum += h.delta [static_cast <std::size_t> (order [kept])];
+                }
+                if (sum <= limit) {
+                    break;
+                }
+                calc_type value = h.importance [static_cast <std::size_t> (order [i])];
+                while (i < order.size () && h.importance [static_cast <std::size_t> (order [i])] == value) {
+                    ++i;
+                }
+                t = tolerance (h, order, i, low);
+            }
+
+            stage.next ("copy keys");
+            return copy (first, last, h, t, result, tol);
+        }
+
+    private:
+        //! \brief Orders point indices on decreasing importance.
+        struct by_importance {
+            by_importance (const std::vector <calc_type>& importance) :
+                importance (importance) {}
+
+            bool operator() (diff_type a, diff_type b) const {
+                return importance [static_cast <std::size_t> (b)] < importance [static_cast <std::size_t> (a)];
+            }
+
+            const std::vector <calc_type>& importance;
         };
+
+        //! \brief Returns a tolerance for which DPc keeps the keys before order [i], given the smallest importance.
+        static double tolerance (const hierarchy& h, const std::vector <diff_type>& order, std::size_t i, double low) {
+            double threshold = i < order.size ()
+                               ? static_cast <double> (h.importance [static_cast <std::size_t> (order [i])])
+                               : 0.0;
+            return detail::tolerance_for_importance (threshold, low);
+        }
+
+        //! \brief Returns the smallest positive importance, or 0 if there is none.
+        static double smallest (const hierarchy& h) {
+            double result = 0;
+            for (std::size_t index = 0; index < h.importance.size (); ++index) {
+                double value = static_cast <double> (h.importance [index]);
+                if (0 < value && (result == 0 || value < result)) {
+                    result = value;
+                }
+            }
+            return result;
+        }
+
+        //! \brief Copies the points that DPc keeps for tolerance t.
+        static OutputIterator copy (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            const hierarchy& h,
+            double t,
+            OutputIterator result,
+            double* tol)
+        {
+            // compared like douglas_peucker_classic does for a tolerance of type double
+            double tol2 = t * t;
+            std::size_t pointCount = h.importance.size ();
+            util::scoped_array <unsigned char> keys (static_cast <unsigned> (pointCount));
+            for (std::size_t index = 0; index < pointCount; ++index) {
+                keys [static_cast <int> (index)] = tol2 < h.importance [index];
+            }
+            keys [0] = 1;
+            keys [static_cast <int> (pointCount - 1)] = 1;
+            util::copy_keys <DIM> (first, last, keys.get (), result);
+            if (tol) {
+                *tol = t;
+            }
+            return result;
+        }
     };
 
 }}
@@ -0,0 +1,137 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+#ifndef PSIMPL_DETAIL_BATCH
+#define PSIMPL_DETAIL_BATCH
+
+
+#include <vector>
+#include "algo.h"
+#include "counters.h"
+#include "trace.h"
+#include "util.h"
+
+
+namespace psimpl {
+    namespace algo
+{
+
+    /*!
+        \brief Douglas-Peucker approximation, with RD as a preprocessing step (DP), for a batch of
+        polylines.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename OffsetIterator,
+        typename Distance,
+        typename OutputIterator,
+        typename OffsetOutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct douglas_peucker_batch
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+        typedef typename std::iterator_traits <RandomAccessIterator>::value_type value_type;
+        typedef std::back_insert_iterator <std::vector <value_type> > reduced_output;
+        typedef util::counting_output <OutputIterator> counting_output;
+        typedef douglas_peucker_classic <DIM, value_type*, Distance, counting_output, Counters> classic;
+
+        /*!
+            \brief Performs Douglas-Peucker approximation, using RD as a preprocessing step, on
+            each polyline of a batch.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            OffsetIterator offsets_first,
+            OffsetIterator offsets_last,
+            Distance tol,
+            OutputIterator result,
+            OffsetOutputIterator result_offsets,
+            Counters stats = Counters ())
+        {
+            util::trace_scope trace ("douglas_peucker_batch");
+            diff_type offset = 0;
+            *result_offsets = offset;
+            ++result_offsets;
+
+            if (offsets_first == offsets_last) {
+                return result;
+            }
+            std::vector <value_type> reduced;   // radial distance results of a single polyline
+            typename classic::buffers storage;  // the DPc buffers, reused by each polyline
+            diff_type poly_first = static_cast <diff_type> (*offsets_first);
+
+            while (++offsets_first != offsets_last) {
+                diff_type poly_last = static_cast <diff_type> (*offsets_first);
+                counting_output out (result);
+                // like simplify_douglas_peucker, copy polylines that need no simplification
+                if (tol <= 0) {
+                    out = std::copy (first + poly_first, first + poly_last, out);
+                }
+                else {
+                    // radial distance simplification routine
+                    reduced.clear ();
+                    radial_distance
+                        <
+                            DIM,
+                            RandomAccessIterator,
+                            Distance,
+                            reduced_output,
+                            Counters
+                        >::simplify (first + poly_first, first + poly_last, tol,
+                                     std::back_inserter (reduced), stats);
+                    // douglas-peucker approximation
+                    value_type* reduced_first = reduced.empty () ? 0 : &reduced [0];
+                    out = classic::simplify (reduced_first, reduced_first + reduced.size (), tol, storage, out, stats);
+                }
+                result = out.base ();
+                offset += static_cast <diff_type> (out.count ());
+                *result_offsets = offset;
+                ++result_offsets;
+                poly_first = poly_last;
+                // stop in between polylines if requested
+                if (stats.stopped ()) {
+                    break;
+                }
+            }
+            return result;
+        }
+    };
+
+}}
+
+
+#endif // PSIMPL_DETAIL_BATCH
@@ -0,0 +1,343 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+
+#ifndef PSIMPL_DETAIL_COUNTERS
+#define PSIMPL_DETAIL_COUNTERS
+
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+
+namespace psimpl
+{
+    /*!
+        \brief Counts the work done by the simplification routines.
+
+        Pass an instance to a routine through with_counters. The counters are not cleared by the
+        routines, so the work of several polylines can be collected. Each thread should use its
+        own instance; instances can be combined with merge.
+    */
+    struct counters
+    {
+        static const unsigned histogram_size = 32;  //!< number of sub polyline size buckets
+
+        counters () {
+            reset ();
+        }
+
+        //! \brief Clears all counts.
+        void reset () {
+            distances = 0;
+            key_searches = 0;
+            max_depth = 0;
+            backtracks = 0;
+            output = 0;
+            std::fill (sub_polylines, sub_polylines + histogram_size, 0ull);
+        }
+
+        //! \brief Adds the counts of other.
+        void merge (const counters& other) {
+            distances += other.distances;
+            key_searches += other.key_searches;
+            max_depth = std::max (max_depth, other.max_depth);
+            backtracks += other.backtracks;
+            output += other.output;
+            for (unsigned k = 0; k < histogram_size; ++k) {
+                sub_polylines [k] += other.sub_polylines [k];
+            }
+        }
+
+        /*!
+            \brief Returns the histogram bucket of a sub polyline of pointCount points.
+
+            Bucket k holds the sizes [2^k, 2^(k+1)), the last bucket holds all larger sizes.
+        */
+        static unsigned bucket (unsigned long long pointCount) {
+            unsigned k = 0;
+            while (pointCount > 1 && k + 1 < histogram_size) {
+                pointCount >>= 1;
+                ++k;
+            }
+            return k;
+        }
+
+        unsigned long long distances;       //!< point, line, ray, segment distance or sleeve tests
+        unsigned long long key_searches;    //!< Douglas-Peucker key searches (find_key calls)
+        unsigned long long max_depth;       //!< high-water mark of the Douglas-Peucker stack or queue
+        unsigned long long backtracks;      //!< Lang look ahead reductions
+        unsigned long long output;          //!< values written through with_counters (result, stats)
+        unsigned long long sub_polylines [histogram_size];  //!< points per searched sub polyline, log2 buckets
+    };
+
+    namespace util
+    {
+        /*!
+            \brief Counters policy that counts nothing.
+
+            All members are empty, so that an algorithm instantiated with this policy compiles to
+            the same code as without instrumentation. This is the default policy of all algorithms.
+            An algorithm stops as soon as it sees stopped return true, see util::progress_ref.
+        */
+        struct no_counters
+        {
+            void distance (unsigned long long = 1) const {}
+            void key_search (unsigned long long) const {}
+            void depth (unsigned long long) const {}
+            void backtrack () const {}
+            void output () const {}
+            bool stopped () const { return false; }
+        };
+
+        /*!
+            \brief Counters policy that adds to a psimpl::counters instance.
+        */
+        class counters_ref
+        {
+        public:
+            explicit counters_ref (counters& stats) :
+                mStats (&stats)
+            {}
+
+            //! \brief Records n distance evaluations.
+            void distance (unsigned long long n = 1) const {
+                mStats->distances += n;
+            }
+
+            //! \brief Records a key search in a sub polyline of pointCount points.
+            void key_search (unsigned long long pointCount) const {
+                ++mStats->key_searches;
+                ++mStats->sub_polylines [counters::bucket (pointCount)];
+            }
+
+            //! \brief Records the current size of a stack or queue.
+            void depth (unsigned long long size) const {
+                mStats->max_depth = std::max (mStats->max_depth, size);
+            }
+
+            //! \brief Records a backtrack.
+            void backtrack () const {
+                ++mStats->backtracks;
+            }
+
+            //! \brief Records a value written to the output.
+            void output () const {
+                ++mStats->output;
+            }
+
+            //! \brief Counting never stops an algorithm.
+            bool stopped () const {
+                return false;
+            }
+
+        private:
+            counters* mStats;
+        };
+
+        /*!
+            \brief Output iterator adaptor that counts the coordinates written through it.
+        */
+        template <typename OutputIterator>
+        class counting_output
+        {
+        public:
+            typedef std::output_iterator_tag iterator_category;
+            typedef void value_type;
+            typedef void difference_type;
+            typedef void pointer;
+            typedef void reference;
+
+            explicit counting_output (OutputIterator it) :
+                mIt (it),
+                mCount (0)
+            {}
+
+            counting_output& operator* () {
+                return *this;
+            }
+
+            //! \brief Writes value and advances, like an insert iterator does.
+            template <typename T>
+            counting_output& operator= (const T& value) {
+                *mIt = value;
+                ++mIt;
+                ++mCount;
+                return *this;
+            }
+
+            counting_output& operator++ () {
+                return *this;
+            }
+
+            counting_output& operator++ (int) {
+                return *this;
+            }
+
+            //! \brief Returns the adapted iterator.
+            OutputIterator base () const {
+                return mIt;
+            }
+
+            //! \brief Returns the number of coordinates written.
+            std::size_t count () const {
+                return mCount;
+            }
+
+        private:
+            OutputIterator mIt;
+            std::size_t mCount;
+        };
+
+        /*!
+            \brief Output iterator adaptor that carries a counters policy to a routine, and
+            records each value written through it.
+
+            Created by psimpl::with_counters. The routines find the policy with output_counters.
+        */
+        template <typename OutputIterator, typename Counters>
+        class monitored_output
+        {
+        public:
+            typedef std::output_iterator_tag iterator_category;
+            typedef void value_type;
+            typedef void difference_type;
+            typedef void pointer;
+            typedef void reference;
+
+            monitored_output (OutputIterator it, Counters stats) :
+                mIt (it),
+                mStats (stats)
+            {}
+
+            monitored_output& operator* () {
+                return *this;
+            }
+
+            //! \brief Writes value and advances, like an insert iterator does.
+            template <typename T>
+            monitored_output& operator= (const T& value) {
+                *mIt = value;
+                ++mIt;
+                mStats.output ();
+                return *this;
+            }
+
+            monitored_output& operator++ () {
+                return *this;
+            }
+
+            monitored_output& operator++ (int) {
+                return *this;
+            }
+
+            //! \brief Returns the adapted iterator.
+            OutputIterator base () const {
+                return mIt;
+            }
+
+            //! \brief Returns the counters policy.
+            Counters counters () const {
+                return mStats;
+            }
+
+        private:
+            OutputIterator mIt;
+            Counters mStats;
+        };
+
+        /*!
+            \brief Selects the counters policy of a routine from its output iterator.
+
+            Plain output iterators select no_counters, so that the routine is not instrumented.
+        */
+        template <typename OutputIterator>
+        struct output_counters
+        {
+            typedef no_counters type;
+
+            static type get (const OutputIterator&) {
+                return type ();
+            }
+        };
+
+        template <typename OutputIterator, typename Counters>
+        struct output_counters <monitored_output <OutputIterator, Counters> >
+        {
+            typedef Counters type;
+
+            static type get (const monitored_output <OutputIterator, Counters>& result) {
+                return result.counters ();
+            }
+        };
+    }
+
+    /*!
+        \brief Counts the work of a routine that writes to result.
+
+        Pass the returned iterator instead of result. The routine then adds its work to stats,
+        and each value it writes to stats.output. The returned iterator of the routine is an
+        adaptor as well; its base () is the end of the output range.
+
+        \param[in] result      destination of the routine
+        \param[in,out] stats   collects the work done
+        \return                 output iterator that writes to result
+    */
+    template <typename OutputIterator>
+    inline util::monitored_output <OutputIterator, util::counters_ref> with_counters (
+        OutputIterator result,
+        counters& stats)
+    {
+        return util::monitored_output <OutputIterator, util::counters_ref> (result, util::counters_ref (stats));
+    }
+
+    /*!
+        \brief Counts the work of a routine without a single output iterator.
+
+        Pass the returned policy as the last argument of a routine that returns a value, like
+        compute_hausdorff_distance, or writes to several outputs, like
+        simplify_radial_distance_multi.
+
+        \param[in,out] stats   collects the work done
+        \return                 the counters policy
+    */
+    inline util::counters_ref with_counters (
+        counters& stats)
+    {
+        return util::counters_ref (stats);
+    }
+}
+
+#endif // PSIMPL_DETAIL_COUNTERS
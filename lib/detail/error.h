@@ -36,8 +36,14 @@
 #define PSIMPL_DETAIL_ERROR
 
 
-#include <numeric>
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include "counters.h"
+#include "spatial.h"
 
 
 namespace psimpl {
@@ -61,6 +67,288 @@ namespace psimpl {
         double std;     //! standard deviation
     };
 
+    /*!
+        \brief Single pass accumulator for statistics.
+
+        Values are added one at a time using Welford's update, in O(1) memory and without
+        storing the values. Accumulators of separate ranges, f.e. of different polylines or of
+        chunks of one polyline, can be combined with merge; the result equals that of a single
+        accumulator over all values, up to rounding.
+    */
+    class accumulator
+    {
+    public:
+        accumulator () :
+            mCount (0),
+            mMax (0),
+            mSum (0),
+            mMean (0),
+            mM2 (0)
+        {}
+
+        //! \brief Adds a single value.
+        void add (double value) {
+            ++mCount;
+            mMax = mCount == 1 ? value : std::max (mMax, value);
+            mSum += value;
+            double delta = value - mMean;
+            mMean += delta / static_cast <double> (mCount);
+            mM2 += delta * (value - mMean);
+        }
+
+        /*!
+            \brief Adds the values in [first, last).
+
+            The block is reduced in two passes without loop-carried divisions, and merged.
+        */
+        template
+        <
+            typename RandomAccessIterator
+        >
+        void add (
+            RandomAccessIterator first,
+            RandomAccessIterator last)
+        {
+            if (first == last) {
+                return;
+            }
+            accumulator block;
+            block.mCount = static_cast <std::size_t> (std::distance (first, last));
+            block.mMax = *first;
+            for (RandomAccessIterator it = first; it != last; ++it) {
+                block.mMax = std::max (block.mMax, static_cast <double> (*it));
+                block.mSum += *it;
+            }
+            block.mMean = block.mSum / static_cast <double> (block.mCount);
+            for (RandomAccessIterator it = first; it != last; ++it) {
+                double delta = *it - block.mMean;
+                block.mM2 += delta * delta;
+            }
+            merge (block);
+        }
+
+        //! \brief Adds all values of another accumulator.
+        void merge (const accumulator& other) {
+            if (!other.mCount) {
+                return;
+            }
+            if (!mCount) {
+                *this = other;
+                return;
+            }
+            double count = static_cast <double> (mCount + other.mCount);
+            double delta = other.mMean - mMean;
+            mMean += delta * static_cast <double> (other.mCount) / count;
+            mM2 += other.mM2 + delta * delta * static_cast <double> (mCount) * static_cast <double> (other.mCount) / count;
+            mSum += other.mSum;
+            mMax = std::max (mMax, other.mMax);
+            mCount += other.mCount;
+        }
+
+        //! \brief Returns the number of values added so far.
+        std::size_t count () const {
+            return mCount;
+        }
+
+        //! \brief Returns the statistics of all values added so far.
+        statistics result () const {
+            statistics stats;
+            if (mCount) {
+                stats.max = mMax;
+                stats.sum = mSum;
+                stats.mean = mSum / static_cast <double> (mCount);
+                stats.std = std::sqrt (std::max (0.0, mM2) / static_cast <double> (mCount));
+            }
+            return stats;
+        }
+
+    private:
+        std::size_t mCount;     //!< number of values
+        double mMax;            //!< largest value
+        double mSum;            //!< sum of all values
+        double mMean;           //!< running mean
+        double mM2;             //!< sum of squared differences from the running mean
+    };
+
+    /*!
+        \brief POD structure for storing common percentiles.
+    */
+    struct percentiles
+    {
+        percentiles () :
+            p50 (0),
+            p90 (0),
+            p99 (0),
+            p999 (0)
+        {}
+
+        double p50;
+        double p90;
+        double p99;
+        double p999;    //!< 99.9th percentile
+    };
+
+    /*!
+        \brief Mergeable quantile sketch for non-negative values (DDSketch).
+
+        Each positive value is counted in a logarithmic bucket, so that any reported quantile
+        is within the relative accuracy of the exact value. Zero (and negative) values are
+        counted separately and reported as zero. When more than max_buckets buckets would be
+        needed, the lowest buckets are collapsed into one; this only affects the accuracy of
+        the smallest values and keeps the upper percentiles exact to the relative accuracy.
+
+        Sketches with the same relative accuracy can be merged, f.e. to combine the errors of
+        several polylines or threads; the result is identical to that of a single sketch over
+        all values, as long as no buckets were collapsed.
+    */
+    class quantile_sketch
+    {
+    public:
+        quantile_sketch (
+            double relative_accuracy = 0.01,
+            std::size_t max_buckets = 2048) :
+            mGamma ((1 + relative_accuracy) / (1 - relative_accuracy)),
+            mLogGamma (std::log (mGamma)),
+            mMaxBuckets (std::max (max_buckets, static_cast <std::size_t> (1))),
+            mOffset (0),
+            mCount (0),
+            mZeroCount (0),
+            mMax (0)
+        {}
+
+        //! \brief Adds a single value.
+        void add (double value) {
+            if (!mCount || mMax < value) {
+                mMax = value;
+            }
+            ++mCount;
+            if (value <= 0) {
+                ++mZeroCount;
+                return;
+            }
+            int index = static_cast <int> (std::ceil (std::log (value) / mLogGamma));
+            mBins [bucket (extend (index, index), index)] += 1;
+        }
+
+        //! \brief Adds all values of another sketch with the same relative accuracy.
+        void merge (const quantile_sketch& other) {
+            if (!other.mCount) {
+                return;
+            }
+            if (!mCount || mMax < other.mMax) {
+                mMax = other.mMax;
+            }
+            mCount += other.mCount;
+            mZeroCount += other.mZeroCount;
+            if (other.mBins.empty ()) {
+                return;
+            }
+            int low = extend (other.mOffset, other.mOffset + static_cast <int> (other.mBins.size ()) - 1);
+            for (std::size_t i = 0; i < other.mBins.size (); ++i) {
+                mBins [bucket (low, other.mOffset + static_cast <int> (i))] += other.mBins [i];
+            }
+        }
+
+        //! \brief Removes all values, but keeps the relative accuracy and maximum number of buckets.
+        void clear () {
+            mOffset = 0;
+            mBins.clear ();
+            mCount = 0;
+            mZeroCount = 0;
+            mMax = 0;
+        }
+
+        //! \brief Returns the number of values added so far.
+        std::size_t count () const {
+            return mCount;
+        }
+
+        //! \brief Returns the number of buckets in use.
+        std::size_t buckets () const {
+            return mBins.size ();
+        }
+
+        /*!
+            \brief Returns an estimate of the q-quantile, 0 <= q <= 1.
+
+            The estimate is within the relative accuracy of the value with rank q * (count - 1)
+            in the sorted sequence of all values. The maximum (q = 1) is exact. Returns 0 when no
+            values were added.
+        */
+        double quantile (double q) const {
+            if (!mCount) {
+                return 0;
+            }
+            double rank = std::min (std::max (q, 0.0), 1.0) * static_cast <double> (mCount - 1);
+            if (rank >= static_cast <double> (mCount - 1)) {
+                // the maximum is known exactly
+                return mMax;
+            }
+            std::size_t seen = mZeroCount;
+            if (rank < static_cast <double> (seen)) {
+                return 0;
+            }
+            for (std::size_t i = 0; i < mBins.size (); ++i) {
+                seen += mBins [i];
+                if (rank < static_cast <double> (seen)) {
+                    double value = 2 * std::pow (mGamma, mOffset + static_cast <int> (i)) / (mGamma + 1);
+                    return std::min (value, mMax);
+                }
+            }
+            return mMax;
+        }
+
+        //! \brief Returns the 50th, 90th, 99th and 99.9th percentiles.
+        percentiles result () const {
+            percentiles p;
+            p.p50 = quantile (0.5);
+            p.p90 = quantile (0.9);
+            p.p99 = quantile (0.99);
+            p.p999 = quantile (0.999);
+            return p;
+        }
+
+    private:
+        /*!
+            \brief Makes room for the bucket indices [low, high].
+
+            Collapses the lowest buckets if the range would exceed the maximum number of
+            buckets, and returns the lowest index that is kept separately.
+        */
+        int extend (int low, int high) {
+            if (!mBins.empty ()) {
+                low = std::min (low, mOffset);
+                high = std::max (high, mOffset + static_cast <int> (mBins.size ()) - 1);
+            }
+            low = std::max (low, high - static_cast <int> (mMaxBuckets) + 1);
+
+            if (mBins.empty () || low != mOffset || mBins.size () != static_cast <std::size_t> (high - low + 1)) {
+                // the range only grows, which is rare after the first values
+                std::vector <std::size_t> bins (static_cast <std::size_t> (high - low + 1), 0);
+                for (std::size_t i = 0; i < mBins.size (); ++i) {
+                    bins [static_cast <std::size_t> (std::max (mOffset + static_cast <int> (i), low) - low)] += mBins [i];
+                }
+                mBins.swap (bins);
+                mOffset = low;
+            }
+            return low;
+        }
+
+        // returns the position of bucket index, where indices below low are collapsed into low
+        std::size_t bucket (int low, int index) const {
+            return static_cast <std::size_t> (std::max (index, low) - mOffset);
+        }
+
+        double mGamma;                      //!< ratio between the bounds of a bucket
+        double mLogGamma;                   //!< log (mGamma)
+        std::size_t mMaxBuckets;            //!< maximum number of buckets
+        int mOffset;                        //!< bucket index of mBins [0]
+        std::vector <std::size_t> mBins;    //!< number of values per bucket
+        std::size_t mCount;                 //!< number of values
+        std::size_t mZeroCount;             //!< number of values <= 0
+        double mMax;                        //!< largest value
+    };
+
     // ---------------------------------------------------------------------------------------------
 
     namespace detail
@@ -80,24 +368,61 @@ namespace psimpl {
             InputIterator first,
             InputIterator last)
         {
-            typedef typename std::iterator_traits <InputIterator>::value_type value_type;
-            typedef typename std::iterator_traits <InputIterator>::difference_type diff_type;
+            accumulator acc;
+            for (; first != last; ++first) {
+                acc.add (static_cast <double> (*first));
+            }
+            return acc.result ();
+        }
 
-            statistics stats;
+        /*!
+            \brief Output iterator that adds the square root of each assigned value to an accumulator.
+
+            Turns the squared errors written by positional::compute into statistics of the
+            errors, without an intermediate array. The errors are optionally also added to a
+            quantile sketch.
+        */
+        class sqrt_accumulate_iterator
+        {
+        public:
+            typedef std::output_iterator_tag iterator_category;
+            typedef void value_type;
+            typedef void difference_type;
+            typedef void pointer;
+            typedef void reference;
+
+            explicit sqrt_accumulate_iterator (
+                accumulator& acc,
+                quantile_sketch* sketch = 0) :
+                mAccumulator (&acc),
+                mSketch (sketch)
+            {}
 
-            diff_type count = std::distance (first, last);
-            if (count == 0) {
-                return stats;
+            sqrt_accumulate_iterator& operator= (double value2) {
+                double value = std::sqrt (value2);
+                mAccumulator->add (value);
+                if (mSketch) {
+                    mSketch->add (value);
+                }
+                return *this;
             }
 
-            value_type init = 0;
-            stats.max = static_cast <double> (*std::max_element (first, last));
-            stats.sum = static_cast <double> (std::accumulate (first, last, init));
-            stats.mean = stats.sum / static_cast<double>(count);
-            std::for_each(first, last, [&stats](auto& x) { x -= stats.mean; });
-            stats.std = std::sqrt (static_cast <double> (std::inner_product (first, last, first, init)) / static_cast<double>(count));
-            return stats;
-        }
+            sqrt_accumulate_iterator& operator* () {
+                return *this;
+            }
+
+            sqrt_accumulate_iterator& operator++ () {
+                return *this;
+            }
+
+            sqrt_accumulate_iterator& operator++ (int) {
+                return *this;
+            }
+
+        private:
+            accumulator* mAccumulator;
+            quantile_sketch* mSketch;
+        };
     }
 
     // ---------------------------------------------------------------------------------------------
@@ -113,7 +438,8 @@ namespace psimpl {
         unsigned DIM,
         typename ForwardIterator1,
         typename ForwardIterator2,
-        typename OutputIterator
+        typename OutputIterator,
+        typename Counters = util::no_counters
     >
     struct positional
     {
@@ -129,7 +455,8 @@ namespace psimpl {
             ForwardIterator2 simplified_first,
             ForwardIterator2 simplified_last,
             OutputIterator result,
-            bool* valid=0)
+            bool* valid=0,
+            Counters stats = Counters ())
         {
             ori_diff_type original_coordCount = std::distance (original_first, original_last);
             ori_diff_type original_pointCount = DIM     // protect against zero DIM
@@ -163,6 +490,10 @@ namespace psimpl {
                 while (original_first != original_last &&
                        !math::equal <DIM> (simplified_first, original_first))
                 {
+                    stats.distance ();
+                    if (stats.stopped ()) {
+                        return result;
+                    }
                     *result = math::segment_distance2 <DIM> (simplified_prev, simplified_first,
                                                              original_first);
                     ++result;
@@ -185,54 +516,1421 @@ namespace psimpl {
         }
     };
 
+    namespace detail
+    {
+        /*!
+            \brief Checks that the indices of the kept points are strictly increasing, and run
+            from the first to the last point of a polyline with coordCount coordinates.
+        */
+        template
+        <
+            unsigned DIM,
+            typename ForwardIterator,
+            typename diff_type
+        >
+        bool valid_indices (
+            diff_type coordCount,
+            ForwardIterator keys_first,
+            ForwardIterator keys_last)
+        {
+            diff_type pointCount = DIM      // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+
+            bool ok = coordCount % DIM == 0 && pointCount >= 2 && keys_first != keys_last &&
+                      static_cast <diff_type> (*keys_first) == 0;
+            diff_type prev = 0;
+            for (ForwardIterator key = keys_first; ok && ++key != keys_last; ) {
+                diff_type index = static_cast <diff_type> (*key);
+                ok = prev < index && index < pointCount;
+                prev = index;
+            }
+            return ok && prev == pointCount - 1;
+        }
+
+        /*!
+            \brief Passes a block of count errors to sink, and reports them as distance evaluations.
+
+            \return false when the computation should stop
+        */
+        template
+        <
+            typename Sink,
+            typename T,
+            typename Size,
+            typename Counters
+        >
+        inline bool flush_errors (
+            Sink& sink,
+            T* errors,
+            Size& count,
+            Counters stats)
+        {
+            stats.distance (static_cast <unsigned long long> (count));
+            sink (errors, count);
+            count = 0;
+            return !stats.stopped ();
+        }
+
+        /*!
+            \brief Computes the squared positional errors for the points [begin, end) of a polyline,
+            given the indices [keys_first, keys_last) of the points kept in its simplification.
+
+            The errors are passed to sink in blocks, as sink (errors, count), so that both the
+            distance loop and the processing of the errors can be vectorized. Kept points have
+            an error of zero. Computing a range of points at a time allows a long polyline to be
+            split into chunks. The computation stops after a block when stats is stopped.
+
+            \pre the indices are valid, see valid_indices, *keys_first <= begin, and
+            begin < end <= the last index + 1
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename ForwardIterator,
+            typename Sink,
+            typename Counters
+        >
+        void positional_range_blocks (
+            RandomAccessIterator original_first,
+            ForwardIterator keys_first,
+            ForwardIterator keys_last,
+            typename std::iterator_traits <RandomAccessIterator>::difference_type begin,
+            typename std::iterator_traits <RandomAccessIterator>::difference_type end,
+            Sink& sink,
+            Counters stats)
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+            typedef typename util::select_calculation_type <RandomAccessIterator>::type calc_type;
+
+            const diff_type blockSize = 256;
+            calc_type errors [blockSize];
+            diff_type size = 0;
+
+            diff_type first = static_cast <diff_type> (*keys_first);
+            for (ForwardIterator key = ++keys_first; key != keys_last && first < end; ++key) {
+                diff_type last = static_cast <diff_type> (*key);
+                diff_type point = std::max (first, begin);
+
+                // the start of the segment is a key
+                if (point == first) {
+                    errors [size++] = 0;
+                    ++point;
+                    if (size == blockSize && !flush_errors (sink, errors, size, stats)) {
+                        return;
+                    }
+                }
+
+                // segment (s1, s2)
+                calc_type s1 [DIM];
+                calc_type v [DIM];  // vector s1 --> s2
+                for (unsigned d = 0; d < DIM; ++d) {
+                    s1 [d] = static_cast <calc_type> (original_first [first * DIM + d]);
+                    v [d] = static_cast <calc_type> (original_first [last * DIM + d]) - s1 [d];
+                }
+                calc_type cv = math::dot <DIM> (v, v);
+                calc_type inv = cv > 0 ? 1 / cv : 0;
+
+                // the points between s1 and s2, in blocks
+                RandomAccessIterator p = original_first + point * DIM;
+                diff_type count = std::min (last, end) - point;
+                while (count > 0) {
+                    diff_type n = std::min (count, blockSize - size);
+                    calc_type* out = errors + size;
+                    for (diff_type i = 0; i < n; ++i) {
+                        // project onto the segment, clamped instead of branching
+                        calc_type w [DIM];  // vector s1 --> p
+                        calc_type cw = 0;
+                        for (unsigned d = 0; d < DIM; ++d) {
+                            w [d] = static_cast <calc_type> (p [i * DIM + d]) - s1 [d];
+                            cw += w [d] * v [d];
+                        }
+                        calc_type fraction = std::min (std::max (cw * inv, calc_type (0)), calc_type (1));
+                        calc_type d2 = 0;
+                        for (unsigned d = 0; d < DIM; ++d) {
+                            calc_type e = w [d] - fraction * v [d];
+                            d2 += e * e;
+                        }
+                        out [i] = d2;
+                    }
+                    p += n * DIM;
+                    count -= n;
+                    size += n;
+                    if (size == blockSize && !flush_errors (sink, errors, size, stats)) {
+                        return;
+                    }
+                }
+                first = last;
+            }
+            // the last point is a key
+            if (first < end) {
+                errors [size++] = 0;
+            }
+            if (size) {
+                flush_errors (sink, errors, size, stats);
+            }
+        }
+
+        /*!
+            \brief Computes the squared positional errors for a polyline and the indices of the
+            points kept in its simplification.
+
+            The errors are passed to sink in blocks, see positional_range_blocks.
+
+            \return false when the input is invalid, in which case sink is not called
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename ForwardIterator,
+            typename Sink,
+            typename Counters
+        >
+        bool positional_indexed_blocks (
+            RandomAccessIterator original_first,
+            RandomAccessIterator original_last,
+            ForwardIterator keys_first,
+            ForwardIterator keys_last,
+            Sink& sink,
+            Counters stats)
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+            diff_type coordCount = std::distance (original_first, original_last);
+            if (!valid_indices <DIM> (coordCount, keys_first, keys_last)) {
+                return false;
+            }
+            positional_range_blocks <DIM> (original_first, keys_first, keys_last,
+                                           diff_type (0), coordCount / DIM, sink, stats);
+            return true;
+        }
+
+        //! \brief Block sink that copies the errors to an output iterator.
+        template
+        <
+            typename OutputIterator
+        >
+        struct copy_sink
+        {
+            explicit copy_sink (OutputIterator result) :
+                result (result)
+            {}
+
+            template <typename T, typename Size>
+            void operator() (const T* errors, Size count) {
+                result = std::copy (errors, errors + count, result);
+            }
+
+            OutputIterator result;
+        };
+
+        //! \brief Block sink that accumulates the square root of the errors.
+        struct sqrt_accumulate_sink
+        {
+            sqrt_accumulate_sink (
+                accumulator& acc,
+                quantile_sketch* sketch) :
+                acc (acc),
+                sketch (sketch)
+            {}
+
+            template <typename T, typename Size>
+            void operator() (T* errors, Size count) {
+                for (Size i = 0; i < count; ++i) {
+                    errors [i] = std::sqrt (errors [i]);
+                }
+                acc.add (errors, errors + count);
+                if (sketch) {
+                    for (Size i = 0; i < count; ++i) {
+                        sketch->add (static_cast <double> (errors [i]));
+                    }
+                }
+            }
+
+            accumulator& acc;
+            quantile_sketch* sketch;
+        };
+    }
+
+    /*!
+        \brief Squared positional error between a polyline and its simplification, where the
+        simplification is defined by the indices of the kept points.
+
+        \note all calculated error values are of the type util::select_calculation_type <RandomAccessIterator>::type
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct positional_indexed
+    {
+        /*!
+            \brief Computes the squared positional error between a polyline and its simplification.
+        */
+        static OutputIterator compute (
+            RandomAccessIterator original_first,
+            RandomAccessIterator original_last,
+            ForwardIterator keys_first,
+            ForwardIterator keys_last,
+            OutputIterator result,
+            bool* valid=0,
+            Counters stats = Counters ())
+        {
+            detail::copy_sink <OutputIterator> sink (result);
+            bool ok = detail::positional_indexed_blocks <DIM> (
+                original_first, original_last, keys_first, keys_last, sink, stats);
+
+            if (valid) {
+                *valid = ok;
+            }
+            return sink.result;
+        }
+    };
+
     /*!
-        \brief Squared positional error statistics between a polyline and its simplification.
+        \brief Positional error statistics between a polyline and its simplification.
 
-        todo move statistics class and compute_statistics function from math to here, set statistics value type to calc type of simplification???
+        The errors are accumulated while they are computed, in a single pass and O(1) memory.
     */
     template
     <
         unsigned DIM,
         typename ForwardIterator1,
-        typename ForwardIterator2
+        typename ForwardIterator2,
+        typename Counters = util::no_counters
     >
     struct positional_statistics
     {
         /*!
-            \brief Computes the squared positional error statistics between a polyline and its simplification.
+            \brief Computes the positional error statistics between a polyline and its simplification.
+
+            Each error is also added to sketch, if specified.
         */
         static statistics compute (
             ForwardIterator1 original_first,
             ForwardIterator1 original_last,
             ForwardIterator2 simplified_first,
             ForwardIterator2 simplified_last,
-            bool* valid=0)
-        {
-            typedef typename std::iterator_traits <ForwardIterator1>::difference_type diff_type;
-
-            diff_type pointCount = std::distance (original_first, original_last) / DIM;
-            util::scoped_array <double> errors (static_cast<unsigned>(pointCount));
-
-            diff_type errorCount = std::distance (
-                errors.get (),
-                positional
-                <
-                    DIM,
-                    ForwardIterator1,
-                    ForwardIterator2,
-                    double*
-                >::compute (original_first, original_last,
-                            simplified_first, simplified_last,
-                            errors.get (), valid));
-
-            std::transform(
-                errors.get(),
-                errors.get() + errorCount,
-                errors.get(),
-                [](double f) -> auto { return sqrt(f); } // call the double version
-            );
-
-            return detail::compute_statistics (errors.get (), errors.get () + errorCount);
+            bool* valid=0,
+            quantile_sketch* sketch=0,
+            Counters stats = Counters ())
+        {
+            accumulator acc;
+            positional
+            <
+                DIM,
+                ForwardIterator1,
+                ForwardIterator2,
+                detail::sqrt_accumulate_iterator,
+                Counters
+            >::compute (original_first, original_last,
+                        simplified_first, simplified_last,
+                        detail::sqrt_accumulate_iterator (acc, sketch), valid, stats);
+
+            return acc.result ();
+        }
+    };
+    /*!
+        \brief Positional error statistics between a polyline and its simplification, where the
+        simplification is defined by the indices of the kept points.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename Counters = util::no_counters
+    >
+    struct positional_indexed_statistics
+    {
+        /*!
+            \brief Computes the positional error statistics between a polyline and its simplification.
+
+            Each error is also added to sketch, if specified.
+        */
+        static statistics compute (
+            RandomAccessIterator original_first,
+            RandomAccessIterator original_last,
+            ForwardIterator keys_first,
+            ForwardIterator keys_last,
+            bool* valid=0,
+            quantile_sketch* sketch=0,
+            Counters stats = Counters ())
+        {
+            accumulator acc;
+            detail::sqrt_accumulate_sink sink (acc, sketch);
+            bool ok = detail::positional_indexed_blocks <DIM> (
+                original_first, original_last, keys_first, keys_last, sink, stats);
+
+            if (valid) {
+                *valid = ok;
+            }
+            return acc.result ();
+        }
+    };
+
+    namespace detail
+    {
+        /*!
+            \brief Finds the indices of the points of a simplification in the original polyline,
+            by matching the points in order, like positional does.
+
+            \return false when a point could not be matched, or when the indices are not valid
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename ForwardIterator,
+            typename Size
+        >
+        inline bool match_indices (
+            RandomAccessIterator original_first,
+            RandomAccessIterator original_last,
+            ForwardIterator simplified_first,
+            ForwardIterator simplified_last,
+            std::vector <Size>& indices)
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+            diff_type coordCount = std::distance (original_first, original_last);
+            if (!DIM || coordCount % DIM || std::distance (simplified_first, simplified_last) % DIM) {
+                return false;
+            }
+            diff_type pointCount = coordCount / DIM;
+            diff_type index = 0;
+            for (; simplified_first != simplified_last; std::advance (simplified_first, DIM)) {
+                while (index < pointCount &&
+                       !math::equal <DIM> (simplified_first, original_first + index * DIM))
+                {
+                    ++index;
+                }
+                if (index == pointCount) {
+                    return false;
+                }
+                indices.push_back (static_cast <Size> (index));
+            }
+            return valid_indices <DIM> (coordCount, indices.begin (), indices.end ());
+        }
+
+        /*!
+            \brief Converts a mask with one flag per point into the indices of the flagged points.
+        */
+        template
+        <
+            typename InputIterator,
+            typename Size
+        >
+        inline std::vector <Size> mask_to_indices (
+            InputIterator mask,
+            Size pointCount)
+        {
+            std::vector <Size> indices;
+            for (Size i = 0; i < pointCount; ++i, ++mask) {
+                if (*mask) {
+                    indices.push_back (i);
+                }
+            }
+            return indices;
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    namespace detail
+    {
+        //! \brief Returns the number of points of a polyline, or -1 if it is not valid.
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator
+        >
+        inline std::ptrdiff_t curve_point_count (
+            RandomAccessIterator first,
+            RandomAccessIterator last)
+        {
+            std::ptrdiff_t coordCount = std::distance (first, last);
+            if (!DIM || coordCount % DIM || !coordCount) {
+                return -1;
+            }
+            return coordCount / DIM;
+        }
+
+        /*!
+            \brief Squared distance between the point p + t * d and segment [a, b], as a function
+            of t.
+
+            The function consists of three quadratics in t, for the points that are nearest to a,
+            to the inside of the segment, and to b. Which one applies follows from the projection
+            s (t) = s0 + s1 * t of the point onto the line through the segment.
+        */
+        template
+        <
+            unsigned DIM
+        >
+        class segment_distance_function
+        {
+        public:
+            segment_distance_function (
+                const double* p,
+                const double* d,
+                const double* a,
+                const double* b)
+            {
+                double dd = 0, ee = 0, de = 0, wd = 0, we = 0, ww = 0, vd = 0, vv = 0;
+                for (unsigned i = 0; i < DIM; ++i) {
+                    double e = b [i] - a [i];
+                    double w = p [i] - a [i];
+                    double v = p [i] - b [i];
+                    dd += d [i] * d [i];
+                    ee += e * e;
+                    de += d [i] * e;
+                    wd += w * d [i];
+                    we += w * e;
+                    ww += w * w;
+                    vd += v * d [i];
+                    vv += v * v;
+                }
+                mCoefficients [0][0] = ww;
+                mCoefficients [0][1] = 2 * wd;
+                mCoefficients [0][2] = dd;
+                mCoefficients [2][0] = vv;
+                mCoefficients [2][1] = 2 * vd;
+                mCoefficients [2][2] = dd;
+                mS0 = mS1 = 0;
+                if (ee > 0) {
+                    mS0 = we / ee;
+                    mS1 = de / ee;
+                    mCoefficients [1][0] = ww - we * we / ee;
+                    mCoefficients [1][1] = 2 * (wd - we * de / ee);
+                    mCoefficients [1][2] = dd - de * de / ee;
+                }
+                else {
+                    std::copy (mCoefficients [0], mCoefficients [0] + 3, mCoefficients [1]);
+                }
+            }
+
+            //! \brief Adds the t in (t0, t1) where the function changes quadratic to breaks.
+            double* breaks (double t0, double t1, double* breaks) const {
+                if (mS1 != 0) {
+                    double t [2] = {-mS0 / mS1, (1 - mS0) / mS1};
+                    for (unsigned i = 0; i < 2; ++i) {
+                        if (t0 < t [i] && t [i] < t1) {
+                            *breaks++ = t [i];
+                        }
+                    }
+                }
+                return breaks;
+            }
+
+            //! \brief Returns the coefficients c0, c1, c2 of c0 + c1 * t + c2 * t^2 that apply at t.
+            const double* coefficients (double t) const {
+                double s = mS0 + mS1 * t;
+                return mCoefficients [s <= 0 ? 0 : s < 1 ? 1 : 2];
+            }
+
+        private:
+            double mS0, mS1;                //!< projection of the point onto the segment line
+            double mCoefficients [3][3];    //!< quadratics for the start, inside and end
+        };
+
+        /*!
+            \brief Adds the t in [t0, t1] where two distance functions are equal to roots.
+        */
+        template
+        <
+            unsigned DIM
+        >
+        void distance_crossings (
+            const segment_distance_function <DIM>& f,
+            const segment_distance_function <DIM>& g,
+            double t0,
+            double t1,
+            std::vector <double>& roots)
+        {
+            // the quadratics of f and g only change at their breaks
+            double cuts [6] = {t0};
+            double* end = g.breaks (t0, t1, f.breaks (t0, t1, cuts + 1));
+            *end++ = t1;
+            for (double* cut = cuts + 2; cut + 1 < end; ++cut) {
+                for (double* prev = cut; *prev < prev [-1]; --prev) {
+                    std::swap (prev [-1], prev [0]);
+                }
+            }
+            for (double* cut = cuts; cut + 1 < end; ++cut) {
+                double lo = cut [0], hi = cut [1];
+                if (!(lo < hi)) {
+                    continue;
+                }
+                const double* a = f.coefficients ((lo + hi) / 2);
+                const double* b = g.coefficients ((lo + hi) / 2);
+                double c0 = a [0] - b [0], c1 = a [1] - b [1], c2 = a [2] - b [2];
+                double t [2];
+                unsigned count = 0;
+                if (c2 == 0) {
+                    if (c1 != 0) {
+                        t [count++] = -c0 / c1;
+                    }
+                }
+                else {
+                    double disc = c1 * c1 - 4 * c2 * c0;
+                    if (disc >= 0) {
+                        // the numerically stable form of both roots
+                        double q = -0.5 * (c1 + (c1 < 0 ? -std::sqrt (disc) : std::sqrt (disc)));
+                        t [count++] = q / c2;
+                        if (q != 0) {
+                            t [count++] = c0 / q;
+                        }
+                    }
+                }
+                for (unsigned i = 0; i < count; ++i) {
+                    if (lo <= t [i] && t [i] <= hi) {
+                        roots.push_back (t [i]);
+                    }
+                }
+            }
+        }
+
+        /*!
+            \brief Finds the largest squared distance between a point of a segment and the
+            segments of another polyline.
+
+            The distance to the other polyline changes by at most the distance travelled along
+            the segment. When it is at most f0 at t0 and at most f1 at t1, no point in between
+            lies farther away than reach = (f0 + f1 + length) / 2, and only the segments within
+            reach of that part can be nearest to it. A part is skipped when its reach cannot
+            exceed the largest distance found so far, and halved while it is near many segments.
+            Otherwise the distance is the lower envelope of the distances to its few segments,
+            which are convex, so it is largest at t0, at t1, or where two of them are equal.
+
+            Distances far from the origin are only known up to the rounding of the coordinates,
+            so halving stops once a part, or the margin of its reach over the result, is below
+            that rounding, or once the segment was halved max_splits times. Such parts are
+            evaluated by the envelope of all segments within reach.
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename Counters
+        >
+        class segment_hausdorff
+        {
+        public:
+            segment_hausdorff (
+                RandomAccessIterator other,
+                const spatial::box_tree <DIM, double>& tree,
+                Counters stats) :
+                mOther (other),
+                mLast (tree.point_count () - 1),
+                mTree (tree),
+                mHint (0),
+                mStats (stats)
+            {}
+
+            //! \brief Starts on segment [p, q].
+            void assign (
+                const double* p,
+                const double* q)
+            {
+                mLength = 0;
+                double scale = 0;
+                for (unsigned d = 0; d < DIM; ++d) {
+                    mP [d] = p [d];
+                    mD [d] = q [d] - p [d];
+                    mLength += mD [d] * mD [d];
+                    scale = std::max (scale, std::max (std::abs (p [d]), std::abs (q [d])));
+                }
+                mLength = std::sqrt (mLength);
+                mEpsilon = 64 * std::numeric_limits <double>::epsilon () * (scale + mLength);
+            }
+
+            /*!
+                \brief Returns the largest squared distance between a point of the segment and
+                the nearest of the segments from first to last of the other polyline.
+
+                As the distance to the other polyline is never larger, the result bounds it from
+                above. Only first and last are used when many segments lie in between.
+            */
+            double bound (
+                std::ptrdiff_t first,
+                std::ptrdiff_t last)
+            {
+                mSegments.clear ();
+                if (first > last) {
+                    std::swap (first, last);
+                }
+                for (std::ptrdiff_t i = first; i <= last; i += last - first <= 2 ? 1 : last - first) {
+                    mSegments.push_back (i);
+                }
+                return envelope (0, 1, mSegments, 0);
+            }
+
+            /*!
+                \brief Returns the largest of result and the squared distances between the
+                points of the segment and the other polyline.
+
+                \param[in] fp       the distance of the start of the segment, or a larger value
+                \param[in] fq       the distance of the end of the segment, or a larger value
+                \param[in] result   the largest squared distance found so far
+            */
+            double compute (
+                double fp,
+                double fq,
+                double result)
+            {
+                mSplits = 0;
+                return split (0, 1, fp, fq, result, 0);
+            }
+
+            //! \brief The number of times a segment is halved at most.
+            static const unsigned max_splits = 1 << 12;
+
+        private:
+            //! \brief Computes point x at t.
+            void point (double t, double* x) const {
+                for (unsigned d = 0; d < DIM; ++d) {
+                    x [d] = mP [d] + t * mD [d];
+                }
+            }
+
+            //! \brief Returns the squared distance between point x and a segment of the other polyline.
+            double distance2 (std::ptrdiff_t segment, const double* x) const {
+                return static_cast <double> (math::segment_distance2 <DIM> (
+                    mOther + segment * DIM, mOther + std::min (segment + 1, mLast) * DIM, x));
+            }
+
+            /*!
+                \brief Returns true when the part of the given length and reach is not worth
+                halving, as halving it cannot improve on result beyond rounding.
+            */
+            bool settled (
+                double length,
+                double reach,
+                double result) const
+            {
+                return length <= mEpsilon || reach - std::sqrt (result) <= mEpsilon || mSplits >= max_splits;
+            }
+
+            //! \brief Halves the part [t0, t1] while it lies within reach of many segments.
+            double split (
+                double t0,
+                double t1,
+                double f0,
+                double f1,
+                double result,
+                unsigned depth)
+            {
+                double length = (t1 - t0) * mLength;
+                double reach = (f0 + f1 + length) / 2;
+                if (reach * reach <= result || mStats.stopped ()) {
+                    return result;
+                }
+                double tm = (t0 + t1) / 2;
+                double mid [DIM];
+                point (tm, mid);
+                double radius = reach + length / 2;
+                std::vector <std::ptrdiff_t> segments;
+                std::size_t limit = depth < 48 && !settled (length, reach, result) ?
+                    16 : std::numeric_limits <std::size_t>::max ();
+                if (spatial::segments_within (mTree, mid, radius * radius, segments, limit)) {
+                    return refine (t0, t1, f0, f1, segments, result, depth);
+                }
+                ++mSplits;
+                // both halves are skipped when the middle lies within this distance
+                double near = std::max (2 * std::sqrt (result) - std::max (f0, f1) - length / 2, 0.);
+                mStats.distance ();
+                double fm2 = spatial::nearest_segment_distance2 (mTree, mOther, mid, near * near, mHint);
+                if (near * near < fm2) {
+                    result = std::max (result, fm2);
+                }
+                double fm = std::sqrt (fm2);
+                result = split (t0, tm, f0, fm, result, depth + 1);
+                return split (tm, t1, fm, f1, result, depth + 1);
+            }
+
+            //! \brief Halves the part [t0, t1] while it lies within reach of more than a few segments.
+            double refine (
+                double t0,
+                double t1,
+                double f0,
+                double f1,
+                const std::vector <std::ptrdiff_t>& segments,
+                double result,
+                unsigned depth)
+            {
+                double length = (t1 - t0) * mLength;
+                double reach = (f0 + f1 + length) / 2;
+                if (reach * reach <= result || mStats.stopped ()) {
+                    return result;
+                }
+
+                // the segments that can be nearest to a point of the part lie within reach of it
+                double tm = (t0 + t1) / 2;
+                double radius = reach + length / 2;
+                double mid [DIM];
+                point (tm, mid);
+                std::vector <std::ptrdiff_t> near;
+                double fm2 = std::numeric_limits <double>::infinity ();
+                for (std::size_t i = 0; i < segments.size (); ++i) {
+                    double dist2 = distance2 (segments [i], mid);
+                    fm2 = std::min (fm2, dist2);
+                    if (dist2 <= radius * radius) {
+                        near.push_back (segments [i]);
+                    }
+                }
+                mStats.distance (segments.size ());
+                if (near.empty ()) {
+                    return result;
+                }
+                result = std::max (result, fm2);
+
+                if (near.size () <= 8 || depth >= 48 || settled (length, reach, result)) {
+                    return envelope (t0, t1, near, result);
+                }
+                ++mSplits;
+                double fm = std::sqrt (fm2);
+                result = refine (t0, tm, f0, fm, near, result, depth + 1);
+                return refine (tm, t1, fm, f1, near, result, depth + 1);
+            }
+
+            //! \brief Evaluates the lower envelope of the distances to segments at t0, t1 and its crossings.
+            double envelope (
+                double t0,
+                double t1,
+                const std::vector <std::ptrdiff_t>& segments,
+                double result)
+            {
+                mFunctions.clear ();
+                for (std::size_t i = 0; i < segments.size (); ++i) {
+                    double a [DIM], b [DIM];
+                    for (unsigned d = 0; d < DIM; ++d) {
+                        a [d] = static_cast <double> (mOther [segments [i] * DIM + d]);
+                        b [d] = static_cast <double> (mOther [std::min (segments [i] + 1, mLast) * DIM + d]);
+                    }
+                    mFunctions.push_back (segment_distance_function <DIM> (mP, mD, a, b));
+                }
+                mRoots.clear ();
+                mRoots.push_back (t0);
+                mRoots.push_back (t1);
+                for (std::size_t i = 0; i < mFunctions.size (); ++i) {
+                    for (std::size_t j = i + 1; j < mFunctions.size (); ++j) {
+                        distance_crossings (mFunctions [i], mFunctions [j], t0, t1, mRoots);
+                    }
+                }
+                for (std::size_t r = 0; r < mRoots.size (); ++r) {
+                    double x [DIM];
+                    point (mRoots [r], x);
+                    double dist2 = std::numeric_limits <double>::infinity ();
+                    for (std::size_t i = 0; i < segments.size () && result < dist2; ++i) {
+                        dist2 = std::min (dist2, distance2 (segments [i], x));
+                    }
+                    mStats.distance (segments.size ());
+                    result = std::max (result, dist2);
+                }
+                return result;
+            }
+
+            double mP [DIM];                //!< the start of the segment
+            double mD [DIM];                //!< the end of the segment minus its start
+            double mLength;                 //!< the length of the segment
+            double mEpsilon;                //!< the rounding of distances near the segment
+            unsigned mSplits;               //!< the number of times the segment was halved
+            RandomAccessIterator mOther;    //!< the other polyline
+            std::ptrdiff_t mLast;           //!< the last point of the other polyline
+            const spatial::box_tree <DIM, double>& mTree;   //!< the segments of the other polyline
+            std::ptrdiff_t mHint;           //!< the nearest segment of the last search
+            std::vector <segment_distance_function <DIM> > mFunctions;  //!< the distances of the envelope
+            std::vector <double> mRoots;    //!< the points of the envelope to evaluate
+            std::vector <std::ptrdiff_t> mSegments; //!< the segments of the bound
+            Counters mStats;                //!< counts the distance evaluations
+        };
+
+        /*!
+            \brief Computes the largest squared distance between a point of the polyline [first,
+            first + pointCount * DIM) and the polyline over which tree was built, if it exceeds
+            bound.
+
+            The distances of the points are found first, rejecting each point as soon as a
+            segment within the largest distance so far is found. The inner points of a segment
+            can only lie farther away where their nearest segment of the other polyline changes,
+            so a segment is skipped when both its end points share their nearest segment, or when
+            the distance to the nearest segments of its end points stays within the result.
+            Otherwise it is searched by a segment_hausdorff.
+
+            \return the directed squared Hausdorff distance, or a value <= bound
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator1,
+            typename RandomAccessIterator2,
+            typename Counters
+        >
+        double directed_hausdorff2 (
+            RandomAccessIterator1 first,
+            std::ptrdiff_t pointCount,
+            RandomAccessIterator2 other,
+            const spatial::box_tree <DIM, double>& tree,
+            double bound,
+            Counters stats)
+        {
+            double result = bound;
+            std::ptrdiff_t hint = 0;
+            // the distance of each point, or the distance to a segment within a bound
+            std::vector <double> dists2 (static_cast <std::size_t> (pointCount));
+            std::vector <std::ptrdiff_t> nearest (static_cast <std::size_t> (pointCount));
+            for (std::ptrdiff_t i = 0; i < pointCount && !stats.stopped (); ++i) {
+                stats.distance ();
+                double p [DIM];
+                for (unsigned d = 0; d < DIM; ++d) {
+                    p [d] = static_cast <double> (first [i * DIM + d]);
+                }
+                // points near the previous point are likely near its nearest segment
+                dists2 [i] = spatial::nearest_segment_distance2 (tree, other, p, result, hint);
+                nearest [i] = hint;
+                result = std::max (result, dists2 [i]);
+            }
+
+            segment_hausdorff <DIM, RandomAccessIterator2, Counters> segment (other, tree, stats);
+            for (std::ptrdiff_t i = 0; i + 1 < pointCount && !stats.stopped (); ++i) {
+                double p [DIM], q [DIM];
+                double length = 0;
+                for (unsigned d = 0; d < DIM; ++d) {
+                    p [d] = static_cast <double> (first [i * DIM + d]);
+                    q [d] = static_cast <double> (first [(i + 1) * DIM + d]);
+                    length += (q [d] - p [d]) * (q [d] - p [d]);
+                }
+                length = std::sqrt (length);
+                // the distance to a single segment is largest at an end point, and the distance
+                // to the polyline changes by at most the distance travelled
+                double reach = (std::sqrt (dists2 [i]) + std::sqrt (dists2 [i + 1]) + length) / 2;
+                if (nearest [i] == nearest [i + 1] || reach * reach <= result) {
+                    continue;
+                }
+                segment.assign (p, q);
+                if (segment.bound (nearest [i], nearest [i + 1]) <= result) {
+                    continue;
+                }
+                result = segment.compute (std::sqrt (dists2 [i]), std::sqrt (dists2 [i + 1]), result);
+            }
+            return result;
+        }
+    }
+
+    /*!
+        \brief Hausdorff distance between two polylines.
+
+        The largest distance from a point of either polyline, including the points inside its
+        segments, to the nearest segment of the other polyline. Unlike the positional error, the
+        polylines do not need to share points.
+
+        The segments of each polyline are indexed by a spatial::box_tree. Each vertex searches
+        the tree for a segment that is closer than the largest distance found so far, starting
+        at the nearest segment of the previous vertex, and stops as soon as it finds one.
+        Vertices that cannot increase the result are thus rejected after visiting only a few
+        nodes. The largest distance can also lie inside a segment, where the nearest segment of
+        the other polyline changes, so the segments between vertices with different nearest
+        segments are searched as well (see detail::directed_hausdorff2). The total cost stays
+        close to linear for polylines that follow each other.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename RandomAccessIterator2,
+        typename Counters = util::no_counters
+    >
+    struct hausdorff
+    {
+        /*!
+            \brief Computes the Hausdorff distance between two polylines.
+        */
+        static double compute (
+            RandomAccessIterator1 first1,
+            RandomAccessIterator1 last1,
+            RandomAccessIterator2 first2,
+            RandomAccessIterator2 last2,
+            bool* valid=0,
+            Counters stats = Counters ())
+        {
+            std::ptrdiff_t pointCount1 = detail::curve_point_count <DIM> (first1, last1);
+            std::ptrdiff_t pointCount2 = detail::curve_point_count <DIM> (first2, last2);
+            if (valid) {
+                *valid = pointCount1 > 0 && pointCount2 > 0;
+            }
+            if (pointCount1 <= 0 || pointCount2 <= 0) {
+                return 0;
+            }
+            spatial::box_tree <DIM, double> tree1 (first1, pointCount1);
+            spatial::box_tree <DIM, double> tree2 (first2, pointCount2);
+
+            double dist2 = detail::directed_hausdorff2 <DIM> (first1, pointCount1, first2, tree2, 0, stats);
+            dist2 = detail::directed_hausdorff2 <DIM> (first2, pointCount2, first1, tree1, dist2, stats);
+            return std::sqrt (dist2);
+        }
+    };
+
+    /*!
+        \brief Discrete Frechet distance between two polylines.
+
+        The smallest, over all monotone couplings of the points of both polylines, of the
+        largest distance between coupled points. It is computed by the classic dynamic program
+        over the n x m grid of point pairs, one row at a time, so that only two rows are kept.
+
+        With a band, point i of the first polyline is only coupled to the points within band of
+        the point of the second polyline at the same fraction of its length. This takes
+        O(n * band) time and O(band) memory for polylines of a similar point density. Couplings
+        outside the band are not considered, so the result is an upper bound of the discrete
+        Frechet distance, which is exact when an optimal coupling lies within the band.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename RandomAccessIterator2,
+        typename Counters = util::no_counters
+    >
+    struct discrete_frechet
+    {
+        /*!
+            \brief Computes the discrete Frechet distance between two polylines.
+
+            \param[in] band    number of columns on either side of the diagonal, 0 for all columns
+        */
+        static double compute (
+            RandomAccessIterator1 first1,
+            RandomAccessIterator1 last1,
+            RandomAccessIterator2 first2,
+            RandomAccessIterator2 last2,
+            std::ptrdiff_t band,
+            bool* valid=0,
+            Counters stats = Counters ())
+        {
+            std::ptrdiff_t n = detail::curve_point_count <DIM> (first1, last1);
+            std::ptrdiff_t m = detail::curve_point_count <DIM> (first2, last2);
+            if (valid) {
+                *valid = n > 0 && m > 0 && band >= 0;
+            }
+            if (n <= 0 || m <= 0 || band < 0) {
+                return 0;
+            }
+            const double inf = std::numeric_limits <double>::infinity ();
+            bool banded = band > 0 && 2 * band + 1 < m;
+
+            // the band follows the points at the same fraction of the length of both polylines
+            double length1 = 0, length2 = 0;
+            if (banded) {
+                for (std::ptrdiff_t i = 1; i < n; ++i) {
+                    length1 += std::sqrt (static_cast <double> (math::point_distance2 <DIM> (
+                        first1 + (i - 1) * DIM, first1 + i * DIM)));
+                }
+                for (std::ptrdiff_t j = 1; j < m; ++j) {
+                    length2 += std::sqrt (static_cast <double> (math::point_distance2 <DIM> (
+                        first2 + (j - 1) * DIM, first2 + j * DIM)));
+                }
+            }
+            // degenerate polylines follow the point indices instead
+            bool byIndex = !(length1 > 0 && length2 > 0);
+            if (byIndex) {
+                length1 = static_cast <double> (n - 1);
+                length2 = static_cast <double> (m - 1);
+            }
+            double position1 = 0, position2 = 0;    // length up to the current points
+            std::ptrdiff_t center = 0;              // band center of the current row
+
+            // coupling distance of the previous and current row, from column lo to hi
+            std::vector <double> prev, curr;
+            std::ptrdiff_t prevLo = 0, prevHi = -1;
+
+            for (std::ptrdiff_t i = 0; i < n; ++i) {
+                std::ptrdiff_t lo = 0, hi = m - 1;
+                if (banded && i < n - 1) {
+                    lo = std::max (center - band, static_cast <std::ptrdiff_t> (0));
+
+                    // find the center of the next row; rows overlap, so that every cell of a
+                    // row can be reached from the row before
+                    position1 += byIndex ? 1 : std::sqrt (static_cast <double> (math::point_distance2 <DIM> (
+                        first1 + i * DIM, first1 + (i + 1) * DIM)));
+                    while (center < m - 1) {
+                        double step = byIndex ? 1 : std::sqrt (static_cast <double> (math::point_distance2 <DIM> (
+                            first2 + center * DIM, first2 + (center + 1) * DIM)));
+                        if ((position2 + step) * length1 > position1 * length2) {
+                            break;
+                        }
+                        position2 += step;
+                        ++center;
+                    }
+                    hi = std::min (center + 1 + band, m - 1);
+                }
+                else if (banded) {
+                    lo = std::max (std::min (center, prevHi) - band, static_cast <std::ptrdiff_t> (0));
+                }
+                curr.assign (static_cast <std::size_t> (hi - lo + 1), inf);
+
+                for (std::ptrdiff_t j = lo; j <= hi; ++j) {
+                    double reach = i == 0 && j == 0 ? 0 : inf;
+                    if (j > lo) {
+                        reach = curr [static_cast <std::size_t> (j - 1 - lo)];
+                    }
+                    if (prevLo <= j && j <= prevHi) {
+                        reach = std::min (reach, prev [static_cast <std::size_t> (j - prevLo)]);
+                    }
+                    if (prevLo <= j - 1 && j - 1 <= prevHi) {
+                        reach = std::min (reach, prev [static_cast <std::size_t> (j - 1 - prevLo)]);
+                    }
+                    double dist2 = static_cast <double> (math::point_distance2 <DIM> (
+                        first1 + i * DIM, first2 + j * DIM));
+                    curr [static_cast <std::size_t> (j - lo)] = std::max (reach, dist2);
+                }
+                prev.swap (curr);
+                prevLo = lo;
+                prevHi = hi;
+
+                stats.distance (static_cast <unsigned long long> (hi - lo + 1));
+                if (stats.stopped ()) {
+                    return 0;
+                }
+            }
+            return std::sqrt (prev.back ());
+        }
+    };
+
+    // ---------------------------------------------------------------------------------------------
+
+    namespace detail
+    {
+        /*!
+            \brief Area between a chain of 2d points and the segment (s1, s2) that replaces it.
+
+            The chain runs from s1 to s2. The points are expressed in the frame of the segment:
+            u along the segment and v perpendicular to it, both scaled by its length. The chain
+            is cut where it crosses the line through the segment, and the shoelace area of each
+            lobe between two crossings is added as an absolute value, so that areas on opposite
+            sides of the segment do not cancel. A closed chain (s1 equals s2) has the absolute
+            shoelace area of the polygon it encloses.
+        */
+        template
+        <
+            typename T
+        >
+        class chain_area
+        {
+        public:
+            template <typename InputIterator>
+            chain_area (
+                InputIterator s1,
+                InputIterator s2) :
+                mTotal (0),
+                mLobe (0),
+                mPrevU (0),
+                mPrevV (0)
+            {
+                mS1 [0] = static_cast <T> (*s1);
+                mS1 [1] = static_cast <T> (*++s1);
+                mD [0] = static_cast <T> (*s2) - mS1 [0];
+                mD [1] = static_cast <T> (*++s2) - mS1 [1];
+                mDD = mD [0] * mD [0] + mD [1] * mD [1];
+            }
+
+            //! \brief Adds the next point of the chain.
+            template <typename InputIterator>
+            void add (InputIterator p) {
+                T w [2];
+                w [0] = static_cast <T> (*p) - mS1 [0];
+                w [1] = static_cast <T> (*++p) - mS1 [1];
+                T u = w [0], v = w [1];
+                if (mDD > 0) {
+                    u = w [0] * mD [0] + w [1] * mD [1];
+                    v = mD [0] * w [1] - mD [1] * w [0];
+
+                    if ((mPrevV < 0 && 0 < v) || (v < 0 && 0 < mPrevV)) {
+                        // close the lobe where the chain crosses the line
+                        T x = mPrevU + (u - mPrevU) * (mPrevV / (mPrevV - v));
+                        mLobe += -mPrevV * x;
+                        mTotal += std::fabs (mLobe);
+                        mLobe = x * v;
+                        mPrevU = u;
+                        mPrevV = v;
+                        return;
+                    }
+                }
+                mLobe += mPrevU * v - u * mPrevV;
+                if (mDD > 0 && v == 0) {
+                    // the chain touches the line
+                    mTotal += std::fabs (mLobe);
+                    mLobe = 0;
+                }
+                mPrevU = u;
+                mPrevV = v;
+            }
+
+            //! \brief Ends the chain at s2, and returns the area.
+            T finish () {
+                // s2 lies at (mDD, 0) in the frame of the segment, or at s1 = (0, 0)
+                mLobe += -mDD * mPrevV;
+                mTotal += std::fabs (mLobe);
+                return mDD > 0 ? mTotal / (2 * mDD) : mTotal / 2;
+            }
+
+        private:
+            T mS1 [2];      //!< start of the segment
+            T mD [2];       //!< vector s1 --> s2
+            T mDD;          //!< squared length of the segment
+            T mTotal;       //!< twice the scaled area of the completed lobes
+            T mLobe;        //!< twice the scaled signed area of the current lobe so far
+            T mPrevU;       //!< previous point along the segment
+            T mPrevV;       //!< previous point perpendicular to the segment
+        };
+
+        //! \brief Output iterator that sums the values written to it.
+        class sum_iterator
+        {
+        public:
+            typedef std::output_iterator_tag iterator_category;
+            typedef void value_type;
+            typedef void difference_type;
+            typedef void pointer;
+            typedef void reference;
+
+            explicit sum_iterator (
+                double& sum) :
+                mSum (&sum)
+            {}
+
+            sum_iterator& operator= (double value) {
+                *mSum += value;
+                return *this;
+            }
+
+            sum_iterator& operator* () {
+                return *this;
+            }
+
+            sum_iterator& operator++ () {
+                return *this;
+            }
+
+            sum_iterator& operator++ (int) {
+                return *this;
+            }
+
+        private:
+            double* mSum;
+        };
+    }
+
+    /*!
+        \brief Areal displacement between a 2d polyline and its simplification.
+
+        For each segment of the simplification, the area between the segment and the points of
+        the original polyline that it replaces is computed with detail::chain_area, in a single
+        pass over both polylines. The points of the simplification are matched to the original
+        polyline like positional does.
+
+        \note all calculated areas are of the type util::select_calculation_type <ForwardIterator1>::type
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator1,
+        typename ForwardIterator2,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct areal
+    {
+        static_assert (DIM == 2, "areal displacement is only defined for 2d polylines");
+
+        typedef typename util::select_calculation_type <ForwardIterator1>::type calc_type;
+
+        /*!
+            \brief Computes the areal displacement of each segment of the simplification.
+        */
+        static OutputIterator compute (
+            ForwardIterator1 original_first,
+            ForwardIterator1 original_last,
+            ForwardIterator2 simplified_first,
+            ForwardIterator2 simplified_last,
+            OutputIterator result,
+            bool* valid=0,
+            Counters stats = Counters ())
+        {
+            std::ptrdiff_t original_coordCount = std::distance (original_first, original_last);
+            std::ptrdiff_t simplified_coordCount = std::distance (simplified_first, simplified_last);
+
+            // validate input
+            if (original_coordCount % DIM || original_coordCount / DIM < 2 ||
+                simplified_coordCount % DIM || simplified_coordCount / DIM < 2 ||
+                original_coordCount < simplified_coordCount ||
+                !math::equal <DIM> (simplified_first, original_first))
+            {
+                if (valid) {
+                    *valid = false;
+                }
+                return result;
+            }
+
+            ForwardIterator2 simplified_prev = simplified_first;
+            std::advance (simplified_first, DIM);
+
+            // process each simplified line segment
+            while (simplified_first != simplified_last) {
+                detail::chain_area <calc_type> area (simplified_prev, simplified_first);
+
+                // add each original point until it equals the end of the line segment; only
+                // the points after the start of the segment are counted
+                unsigned long long added = 0;
+                while (original_first != original_last &&
+                       !math::equal <DIM> (simplified_first, original_first))
+                {
+                    area.add (original_first);
+                    std::advance (original_first, DIM);
+                    ++added;
+                }
+                stats.distance (added ? added - 1 : 0);
+                if (stats.stopped ()) {
+                    return result;
+                }
+                *result = area.finish ();
+                ++result;
+
+                simplified_prev = simplified_first;
+                std::advance (simplified_first, DIM);
+            }
+
+            if (valid) {
+                *valid = original_first != original_last;
+            }
+            return result;
+        }
+    };
+
+    /*!
+        \brief Areal displacement between a 2d polyline and its simplification, where the
+        simplification is defined by the indices of the kept points.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct areal_indexed
+    {
+        static_assert (DIM == 2, "areal displacement is only defined for 2d polylines");
+
+        typedef typename util::select_calculation_type <RandomAccessIterator>::type calc_type;
+
+        /*!
+            \brief Computes the areal displacement of each segment between consecutive indices in
+            [keys_first, keys_last).
+
+            \pre the indices are valid, see detail::valid_indices
+        */
+        static OutputIterator compute (
+            RandomAccessIterator original_first,
+            ForwardIterator keys_first,
+            ForwardIterator keys_last,
+            OutputIterator result,
+            Counters stats = Counters ())
+        {
+            std::ptrdiff_t first = static_cast <std::ptrdiff_t> (*keys_first);
+            for (ForwardIterator key = ++keys_first; key != keys_last; ++key) {
+                std::ptrdiff_t last = static_cast <std::ptrdiff_t> (*key);
+                stats.distance (static_cast <unsigned long long> (last - first - 1));
+                if (stats.stopped ()) {
+                    return result;
+                }
+                detail::chain_area <calc_type> area (original_first + first * DIM, original_first + last * DIM);
+                for (std::ptrdiff_t i = first + 1; i < last; ++i) {
+                    area.add (original_first + i * DIM);
+                }
+                *result = area.finish ();
+                ++result;
+                first = last;
+            }
+            return result;
+        }
+    };
+
+    /*!
+        \brief Areal displacement for a batch of 2d polylines and their simplifications.
+
+        The polylines and their simplifications are defined by coordinate ranges and coord
+        offsets, like the batch simplification routines use, so the output of those routines
+        can be measured directly.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename OffsetIterator1,
+        typename RandomAccessIterator2,
+        typename OffsetIterator2,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct areal_batch
+    {
+        /*!
+            \brief Computes the total areal displacement of each polyline of the batch.
+
+            Pairs that are not valid get an area of 0, and clear the valid flag.
+        */
+        static OutputIterator compute (
+            RandomAccessIterator1 original_first,
+            OffsetIterator1 original_offsets_first,
+            OffsetIterator1 original_offsets_last,
+            RandomAccessIterator2 simplified_first,
+            OffsetIterator2 simplified_offsets_first,
+            OutputIterator result,
+            bool* valid=0,
+            Counters stats = Counters ())
+        {
+            bool ok = original_offsets_first != original_offsets_last;
+            if (!ok) {
+                if (valid) {
+                    *valid = false;
+                }
+                return result;
+            }
+            std::ptrdiff_t original = static_cast <std::ptrdiff_t> (*original_offsets_first);
+            std::ptrdiff_t simplified = static_cast <std::ptrdiff_t> (*simplified_offsets_first);
+
+            while (++original_offsets_first != original_offsets_last) {
+                std::ptrdiff_t original_next = static_cast <std::ptrdiff_t> (*original_offsets_first);
+                std::ptrdiff_t simplified_next = static_cast <std::ptrdiff_t> (*++simplified_offsets_first);
+
+                double sum = 0;
+                bool pairValid = false;
+                areal <DIM, RandomAccessIterator1, RandomAccessIterator2, detail::sum_iterator, Counters>::compute (
+                    original_first + original, original_first + original_next,
+                    simplified_first + simplified, simplified_first + simplified_next,
+                    detail::sum_iterator (sum), &pairValid, stats);
+
+                *result = pairValid ? sum : 0;
+                ++result;
+                // stop in between polylines if requested
+                if (stats.stopped ()) {
+                    return result;
+                }
+                ok = ok && pairValid;
+                original = original_next;
+                simplified = simplified_next;
+            }
+            if (valid) {
+                *valid = ok;
+            }
+            return result;
         }
     };
 }}
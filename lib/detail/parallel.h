@@ -0,0 +1,1573 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+
+#ifndef PSIMPL_DETAIL_PARALLEL
+#define PSIMPL_DETAIL_PARALLEL
+
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "algo.h"
+#include "error.h"
+#include "math.h"
+#include "trace.h"
+#include "util.h"
+
+
+namespace psimpl {
+    namespace util
+{
+    /*!
+        \brief Determines the number of worker threads to use.
+
+        \param[in] requested    the requested number of threads, 0 means one per hardware thread
+        \return                 the number of threads to use, at least 1
+    */
+    inline unsigned thread_count (
+        unsigned requested)
+    {
+        if (requested == 0) {
+            requested = std::thread::hardware_concurrency ();
+        }
+        return requested ? requested : 1;
+    }
+
+    /*!
+        \brief A fixed set of worker threads that repeatedly perform batches of tasks.
+
+        Starting threads is expensive compared to the small batches of work that some routines
+        hand out, so the workers are started once and then wait for the next batch.
+    */
+    class thread_pool
+    {
+    public:
+        /*!
+            \brief Starts threadCount - 1 workers; the calling thread is the last worker.
+        */
+        explicit thread_pool (unsigned threadCount) :
+            generation (0),
+            next (0),
+            taskCount (0),
+            busy (0),
+            stop (false),
+            invoke (0),
+            context (0)
+        {
+            for (unsigned t = 1; t < threadCount; ++t) {
+                workers.push_back (std::thread (&thread_pool::work, this));
+            }
+        }
+
+        ~thread_pool () {
+            {
+                std::lock_guard <std::mutex> lock (mutex);
+                stop = true;
+            }
+            wake.notify_all ();
+            for (size_t t = 0; t < workers.size (); ++t) {
+                workers [t].join ();
+            }
+        }
+
+        //! \brief Returns the number of threads, including the calling thread.
+        unsigned size () const {
+            return static_cast <unsigned> (workers.size ()) + 1;
+        }
+
+        /*!
+            \brief Calls task (i) for each i in [0, count), and returns when all calls completed.
+
+            Tasks are handed out one at a time, so tasks of unequal size are balanced over the
+            threads. When tracing, each task is reported by the thread that performs it, and the
+            calling thread reports how long it waits for the other threads to finish.
+        */
+        template <typename Task>
+        void run (unsigned count, Task& task) {
+            if (workers.empty () || count < 2) {
+                for (unsigned i = 0; i < count; ++i) {
+                    task (i);
+                }
+                return;
+            }
+            {
+                std::lock_guard <std::mutex> lock (mutex);
+                invoke = &call <Task>;
+                context = &task;
+                taskCount = count;
+                next = 0;
+                busy = static_cast <unsigned> (workers.size ());
+                ++generation;
+            }
+            util::trace_scope trace ("parallel run");
+            wake.notify_all ();
+            perform ();
+
+            util::trace_scope stage ("wait");
+            std::unique_lock <std::mutex> lock (mutex);
+            while (busy) {
+                done.wait (lock);
+            }
+        }
+
+    private:
+        thread_pool (const thread_pool&);
+        thread_pool& operator= (const thread_pool&);
+
+        template <typename Task>
+        static void call (void* context, unsigned i) {
+            (*static_cast <Task*> (context)) (i);
+        }
+
+        void perform () {
+            for (unsigned i = next++; i < taskCount; i = next++) {
+                util::trace_scope trace ("task");
+                invoke (context, i);
+            }
+        }
+
+        void work () {
+            unsigned seen = 0;
+            for (;;) {
+                {
+                    std::unique_lock <std::mutex> lock (mutex);
+                    while (!stop && generation == seen) {
+                        wake.wait (lock);
+                    }
+                    if (stop) {
+                        return;
+                    }
+                    seen = generation;
+                }
+                perform ();
+                {
+                    std::lock_guard <std::mutex> lock (mutex);
+                    if (--busy == 0) {
+                        done.notify_one ();
+                    }
+                }
+            }
+        }
+
+    private:
+        std::vector <std::thread> workers;      //!< all threads except the calling one
+        std::mutex mutex;                       //!< guards the batch description
+        std::condition_variable wake;           //!< signals a new batch, or stop
+        std::condition_variable done;           //!< signals that all workers finished the batch
+        unsigned generation;                    //!< identifies the current batch
+        std::atomic <unsigned> next;            //!< next task of the current batch
+        unsigned taskCount;                     //!< number of tasks in the current batch
+        unsigned busy;                          //!< number of workers still in the current batch
+        bool stop;                              //!< tells the workers to quit
+        void (*invoke) (void*, unsigned);       //!< calls the task of the current batch
+        void* context;                          //!< the task of the current batch
+    };
+
+    /*!
+        \brief Calls task (i) for each i in [0, taskCount), spread over threadCount threads.
+
+        The calling thread takes part in the work. Returns when all tasks have completed.
+
+        \param[in]     taskCount    the number of tasks
+        \param[in]     threadCount  the maximum number of threads to use
+        \param[in,out] task         function object that performs task i
+    */
+    template <typename Task>
+    inline void parallel_for (
+        unsigned taskCount,
+        unsigned threadCount,
+        Task& task)
+    {
+        util::trace_scope stage ("start threads");
+        thread_pool pool (std::min (threadCount, taskCount));
+        stage.end ();
+        pool.run (taskCount, task);
+    }
+}}
+
+
+namespace psimpl {
+    namespace algo
+{
+
+    namespace detail
+    {
+        /*!
+            \brief Speculative chunk-parallel key search for sequential simplification routines.
+
+            A sequential routine finds its keys one after the other: the next key only depends
+            on the current key. Such a routine is described by a Step object that provides:
+             - diff_type next (diff_type key, unsigned long long& work) const: the point index of
+               the key that follows key, adding its distance evaluations to work
+             - diff_type guess (diff_type index) const: a likely key at or after point index
+
+            The points are divided into chunks. Each chunk is simplified concurrently, starting
+            from a guessed key near its first point. The chunks are then visited in order: when
+            the real key that enters a chunk differs from the guess, the chunk is re-run from the
+            real key, until it reaches a key that was also found by the speculative run. From
+            there on both runs are identical, so the remainder of the speculative keys is kept.
+            The resulting keys are therefore identical to those of the sequential routine.
+        */
+        template
+        <
+            typename Step,
+            typename diff_type
+        >
+        struct chunk_parallel
+        {
+            /*!
+                \brief A single chunk of points.
+            */
+            struct chunk {
+                chunk (diff_type begin=0, diff_type end=0) :
+                    begin (begin), end (end), start (begin), exit (begin), work (0) {}
+
+                diff_type begin;    //!< point index of the first point of the chunk
+                diff_type end;      //!< point index one beyond the last point of the chunk
+                diff_type start;    //!< point index of the key the chunk was started from
+                diff_type exit;     //!< point index of the first key beyond the chunk
+                unsigned long long work;    //!< distance evaluations of the speculative run
+            };
+
+            /*!
+                \brief Simplifies each chunk, starting from its guessed key.
+            */
+            struct speculate {
+                speculate (const Step& step, std::vector <chunk>& chunks, unsigned char* keys) :
+                    step (step), chunks (chunks), keys (keys) {}
+
+                void operator () (unsigned i) {
+                    chunk& c = chunks [i];
+                    std::fill (keys + c.begin, keys + c.end, 0);
+                    c.start = i ? step.guess (c.begin) : c.begin;
+                    diff_type key = c.start;
+                    while (key < c.end) {
+                        keys [key] = 1;
+                        key = step.next (key, c.work);
+                    }
+                    c.exit = key;
+                }
+
+                const Step& step;
+                std::vector <chunk>& chunks;
+                unsigned char* keys;
+            };
+
+            /*!
+                \brief Finds all keys of a polyline of pointCount points.
+
+                \param[in]  step            the sequential routine
+                \param[in]  pointCount      the number of points of the polyline
+                \param[in]  chunkCount      the number of chunks to split the polyline into
+                \param[in]  threadCount     the number of threads to use
+                \param[out] keys            key flag of each point
+                \param[in]  stats           counts the distance evaluations, on the calling thread
+                \return                     false when stats stopped the search, in between phases
+            */
+            template <typename Counters>
+            static bool apply (
+                const Step& step,
+                diff_type pointCount,
+                unsigned chunkCount,
+                unsigned threadCount,
+                unsigned char* keys,
+                Counters stats)
+            {
+                // the last point is always a key, and is not part of any chunk
+                diff_type last = pointCount - 1;
+                std::vector <chunk> chunks;
+                for (unsigned i = 0; i < chunkCount; ++i) {
+                    chunks.push_back (chunk (last * i / chunkCount, last * (i + 1) / chunkCount));
+                }
+
+                util::trace_scope stage ("speculate");
+                speculate task (step, chunks, keys);
+                util::parallel_for (chunkCount, threadCount, task);
+                for (unsigned i = 0; i < chunkCount; ++i) {
+                    stats.distance (chunks [i].work);
+                }
+                if (stats.stopped ()) {
+                    return false;
+                }
+
+                // repair the seams
+                stage.next ("repair seams");
+                for (unsigned i = 1; i < chunkCount; ++i) {
+                    if (chunks [i-1].exit != chunks [i].start) {
+                        unsigned long long work = 0;
+                        repair (step, chunks [i-1].exit, chunks [i], keys, work);
+                        stats.distance (work);
+                        if (stats.stopped ()) {
+                            return false;
+                        }
+                    }
+                }
+                keys [last] = 1;
+                return true;
+            }
+
+        private:
+            /*!
+                \brief Re-runs a chunk from its real start key, until it agrees with the speculative run.
+            */
+            static void repair (
+                const Step& step,
+                diff_type key,
+                chunk& c,
+                unsigned char* keys,
+                unsigned long long& work)
+            {
+                // speculative keys before the current key are wrong
+                diff_type clear = c.begin;
+
+                while (key < c.end) {
+                    std::fill (keys + clear, keys + key, 0);
+                    if (keys [key]) {
+                        // both runs agree from here on
+                        return;
+                    }
+                    keys [key] = 1;
+                    clear = key + 1;
+                    key = step.next (key, work);
+                }
+                std::fill (keys + clear, keys + c.end, 0);
+                c.exit = key;
+            }
+        };
+
+        /*!
+            \brief Minimum number of points per chunk; smaller polylines are simplified serially.
+        */
+        static const unsigned parallel_min_chunk = 1 << 14;
+
+        /*!
+            \brief Selects the number of chunks for a polyline of pointCount points, 1 means serial.
+        */
+        template <typename diff_type>
+        inline unsigned parallel_chunk_count (
+            diff_type pointCount,
+            unsigned threadCount)
+        {
+            diff_type maxCount = pointCount / static_cast <diff_type> (parallel_min_chunk);
+            return static_cast <unsigned> (std::max (static_cast <diff_type> (1),
+                std::min (maxCount, static_cast <diff_type> (threadCount))));
+        }
+
+        /*!
+            \brief Finds keys in parallel, and copies them to result.
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename Step,
+            typename OutputIterator,
+            typename Counters
+        >
+        inline OutputIterator simplify_parallel (
+            RandomAccessIterator first,
+            const Step& step,
+            typename std::iterator_traits <RandomAccessIterator>::difference_type pointCount,
+            unsigned chunkCount,
+            unsigned threadCount,
+            OutputIterator result,
+            Counters stats)
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+            util::trace_scope trace ("chunk parallel");
+            util::scoped_array <unsigned char> keys (static_cast <unsigned> (pointCount));
+            if (!chunk_parallel <Step, diff_type>::apply (step, pointCount, chunkCount, threadCount, keys.get (), stats)) {
+                return result;
+            }
+
+            util::trace_scope stage ("copy keys");
+            util::copy_keys <DIM> (first, first + pointCount * DIM, keys.get (), result);
+            return result;
+        }
+
+        /*!
+            \brief Key finder that splits large sub polylines over the threads of a pool.
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator
+        >
+        struct find_key_parallel
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+            typedef typename find_key <DIM, RandomAccessIterator>::key key;
+
+            /*!
+                \brief Finds the key of a single range of internal points.
+            */
+            struct scan {
+                scan (RandomAccessIterator poly, diff_type first, diff_type last, unsigned chunkCount) :
+                    poly (poly), first (first), last (last), keys (chunkCount) {}
+
+                void operator () (unsigned i) {
+                    diff_type count = (last - first) / DIM - 1;
+                    diff_type chunkCount = static_cast <diff_type> (keys.size ());
+                    diff_type begin = first + (1 + count * i / chunkCount) * DIM;
+                    diff_type end = first + (1 + count * (i + 1) / chunkCount) * DIM;
+                    keys [i] = find_key <DIM, RandomAccessIterator>::apply (poly, first, last, begin, end);
+                }
+
+                RandomAccessIterator poly;
+                diff_type first;
+                diff_type last;
+                std::vector <key> keys;
+            };
+
+            /*!
+                \brief Finds the key in a sub polyline; identical to find_key::apply.
+            */
+            static key apply (
+                util::thread_pool& pool,
+                RandomAccessIterator poly,
+                diff_type first,
+                diff_type last)
+            {
+                diff_type count = (last - first) / DIM - 1;
+                unsigned chunkCount = parallel_chunk_count (count, pool.size ());
+                if (chunkCount < 2) {
+                    return find_key <DIM, RandomAccessIterator>::apply (poly, first, last);
+                }
+                scan task (poly, first, last, chunkCount);
+                pool.run (chunkCount, task);
+
+                // keep the last key with the highest distance, like a single scan would
+                key result;
+                for (unsigned i = 0; i < chunkCount; ++i) {
+                    if (task.keys [i].index && result.dist2 <= task.keys [i].dist2) {
+                        result = task.keys [i];
+                    }
+                }
+                return result;
+            }
+        };
+
+        /*!
+            \brief A single step of the nth point routine (NP).
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator
+        >
+        struct nth_point_step
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+            nth_point_step (diff_type pointCount, diff_type n) :
+                last (pointCount - 1), n (n) {}
+
+            diff_type next (diff_type key, unsigned long long&) const {
+                return std::min (key + n, last);
+            }
+
+            // keys are multiples of n, so the guess is always right
+            diff_type guess (diff_type index) const {
+                return std::min ((index + n - 1) / n * n, last);
+            }
+
+            diff_type last;     //!< point index of the last point
+            diff_type n;        //!< specifies 'each nth point'
+        };
+
+        /*!
+            \brief A single step of the radial distance routine (RD).
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename Distance
+        >
+        struct radial_distance_step
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+            radial_distance_step (RandomAccessIterator first, diff_type pointCount, Distance tol2) :
+                first (first), last (pointCount - 1), tol2 (tol2) {}
+
+            diff_type next (diff_type key, unsigned long long& work) const {
+                RandomAccessIterator current = first + key * DIM;
+                RandomAccessIterator next = current + DIM;
+                for (diff_type index = key + 1; index < last; ++index, next += DIM) {
+                    if (tol2 <= math::point_distance2 <DIM> (current, next)) {
+                        work += static_cast <unsigned long long> (index - key);
+                        return index;
+                    }
+                }
+                work += static_cast <unsigned long long> (last - key - 1);
+                return last;
+            }
+
+            diff_type guess (diff_type index) const {
+                return index;
+            }
+
+            RandomAccessIterator first;     //!< the first coordinate of the first polyline point
+            diff_type last;                 //!< point index of the last point
+            Distance tol2;                  //!< squared distance tolerance
+        };
+
+        /*!
+            \brief A single step of Reumann-Witkam approximation (RW).
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename Distance
+        >
+        struct reumann_witkam_step
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+            reumann_witkam_step (RandomAccessIterator first, diff_type pointCount, Distance tol2) :
+                first (first), pointCount (pointCount), tol2 (tol2) {}
+
+            diff_type next (diff_type key, unsigned long long& work) const {
+                // define the line L(p0, p1)
+                RandomAccessIterator p0 = first + key * DIM;
+                RandomAccessIterator p1 = p0 + DIM;
+                RandomAccessIterator pj = p1 + DIM;
+                for (diff_type j = key + 2; j < pointCount; ++j, pj += DIM) {
+                    if (!(math::line_distance2 <DIM> (p0, p1, pj) < tol2)) {
+                        work += static_cast <unsigned long long> (j - key - 1);
+                        return j - 1;
+                    }
+                }
+                work += static_cast <unsigned long long> (std::max (pointCount - key - 2, diff_type (0)));
+                return pointCount - 1;
+            }
+
+            diff_type guess (diff_type index) const {
+                return index;
+            }
+
+            RandomAccessIterator first;     //!< the first coordinate of the first polyline point
+            diff_type pointCount;           //!< the number of points
+            Distance tol2;                  //!< squared distance tolerance
+        };
+
+        /*!
+            \brief A single step of Opheim approximation (OP).
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename Distance
+        >
+        struct opheim_step
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+            opheim_step (RandomAccessIterator first, diff_type pointCount, Distance min_tol2, Distance max_tol2) :
+                first (first), pointCount (pointCount), min_tol2 (min_tol2), max_tol2 (max_tol2) {}
+
+            diff_type next (diff_type key, unsigned long long& work) const {
+                // define the ray R(r0, r1)
+                RandomAccessIterator r0 = first + key * DIM;
+                RandomAccessIterator r1 = r0;
+                bool rayDefined = false;
+
+                RandomAccessIterator pj = r0 + 2 * DIM;
+                for (diff_type j = key + 2; j < pointCount; ++j, pj += DIM) {
+                    if (!rayDefined) {
+                        // discard each point within minimum tolerance
+                        ++work;
+                        if (math::point_distance2 <DIM> (r0, pj) < min_tol2) {
+                            continue;
+                        }
+                        // the last point within minimum tolerance pi defines the ray R(r0, r1)
+                        r1 = pj - DIM;
+                        rayDefined = true;
+                    }
+                    // check each point pj against R(r0, r1)
+                    ++work;
+                    if (math::point_distance2 <DIM> (r0, pj) < max_tol2) {
+                        ++work;
+                        if (math::ray_distance2 <DIM> (r0, r1, pj) < min_tol2) {
+                            continue;
+                        }
+                    }
+                    return j - 1;
+                }
+                return pointCount - 1;
+            }
+
+            diff_type guess (diff_type index) const {
+                return index;
+            }
+
+            RandomAccessIterator first;     //!< the first coordinate of the first polyline point
+            diff_type pointCount;           //!< the number of points
+            Distance min_tol2;              //!< squared minimum distance tolerance
+            Distance max_tol2;              //!< squared maximum distance tolerance
+        };
+
+        /*!
+            \brief A single step of Lang approximation (LA).
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator,
+            typename Distance
+        >
+        struct lang_step
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+            typedef typename util::select_calculation_type <RandomAccessIterator>::type calc_type;
+
+            lang_step (RandomAccessIterator first, diff_type pointCount, Distance tol2, diff_type look_ahead) :
+                first (first), last (pointCount - 1), tol2 (tol2), look_ahead (look_ahead) {}
+
+            diff_type next (diff_type key, unsigned long long& work) const {
+                RandomAccessIterator current = first + key * DIM;
+                diff_type index = key + std::min (look_ahead, last - key);
+
+                for (;; --index) {
+                    RandomAccessIterator next = first + index * DIM;
+                    calc_type d2 = 0;
+                    for (RandomAccessIterator p = current + DIM; p != next; p += DIM) {
+                        ++work;
+                        d2 = std::max (d2, math::segment_distance2 <DIM> (current, next, p));
+                        if (tol2 < d2) {
+                            break;
+                        }
+                    }
+                    if (d2 < tol2) {
+                        return index;
+                    }
+                }
+            }
+
+            diff_type guess (diff_type index) const {
+                return index;
+            }
+
+            RandomAccessIterator first;     //!< the first coordinate of the first polyline point
+            diff_type last;                 //!< point index of the last point
+            Distance tol2;                  //!< squared distance tolerance
+            diff_type look_ahead;           //!< size of the search region
+        };
+    }
+
+    /*!
+        \brief Nth point routine (NP), parallel.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Size,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct nth_point_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+        /*!
+            \brief Performs the nth point simplification routine using multiple threads.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Size n,
+            OutputIterator result,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM               // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            unsigned threadCount = util::thread_count (thread_count);
+            unsigned chunkCount = detail::parallel_chunk_count (pointCount, threadCount);
+
+            // validate input and check if parallel simplification is worthwhile
+            if (coordCount % DIM || pointCount < 3 || n < 2 || chunkCount < 2) {
+                return nth_point <DIM, RandomAccessIterator, Size, OutputIterator>::simplify (
+                    first, last, n, result);
+            }
+            return detail::simplify_parallel <DIM> (
+                first,
+                detail::nth_point_step <DIM, RandomAccessIterator> (pointCount, static_cast <diff_type> (n)),
+                pointCount, chunkCount, threadCount, result, stats);
+        }
+    };
+
+    /*!
+        \brief Radial distance routine (RD), parallel.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct radial_distance_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+        /*!
+            \brief Performs the radial distance simplification routine using multiple threads.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Distance tol,
+            OutputIterator result,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM          // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            Distance tol2 = tol * tol;          // squared distance tolerance
+            unsigned threadCount = util::thread_count (thread_count);
+            unsigned chunkCount = detail::parallel_chunk_count (pointCount, threadCount);
+
+            // validate input and check if parallel simplification is worthwhile
+            if (coordCount % DIM || pointCount < 3 || tol2 <= 0 || chunkCount < 2) {
+                return radial_distance <DIM, RandomAccessIterator, Distance, OutputIterator, Counters>::simplify (
+                    first, last, tol, result, stats);
+            }
+            return detail::simplify_parallel <DIM> (
+                first,
+                detail::radial_distance_step <DIM, RandomAccessIterator, Distance> (first, pointCount, tol2),
+                pointCount, chunkCount, threadCount, result, stats);
+        }
+    };
+
+    /*!
+        \brief Reumann-Witkam approximation (RW), parallel.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct reumann_witkam_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+        /*!
+            \brief Performs Reumann-Witkam approximation using multiple threads.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Distance tol,
+            OutputIterator result,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM      // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            Distance tol2 = tol * tol;      // squared distance tolerance
+            unsigned threadCount = util::thread_count (thread_count);
+            unsigned chunkCount = detail::parallel_chunk_count (pointCount, threadCount);
+
+            // validate input and check if parallel simplification is worthwhile
+            if (coordCount % DIM || pointCount < 3 || tol2 <= 0 || chunkCount < 2) {
+                return reumann_witkam <DIM, RandomAccessIterator, Distance, OutputIterator, Counters>::simplify (
+                    first, last, tol, result, stats);
+            }
+            return detail::simplify_parallel <DIM> (
+                first,
+                detail::reumann_witkam_step <DIM, RandomAccessIterator, Distance> (first, pointCount, tol2),
+                pointCount, chunkCount, threadCount, result, stats);
+        }
+    };
+
+    /*!
+        \brief Opheim approximation (OP), parallel.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct opheim_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+        /*!
+            \brief Performs Opheim approximation using multiple threads.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Distance min_tol,
+            Distance max_tol,
+            OutputIterator result,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM              // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            Distance min_tol2 = min_tol * min_tol;  // squared minimum distance tolerance
+            Distance max_tol2 = max_tol * max_tol;  // squared maximum distance tolerance
+            unsigned threadCount = util::thread_count (thread_count);
+            unsigned chunkCount = detail::parallel_chunk_count (pointCount, threadCount);
+
+            // validate input and check if parallel simplification is worthwhile
+            if (coordCount % DIM || pointCount < 3 || min_tol2 <= 0 || max_tol2 <= 0 || chunkCount < 2) {
+                return opheim <DIM, RandomAccessIterator, Distance, OutputIterator, Counters>::simplify (
+                    first, last, min_tol, max_tol, result, stats);
+            }
+            return detail::simplify_parallel <DIM> (
+                first,
+                detail::opheim_step <DIM, RandomAccessIterator, Distance> (first, pointCount, min_tol2, max_tol2),
+                pointCount, chunkCount, threadCount, result, stats);
+        }
+    };
+
+    /*!
+        \brief Lang approximation (LA), parallel.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename Size,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct lang_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+        /*!
+            \brief Performs Lang approximation using multiple threads.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Distance tol,
+            Size look_ahead,
+            OutputIterator result,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM              // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            Distance tol2 = tol * tol;              // squared minimum distance tolerance
+            unsigned threadCount = util::thread_count (thread_count);
+            unsigned chunkCount = detail::parallel_chunk_count (pointCount, threadCount);
+
+            // validate input and check if parallel simplification is worthwhile
+            if (coordCount % DIM || pointCount < 3 || look_ahead < 2 || tol2 <= 0 || chunkCount < 2) {
+                return lang <DIM, RandomAccessIterator, Distance, Size, OutputIterator, Counters>::simplify (
+                    first, last, tol, look_ahead, result, stats);
+            }
+            return detail::simplify_parallel <DIM> (
+                first,
+                detail::lang_step <DIM, RandomAccessIterator, Distance> (
+                    first, pointCount, tol2, static_cast <diff_type> (look_ahead)),
+                pointCount, chunkCount, threadCount, result, stats);
+        }
+    };
+
+    /*!
+        \brief Douglas-Peucker approximation with a point count tolerance (DPn), parallel.
+
+        Only the distance evaluations are passed to the counters, by the calling thread after
+        each batch of candidates, which is also when the routine checks if it should stop.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Size,
+        typename OutputIterator,
+        typename Counters = util::no_counters
+    >
+    struct douglas_peucker_n_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+        typedef typename detail::find_key <DIM, RandomAccessIterator> key_finder;
+        typedef typename detail::find_key <DIM, RandomAccessIterator>::key key_type;
+        typedef typename detail::find_key_parallel <DIM, RandomAccessIterator> parallel_key_finder;
+
+        /*!
+            \brief Performs Douglas-Peucker approximation with a point count tolerance, using
+            multiple threads.
+        */
+        static OutputIterator simplify (
+            RandomAccessIterator first,
+            RandomAccessIterator last,
+            Size tol,
+            OutputIterator result,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            diff_type coordCount = std::distance (first, last);
+            diff_type pointCount = DIM      // protect against zero DIM
+                                   ? coordCount / DIM
+                                   : 0;
+            unsigned threadCount = util::thread_count (thread_count);
+
+            // validate input and check if parallel simplification is worthwhile
+            if (coordCount % DIM || pointCount <= static_cast <diff_type> (tol) || tol <= 2 ||
+                threadCount < 2 || pointCount < static_cast <diff_type> (2 * detail::parallel_min_chunk))
+            {
+                return douglas_peucker_n <DIM, RandomAccessIterator, Size, OutputIterator, Counters>::simplify (
+                    first, last, tol, result, stats);
+            }
+
+            util::trace_scope trace ("douglas_peucker_n_parallel");
+            util::trace_scope stage ("start threads");
+
+            // keep track of what points are part of the simplification (keys)
+            util::scoped_array <unsigned char> keys (static_cast <unsigned> (pointCount));
+            std::fill_n (keys.get (), pointCount, 0);
+            keys [0] = 1;                   // the first point is always a key
+            keys [static_cast <int> (pointCount - 1)] = 1;      // the last point is always a key
+            Size keyCount = 2;
+
+            util::thread_pool pool (threadCount);
+            stage.next ("find keys");
+            size_t batchSize = 4 * threadCount;
+
+            // keep track of all sub polylines that still need to be processed
+            util::dary_heap <sub_poly> queue;        // sorted (max key dist2) job queue
+            sub_poly poly (0, coordCount-DIM);
+            poly.key = parallel_key_finder::apply (pool, first, poly.first, poly.last);
+            queue.push (poly);                       // add complete poly
+            stats.distance (static_cast <unsigned long long> (pointCount - 2));
+
+            std::vector <sub_poly> batch;
+            while (!queue.empty ()) {
+                // take the top candidates
+                batch.clear ();
+                size_t needed = static_cast <size_t> (tol - keyCount);
+                while (!queue.empty () && batch.size () < std::min (batchSize, needed)) {
+                    batch.push_back (queue.top ());
+                    queue.pop ();
+                }
+                stats.distance (static_cast <unsigned long long> (expand (pool, first, batch)));
+                if (stats.stopped ()) {
+                    return result;
+                }
+
+                // accept candidates in the order the serial routine would take them: a candidate
+                // is only accepted when it beats each child of the already accepted candidates
+                size_t accepted = 0;
+                sub_poly best;
+                bool done = false;
+                for (; accepted < batch.size () && !done; ++accepted) {
+                    const sub_poly& candidate = batch [accepted];
+                    if (best.key.index && candidate < best) {
+                        break;
+                    }
+                    // store the key
+                    keys [static_cast <int> (candidate.key.index / DIM)] = 1;
+                    // check point count tolerance
+                    done = ++keyCount == tol;
+
+                    // split the polyline at the key and recurse
+                    sub_poly left (candidate.first, candidate.key.index);
+                    left.key = candidate.left;
+                    sub_poly right (candidate.key.index, candidate.last);
+                    right.key = candidate.right;
+                    if (left.key.index) {
+                        queue.push (left);
+                        best = best.key.index && left < best ? best : left;
+                    }
+                    if (right.key.index) {
+                        queue.push (right);
+                        best = best.key.index && right < best ? best : right;
+                    }
+                }
+                if (done) {
+                    break;
+                }
+                // return the remaining candidates, their children remain cached
+                for (size_t i = accepted; i < batch.size (); ++i) {
+                    queue.push (batch [i]);
+                }
+            }
+            // copy keys
+            stage.next ("copy keys");
+            util::copy_keys <DIM> (first, last, keys.get (), result);
+            return result;
+        }
+
+    private:
+        /*!
+            \brief Defines a sub polyline, and caches the keys of its children.
+        */
+        struct sub_poly {
+            sub_poly (diff_type first=0, diff_type last=0) :
+                first (first), last (last), expanded (false) {}
+
+            diff_type first;    //!< coord index of the first point
+            diff_type last;     //!< coord index of the last point
+            key_type key;       //!< key of this sub poly
+            bool expanded;      //!< indicates if the keys of both children are known
+            key_type left;      //!< key of the sub poly [first, key]
+            key_type right;     //!< key of the sub poly [key, last]
+
+            //! \brief Orders on key dist2; ties go to the sub poly that comes first.
+            bool operator< (const sub_poly& other) const {
+                return key.dist2 < other.key.dist2 ||
+                       (key.dist2 == other.key.dist2 && other.first < first);
+            }
+        };
+
+        /*!
+            \brief Finds the key of a single child of a candidate.
+        */
+        struct find_child {
+            find_child (RandomAccessIterator poly, std::vector <sub_poly>& batch) :
+                poly (poly), batch (batch) {}
+
+            void operator () (unsigned i) {
+                sub_poly& candidate = batch [jobs [i] / 2];
+                if (jobs [i] % 2) {
+                    candidate.right = key_finder::apply (poly, candidate.key.index, candidate.last);
+                }
+                else {
+                    candidate.left = key_finder::apply (poly, candidate.first, candidate.key.index);
+                }
+            }
+
+            RandomAccessIterator poly;
+            std::vector <sub_poly>& batch;
+            std::vector <unsigned> jobs;    //!< 2 * candidate index + (0: left, 1: right)
+        };
+
+        /*!
+            \brief Finds the keys of the children of each candidate that was not expanded before.
+
+            Large children are split over all threads; small children are divided over the
+            threads, unless there is too little work to benefit from that.
+
+            \return the number of distance evaluations
+        */
+        static diff_type expand (
+            util::thread_pool& pool,
+            RandomAccessIterator poly,
+            std::vector <sub_poly>& batch)
+        {
+            find_child task (poly, batch);
+            diff_type work = 0;         // the points of the small children
+            diff_type distances = 0;
+
+            for (size_t c = 0; c < batch.size (); ++c) {
+                sub_poly& candidate = batch [c];
+                if (candidate.expanded) {
+                    continue;
+                }
+                candidate.expanded = true;
+
+                diff_type count [2] = {
+                    (candidate.key.index - candidate.first) / DIM,
+                    (candidate.last - candidate.key.index) / DIM
+                };
+                for (unsigned side = 0; side < 2; ++side) {
+                    distances += std::max (count [side] - 1, static_cast <diff_type> (0));
+                    if (static_cast <diff_type> (2 * detail::parallel_min_chunk) <= count [side]) {
+                        key_type& key = side ? candidate.right : candidate.left;
+                        key = side
+                            ? parallel_key_finder::apply (pool, poly, candidate.key.index, candidate.last)
+                            : parallel_key_finder::apply (pool, poly, candidate.first, candidate.key.index);
+                    }
+                    else {
+                        task.jobs.push_back (static_cast <unsigned> (2 * c + side));
+                        work += count [side];
+                    }
+                }
+            }
+            if (static_cast <diff_type> (detail::parallel_min_chunk) <= work) {
+                pool.run (static_cast <unsigned> (task.jobs.size ()), task);
+            }
+            else {
+                for (unsigned i = 0; i < task.jobs.size (); ++i) {
+                    task (i);
+                }
+            }
+            return distances;
+        }
+    };
+
+}}
+
+
+namespace psimpl {
+    namespace error
+{
+    namespace detail
+    {
+        /*!
+            \brief Computes the positional errors of one chunk of points per task.
+
+            The points of the original polyline are divided into equally sized chunks, so that
+            the work is balanced independent of the length of the segments. The segment that
+            contains the first point of a chunk is found by a binary search in the indices.
+            Each chunk passes its errors to its own sink.
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator1,
+            typename RandomAccessIterator2,
+            typename Sink
+        >
+        class positional_chunk_task
+        {
+            typedef typename std::iterator_traits <RandomAccessIterator1>::difference_type diff_type;
+            typedef typename std::iterator_traits <RandomAccessIterator2>::value_type key_type;
+
+        public:
+            positional_chunk_task (
+                RandomAccessIterator1 original_first,
+                RandomAccessIterator2 keys_first,
+                RandomAccessIterator2 keys_last,
+                diff_type pointCount,
+                std::vector <Sink>& sinks) :
+                original_first (original_first),
+                keys_first (keys_first),
+                keys_last (keys_last),
+                pointCount (pointCount),
+                sinks (sinks)
+            {}
+
+            //! \brief Returns the first point of chunk i.
+            static diff_type chunk_begin (diff_type pointCount, unsigned chunkCount, unsigned i) {
+                return pointCount / chunkCount * i + std::min (pointCount % chunkCount, static_cast <diff_type> (i));
+            }
+
+            void operator() (unsigned i) {
+                unsigned chunkCount = static_cast <unsigned> (sinks.size ());
+                diff_type begin = chunk_begin (pointCount, chunkCount, i);
+                diff_type end = chunk_begin (pointCount, chunkCount, i + 1);
+
+                // the last index at or before begin
+                RandomAccessIterator2 key = std::upper_bound (keys_first, keys_last, static_cast <key_type> (begin));
+                positional_range_blocks <DIM> (original_first, key - 1, keys_last, begin, end, sinks [i], util::no_counters ());
+            }
+
+        private:
+            RandomAccessIterator1 original_first;
+            RandomAccessIterator2 keys_first;
+            RandomAccessIterator2 keys_last;
+            diff_type pointCount;
+            std::vector <Sink>& sinks;
+        };
+    }
+
+    /*!
+        \brief Squared positional error between a polyline and its simplification, where the
+        simplification is defined by the indices of the kept points, computed using multiple
+        threads.
+
+        Each chunk writes its errors directly to its part of the output range.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename RandomAccessIterator2,
+        typename RandomAccessIterator3,
+        typename Counters = util::no_counters
+    >
+    struct positional_indexed_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator1>::difference_type diff_type;
+
+        /*!
+            \brief Computes the squared positional error between a polyline and its simplification.
+        */
+        static RandomAccessIterator3 compute (
+            RandomAccessIterator1 original_first,
+            RandomAccessIterator1 original_last,
+            RandomAccessIterator2 keys_first,
+            RandomAccessIterator2 keys_last,
+            RandomAccessIterator3 result,
+            bool* valid,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            typedef detail::copy_sink <RandomAccessIterator3> sink_type;
+            typedef detail::positional_chunk_task <DIM, RandomAccessIterator1, RandomAccessIterator2, sink_type> task_type;
+
+            diff_type coordCount = std::distance (original_first, original_last);
+            bool ok = detail::valid_indices <DIM> (coordCount, keys_first, keys_last);
+            if (valid) {
+                *valid = ok;
+            }
+            if (!ok) {
+                return result;
+            }
+            diff_type pointCount = coordCount / DIM;
+            unsigned threadCount = util::thread_count (thread_count);
+            unsigned chunkCount = algo::detail::parallel_chunk_count (pointCount, threadCount);
+
+            std::vector <sink_type> sinks;
+            for (unsigned i = 0; i < chunkCount; ++i) {
+                sinks.push_back (sink_type (result + task_type::chunk_begin (pointCount, chunkCount, i)));
+            }
+            task_type task (original_first, keys_first, keys_last, pointCount, sinks);
+            util::parallel_for (chunkCount, threadCount, task);
+            stats.distance (static_cast <unsigned long long> (pointCount));
+
+            return result + pointCount;
+        }
+    };
+
+    /*!
+        \brief Positional error statistics between a polyline and its simplification, where the
+        simplification is defined by the indices of the kept points, computed using multiple
+        threads.
+
+        Each chunk accumulates its own statistics and quantile sketch, which are merged in order.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename RandomAccessIterator2,
+        typename Counters = util::no_counters
+    >
+    struct positional_indexed_statistics_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator1>::difference_type diff_type;
+
+        /*!
+            \brief Computes the positional error statistics between a polyline and its simplification.
+
+            Each error is also added to sketch, if specified.
+        */
+        static statistics compute (
+            RandomAccessIterator1 original_first,
+            RandomAccessIterator1 original_last,
+            RandomAccessIterator2 keys_first,
+            RandomAccessIterator2 keys_last,
+            bool* valid,
+            quantile_sketch* sketch,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            typedef detail::sqrt_accumulate_sink sink_type;
+            typedef detail::positional_chunk_task <DIM, RandomAccessIterator1, RandomAccessIterator2, sink_type> task_type;
+
+            diff_type coordCount = std::distance (original_first, original_last);
+            bool ok = detail::valid_indices <DIM> (coordCount, keys_first, keys_last);
+            if (valid) {
+                *valid = ok;
+            }
+            if (!ok) {
+                return statistics ();
+            }
+            diff_type pointCount = coordCount / DIM;
+            unsigned threadCount = util::thread_count (thread_count);
+            unsigned chunkCount = algo::detail::parallel_chunk_count (pointCount, threadCount);
+
+            // partial results per chunk, sketches with the same parameters as sketch
+            std::vector <accumulator> accs (chunkCount);
+            std::vector <quantile_sketch> sketches;
+            if (sketch) {
+                quantile_sketch empty (*sketch);
+                empty.clear ();
+                sketches.assign (chunkCount, empty);
+            }
+            std::vector <sink_type> sinks;
+            for (unsigned i = 0; i < chunkCount; ++i) {
+                sinks.push_back (sink_type (accs [i], sketch ? &sketches [i] : 0));
+            }
+            task_type task (original_first, keys_first, keys_last, pointCount, sinks);
+            util::parallel_for (chunkCount, threadCount, task);
+            stats.distance (static_cast <unsigned long long> (pointCount));
+
+            accumulator acc;
+            for (unsigned i = 0; i < chunkCount; ++i) {
+                acc.merge (accs [i]);
+                if (sketch) {
+                    sketch->merge (sketches [i]);
+                }
+            }
+            return acc.result ();
+        }
+    };
+
+    /*!
+        \brief Squared positional error between a polyline and its simplification, computed using
+        multiple threads.
+
+        The points of the simplification are first matched to the original polyline, which only
+        compares coordinates, after which the errors are computed in parallel from the indices.
+        If the points cannot be matched, the serial routine is used, so that the output is the
+        same as that of positional.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename ForwardIterator,
+        typename RandomAccessIterator2,
+        typename Counters = util::no_counters
+    >
+    struct positional_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator1>::difference_type diff_type;
+
+        /*!
+            \brief Computes the squared positional error between a polyline and its simplification.
+        */
+        static RandomAccessIterator2 compute (
+            RandomAccessIterator1 original_first,
+            RandomAccessIterator1 original_last,
+            ForwardIterator simplified_first,
+            ForwardIterator simplified_last,
+            RandomAccessIterator2 result,
+            bool* valid,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            std::vector <diff_type> keys;
+            if (!detail::match_indices <DIM> (original_first, original_last,
+                                              simplified_first, simplified_last, keys))
+            {
+                return positional <DIM, RandomAccessIterator1, ForwardIterator, RandomAccessIterator2, Counters>::compute (
+                    original_first, original_last, simplified_first, simplified_last, result, valid, stats);
+            }
+            return positional_indexed_parallel
+                <
+                    DIM,
+                    RandomAccessIterator1,
+                    typename std::vector <diff_type>::const_iterator,
+                    RandomAccessIterator2,
+                    Counters
+                >::compute (original_first, original_last,
+                            keys.begin (), keys.end (),
+                            result, valid, thread_count, stats);
+        }
+    };
+
+    /*!
+        \brief Positional error statistics between a polyline and its simplification, computed
+        using multiple threads.
+
+        See positional_parallel for how the points of the simplification are matched.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename Counters = util::no_counters
+    >
+    struct positional_statistics_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+        /*!
+            \brief Computes the positional error statistics between a polyline and its simplification.
+
+            Each error is also added to sketch, if specified.
+        */
+        static statistics compute (
+            RandomAccessIterator original_first,
+            RandomAccessIterator original_last,
+            ForwardIterator simplified_first,
+            ForwardIterator simplified_last,
+            bool* valid,
+            quantile_sketch* sketch,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            std::vector <diff_type> keys;
+            if (!detail::match_indices <DIM> (original_first, original_last,
+                                              simplified_first, simplified_last, keys))
+            {
+                return positional_statistics <DIM, RandomAccessIterator, ForwardIterator, Counters>::compute (
+                    original_first, original_last, simplified_first, simplified_last, valid, sketch, stats);
+            }
+            return positional_indexed_statistics_parallel
+                <
+                    DIM,
+                    RandomAccessIterator,
+                    typename std::vector <diff_type>::const_iterator,
+                    Counters
+                >::compute (original_first, original_last,
+                            keys.begin (), keys.end (),
+                            valid, sketch, thread_count, stats);
+        }
+    };
+
+    namespace detail
+    {
+        /*!
+            \brief Sums the areal displacement of one range of segments per task.
+        */
+        template
+        <
+            unsigned DIM,
+            typename RandomAccessIterator1,
+            typename RandomAccessIterator2
+        >
+        class areal_chunk_task
+        {
+        public:
+            areal_chunk_task (
+                RandomAccessIterator1 original_first,
+                RandomAccessIterator2 keys_first,
+                const std::vector <std::ptrdiff_t>& bounds,
+                std::vector <double>& sums) :
+                original_first (original_first),
+                keys_first (keys_first),
+                bounds (bounds),
+                sums (sums)
+            {}
+
+            void operator() (unsigned i) {
+                areal_indexed <DIM, RandomAccessIterator1, RandomAccessIterator2, sum_iterator>::compute (
+                    original_first, keys_first + bounds [i], keys_first + bounds [i + 1] + 1,
+                    sum_iterator (sums [i]));
+            }
+
+        private:
+            RandomAccessIterator1 original_first;
+            RandomAccessIterator2 keys_first;
+            const std::vector <std::ptrdiff_t>& bounds;
+            std::vector <double>& sums;
+        };
+    }
+
+    /*!
+        \brief Total areal displacement between a 2d polyline and its simplification, computed
+        using multiple threads.
+
+        The points of the simplification are matched to the original polyline first, see
+        positional_parallel. The segments are then divided into ranges that each cover about
+        the same number of original points, and the partial sums are added in order. If the
+        points cannot be matched, the serial routine is used.
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename Counters = util::no_counters
+    >
+    struct areal_parallel
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+        typedef typename std::vector <diff_type>::const_iterator key_iterator;
+
+        /*!
+            \brief Computes the total areal displacement between a polyline and its simplification.
+        */
+        static double compute (
+            RandomAccessIterator original_first,
+            RandomAccessIterator original_last,
+            ForwardIterator simplified_first,
+            ForwardIterator simplified_last,
+            bool* valid,
+            unsigned thread_count,
+            Counters stats = Counters ())
+        {
+            double sum = 0;
+            std::vector <diff_type> keys;
+            if (!detail::match_indices <DIM> (original_first, original_last,
+                                              simplified_first, simplified_last, keys))
+            {
+                areal <DIM, RandomAccessIterator, ForwardIterator, detail::sum_iterator, Counters>::compute (
+                    original_first, original_last, simplified_first, simplified_last,
+                    detail::sum_iterator (sum), valid, stats);
+                return sum;
+            }
+            if (valid) {
+                *valid = true;
+            }
+            diff_type pointCount = std::distance (original_first, original_last) / DIM;
+            unsigned threadCount = util::thread_count (thread_count);
+            unsigned chunkCount = algo::detail::parallel_chunk_count (pointCount, threadCount);
+
+            // the first key at or after each chunk of points
+            std::vector <std::ptrdiff_t> bounds (1, 0);
+            for (unsigned i = 1; i < chunkCount; ++i) {
+                std::ptrdiff_t bound = std::lower_bound (keys.begin (), keys.end (), pointCount / chunkCount * i) - keys.begin ();
+                if (bounds.back () < bound && bound < static_cast <std::ptrdiff_t> (keys.size ()) - 1) {
+                    bounds.push_back (bound);
+                }
+            }
+            bounds.push_back (static_cast <std::ptrdiff_t> (keys.size ()) - 1);
+
+            std::vector <double> sums (bounds.size () - 1, 0.0);
+            key_iterator keys_first = keys.begin ();
+            detail::areal_chunk_task <DIM, RandomAccessIterator, key_iterator> task (original_first, keys_first, bounds, sums);
+            util::parallel_for (static_cast <unsigned> (sums.size ()), threadCount, task);
+            stats.distance (static_cast <unsigned long long> (pointCount) - keys.size ());
+
+            for (size_t i = 0; i < sums.size (); ++i) {
+                sum += sums [i];
+            }
+            return sum;
+        }
+    };
+}}
+
+
+#endif // PSIMPL_DETAIL_PARALLEL
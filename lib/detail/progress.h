@@ -0,0 +1,238 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+
+#ifndef PSIMPL_DETAIL_PROGRESS
+#define PSIMPL_DETAIL_PROGRESS
+
+
+#include <atomic>
+#include "counters.h"
+
+
+namespace psimpl
+{
+    /*!
+        \brief Reports the progress of a long running routine, and lets it be cancelled.
+
+        Pass an instance to a routine through with_counters. The routine reports its
+        work in distance evaluations, and every interval evaluations it calls update, and checks
+        if cancel was called. When update returns false, or after cancel, the routine stops at
+        its next check. Its result is then abandoned: the coordinates that were written so far,
+        and the returned iterator or value, are incomplete and must be discarded.
+
+        Checks happen between the steps of a routine, e.g. after each segment that
+        Douglas-Peucker searches for its key, after each row of the discrete Frechet table, after
+        each block of points of the single pass routines and of the positional errors, or after
+        each polyline of a batch. simplify_douglas_peucker_n_parallel checks after each batch of
+        candidates, the other chunk parallel simplifications after their speculative run and
+        after each seam they repair.
+
+        All routines report their work. The serial simplification, positional error, areal
+        displacement, Hausdorff and discrete Frechet routines, and the parallel
+        simplifications, also check for cancellation. Exceptions are the nth point routines,
+        which evaluate no distances and always run to completion, and the parallel positional
+        error and areal displacement routines, which report their work once their threads have
+        finished, and so cannot be stopped early.
+
+        update is called by the thread that runs the routine, cancel can be called by any
+        thread. An instance should be used by one routine at a time, but can be reused.
+    */
+    class progress
+    {
+    public:
+        //! \brief Creates a progress object that checks every interval distance evaluations.
+        explicit progress (unsigned long long interval = 65536) :
+            mInterval (interval ? interval : 1),
+            mWork (0),
+            mNext (mInterval),
+            mStopped (false),
+            mCancelled (false)
+        {}
+
+        virtual ~progress () {}
+
+        //! \brief Requests the routine to stop at its next check.
+        void cancel () {
+            mCancelled.store (true, std::memory_order_relaxed);
+        }
+
+        //! \brief Indicates if the routine was stopped, and its result must be discarded.
+        bool stopped () const {
+            return mStopped;
+        }
+
+        //! \brief Returns the number of distance evaluations reported so far.
+        unsigned long long work () const {
+            return mWork;
+        }
+
+        //! \brief Clears the work, and the stopped and cancelled state.
+        void reset () {
+            mWork = 0;
+            mNext = mInterval;
+            mStopped = false;
+            mCancelled.store (false, std::memory_order_relaxed);
+        }
+
+        /*!
+            \brief Adds n distance evaluations, and checks for cancellation once an interval
+            has passed.
+        */
+        void advance (unsigned long long n) {
+            mWork += n;
+            if (mNext <= mWork && !mStopped) {
+                mNext = mWork + mInterval;
+                mStopped = mCancelled.load (std::memory_order_relaxed) || !update (mWork);
+            }
+        }
+
+    protected:
+        /*!
+            \brief Called at each check with the work done so far.
+
+            The default implementation never stops the routine.
+
+            \param[in] work     the number of distance evaluations reported so far
+            \return             false to stop the routine
+        */
+        virtual bool update (unsigned long long work) {
+            (void) work;
+            return true;
+        }
+
+    private:
+        progress (const progress&);
+        progress& operator= (const progress&);
+
+    private:
+        unsigned long long mInterval;       //!< distance evaluations between checks
+        unsigned long long mWork;           //!< distance evaluations reported so far
+        unsigned long long mNext;           //!< work at which the next check happens
+        bool mStopped;                      //!< indicates that a check stopped the routine
+        std::atomic <bool> mCancelled;      //!< indicates that cancel was called
+    };
+
+    /*!
+        \brief Progress object that stops the routine once a deadline has passed.
+
+        The deadline is a std::chrono::time_point; its clock is read at each check, like
+        douglas_peucker_n_refiner::refine_until does.
+    */
+    template <typename TimePoint>
+    class deadline_progress : public progress
+    {
+    public:
+        explicit deadline_progress (
+            const TimePoint& deadline,
+            unsigned long long interval = 65536) :
+            progress (interval),
+            mDeadline (deadline)
+        {}
+
+    protected:
+        virtual bool update (unsigned long long) {
+            return TimePoint::clock::now () < mDeadline;
+        }
+
+    private:
+        TimePoint mDeadline;                //!< the routine stops at the first check after this
+    };
+
+    namespace util
+    {
+        /*!
+            \brief Counters policy that reports the distance evaluations to a psimpl::progress
+            instance, and stops the algorithm when it was stopped.
+        */
+        class progress_ref
+        {
+        public:
+            explicit progress_ref (progress& monitor) :
+                mProgress (&monitor)
+            {}
+
+            //! \brief Reports n distance evaluations.
+            void distance (unsigned long long n = 1) const {
+                mProgress->advance (n);
+            }
+
+            void key_search (unsigned long long) const {}
+            void depth (unsigned long long) const {}
+            void backtrack () const {}
+            void output () const {}
+
+            //! \brief Indicates if the algorithm should stop.
+            bool stopped () const {
+                return mProgress->stopped ();
+            }
+
+        private:
+            progress* mProgress;
+        };
+    }
+
+    /*!
+        \brief Reports the progress of a routine that writes to result.
+
+        Like with_counters (result, counters&), but reports the work to monitor.
+
+        \param[in] result      destination of the routine
+        \param[in,out] monitor reports the progress, and can stop the routine
+        \return                 output iterator that writes to result
+    */
+    template <typename OutputIterator>
+    inline util::monitored_output <OutputIterator, util::progress_ref> with_counters (
+        OutputIterator result,
+        progress& monitor)
+    {
+        return util::monitored_output <OutputIterator, util::progress_ref> (result, util::progress_ref (monitor));
+    }
+
+    /*!
+        \brief Reports the progress of a routine without a single output iterator.
+
+        Like with_counters (counters&), but reports the work to monitor.
+
+        \param[in,out] monitor reports the progress, and can stop the routine
+        \return                 the counters policy
+    */
+    inline util::progress_ref with_counters (
+        progress& monitor)
+    {
+        return util::progress_ref (monitor);
+    }
+}
+
+#endif // PSIMPL_DETAIL_PROGRESS
@@ -0,0 +1,371 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+
+#ifndef PSIMPL_DETAIL_SPATIAL
+#define PSIMPL_DETAIL_SPATIAL
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include "math.h"
+
+
+namespace psimpl {
+    namespace spatial
+{
+    /*!
+        \brief Hierarchy of axis aligned bounding boxes over consecutive points of a polyline.
+
+        The points are divided into leaves of leaf_size segments. Leaf k bounds the points
+        [k * leaf_size, (k + 1) * leaf_size], so it contains all segments that start in it.
+        Each next level bounds pairs of nodes of the level below, up to a single root. Because
+        consecutive points of a polyline lie close together, the boxes are tight without
+        sorting the points, and the tree takes O(n / leaf_size) memory.
+
+        When the coordinates do not convert exactly to T, the minimum coordinates are rounded
+        down and the maximum coordinates up, so that each box still bounds its points.
+    */
+    template
+    <
+        unsigned DIM,
+        typename T
+    >
+    class box_tree
+    {
+    public:
+        /*!
+            \brief Builds the tree over the polyline [first, first + pointCount * DIM).
+        */
+        template <typename RandomAccessIterator>
+        box_tree (
+            RandomAccessIterator first,
+            std::ptrdiff_t pointCount,
+            std::ptrdiff_t leaf_size = 8) :
+            mPointCount (pointCount),
+            mLeafSize (std::max (leaf_size, static_cast <std::ptrdiff_t> (1)))
+        {
+            std::ptrdiff_t segmentCount = std::max (pointCount - 1, static_cast <std::ptrdiff_t> (1));
+            std::ptrdiff_t count = pointCount > 0 ? (segmentCount + mLeafSize - 1) / mLeafSize : 0;
+
+            // the leaves
+            mOffsets.push_back (0);
+            mBoxes.resize (static_cast <std::size_t> (count) * 2 * DIM);
+            for (std::ptrdiff_t k = 0; k < count; ++k) {
+                T* box = &mBoxes [static_cast <std::size_t> (k) * 2 * DIM];
+                std::ptrdiff_t last = std::min ((k + 1) * mLeafSize, pointCount - 1);
+                for (unsigned d = 0; d < DIM; ++d) {
+                    box [d] = round_down (first [k * mLeafSize * DIM + d]);
+                    box [DIM + d] = round_up (first [k * mLeafSize * DIM + d]);
+                }
+                for (std::ptrdiff_t i = k * mLeafSize + 1; i <= last; ++i) {
+                    for (unsigned d = 0; d < DIM; ++d) {
+                        box [d] = std::min (box [d], round_down (first [i * DIM + d]));
+                        box [DIM + d] = std::max (box [DIM + d], round_up (first [i * DIM + d]));
+                    }
+                }
+            }
+            if (count) {
+                mOffsets.push_back (static_cast <std::size_t> (count));
+            }
+
+            // the levels above
+            while (count > 1) {
+                std::size_t below = mOffsets [mOffsets.size () - 2];
+                count = (count + 1) / 2;
+                mBoxes.resize ((mOffsets.back () + static_cast <std::size_t> (count)) * 2 * DIM);
+                for (std::ptrdiff_t k = 0; k < count; ++k) {
+                    T* box = &mBoxes [(mOffsets.back () + static_cast <std::size_t> (k)) * 2 * DIM];
+                    const T* left = &mBoxes [(below + static_cast <std::size_t> (2 * k)) * 2 * DIM];
+                    std::copy (left, left + 2 * DIM, box);
+                    if (below + static_cast <std::size_t> (2 * k + 1) < mOffsets.back ()) {
+                        const T* right = left + 2 * DIM;
+                        for (unsigned d = 0; d < DIM; ++d) {
+                            box [d] = std::min (box [d], right [d]);
+                            box [DIM + d] = std::max (box [DIM + d], right [DIM + d]);
+                        }
+                    }
+                }
+                mOffsets.push_back (mOffsets.back () + static_cast <std::size_t> (count));
+            }
+        }
+
+        //! \brief Returns the number of levels, where level 0 contains the leaves; 0 when empty.
+        unsigned levels () const {
+            return static_cast <unsigned> (mOffsets.size () - 1);
+        }
+
+        //! \brief Returns the number of nodes of a level.
+        std::ptrdiff_t nodes (unsigned level) const {
+            return static_cast <std::ptrdiff_t> (mOffsets [level + 1] - mOffsets [level]);
+        }
+
+        //! \brief Returns the minimum coordinates of a node, followed by its maximum coordinates.
+        const T* box (unsigned level, std::ptrdiff_t node) const {
+            return &mBoxes [(mOffsets [level] + static_cast <std::size_t> (node)) * 2 * DIM];
+        }
+
+        //! \brief Returns the first point bounded by a node.
+        std::ptrdiff_t first_point (unsigned level, std::ptrdiff_t node) const {
+            return (node << level) * mLeafSize;
+        }
+
+        //! \brief Returns the last point bounded by a node (inclusive).
+        std::ptrdiff_t last_point (unsigned level, std::ptrdiff_t node) const {
+            return std::min (((node + 1) << level) * mLeafSize, mPointCount - 1);
+        }
+
+        //! \brief Returns the number of segments per leaf.
+        std::ptrdiff_t leaf_size () const {
+            return mLeafSize;
+        }
+
+        //! \brief Returns the number of points of the polyline.
+        std::ptrdiff_t point_count () const {
+            return mPointCount;
+        }
+
+        //! \brief Returns the squared distance between a node and point p, 0 when p is inside.
+        T distance2 (unsigned level, std::ptrdiff_t node, const T* p) const {
+            const T* b = box (level, node);
+            T dist2 = 0;
+            for (unsigned d = 0; d < DIM; ++d) {
+                T e = std::max (std::max (b [d] - p [d], p [d] - b [DIM + d]), T (0));
+                dist2 += e * e;
+            }
+            return dist2;
+        }
+
+    private:
+        //! \brief Converts a coordinate to the largest T that does not exceed it.
+        template <typename V>
+        static T round_down (V value) {
+            T result = static_cast <T> (value);
+            return value < result ? step (result, -1) : result;
+        }
+
+        //! \brief Converts a coordinate to the smallest T that is not below it.
+        template <typename V>
+        static T round_up (V value) {
+            T result = static_cast <T> (value);
+            return result < value ? step (result, 1) : result;
+        }
+
+        //! \brief Returns the next representable value after value in the given direction.
+        static T step (T value, int direction) {
+            return std::numeric_limits <T>::is_integer
+                ? static_cast <T> (value + direction)
+                : static_cast <T> (std::nextafter (value, direction * std::numeric_limits <T>::max ()));
+        }
+
+        std::ptrdiff_t mPointCount;         //!< number of points of the polyline
+        std::ptrdiff_t mLeafSize;           //!< number of segments per leaf
+        std::vector <std::size_t> mOffsets; //!< index of the first node of each level, and the end
+        std::vector <T> mBoxes;             //!< minimum and maximum coordinates of each node
+    };
+
+    /*!
+        \brief Finds the squared distance between point p and the nearest segment of a polyline.
+
+        The search starts at the segment hint, typically the nearest segment of the previous
+        query point, and then visits the nodes of the tree nearest first, skipping each node that
+        is farther away than the nearest segment found so far. The search stops as soon as a
+        segment within bound is found, which is all that is needed when only the largest
+        distance over many query points is of interest.
+
+        A polyline of a single point is treated as a single segment of zero length.
+
+        \param[in]     tree     the tree over the polyline
+        \param[in]     first    the first coordinate of the polyline
+        \param[in]     p        the query point
+        \param[in]     bound    the squared distance that is close enough
+        \param[in,out] hint     the first segment to test; becomes the nearest segment found
+        \return                 the squared distance to the nearest segment, or to a segment
+                                within bound
+    */
+    template
+    <
+        unsigned DIM,
+        typename T,
+        typename RandomAccessIterator
+    >
+    T nearest_segment_distance2 (
+        const box_tree <DIM, T>& tree,
+        RandomAccessIterator first,
+        const T* p,
+        T bound,
+        std::ptrdiff_t& hint)
+    {
+        std::ptrdiff_t last = std::max (tree.point_count () - 1, static_cast <std::ptrdiff_t> (0));
+        hint = std::min (std::max (hint, static_cast <std::ptrdiff_t> (0)),
+                         std::max (last - 1, static_cast <std::ptrdiff_t> (0)));
+
+        T best = static_cast <T> (math::segment_distance2 <DIM> (
+            first + hint * DIM, first + std::min (hint + 1, last) * DIM, p));
+        if (best <= bound || !tree.levels ()) {
+            return best;
+        }
+
+        // depth first, nearest child first; each level pushes at most two nodes
+        struct entry {
+            unsigned level;
+            std::ptrdiff_t node;
+            T dist2;
+        };
+        entry stack [2 * (std::numeric_limits <std::ptrdiff_t>::digits + 1)];
+        unsigned size = 0;
+        unsigned top = tree.levels () - 1;
+        stack [size].level = top;
+        stack [size].node = 0;
+        stack [size].dist2 = tree.distance2 (top, 0, p);
+        ++size;
+
+        while (size) {
+            entry e = stack [--size];
+            if (best <= e.dist2) {
+                continue;
+            }
+            if (e.level == 0) {
+                // scan the segments of the leaf
+                std::ptrdiff_t end = std::max (tree.last_point (0, e.node), tree.first_point (0, e.node) + 1);
+                for (std::ptrdiff_t i = tree.first_point (0, e.node); i < end; ++i) {
+                    T dist2 = static_cast <T> (math::segment_distance2 <DIM> (
+                        first + i * DIM, first + std::min (i + 1, last) * DIM, p));
+                    if (dist2 < best) {
+                        best = dist2;
+                        hint = i;
+                        if (best <= bound) {
+                            return best;
+                        }
+                    }
+                }
+                continue;
+            }
+            // push the farther child first, so that the nearer child is visited first
+            unsigned level = e.level - 1;
+            std::ptrdiff_t left = 2 * e.node;
+            T leftDist2 = tree.distance2 (level, left, p);
+            if (left + 1 < tree.nodes (level)) {
+                T rightDist2 = tree.distance2 (level, left + 1, p);
+                entry near = {level, left, leftDist2};
+                entry far = {level, left + 1, rightDist2};
+                if (rightDist2 < leftDist2) {
+                    std::swap (near, far);
+                }
+                if (far.dist2 < best) {
+                    stack [size++] = far;
+                }
+                if (near.dist2 < best) {
+                    stack [size++] = near;
+                }
+            }
+            else if (leftDist2 < best) {
+                entry near = {level, left, leftDist2};
+                stack [size++] = near;
+            }
+        }
+        return best;
+    }
+
+    /*!
+        \brief Collects the segments of a polyline that may lie within a distance of point p.
+
+        Collects all segments of each leaf whose box lies within that distance, so the result
+        contains every segment within the distance, and possibly some segments beyond it. The
+        search gives up as soon as more than limit segments are collected.
+
+        \param[in]  tree       the tree over the polyline
+        \param[in]  p          the query point
+        \param[in]  dist2      the squared distance
+        \param[out] segments   receives the index of the first point of each segment
+        \param[in]  limit      the largest number of segments to collect
+        \return                false when the search gave up
+    */
+    template
+    <
+        unsigned DIM,
+        typename T
+    >
+    bool segments_within (
+        const box_tree <DIM, T>& tree,
+        const T* p,
+        T dist2,
+        std::vector <std::ptrdiff_t>& segments,
+        std::size_t limit = std::numeric_limits <std::size_t>::max ())
+    {
+        if (!tree.levels ()) {
+            return true;
+        }
+        struct entry {
+            unsigned level;
+            std::ptrdiff_t node;
+        };
+        entry stack [2 * (std::numeric_limits <std::ptrdiff_t>::digits + 1)];
+        unsigned size = 0;
+        entry root = {tree.levels () - 1, 0};
+        stack [size++] = root;
+
+        while (size) {
+            entry e = stack [--size];
+            if (dist2 < tree.distance2 (e.level, e.node, p)) {
+                continue;
+            }
+            if (e.level == 0) {
+                std::ptrdiff_t end = std::max (tree.last_point (0, e.node), tree.first_point (0, e.node) + 1);
+                for (std::ptrdiff_t i = tree.first_point (0, e.node); i < end; ++i) {
+                    segments.push_back (i);
+                }
+                if (segments.size () > limit) {
+                    return false;
+                }
+                continue;
+            }
+            unsigned level = e.level - 1;
+            for (std::ptrdiff_t node = 2 * e.node + 1; node >= 2 * e.node; --node) {
+                if (node < tree.nodes (level)) {
+                    entry child = {level, node};
+                    stack [size++] = child;
+                }
+            }
+        }
+        return true;
+    }
+}}
+
+
+#endif // PSIMPL_DETAIL_SPATIAL
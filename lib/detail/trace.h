@@ -0,0 +1,255 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+
+#ifndef PSIMPL_DETAIL_TRACE
+#define PSIMPL_DETAIL_TRACE
+
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+
+namespace psimpl
+{
+    /*!
+        \brief Receives the begin and end of the stages of the simplification routines.
+
+        Tracing is off until a sink is installed with set_trace_sink. The stages are reported
+        by the thread that performs them, so begin and end can be called by several threads at
+        once. Stages nest: each end matches the most recent unmatched begin of the same thread.
+        The stage names are string literals that remain valid for the lifetime of the program.
+    */
+    class trace_sink
+    {
+    public:
+        virtual ~trace_sink () {}
+
+        //! \brief Called when the current thread starts the stage called name.
+        virtual void begin (const char* name) = 0;
+
+        //! \brief Called when the current thread completes the stage called name.
+        virtual void end (const char* name) = 0;
+    };
+
+    namespace util
+    {
+        //! \brief Returns the storage of the installed trace sink.
+        inline std::atomic <trace_sink*>& trace_sink_slot () {
+            static std::atomic <trace_sink*> sink (0);
+            return sink;
+        }
+
+        /*!
+            \brief Reports a stage to the installed trace sink for the lifetime of the scope.
+
+            A scope can also report a sequence of stages with next, or end its stage early.
+            Without a sink this costs a single atomic load, so scopes are only placed around
+            stages, never inside the per point loops.
+        */
+        class trace_scope
+        {
+        public:
+            explicit trace_scope (const char* name) :
+                mSink (trace_sink_slot ().load (std::memory_order_acquire)),
+                mName (name)
+            {
+                if (mSink) {
+                    mSink->begin (mName);
+                }
+            }
+
+            ~trace_scope () {
+                end ();
+            }
+
+            //! \brief Ends the current stage, and starts the next stage called name.
+            void next (const char* name) {
+                if (mSink) {
+                    mSink->end (mName);
+                    mSink->begin (name);
+                }
+                mName = name;
+            }
+
+            //! \brief Ends the current stage before the end of the scope.
+            void end () {
+                if (mSink) {
+                    mSink->end (mName);
+                    mSink = 0;
+                }
+            }
+
+        private:
+            trace_scope (const trace_scope&);
+            trace_scope& operator= (const trace_scope&);
+
+        private:
+            trace_sink* mSink;      //!< sink at the start of the stage, also receives the end
+            const char* mName;      //!< stage name
+        };
+    }
+
+    /*!
+        \brief Installs the trace sink that receives the stages of all routines, in all threads.
+
+        The sink must remain valid until all routines that were started while it was installed
+        have completed. A null sink turns tracing off.
+
+        \param[in] sink     the new sink, or 0
+        \return             the previously installed sink, or 0
+    */
+    inline trace_sink* set_trace_sink (
+        trace_sink* sink)
+    {
+        return util::trace_sink_slot ().exchange (sink, std::memory_order_acq_rel);
+    }
+
+    /*!
+        \brief Trace sink that records each stage with its thread and timestamps, and writes
+        them in the Chrome trace-event format.
+
+        The written JSON can be opened in chrome://tracing or the Perfetto UI, which show each
+        thread as a track of nested stages. Events are recorded under a lock, which is cheap
+        compared to the stages that are reported.
+    */
+    class trace_recorder : public trace_sink
+    {
+    public:
+        /*!
+            \brief A recorded begin or end of a stage.
+        */
+        struct event {
+            const char* name;       //!< stage name
+            char phase;             //!< 'B' for begin, 'E' for end
+            unsigned thread;        //!< thread index, in order of the first event of each thread
+            long long time;         //!< nanoseconds since the recorder was created or cleared
+        };
+
+        trace_recorder () :
+            mStart (clock::now ())
+        {}
+
+        virtual void begin (const char* name) {
+            record (name, 'B');
+        }
+
+        virtual void end (const char* name) {
+            record (name, 'E');
+        }
+
+        //! \brief Returns a copy of the recorded events, in recording order.
+        std::vector <event> events () const {
+            std::lock_guard <std::mutex> lock (mMutex);
+            return mEvents;
+        }
+
+        //! \brief Discards all events, and restarts the clock.
+        void clear () {
+            std::lock_guard <std::mutex> lock (mMutex);
+            mEvents.clear ();
+            mThreads.clear ();
+            mStart = clock::now ();
+        }
+
+        /*!
+            \brief Writes the recorded events as a Chrome trace-event JSON object.
+
+            Timestamps are written in microseconds, with nanosecond precision. Each thread is
+            named after its index.
+        */
+        void write (std::ostream& os) const {
+            std::lock_guard <std::mutex> lock (mMutex);
+            char buffer [32];
+            os << "{\"traceEvents\":[";
+            for (size_t t = 0; t < mThreads.size (); ++t) {
+                os << (t ? ",\n" : "\n")
+                   << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+                   << ",\"args\":{\"name\":\"thread " << t << "\"}}";
+            }
+            for (size_t e = 0; e < mEvents.size (); ++e) {
+                const event& ev = mEvents [e];
+                std::snprintf (buffer, sizeof (buffer), "%lld.%03lld", ev.time / 1000, ev.time % 1000);
+                os << ",\n{\"name\":\"";
+                for (const char* c = ev.name; *c; ++c) {
+                    if (*c == '"' || *c == '\\') {
+                        os << '\\';
+                    }
+                    os << *c;
+                }
+                os << "\",\"cat\":\"psimpl\",\"ph\":\"" << ev.phase << "\",\"ts\":" << buffer
+                   << ",\"pid\":1,\"tid\":" << ev.thread << "}";
+            }
+            os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        }
+
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        void record (const char* name, char phase) {
+            // read the clock before waiting for the lock
+            clock::time_point now = clock::now ();
+            std::thread::id id = std::this_thread::get_id ();
+
+            std::lock_guard <std::mutex> lock (mMutex);
+            unsigned thread = 0;
+            while (thread < mThreads.size () && mThreads [thread] != id) {
+                ++thread;
+            }
+            if (thread == mThreads.size ()) {
+                mThreads.push_back (id);
+            }
+            event ev = {
+                name,
+                phase,
+                thread,
+                static_cast <long long> (std::chrono::duration_cast <std::chrono::nanoseconds> (now - mStart).count ())
+            };
+            mEvents.push_back (ev);
+        }
+
+    private:
+        mutable std::mutex mMutex;              //!< guards all members
+        clock::time_point mStart;               //!< time zero of the events
+        std::vector <std::thread::id> mThreads; //!< thread of each thread index
+        std::vector <event> mEvents;            //!< all recorded events
+    };
+}
+
+#endif // PSIMPL_DETAIL_TRACE
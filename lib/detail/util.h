@@ -37,6 +37,8 @@
 
 
 #include <algorithm>
+#include <type_traits>
+#include <vector>
 
 
 namespace psimpl {
@@ -261,6 +263,80 @@ namespace psimpl {
 
     // ---------------------------------------------------------------------------------------------
 
+    /*!
+        \brief A d-ary max-heap.
+
+        Each node has D children, so the tree is log(D) times shallower than a binary heap, and
+        the children of a node share a few cache lines. The largest element according to
+        operator< is on top.
+    */
+    template <typename T, unsigned D=4>
+    class dary_heap
+    {
+    public:
+        bool empty () const {
+            return data.empty ();
+        }
+
+        size_t size () const {
+            return data.size ();
+        }
+
+        const T& top () const {
+            return data.front ();
+        }
+
+        void push (const T& value) {
+            // sift up
+            size_t child = data.size ();
+            data.push_back (value);
+            while (child) {
+                size_t parent = (child - 1) / D;
+                if (!(data [parent] < value)) {
+                    break;
+                }
+                data [child] = data [parent];
+                child = parent;
+            }
+            data [child] = value;
+        }
+
+        void pop () {
+            T value = data.back ();
+            data.pop_back ();
+            if (data.empty ()) {
+                return;
+            }
+            // sift down
+            size_t parent = 0;
+            size_t count = data.size ();
+            for (;;) {
+                size_t first = parent * D + 1;
+                if (count <= first) {
+                    break;
+                }
+                size_t last = std::min (first + D, count);
+                size_t largest = first;
+                for (size_t child = first + 1; child < last; ++child) {
+                    if (data [largest] < data [child]) {
+                        largest = child;
+                    }
+                }
+                if (!(value < data [largest])) {
+                    break;
+                }
+                data [parent] = data [largest];
+                parent = largest;
+            }
+            data [parent] = value;
+        }
+
+    private:
+        std::vector <T> data;
+    };
+
+    // ---------------------------------------------------------------------------------------------
+
     //! \brief Meta function: selects a calculation type based on an interator type.
     template <typename Iterator>
     struct select_calculation_type
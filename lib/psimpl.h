@@ -56,6 +56,10 @@
       by their left and right neighbors
     + Reumann-Witkam - Shifts a strip along the polyline and removes points that fall outside
     + Opheim - A constrained version of Reumann-Witkam
+    + Sleeve-fitting - Grows a 2d sleeve of directions from each key, keeping every point within
+      tolerance of the resulting segments in a single pass
+    + Optimal - Finds the fewest vertices for which all points are within tolerance of the
+      simplification (Imai-Iri, using the wedges of Chan-Chin)
     + Lang - Similar to the Perpendicular distance routine, but instead of looking only at direct
       neighbors, an entire search region is processed
     + Douglas-Peucker - A classic simplification algorithm that provides an excellent approximation
@@ -63,6 +67,10 @@
 
     Errors
     + positional error - Distance of each polyline point to its simplification
+    + Hausdorff distance - Largest distance from a point of either polyline to the other polyline
+    + discrete Frechet distance - Largest distance between coupled points, for the best monotone
+      coupling of the points of both polylines
+    + areal displacement - Area between a 2d polyline and its simplification
 
     All the algorithms have been implemented in a header-only library using an STL-style interface
     that operates on input and output iterators. Supported polylines can be of any dimension, and
@@ -97,8 +105,14 @@
 
 
 #include "detail/algo.h"
+#include "detail/batch.h"
+#include "detail/counters.h"
 #include "detail/error.h"
 #include "detail/math.h"
+#include "detail/parallel.h"
+#include "detail/progress.h"
+#include "detail/spatial.h"
+#include "detail/trace.h"
 #include "detail/util.h"
 
 
@@ -218,13 +232,126 @@ namespace psimpl
         Distance tol,
         OutputIterator result)
     {
+        typedef util::output_counters <OutputIterator> policy;
+
         return algo::radial_distance
             <
                 DIM,
                 ForwardIterator,
                 Distance,
-                OutputIterator
-            >::simplify (first, last, tol, result);
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, result, policy::get (result));
+    }
+
+    /*!
+        \brief Performs the radial distance routine (RD) for several tolerances at once.
+
+        Running simplify_radial_distance once per level of detail reads the input once per
+        tolerance. This routine reads the input only once: each tolerance keeps track of its own
+        current key, and each point is tested against all of them. Note that the keys of a larger
+        tolerance are not necessarily a subset of the keys of a smaller tolerance.
+
+        The tolerances are given by the range [tol_first, tol_last). The results range holds one
+        output iterator per tolerance: level i is copied to the output range starting at
+        *(results + i), like simplify_radial_distance would for tolerance *(tol_first + i). Each
+        output iterator in the results range is replaced by one beyond the last coordinate of
+        its level. The return value is one beyond the output iterator of the last level.
+
+        The result for each level is identical to that of simplify_radial_distance.
+
+        Input (Type) requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The ForwardIterator value type is convertible to a value type of the OutputIterators
+        3- The ResultIterator is a mutable ForwardIterator whose value type is an OutputIterator
+        4- The range [first, last) contains only vertex coordinates in multiples of DIM
+        5- The range [first, last) contains at least 2 vertices
+        6- The results range contains at least (tol_last - tol_first) output iterators
+
+        In case requirements 4 or 5 are not met, the entire input range [first, last) is copied
+        to each level. A level with tol <= 0 contains all the vertices.
+
+        \param[in] first        the first coordinate of the first polyline point
+        \param[in] last         one beyond the last coordinate of the last polyline point
+        \param[in] tol_first    the first radial (point-to-point) distance tolerance
+        \param[in] tol_last     one beyond the last radial distance tolerance
+        \param[in] results      the output iterator of each level
+        \param[in,out] stats    [optional] collects the work done, see with_counters
+        \return                 one beyond the output iterator of the last level
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator,
+        typename DistanceIterator,
+        typename ResultIterator,
+        typename Counters = util::no_counters
+    >
+    ResultIterator simplify_radial_distance_multi (
+        ForwardIterator first,
+        ForwardIterator last,
+        DistanceIterator tol_first,
+        DistanceIterator tol_last,
+        ResultIterator results,
+        Counters stats = Counters ())
+    {
+        return algo::radial_distance_multi
+            <
+                DIM,
+                ForwardIterator,
+                DistanceIterator,
+                ResultIterator,
+                algo::detail::key_output <DIM>,
+                Counters
+            >::simplify (first, last, tol_first, tol_last, results, stats);
+    }
+
+    /*!
+        \brief Performs the radial distance routine (RD) for several tolerances at once, writing
+        the indices of the kept points.
+
+        Identical to simplify_radial_distance_multi, but instead of the coordinates, the point
+        index of each key is written to the output range of its level. Such index lists can be
+        passed directly to compute_positional_errors2_indexed.
+
+        In case the range [first, last) contains an incomplete vertex or less than 3 vertices,
+        the indices of all complete vertices are written to each level.
+
+        \sa simplify_radial_distance_multi
+
+        \param[in] first        the first coordinate of the first polyline point
+        \param[in] last         one beyond the last coordinate of the last polyline point
+        \param[in] tol_first    the first radial (point-to-point) distance tolerance
+        \param[in] tol_last     one beyond the last radial distance tolerance
+        \param[in] results      the output iterator of each level
+        \param[in,out] stats    [optional] collects the work done, see with_counters
+        \return                 one beyond the output iterator of the last level
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator,
+        typename DistanceIterator,
+        typename ResultIterator,
+        typename Counters = util::no_counters
+    >
+    ResultIterator simplify_radial_distance_multi_indices (
+        ForwardIterator first,
+        ForwardIterator last,
+        DistanceIterator tol_first,
+        DistanceIterator tol_last,
+        ResultIterator results,
+        Counters stats = Counters ())
+    {
+        return algo::radial_distance_multi
+            <
+                DIM,
+                ForwardIterator,
+                DistanceIterator,
+                ResultIterator,
+                algo::detail::index_output <DIM>,
+                Counters
+            >::simplify (first, last, tol_first, tol_last, results, stats);
     }
 
     /*!
@@ -273,13 +400,16 @@ namespace psimpl
         Distance tol,
         OutputIterator result)
     {
+        typedef util::output_counters <OutputIterator> policy;
+
         return algo::perpendicular_distance
             <
                 DIM,
                 ForwardIterator,
                 Distance,
-                OutputIterator
-            >::simplify (first, last, tol, result);
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, result, policy::get (result));
     }
 
     /*!
@@ -311,14 +441,17 @@ namespace psimpl
         Size repeat,
         OutputIterator result)
     {
+        typedef util::output_counters <OutputIterator> policy;
+
         return algo::perpendicular_distance_repeat
             <
                 DIM,
                 ForwardIterator,
                 Distance,
                 Size,
-                OutputIterator
-            >::simplify (first, last, tol, repeat, result);
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, repeat, result, policy::get (result));
     }
 
     /*!
@@ -367,13 +500,16 @@ namespace psimpl
         Distance tol,
         OutputIterator result)
     {
+        typedef util::output_counters <OutputIterator> policy;
+
         return algo::reumann_witkam
             <
                 DIM,
                 ForwardIterator,
                 Distance,
-                OutputIterator
-            >::simplify (first, last, tol, result);
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, result, policy::get (result));
     }
 
     /*!
@@ -430,13 +566,16 @@ namespace psimpl
         Distance max_tol,
         OutputIterator result)
     {
+        typedef util::output_counters <OutputIterator> policy;
+
         return algo::opheim
             <
                 DIM,
                 ForwardIterator,
                 Distance,
-                OutputIterator
-            >::simplify (first, last, min_tol, max_tol, result);
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, min_tol, max_tol, result, policy::get (result));
     }
 
     /*!
@@ -495,14 +634,205 @@ namespace psimpl
         Size look_ahead,
         OutputIterator result)
     {
+        typedef util::output_counters <OutputIterator> policy;
+
         return algo::lang
             <
                 DIM,
                 BidirectionalIterator,
                 Distance,
                 Size,
-                OutputIterator
-            >::simplify (first, last, tol, look_ahead, result);
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, look_ahead, result, policy::get (result));
+    }
+
+    /*!
+        \brief Performs Zhao-Saalfeld sleeve-fitting approximation (SF).
+
+        The O(n) SF routine uses a point-to-line (perpendicular) distance tolerance, like the
+        Reumann-Witkam routine, but guarantees that every removed vertex lies within tolerance
+        of its simplified segment. Starting at a key vkey, it maintains the sleeve of directions
+        for which a line through vkey passes within tolerance of every vertex processed so far.
+        Each vertex vi at distance d from vkey narrows this sleeve to its intersection with
+        [angle(vi) - asin(tol/d), angle(vi) + asin(tol/d)]. A new key is found at vi-1 when the
+        direction of vi lies outside the sleeve, after which the sleeve is restarted at vi-1.
+        A new key is also found when vi lies too close to vkey for the segment to pass within
+        tolerance of an earlier vertex, which happens when the polyline doubles back.
+
+        The routine needs constant state and reads the input in a single pass. The same
+        algorithm is available as algo::sleeve_fitting_stream, which accepts the points one at a
+        time and writes each key as soon as it is known.
+
+        SF routine is applied to the range [first, last) using the specified perpendicular
+        distance tolerance tol. The resulting simplified polyline is copied to the output range
+        [result, result + m*DIM), where m is the number of vertices of the simplified polyline.
+        The return value is the end of the output range: result + m*DIM.
+
+        Input (Type) Requirements:
+        1- DIM is 2, where DIM represents the dimension of the polyline
+        2- The ForwardIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains vertex coordinates in multiples of DIM,
+           f.e.: x, y, x, y, x, y
+        4- The range [first, last) contains at least 2 vertices
+        5- tol > 0
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)) OR compile errors may occur.
+
+        \param[in] first    the first coordinate of the first polyline point
+        \param[in] last     one beyond the last coordinate of the last polyline point
+        \param[in] tol      perpendicular (point-to-line) distance tolerance
+        \param[in] result   destination of the simplified polyline
+        \return             one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator,
+        typename Distance,
+        typename OutputIterator
+    >
+    OutputIterator simplify_sleeve_fitting (
+        ForwardIterator first,
+        ForwardIterator last,
+        Distance tol,
+        OutputIterator result)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::sleeve_fitting
+            <
+                DIM,
+                ForwardIterator,
+                Distance,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, result, policy::get (result));
+    }
+
+    /*!
+        \brief Performs optimal min-# approximation (OPT) of a 2d polyline.
+
+        Unlike the greedy routines, OPT finds a simplification with the fewest possible vertices
+        for which every removed vertex lies within the perpendicular (point-to-segment) distance
+        tolerance of its simplified segment. Following Imai-Iri, each valid shortcut (vi, vj)
+        is an edge of a graph, and the simplification is the shortest path from the first to the
+        last vertex. The shortcuts are found in O(n^2) time instead of O(n^3) using the angular
+        wedges of Chan-Chin: a forward wedge from each vi contains the directions of all rays
+        that pass within tolerance of every vertex seen so far, and a shortcut is valid when vj
+        lies in the forward wedge of vi and vi lies in the backward wedge of vj. Scanning stops
+        as soon as a wedge becomes empty, so noisy polylines are processed much faster than
+        this worst case.
+
+        Memory use is O(n^2) bits in the worst case (nearly straight polylines); use
+        simplify_optimal_windowed to bound it for long polylines.
+
+        OPT routine is applied to the range [first, last) using the specified perpendicular
+        distance tolerance tol. The resulting simplified polyline is copied to the output range
+        [result, result + m*DIM), where m is the number of vertices of the simplified polyline.
+        The return value is the end of the output range: result + m*DIM.
+
+        Input (Type) Requirements:
+        1- DIM is 2, where DIM represents the dimension of the polyline
+        2- The ForwardIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains vertex coordinates in multiples of DIM,
+           f.e.: x, y, x, y, x, y
+        4- The range [first, last) contains at least 2 vertices
+        5- tol > 0
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)) OR compile errors may occur.
+
+        \param[in] first    the first coordinate of the first polyline point
+        \param[in] last     one beyond the last coordinate of the last polyline point
+        \param[in] tol      perpendicular (point-to-segment) distance tolerance
+        \param[in] result   destination of the simplified polyline
+        \return             one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator,
+        typename Distance,
+        typename OutputIterator
+    >
+    OutputIterator simplify_optimal (
+        ForwardIterator first,
+        ForwardIterator last,
+        Distance tol,
+        OutputIterator result)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::optimal
+            <
+                DIM,
+                ForwardIterator,
+                Distance,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, 0, result, policy::get (result));
+    }
+
+    /*!
+        \brief Performs optimal min-# approximation (OPT) on successive windows of a 2d polyline.
+
+        Solves the OPT problem (see simplify_optimal) for the first window of vertices. The
+        keys of that solution within the first half of the window are final; the window then
+        restarts at the last of those keys. This bounds memory use to O(window^2) bits and time
+        to O(n * window). The price is that no segment spans more than window vertices, and
+        that the result may contain a few more vertices than the global optimum. When window
+        is at least the number of vertices the result is identical to that of simplify_optimal.
+
+        Input (Type) Requirements:
+        1- DIM is 2, where DIM represents the dimension of the polyline
+        2- The ForwardIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains vertex coordinates in multiples of DIM,
+           f.e.: x, y, x, y, x, y
+        4- The range [first, last) contains at least 2 vertices
+        5- tol > 0
+        6- window > 2
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)) OR compile errors may occur.
+
+        \param[in] first    the first coordinate of the first polyline point
+        \param[in] last     one beyond the last coordinate of the last polyline point
+        \param[in] tol      perpendicular (point-to-segment) distance tolerance
+        \param[in] window   maximum number of vertices per sub problem
+        \param[in] result   destination of the simplified polyline
+        \return             one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator,
+        typename Distance,
+        typename Size,
+        typename OutputIterator
+    >
+    OutputIterator simplify_optimal_windowed (
+        ForwardIterator first,
+        ForwardIterator last,
+        Distance tol,
+        Size window,
+        OutputIterator result)
+    {
+        typedef typename std::iterator_traits <ForwardIterator>::difference_type diff_type;
+        typedef util::output_counters <OutputIterator> policy;
+
+        if (window < 3) {
+            return std::copy (first, last, result);
+        }
+        return algo::optimal
+            <
+                DIM,
+                ForwardIterator,
+                Distance,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, static_cast <diff_type> (window), result, policy::get (result));
     }
 
     /*!
@@ -553,13 +883,111 @@ namespace psimpl
         Distance tol,
         OutputIterator result)
     {
+        typedef util::output_counters <OutputIterator> policy;
+
         return algo::douglas_peucker_classic
             <
                 DIM,
                 RandomAccessIterator,
                 Distance,
-                OutputIterator
-            >::simplify (first, last, tol, result);
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, result, policy::get (result));
+    }
+
+    /*!
+        \brief Performs Douglas-Peucker approximation (DPc), using a hierarchy of bounding boxes
+        to skip blocks of points.
+
+        The result is identical to that of simplify_douglas_peucker_classic. The polyline is
+        first covered by a spatial::box_tree: a hierarchy of boxes over consecutive points.
+        Since the distance to a segment is convex, no point inside a box is farther from a
+        segment than the farthest corner of that box. Each key search skips the boxes whose
+        corners all lie within tolerance, or that cannot beat the key found so far, so a sub
+        polyline that lies within tolerance as a whole is rejected after testing a few boxes.
+        Smooth polylines at coarse tolerances skip most of the distance computations.
+
+        Input (Type) requirements: see simplify_douglas_peucker_classic
+
+        \param[in] first    the first coordinate of the first polyline point
+        \param[in] last     one beyond the last coordinate of the last polyline point
+        \param[in] tol      perpendicular (point-to-segment) distance tolerance
+        \param[in] result   destination of the simplified polyline
+        \return             one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename OutputIterator
+    >
+    OutputIterator simplify_douglas_peucker_pruned (
+        RandomAccessIterator first,
+        RandomAccessIterator last,
+        Distance tol,
+        OutputIterator result)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::douglas_peucker_pruned
+            <
+                DIM,
+                RandomAccessIterator,
+                Distance,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, result, policy::get (result));
+    }
+
+    /*!
+        \brief Performs Douglas-Peucker approximation (DPc), using a precomputed hierarchy of
+        bounding boxes to skip blocks of points.
+
+        Identical to the overload above, but uses a tree that was built over the range [first,
+        last) before, f.e. to simplify the same polyline with several tolerances:
+
+        <pre>
+        psimpl::spatial::box_tree <2, double> tree (first, (last - first) / 2);
+        psimpl::simplify_douglas_peucker_pruned <2> (first, last, 1.0, tree, result1);
+        psimpl::simplify_douglas_peucker_pruned <2> (first, last, 5.0, tree, result2);
+        </pre>
+
+        In case the tree was not built over the same number of points, the entire input range
+        [first, last) is copied to the output range.
+
+        \param[in] first    the first coordinate of the first polyline point
+        \param[in] last     one beyond the last coordinate of the last polyline point
+        \param[in] tol      perpendicular (point-to-segment) distance tolerance
+        \param[in] tree     the box tree over the polyline
+        \param[in] result   destination of the simplified polyline
+        \return             one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename T,
+        typename OutputIterator
+    >
+    OutputIterator simplify_douglas_peucker_pruned (
+        RandomAccessIterator first,
+        RandomAccessIterator last,
+        Distance tol,
+        const spatial::box_tree <DIM, T>& tree,
+        OutputIterator result)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::douglas_peucker_pruned
+            <
+                DIM,
+                RandomAccessIterator,
+                Distance,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, tree, result, policy::get (result));
     }
 
     /*!
@@ -607,13 +1035,16 @@ namespace psimpl
         Distance tol,
         OutputIterator result)
     {
+        typedef util::output_counters <OutputIterator> policy;
+
         return algo::douglas_peucker
             <
                 DIM,
                 ForwardIterator,
                 Distance,
-                OutputIterator
-            >::simplify (first, last, tol, result);
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, result, policy::get (result));
     }
 
     /*!
@@ -632,6 +1063,15 @@ namespace psimpl
         of count vertices and is copied to the output range [result, result + count). The
         return value is the end of the output range: result + count.
 
+        DPn refines the simplification one key at a time, so it can also be stopped at any
+        moment. For progressive detail, f.e. within the frame budget of a viewer, use
+        algo::douglas_peucker_n_refiner instead: it keeps its priority queue between calls to
+        refine or refine_until, and its current keys can be read at any time:
+
+            algo::douglas_peucker_n_refiner <2, const double*> refiner (first, last);
+            refiner.refine_until (std::chrono::steady_clock::now () + std::chrono::milliseconds (5));
+            refiner.copy_keys (result);
+
         Input (Type) requirements:
         1- DIM is not 0, where DIM represents the dimension of the polyline
         2- The RandomAccessIterator value type is convertible to a value type of the OutputIterator
@@ -662,59 +1102,1477 @@ namespace psimpl
         Size count,
         OutputIterator result)
     {
+        typedef util::output_counters <OutputIterator> policy;
+
         return algo::douglas_peucker_n
             <
                 DIM,
                 RandomAccessIterator,
                 Size,
-                OutputIterator
-            >::simplify (first, last, count, result);
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, count, result, policy::get (result));
     }
 
     /*!
-        \brief Computes the squared positional error between a polyline and its simplification.
-
-        For each point in the range [original_first, original_last) the squared distance to the
-        simplification [simplified_first, simplified_last) is calculated. Each positional error
-        is copied to the output range [result, result + count), where count is the number of
-        points in the original polyline. The return value is the end of the output range:
-        result + count.
-
-        \image html psimpl_pos_error.png
+        \brief Performs Douglas-Peucker approximation (DPc) with the smallest tolerance that
+        keeps at most count vertices.
+
+        Instead of bisecting over simplify_douglas_peucker_classic, the DPc recursion is run
+        once without a tolerance. This gives the importance of each vertex: the smallest
+        distance of itself and of all the keys found before it along its path in the
+        recursion. DPc keeps exactly the vertices whose importance exceeds the tolerance, so
+        the tolerance follows from a selection of the importances. The cost is that of DPc with
+        a tolerance close to 0: O(n2) in worst case and O(n log n) on average.
+
+        The resulting simplified polyline is identical to that of
+        simplify_douglas_peucker_classic using the tolerance that is stored in tol, and it is
+        copied to the output range [result, result + m*DIM), where m <= count. Vertices with an
+        equal importance are kept or removed together, so m may be less than count. The return
+        value is the end of the output range: result + m*DIM.
 
         Input (Type) requirements:
         1- DIM is not 0, where DIM represents the dimension of the polyline
-        2- The value type of ForwardIterator1 is convertible to the value type of ForwardIterator2
-        3- The value type of ForwardIterator2, possibly promoted to a floating point type, is convertible
-           to the value type of OutputIterator
-        4- The ranges [original_first, original_last) and [simplified_first, simplified_last)
-           contain vertex coordinates in multiples of DIM, f.e.: x, y, z, x, y, z, x, y, z
-           when DIM = 3
-        5- The ranges [original_first, original_last) and [simplified_first, simplified_last)
-           each contain a minimum of 2 vertices
-        6- The range [simplified_first, simplified_last) represents a simplification of the
-           range [original_first, original_last), meaning each point in the simplification
-           has the exact same coordinates as some point from the original polyline
+        2- The RandomAccessIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains vertex coordinates in multiples of DIM
+        4- The range [first, last) contains more than count vertices
+        5- count >= 2
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)), and 0 is stored in tol.
+
+        \param[in] first    the first coordinate of the first polyline point
+        \param[in] last     one beyond the last coordinate of the last polyline point
+        \param[in] count    the maximum number of points of the simplified polyline
+        \param[in] result   destination of the simplified polyline
+        \param[out] tol     optional destination of the found tolerance
+        \return             one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Size,
+        typename OutputIterator
+    >
+    OutputIterator simplify_douglas_peucker_to_count (
+        RandomAccessIterator first,
+        RandomAccessIterator last,
+        Size count,
+        OutputIterator result,
+        double* tol = 0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::douglas_peucker_solver
+            <
+                DIM,
+                RandomAccessIterator,
+                OutputIterator,
+                typename policy::type
+            >::simplify_to_count (first, last, count, result, tol, policy::get (result));
+    }
+
+    /*!
+        \brief Performs Douglas-Peucker approximation (DPc) with the largest tolerance for which
+        the mean positional error does not exceed error.
+
+        Like simplify_douglas_peucker_to_count, the DPc recursion is run once without a
+        tolerance. While searching the key of a sub polyline, the positional errors of its
+        internal points are summed, so that the change of the total positional error is known
+        for each key. The keys are then added by decreasing importance, which is the order in
+        which DPc adds them for a decreasing tolerance, until the mean positional error drops
+        below error. The error is thus tracked incrementally, instead of being recomputed for
+        every candidate tolerance.
+
+        The resulting simplified polyline is identical to that of
+        simplify_douglas_peucker_classic using the tolerance that is stored in tol. Its mean
+        positional error, as computed by compute_positional_error_statistics_indexed, does not
+        exceed error up to rounding. The mean positional error need not decrease monotonically
+        with the tolerance; the first tolerance, from large to small, that meets the target is
+        used.
+
+        Input (Type) requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The RandomAccessIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains vertex coordinates in multiples of DIM
+        4- The range [first, last) contains at least 3 vertices
+        5- error >= 0
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)), and 0 is stored in tol.
+
+        \param[in] first    the first coordinate of the first polyline point
+        \param[in] last     one beyond the last coordinate of the last polyline point
+        \param[in] error    the maximum mean positional error
+        \param[in] result   destination of the simplified polyline
+        \param[out] tol     optional destination of the found tolerance
+        \return             one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename OutputIterator
+    >
+    OutputIterator simplify_douglas_peucker_to_error (
+        RandomAccessIterator first,
+        RandomAccessIterator last,
+        double error,
+        OutputIterator result,
+        double* tol = 0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::douglas_peucker_solver
+            <
+                DIM,
+                RandomAccessIterator,
+                OutputIterator,
+                typename policy::type
+            >::simplify_to_error (first, last, error, result, tol, policy::get (result));
+    }
+
+    /*!
+        \brief Performs Douglas-Peucker approximation, with RD as a preprocessing step (DP), on a
+        batch of polylines.
+
+        The batch equivalent of simplify_douglas_peucker. Calling simplify_douglas_peucker for
+        each polyline allocates an RD buffer, the key flags and the job stack in every call. This
+        routine reuses them for all polylines of the batch, which matters for short polylines:
+        for 3 to 20 points per polyline it is about 15-20% faster than the loop.
+
+        The batch is defined by the coordinate range starting at first and the range of coord
+        offsets [offsets_first, offsets_last). Polyline i consists of the coordinates
+        [first + offsets [i], first + offsets [i+1]). Each simplified polyline is copied to the
+        output range starting at result, in order. The coord offsets of the simplified polylines,
+        starting with 0, are copied to result_offsets. The return value is the end of the
+        output range.
+
+        The result for each polyline is identical to that of simplify_douglas_peucker.
+
+        Input (Type) requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The RandomAccessIterator value type is convertible to a value type of the OutputIterator
+        3- The OffsetIterator value type is convertible to the difference type of the
+           RandomAccessIterator, and the offsets are non-decreasing
+        4- tol > 0
+
+        Each polyline that does not contain at least 3 complete vertices is copied as a whole.
+
+        \param[in] first            the first coordinate of the batch
+        \param[in] offsets_first    the first coord offset
+        \param[in] offsets_last     one beyond the last coord offset
+        \param[in] tol              perpendicular (point-to-segment) distance tolerance
+        \param[in] result           destination of the simplified polylines
+        \param[in] result_offsets   destination of the coord offsets of the simplified polylines
+        \return                     one beyond the last coordinate of the simplified polylines
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename OffsetIterator,
+        typename Distance,
+        typename OutputIterator,
+        typename OffsetOutputIterator
+    >
+    OutputIterator simplify_douglas_peucker_batch (
+        RandomAccessIterator first,
+        OffsetIterator offsets_first,
+        OffsetIterator offsets_last,
+        Distance tol,
+        OutputIterator result,
+        OffsetOutputIterator result_offsets)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::douglas_peucker_batch
+            <
+                DIM,
+                RandomAccessIterator,
+                OffsetIterator,
+                Distance,
+                OutputIterator,
+                OffsetOutputIterator,
+                typename policy::type
+            >::simplify (first, offsets_first, offsets_last, tol, result, result_offsets, policy::get (result));
+    }
+
+    /*!
+        \brief Performs the nth point simplification routine (NP) using multiple threads.
+
+        The parallel equivalent of simplify_nth_point. The polyline is split into one chunk per
+        thread. Each chunk is simplified concurrently, starting from a guessed key, after which the
+        seams between chunks are repaired; see simplify_radial_distance_parallel for details.
+        The result is identical to that of simplify_nth_point.
+
+        Input (Type) requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The RandomAccessIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains only vertex coordinates in multiples of DIM, f.e.:
+           x, y, z, x, y, z, x, y, z when DIM = 3
+        4- The range [first, last) contains at least 2 vertices
+        5- n > 0
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)) OR compile errors may occur.
+
+        \param[in] first        the first coordinate of the first polyline point
+        \param[in] last         one beyond the last coordinate of the last polyline point
+        \param[in] n            specifies 'each nth point'
+        \param[in] result       destination of the simplified polyline
+        \param[in] thread_count the maximum number of threads to use, 0 means one per hardware thread
+        \return                 one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Size,
+        typename OutputIterator
+    >
+    OutputIterator simplify_nth_point_parallel (
+        RandomAccessIterator first,
+        RandomAccessIterator last,
+        Size n,
+        OutputIterator result,
+        unsigned thread_count = 0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::nth_point_parallel
+            <
+                DIM,
+                RandomAccessIterator,
+                Size,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, n, result, thread_count, policy::get (result));
+    }
+
+    /*!
+        \brief Performs the radial distance simplification routine (RD) using multiple threads.
+
+        The parallel equivalent of simplify_radial_distance. RD is a sequential scan: each key
+        depends on the previous one. However, the next key only depends on the current key, and
+        not on how that key was found. The polyline is therefore split into one chunk per thread,
+        and each chunk is simplified concurrently, starting from its first point as a guessed key.
+        Afterwards the chunks are visited in order. When the real key that enters a chunk differs
+        from the guessed one, the chunk is re-run from the real key until it finds a key that the
+        speculative run also found; the remaining speculative keys are then known to be correct.
+        The result is identical to that of simplify_radial_distance.
+
+        Polylines that are too small to benefit from multiple threads are simplified serially.
+
+        Input (Type) requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The RandomAccessIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains only vertex coordinates in multiples of DIM, f.e.:
+           x, y, z, x, y, z, x, y, z when DIM = 3
+        4- The range [first, last) contains at least 2 vertices
+        5- tol > 0
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)) OR compile errors may occur.
+
+        \param[in] first        the first coordinate of the first polyline point
+        \param[in] last         one beyond the last coordinate of the last polyline point
+        \param[in] tol          radial (point-to-point) distance tolerance
+        \param[in] result       destination of the simplified polyline
+        \param[in] thread_count the maximum number of threads to use, 0 means one per hardware thread
+        \return                 one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename OutputIterator
+    >
+    OutputIterator simplify_radial_distance_parallel (
+        RandomAccessIterator first,
+        RandomAccessIterator last,
+        Distance tol,
+        OutputIterator result,
+        unsigned thread_count = 0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::radial_distance_parallel
+            <
+                DIM,
+                RandomAccessIterator,
+                Distance,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, result, thread_count, policy::get (result));
+    }
+
+    /*!
+        \brief Performs Reumann-Witkam approximation (RW) using multiple threads.
+
+        The parallel equivalent of simplify_reumann_witkam; see simplify_radial_distance_parallel
+        for details. The result is identical to that of simplify_reumann_witkam.
+
+        Input (Type) Requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The RandomAccessIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains vertex coordinates in multiples of DIM,
+           f.e.: x, y, z, x, y, z, x, y, z when DIM = 3
+        4- The range [first, last) contains at least 2 vertices
+        5- tol > 0
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)) OR compile errors may occur.
+
+        \param[in] first        the first coordinate of the first polyline point
+        \param[in] last         one beyond the last coordinate of the last polyline point
+        \param[in] tol          perpendicular (point-to-line) distance tolerance
+        \param[in] result       destination of the simplified polyline
+        \param[in] thread_count the maximum number of threads to use, 0 means one per hardware thread
+        \return                 one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename OutputIterator
+    >
+    OutputIterator simplify_reumann_witkam_parallel (
+        RandomAccessIterator first,
+        RandomAccessIterator last,
+        Distance tol,
+        OutputIterator result,
+        unsigned thread_count = 0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::reumann_witkam_parallel
+            <
+                DIM,
+                RandomAccessIterator,
+                Distance,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, result, thread_count, policy::get (result));
+    }
+
+    /*!
+        \brief Performs Opheim approximation (OP) using multiple threads.
+
+        The parallel equivalent of simplify_opheim; see simplify_radial_distance_parallel for
+        details. The result is identical to that of simplify_opheim.
+
+        Input (Type) Requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The RandomAccessIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains vertex coordinates in multiples of DIM,
+           f.e.: x, y, z, x, y, z, x, y, z when DIM = 3
+        4- The range [first, last) contains at least 2 vertices
+        5- min_tol > 0
+        6- max_tol > 0
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)) OR compile errors may occur.
+
+        \param[in] first        the first coordinate of the first polyline point
+        \param[in] last         one beyond the last coordinate of the last polyline point
+        \param[in] min_tol      radial and perpendicular (point-to-ray) distance tolerance
+        \param[in] max_tol      radial distance tolerance
+        \param[in] result       destination of the simplified polyline
+        \param[in] thread_count the maximum number of threads to use, 0 means one per hardware thread
+        \return                 one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename OutputIterator
+    >
+    OutputIterator simplify_opheim_parallel (
+        RandomAccessIterator first,
+        RandomAccessIterator last,
+        Distance min_tol,
+        Distance max_tol,
+        OutputIterator result,
+        unsigned thread_count = 0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::opheim_parallel
+            <
+                DIM,
+                RandomAccessIterator,
+                Distance,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, min_tol, max_tol, result, thread_count, policy::get (result));
+    }
+
+    /*!
+        \brief Performs Lang approximation (LA) using multiple threads.
+
+        The parallel equivalent of simplify_lang; see simplify_radial_distance_parallel for
+        details. The result is identical to that of simplify_lang.
+
+        Input (Type) Requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The RandomAccessIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains vertex coordinates in multiples of DIM,
+           f.e.: x, y, z, x, y, z, x, y, z when DIM = 3
+        4- The range [first, last) contains at least 2 vertices
+        5- tol > 0
+        6- look_ahead > 0
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)) OR compile errors may occur.
+
+        \param[in] first        the first coordinate of the first polyline point
+        \param[in] last         one beyond the last coordinate of the last polyline point
+        \param[in] tol          perpendicular (point-to-segment) distance tolerance
+        \param[in] look_ahead   defines the size of the search region
+        \param[in] result       destination of the simplified polyline
+        \param[in] thread_count the maximum number of threads to use, 0 means one per hardware thread
+        \return                 one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Distance,
+        typename Size,
+        typename OutputIterator
+    >
+    OutputIterator simplify_lang_parallel (
+        RandomAccessIterator first,
+        RandomAccessIterator last,
+        Distance tol,
+        Size look_ahead,
+        OutputIterator result,
+        unsigned thread_count = 0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::lang_parallel
+            <
+                DIM,
+                RandomAccessIterator,
+                Distance,
+                Size,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, tol, look_ahead, result, thread_count, policy::get (result));
+    }
+
+    /*!
+        \brief Performs Douglas-Peucker approximation with a point count tolerance (DPn) using
+        multiple threads.
+
+        The parallel equivalent of simplify_douglas_peucker_n. The serial routine takes one sub
+        polyline at a time from its job queue, and scans both of its halves for their keys. The
+        parallel routine instead takes the top candidates from the queue at once, and scans the
+        halves of all these candidates concurrently. Then it accepts the candidates in the order
+        the serial routine would: a candidate is accepted when its key beats the keys of all
+        halves found so far, otherwise it is returned to the queue together with the keys of
+        its halves. Halves that are large enough are scanned by all threads together.
+        The result is identical to that of simplify_douglas_peucker_n.
+
+        Input (Type) requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The RandomAccessIterator value type is convertible to a value type of the OutputIterator
+        3- The range [first, last) contains vertex coordinates in multiples of DIM, f.e.:
+           x, y, z, x, y, z, x, y, z when DIM = 3
+        4- The range [first, last) contains a minimum of count vertices
+        5- count > 2
+
+        In case these requirements are not met, the entire input range [first, last) is copied
+        to the output range [result, result + (last - first)) OR compile errors may occur.
+
+        \param[in] first        the first coordinate of the first polyline point
+        \param[in] last         one beyond the last coordinate of the last polyline point
+        \param[in] count        the maximum number of points of the simplified polyline
+        \param[in] result       destination of the simplified polyline
+        \param[in] thread_count the maximum number of threads to use, 0 means one per hardware thread
+        \return                 one beyond the last coordinate of the simplified polyline
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename Size,
+        typename OutputIterator
+    >
+    OutputIterator simplify_douglas_peucker_n_parallel (
+        RandomAccessIterator first,
+        RandomAccessIterator last,
+        Size count,
+        OutputIterator result,
+        unsigned thread_count = 0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return algo::douglas_peucker_n_parallel
+            <
+                DIM,
+                RandomAccessIterator,
+                Size,
+                OutputIterator,
+                typename policy::type
+            >::simplify (first, last, count, result, thread_count, policy::get (result));
+    }
+
+    /*!
+        \brief Computes the squared positional error between a polyline and its simplification.
+
+        For each point in the range [original_first, original_last) the squared distance to the
+        simplification [simplified_first, simplified_last) is calculated. Each positional error
+        is copied to the output range [result, result + count), where count is the number of
+        points in the original polyline. The return value is the end of the output range:
+        result + count.
+
+        \image html psimpl_pos_error.png
+
+        Input (Type) requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The value type of ForwardIterator1 is convertible to the value type of ForwardIterator2
+        3- The value type of ForwardIterator2, possibly promoted to a floating point type, is convertible
+           to the value type of OutputIterator
+        4- The ranges [original_first, original_last) and [simplified_first, simplified_last)
+           contain vertex coordinates in multiples of DIM, f.e.: x, y, z, x, y, z, x, y, z
+           when DIM = 3
+        5- The ranges [original_first, original_last) and [simplified_first, simplified_last)
+           each contain a minimum of 2 vertices
+        6- The range [simplified_first, simplified_last) represents a simplification of the
+           range [original_first, original_last), meaning each point in the simplification
+           has the exact same coordinates as some point from the original polyline
+
+        In case these requirements are not met, the valid flag is set to false OR
+        compile errors may occur.
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] simplified_first the first coordinate of the first simplified polyline point
+        \param[in] simplified_last  one beyond the last coordinate of the last simplified polyline point
+        \param[in] result           destination of the squared positional errors
+        \param[out] valid           [optional] indicates if the computed positional errors are valid
+        \return                     one beyond the last computed positional error
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator1,
+        typename ForwardIterator2,
+        typename OutputIterator
+    >
+    OutputIterator compute_positional_errors2 (
+        ForwardIterator1 original_first,
+        ForwardIterator1 original_last,
+        ForwardIterator2 simplified_first,
+        ForwardIterator2 simplified_last,
+        OutputIterator result,
+        bool* valid=0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return error::positional
+            <
+                DIM,
+                ForwardIterator1,
+                ForwardIterator2,
+                OutputIterator,
+                typename policy::type
+            >::compute (original_first, original_last,
+                        simplified_first, simplified_last,
+                        result, valid, policy::get (result));
+    }
+
+    /*!
+        \brief Computes statistics for the positional errors between a polyline and its simplification.
+
+        Various statistics (mean, max, sum, std) are calculated for the positional errors
+        between the range [original_first, original_last) and its simplification the range
+        [simplified_first, simplified_last). The errors are accumulated in a single pass without
+        temporary storage; error::accumulator can be used to combine the statistics of several
+        polylines.
+
+        Input (Type) requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The value type of ForwardIterator1 is convertible to the value type of ForwardIterator2
+        3- The value type of ForwardIterator2, possibly promoted to a floating point type, is convertible
+           to double
+        3- The ranges [original_first, original_last) and [simplified_first, simplified_last)
+           contain vertex coordinates in multiples of DIM, f.e.: x, y, z, x, y, z, x, y, z
+           when DIM = 3
+        4- The ranges [original_first, original_last) and [simplified_first, simplified_last)
+           contain a minimum of 2 vertices
+        5- The range [simplified_first, simplified_last) represents a simplification of the
+           range [original_first, original_last), meaning each point in the simplification
+           has the exact same coordinates as some point from the original polyline
 
         In case these requirements are not met, the valid flag is set to false OR
         compile errors may occur.
 
+        \sa ComputePositionalErrors2
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] simplified_first the first coordinate of the first simplified polyline point
+        \param[in] simplified_last  one beyond the last coordinate of the last simplified polyline point
+        \param[out] valid           [optional] indicates if the computed statistics are valid
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the computed statistics
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator1,
+        typename ForwardIterator2,
+        typename Counters = util::no_counters
+    >
+    error::statistics compute_positional_error_statistics (
+        ForwardIterator1 original_first,
+        ForwardIterator1 original_last,
+        ForwardIterator2 simplified_first,
+        ForwardIterator2 simplified_last,
+        bool* valid=0,
+        Counters stats = Counters ())
+    {
+        return error::positional_statistics
+            <
+                DIM,
+                ForwardIterator1,
+                ForwardIterator2,
+                Counters
+            >::compute (original_first, original_last,
+                        simplified_first, simplified_last,
+                        valid, 0, stats);
+    }
+
+    /*!
+        \brief Computes statistics and percentiles for the positional errors between a polyline
+        and its simplification.
+
+        Identical to compute_positional_error_statistics, but also adds each positional error to
+        the specified quantile sketch. The sketch is not cleared first, so the errors of several
+        polylines can be collected in one sketch; sketches filled by different threads can be
+        combined with quantile_sketch::merge. Afterwards sketch.result () returns the p50, p90,
+        p99 and p99.9 positional errors, within the relative accuracy of the sketch and in
+        bounded memory.
+
+        \sa compute_positional_error_statistics
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] simplified_first the first coordinate of the first simplified polyline point
+        \param[in] simplified_last  one beyond the last coordinate of the last simplified polyline point
+        \param[in,out] sketch       collects the positional errors
+        \param[out] valid           [optional] indicates if the computed statistics are valid
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the computed statistics
+    */
+    template
+    <
+        unsigned DIM,
+        typename ForwardIterator1,
+        typename ForwardIterator2,
+        typename Counters = util::no_counters
+    >
+    error::statistics compute_positional_error_statistics (
+        ForwardIterator1 original_first,
+        ForwardIterator1 original_last,
+        ForwardIterator2 simplified_first,
+        ForwardIterator2 simplified_last,
+        error::quantile_sketch& sketch,
+        bool* valid=0,
+        Counters stats = Counters ())
+    {
+        return error::positional_statistics
+            <
+                DIM,
+                ForwardIterator1,
+                ForwardIterator2,
+                Counters
+            >::compute (original_first, original_last,
+                        simplified_first, simplified_last,
+                        valid, &sketch, stats);
+    }
+
+    /*!
+        \brief Computes the squared positional error between a polyline and its simplification,
+        where the simplification is given by the indices of the kept points.
+
+        Unlike compute_positional_errors2, the points of the simplification are not matched by
+        comparing coordinates, so the simplification may contain duplicate points. Each
+        simplified segment covers a known range of original points, for which the squared
+        distances are computed in a tight loop. The output is the same: one squared positional
+        error per original point, where kept points have an error of zero.
+
+        Input (Type) requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The range [original_first, original_last) contains vertex coordinates in multiples
+           of DIM, and at least 2 vertices
+        3- The range [keys_first, keys_last) contains strictly increasing point indices,
+           starting with 0 and ending with the index of the last original point
+        4- The value type of RandomAccessIterator, possibly promoted to a floating point type,
+           is convertible to the value type of OutputIterator
+
+        In case these requirements are not met, the valid flag is set to false OR compile errors
+        may occur. Nothing is written to result in that case.
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] keys_first       the index of the first kept point
+        \param[in] keys_last        one beyond the index of the last kept point
+        \param[in] result           destination of the squared positional errors
+        \param[out] valid           [optional] indicates if the computed positional errors are valid
+        \return                     one beyond the last computed positional error
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename OutputIterator
+    >
+    OutputIterator compute_positional_errors2_indexed (
+        RandomAccessIterator original_first,
+        RandomAccessIterator original_last,
+        ForwardIterator keys_first,
+        ForwardIterator keys_last,
+        OutputIterator result,
+        bool* valid=0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return error::positional_indexed
+            <
+                DIM,
+                RandomAccessIterator,
+                ForwardIterator,
+                OutputIterator,
+                typename policy::type
+            >::compute (original_first, original_last,
+                        keys_first, keys_last,
+                        result, valid, policy::get (result));
+    }
+
+    /*!
+        \brief Computes the squared positional error between a polyline and its simplification,
+        where the simplification is given by a mask of kept points.
+
+        Identical to compute_positional_errors2_indexed, but the kept points are defined by
+        the range [mask, mask + n), containing a flag for each of the n original points. The
+        first and last flags must be set.
+
+        \sa compute_positional_errors2_indexed
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] mask             flag of the first point, non-zero if it is kept
+        \param[in] result           destination of the squared positional errors
+        \param[out] valid           [optional] indicates if the computed positional errors are valid
+        \return                     one beyond the last computed positional error
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename InputIterator,
+        typename OutputIterator
+    >
+    OutputIterator compute_positional_errors2_masked (
+        RandomAccessIterator original_first,
+        RandomAccessIterator original_last,
+        InputIterator mask,
+        OutputIterator result,
+        bool* valid=0)
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+        typedef util::output_counters <OutputIterator> policy;
+
+        std::vector <diff_type> keys = error::detail::mask_to_indices (
+            mask, static_cast <diff_type> (DIM ? std::distance (original_first, original_last) / DIM : 0));
+
+        return error::positional_indexed
+            <
+                DIM,
+                RandomAccessIterator,
+                typename std::vector <diff_type>::const_iterator,
+                OutputIterator,
+                typename policy::type
+            >::compute (original_first, original_last,
+                        keys.begin (), keys.end (),
+                        result, valid, policy::get (result));
+    }
+
+    /*!
+        \brief Computes statistics for the positional errors between a polyline and its
+        simplification, where the simplification is given by the indices of the kept points.
+
+        Identical to compute_positional_error_statistics, but uses the kept point indices like
+        compute_positional_errors2_indexed.
+
+        \sa compute_positional_errors2_indexed
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] keys_first       the index of the first kept point
+        \param[in] keys_last        one beyond the index of the last kept point
+        \param[out] valid           [optional] indicates if the computed statistics are valid
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the computed statistics
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename Counters = util::no_counters
+    >
+    error::statistics compute_positional_error_statistics_indexed (
+        RandomAccessIterator original_first,
+        RandomAccessIterator original_last,
+        ForwardIterator keys_first,
+        ForwardIterator keys_last,
+        bool* valid=0,
+        Counters stats = Counters ())
+    {
+        return error::positional_indexed_statistics
+            <
+                DIM,
+                RandomAccessIterator,
+                ForwardIterator,
+                Counters
+            >::compute (original_first, original_last,
+                        keys_first, keys_last,
+                        valid, 0, stats);
+    }
+
+    /*!
+        \brief Computes statistics and percentiles for the positional errors between a polyline
+        and its simplification, where the simplification is given by the indices of the kept
+        points.
+
+        Identical to the overload without sketch, but also adds each positional error to the
+        specified quantile sketch, like the sketch overload of compute_positional_error_statistics.
+
+        \sa compute_positional_error_statistics_indexed
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] keys_first       the index of the first kept point
+        \param[in] keys_last        one beyond the index of the last kept point
+        \param[in,out] sketch       collects the positional errors
+        \param[out] valid           [optional] indicates if the computed statistics are valid
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the computed statistics
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename Counters = util::no_counters
+    >
+    error::statistics compute_positional_error_statistics_indexed (
+        RandomAccessIterator original_first,
+        RandomAccessIterator original_last,
+        ForwardIterator keys_first,
+        ForwardIterator keys_last,
+        error::quantile_sketch& sketch,
+        bool* valid=0,
+        Counters stats = Counters ())
+    {
+        return error::positional_indexed_statistics
+            <
+                DIM,
+                RandomAccessIterator,
+                ForwardIterator,
+                Counters
+            >::compute (original_first, original_last,
+                        keys_first, keys_last,
+                        valid, &sketch, stats);
+    }
+
+    /*!
+        \brief Computes statistics for the positional errors between a polyline and its
+        simplification, where the simplification is given by a mask of kept points.
+
+        \sa compute_positional_errors2_masked, compute_positional_error_statistics_indexed
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] mask             flag of the first point, non-zero if it is kept
+        \param[out] valid           [optional] indicates if the computed statistics are valid
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the computed statistics
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename InputIterator,
+        typename Counters = util::no_counters
+    >
+    error::statistics compute_positional_error_statistics_masked (
+        RandomAccessIterator original_first,
+        RandomAccessIterator original_last,
+        InputIterator mask,
+        bool* valid=0,
+        Counters stats = Counters ())
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+        std::vector <diff_type> keys = error::detail::mask_to_indices (
+            mask, static_cast <diff_type> (DIM ? std::distance (original_first, original_last) / DIM : 0));
+
+        return error::positional_indexed_statistics
+            <
+                DIM,
+                RandomAccessIterator,
+                typename std::vector <diff_type>::const_iterator,
+                Counters
+            >::compute (original_first, original_last,
+                        keys.begin (), keys.end (),
+                        valid, 0, stats);
+    }
+
+    /*!
+        \brief Computes statistics and percentiles for the positional errors between a polyline
+        and its simplification, where the simplification is given by a mask of kept points.
+
+        Identical to the overload without sketch, but also adds each positional error to the
+        specified quantile sketch, like the sketch overload of compute_positional_error_statistics.
+
+        \sa compute_positional_error_statistics_masked
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] mask             flag of the first point, non-zero if it is kept
+        \param[in,out] sketch       collects the positional errors
+        \param[out] valid           [optional] indicates if the computed statistics are valid
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the computed statistics
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename InputIterator,
+        typename Counters = util::no_counters
+    >
+    error::statistics compute_positional_error_statistics_masked (
+        RandomAccessIterator original_first,
+        RandomAccessIterator original_last,
+        InputIterator mask,
+        error::quantile_sketch& sketch,
+        bool* valid=0,
+        Counters stats = Counters ())
+    {
+        typedef typename std::iterator_traits <RandomAccessIterator>::difference_type diff_type;
+
+        std::vector <diff_type> keys = error::detail::mask_to_indices (
+            mask, static_cast <diff_type> (DIM ? std::distance (original_first, original_last) / DIM : 0));
+
+        return error::positional_indexed_statistics
+            <
+                DIM,
+                RandomAccessIterator,
+                typename std::vector <diff_type>::const_iterator,
+                Counters
+            >::compute (original_first, original_last,
+                        keys.begin (), keys.end (),
+                        valid, &sketch, stats);
+    }
+
+    /*!
+        \brief Computes the squared positional error between a polyline and its simplification
+        using multiple threads.
+
+        The parallel equivalent of compute_positional_errors2. The points of the simplification
+        are first matched to the original polyline, which only compares coordinates. Then the
+        original points are split into one chunk per thread, and the errors of each chunk are
+        computed concurrently, like compute_positional_errors2_indexed_parallel does. When the
+        simplification cannot be matched, compute_positional_errors2 is used instead. Polylines
+        that are too short to benefit from multiple threads are processed serially.
+
+        Input (Type) requirements: see compute_positional_errors2, in addition:
+        1- The output iterator is a RandomAccessIterator
+
+        \sa compute_positional_errors2
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] simplified_first the first coordinate of the first simplified polyline point
+        \param[in] simplified_last  one beyond the last coordinate of the last simplified polyline point
+        \param[in] result           destination of the squared positional errors
+        \param[out] valid           [optional] indicates if the computed positional errors are valid
+        \param[in] thread_count     the maximum number of threads to use, 0 means one per hardware thread
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     one beyond the last computed positional error
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename ForwardIterator,
+        typename RandomAccessIterator2,
+        typename Counters = util::no_counters
+    >
+    RandomAccessIterator2 compute_positional_errors2_parallel (
+        RandomAccessIterator1 original_first,
+        RandomAccessIterator1 original_last,
+        ForwardIterator simplified_first,
+        ForwardIterator simplified_last,
+        RandomAccessIterator2 result,
+        bool* valid=0,
+        unsigned thread_count = 0,
+        Counters stats = Counters ())
+    {
+        return error::positional_parallel
+            <
+                DIM,
+                RandomAccessIterator1,
+                ForwardIterator,
+                RandomAccessIterator2,
+                Counters
+            >::compute (original_first, original_last,
+                        simplified_first, simplified_last,
+                        result, valid, thread_count, stats);
+    }
+
+    /*!
+        \brief Computes statistics for the positional errors between a polyline and its
+        simplification using multiple threads.
+
+        The parallel equivalent of compute_positional_error_statistics; see
+        compute_positional_errors2_parallel for how the work is divided. Each chunk collects
+        its own statistics. These are merged in order, so the result only differs from the
+        serial result by rounding.
+
+        \sa compute_positional_error_statistics, compute_positional_errors2_parallel
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] simplified_first the first coordinate of the first simplified polyline point
+        \param[in] simplified_last  one beyond the last coordinate of the last simplified polyline point
+        \param[out] valid           [optional] indicates if the computed statistics are valid
+        \param[in] thread_count     the maximum number of threads to use, 0 means one per hardware thread
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the computed statistics
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename Counters = util::no_counters
+    >
+    error::statistics compute_positional_error_statistics_parallel (
+        RandomAccessIterator original_first,
+        RandomAccessIterator original_last,
+        ForwardIterator simplified_first,
+        ForwardIterator simplified_last,
+        bool* valid=0,
+        unsigned thread_count = 0,
+        Counters stats = Counters ())
+    {
+        return error::positional_statistics_parallel
+            <
+                DIM,
+                RandomAccessIterator,
+                ForwardIterator,
+                Counters
+            >::compute (original_first, original_last,
+                        simplified_first, simplified_last,
+                        valid, 0, thread_count, stats);
+    }
+
+    /*!
+        \brief Computes statistics and percentiles for the positional errors between a polyline
+        and its simplification using multiple threads.
+
+        Identical to the overload without sketch, but also adds each positional error to the
+        specified quantile sketch, like the sketch overload of compute_positional_error_statistics.
+        Each chunk fills its own copy of the sketch, and these are merged into sketch in order.
+
+        \sa compute_positional_error_statistics_parallel
+
         \param[in] original_first   the first coordinate of the first polyline point
         \param[in] original_last    one beyond the last coordinate of the last polyline point
         \param[in] simplified_first the first coordinate of the first simplified polyline point
         \param[in] simplified_last  one beyond the last coordinate of the last simplified polyline point
+        \param[in,out] sketch       collects the positional errors
+        \param[out] valid           [optional] indicates if the computed statistics are valid
+        \param[in] thread_count     the maximum number of threads to use, 0 means one per hardware thread
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the computed statistics
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename Counters = util::no_counters
+    >
+    error::statistics compute_positional_error_statistics_parallel (
+        RandomAccessIterator original_first,
+        RandomAccessIterator original_last,
+        ForwardIterator simplified_first,
+        ForwardIterator simplified_last,
+        error::quantile_sketch& sketch,
+        bool* valid=0,
+        unsigned thread_count = 0,
+        Counters stats = Counters ())
+    {
+        return error::positional_statistics_parallel
+            <
+                DIM,
+                RandomAccessIterator,
+                ForwardIterator,
+                Counters
+            >::compute (original_first, original_last,
+                        simplified_first, simplified_last,
+                        valid, &sketch, thread_count, stats);
+    }
+
+    /*!
+        \brief Computes the squared positional error between a polyline and its simplification
+        using multiple threads, where the simplification is given by the indices of the kept
+        points.
+
+        The parallel equivalent of compute_positional_errors2_indexed. The original points are
+        split into equally sized chunks, one per thread. The segment that contains the first
+        point of a chunk is found by a binary search in the indices, so that the work is
+        balanced regardless of the length of the segments. Each chunk writes its errors directly
+        to its part of the output range. The result is identical to that of
+        compute_positional_errors2_indexed.
+
+        Input (Type) requirements: see compute_positional_errors2_indexed, in addition:
+        1- The indices and the output are accessed through RandomAccessIterators
+
+        \sa compute_positional_errors2_indexed
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] keys_first       the index of the first kept point
+        \param[in] keys_last        one beyond the index of the last kept point
         \param[in] result           destination of the squared positional errors
         \param[out] valid           [optional] indicates if the computed positional errors are valid
+        \param[in] thread_count     the maximum number of threads to use, 0 means one per hardware thread
+        \param[in,out] stats        [optional] collects the work done, see with_counters
         \return                     one beyond the last computed positional error
     */
     template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename RandomAccessIterator2,
+        typename RandomAccessIterator3,
+        typename Counters = util::no_counters
+    >
+    RandomAccessIterator3 compute_positional_errors2_indexed_parallel (
+        RandomAccessIterator1 original_first,
+        RandomAccessIterator1 original_last,
+        RandomAccessIterator2 keys_first,
+        RandomAccessIterator2 keys_last,
+        RandomAccessIterator3 result,
+        bool* valid=0,
+        unsigned thread_count = 0,
+        Counters stats = Counters ())
+    {
+        return error::positional_indexed_parallel
+            <
+                DIM,
+                RandomAccessIterator1,
+                RandomAccessIterator2,
+                RandomAccessIterator3,
+                Counters
+            >::compute (original_first, original_last,
+                        keys_first, keys_last,
+                        result, valid, thread_count, stats);
+    }
+
+    /*!
+        \brief Computes statistics for the positional errors between a polyline and its
+        simplification using multiple threads, where the simplification is given by the
+        indices of the kept points.
+
+        The parallel equivalent of compute_positional_error_statistics_indexed; see
+        compute_positional_errors2_indexed_parallel and
+        compute_positional_error_statistics_parallel.
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] keys_first       the index of the first kept point
+        \param[in] keys_last        one beyond the index of the last kept point
+        \param[out] valid           [optional] indicates if the computed statistics are valid
+        \param[in] thread_count     the maximum number of threads to use, 0 means one per hardware thread
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the computed statistics
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename RandomAccessIterator2,
+        typename Counters = util::no_counters
+    >
+    error::statistics compute_positional_error_statistics_indexed_parallel (
+        RandomAccessIterator1 original_first,
+        RandomAccessIterator1 original_last,
+        RandomAccessIterator2 keys_first,
+        RandomAccessIterator2 keys_last,
+        bool* valid=0,
+        unsigned thread_count = 0,
+        Counters stats = Counters ())
+    {
+        return error::positional_indexed_statistics_parallel
+            <
+                DIM,
+                RandomAccessIterator1,
+                RandomAccessIterator2,
+                Counters
+            >::compute (original_first, original_last,
+                        keys_first, keys_last,
+                        valid, 0, thread_count, stats);
+    }
+
+    /*!
+        \brief Computes statistics and percentiles for the positional errors between a polyline
+        and its simplification using multiple threads, where the simplification is given by the
+        indices of the kept points.
+
+        Identical to the overload without sketch, but also adds each positional error to the
+        specified quantile sketch, like the sketch overload of compute_positional_error_statistics.
+        Each chunk fills its own copy of the sketch, and these are merged into sketch in order.
+
+        \sa compute_positional_error_statistics_indexed_parallel
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] keys_first       the index of the first kept point
+        \param[in] keys_last        one beyond the index of the last kept point
+        \param[in,out] sketch       collects the positional errors
+        \param[out] valid           [optional] indicates if the computed statistics are valid
+        \param[in] thread_count     the maximum number of threads to use, 0 means one per hardware thread
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the computed statistics
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename RandomAccessIterator2,
+        typename Counters = util::no_counters
+    >
+    error::statistics compute_positional_error_statistics_indexed_parallel (
+        RandomAccessIterator1 original_first,
+        RandomAccessIterator1 original_last,
+        RandomAccessIterator2 keys_first,
+        RandomAccessIterator2 keys_last,
+        error::quantile_sketch& sketch,
+        bool* valid=0,
+        unsigned thread_count = 0,
+        Counters stats = Counters ())
+    {
+        return error::positional_indexed_statistics_parallel
+            <
+                DIM,
+                RandomAccessIterator1,
+                RandomAccessIterator2,
+                Counters
+            >::compute (original_first, original_last,
+                        keys_first, keys_last,
+                        valid, &sketch, thread_count, stats);
+    }
+
+    /*!
+        \brief Computes the Hausdorff distance between two polylines.
+
+        The Hausdorff distance is the largest distance from a point of either polyline to the
+        nearest segment of the other polyline. This includes the points inside the segments, as
+        the largest distance can lie between two vertices, where their nearest segments of the
+        other polyline differ. Unlike the positional error, the second polyline does not need
+        to consist of points of the first polyline, so it can be used to compare the results of
+        any simplification, smoothing or third-party routine.
+
+        The segments of both polylines are indexed by a hierarchy of bounding boxes. Points that
+        cannot increase the distance found so far are rejected after visiting only a few boxes,
+        so the cost is close to O((n + m) log (n + m)) instead of O(n * m) for polylines that
+        follow each other.
+
+        Input (Type) requirements:
+        1- DIM is not 0, where DIM represents the dimension of the polyline
+        2- The ranges [first1, last1) and [first2, last2) contain vertex coordinates in
+           multiples of DIM, and at least 1 vertex each
+
+        In case these requirements are not met, the valid flag is set to false OR compile
+        errors may occur.
+
+        \param[in] first1       the first coordinate of the first point of the first polyline
+        \param[in] last1        one beyond the last coordinate of the last point of the first polyline
+        \param[in] first2       the first coordinate of the first point of the second polyline
+        \param[in] last2        one beyond the last coordinate of the last point of the second polyline
+        \param[out] valid       [optional] indicates if the computed distance is valid
+        \param[in,out] stats    [optional] collects the work done, see with_counters
+        \return                 the Hausdorff distance
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename RandomAccessIterator2,
+        typename Counters = util::no_counters
+    >
+    double compute_hausdorff_distance (
+        RandomAccessIterator1 first1,
+        RandomAccessIterator1 last1,
+        RandomAccessIterator2 first2,
+        RandomAccessIterator2 last2,
+        bool* valid=0,
+        Counters stats = Counters ())
+    {
+        return error::hausdorff
+            <
+                DIM,
+                RandomAccessIterator1,
+                RandomAccessIterator2,
+                Counters
+            >::compute (first1, last1, first2, last2, valid, stats);
+    }
+
+    /*!
+        \brief Computes the discrete Frechet distance between two polylines.
+
+        The discrete Frechet distance is the smallest, over all couplings of the points of both
+        polylines that walk along both polylines without going back, of the largest distance
+        between coupled points. Unlike the Hausdorff distance it takes the order of the points
+        into account, so it detects a simplification that skips back and forth.
+
+        The distance is computed by a dynamic program over all n * m pairs of points, that only
+        keeps two rows of m values in memory. See compute_discrete_frechet_distance_banded for
+        a faster approximation of long polylines.
+
+        Input (Type) requirements: see compute_hausdorff_distance
+
+        \param[in] first1       the first coordinate of the first point of the first polyline
+        \param[in] last1        one beyond the last coordinate of the last point of the first polyline
+        \param[in] first2       the first coordinate of the first point of the second polyline
+        \param[in] last2        one beyond the last coordinate of the last point of the second polyline
+        \param[out] valid       [optional] indicates if the computed distance is valid
+        \param[in,out] stats    [optional] collects the work done, see with_counters
+        \return                 the discrete Frechet distance
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename RandomAccessIterator2,
+        typename Counters = util::no_counters
+    >
+    double compute_discrete_frechet_distance (
+        RandomAccessIterator1 first1,
+        RandomAccessIterator1 last1,
+        RandomAccessIterator2 first2,
+        RandomAccessIterator2 last2,
+        bool* valid=0,
+        Counters stats = Counters ())
+    {
+        return error::discrete_frechet
+            <
+                DIM,
+                RandomAccessIterator1,
+                RandomAccessIterator2,
+                Counters
+            >::compute (first1, last1, first2, last2, 0, valid, stats);
+    }
+
+    /*!
+        \brief Computes an upper bound of the discrete Frechet distance between two polylines,
+        only considering couplings near the diagonal.
+
+        Identical to compute_discrete_frechet_distance, but each point of the first polyline is
+        only coupled to the points of the second polyline within band points of the point at
+        the same fraction of its length. This takes O(n * band) time and O(band) memory when
+        both polylines have a similar point density. The result is exact when an optimal
+        coupling lies within the band; otherwise it is larger than the exact distance. A band
+        of 0 considers all couplings.
+
+        \sa compute_discrete_frechet_distance
+
+        \param[in] first1       the first coordinate of the first point of the first polyline
+        \param[in] last1        one beyond the last coordinate of the last point of the first polyline
+        \param[in] first2       the first coordinate of the first point of the second polyline
+        \param[in] last2        one beyond the last coordinate of the last point of the second polyline
+        \param[in] band         the number of points on either side of the diagonal
+        \param[out] valid       [optional] indicates if the computed distance is valid
+        \param[in,out] stats    [optional] collects the work done, see with_counters
+        \return                 the discrete Frechet distance, or an upper bound of it
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename RandomAccessIterator2,
+        typename Size,
+        typename Counters = util::no_counters
+    >
+    double compute_discrete_frechet_distance_banded (
+        RandomAccessIterator1 first1,
+        RandomAccessIterator1 last1,
+        RandomAccessIterator2 first2,
+        RandomAccessIterator2 last2,
+        Size band,
+        bool* valid=0,
+        Counters stats = Counters ())
+    {
+        return error::discrete_frechet
+            <
+                DIM,
+                RandomAccessIterator1,
+                RandomAccessIterator2,
+                Counters
+            >::compute (first1, last1, first2, last2, static_cast <std::ptrdiff_t> (band), valid, stats);
+    }
+
+    /*!
+        \brief Computes the areal displacement of each segment of the simplification of a 2d
+        polyline.
+
+        Each segment of the simplification [simplified_first, simplified_last) replaces a chain
+        of points of the original polyline [original_first, original_last). The area enclosed
+        between that chain and the segment is computed with the shoelace formula, in a single
+        pass over both polylines. The chain is cut where it crosses the segment, and the
+        absolute areas of the parts are added, so that areas on either side of the segment do
+        not cancel out. The area of each segment is copied to the output range [result, result
+        + count - 1), where count is the number of points of the simplification.
+
+        Input (Type) requirements: see compute_positional_errors2, in addition:
+        1- DIM is 2
+
+        In case these requirements are not met, the valid flag is set to false OR
+        compile errors may occur.
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] simplified_first the first coordinate of the first simplified polyline point
+        \param[in] simplified_last  one beyond the last coordinate of the last simplified polyline point
+        \param[in] result           destination of the areal displacement of each segment
+        \param[out] valid           [optional] indicates if the computed areas are valid
+        \return                     one beyond the last computed area
+    */
+    template
     <
         unsigned DIM,
         typename ForwardIterator1,
         typename ForwardIterator2,
         typename OutputIterator
     >
-    OutputIterator compute_positional_errors2 (
+    OutputIterator compute_areal_displacements (
         ForwardIterator1 original_first,
         ForwardIterator1 original_last,
         ForwardIterator2 simplified_first,
@@ -722,71 +2580,169 @@ namespace psimpl
         OutputIterator result,
         bool* valid=0)
     {
-        return error::positional
+        typedef util::output_counters <OutputIterator> policy;
+
+        return error::areal
             <
                 DIM,
                 ForwardIterator1,
                 ForwardIterator2,
-                OutputIterator
+                OutputIterator,
+                typename policy::type
             >::compute (original_first, original_last,
                         simplified_first, simplified_last,
-                        result, valid);
+                        result, valid, policy::get (result));
     }
 
     /*!
-        \brief Computes statistics for the positional errors between a polyline and its simplification.
-
-        Various statistics (mean, max, sum, std) are calculated for the positional errors
-        between the range [original_first, original_last) and its simplification the range
-        [simplified_first, simplified_last).
-
-        Input (Type) requirements:
-        1- DIM is not 0, where DIM represents the dimension of the polyline
-        2- The value type of ForwardIterator1 is convertible to the value type of ForwardIterator2
-        3- The value type of ForwardIterator2, possibly promoted to a floating point type, is convertible
-           to double
-        3- The ranges [original_first, original_last) and [simplified_first, simplified_last)
-           contain vertex coordinates in multiples of DIM, f.e.: x, y, z, x, y, z, x, y, z
-           when DIM = 3
-        4- The ranges [original_first, original_last) and [simplified_first, simplified_last)
-           contain a minimum of 2 vertices
-        5- The range [simplified_first, simplified_last) represents a simplification of the
-           range [original_first, original_last), meaning each point in the simplification
-           has the exact same coordinates as some point from the original polyline
+        \brief Computes the total areal displacement between a 2d polyline and its simplification.
 
-        In case these requirements are not met, the valid flag is set to false OR
-        compile errors may occur.
+        The sum of the areas computed by compute_areal_displacements.
 
-        \sa ComputePositionalErrors2
+        \sa compute_areal_displacements
 
         \param[in] original_first   the first coordinate of the first polyline point
         \param[in] original_last    one beyond the last coordinate of the last polyline point
         \param[in] simplified_first the first coordinate of the first simplified polyline point
         \param[in] simplified_last  one beyond the last coordinate of the last simplified polyline point
-        \param[out] valid           [optional] indicates if the computed statistics are valid
-        \return                     the computed statistics
+        \param[out] valid           [optional] indicates if the computed area is valid
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the total area between the polyline and its simplification
     */
     template
     <
         unsigned DIM,
         typename ForwardIterator1,
-        typename ForwardIterator2
+        typename ForwardIterator2,
+        typename Counters = util::no_counters
     >
-    error::statistics compute_positional_error_statistics (
+    double compute_areal_displacement (
         ForwardIterator1 original_first,
         ForwardIterator1 original_last,
         ForwardIterator2 simplified_first,
         ForwardIterator2 simplified_last,
-        bool* valid=0)
+        bool* valid=0,
+        Counters stats = Counters ())
     {
-        return error::positional_statistics
+        double sum = 0;
+        error::areal
             <
                 DIM,
                 ForwardIterator1,
-                ForwardIterator2
+                ForwardIterator2,
+                error::detail::sum_iterator,
+                Counters
+            >::compute (original_first, original_last,
+                        simplified_first, simplified_last,
+                        error::detail::sum_iterator (sum), valid, stats);
+        return sum;
+    }
+
+    /*!
+        \brief Computes the total areal displacement between a 2d polyline and its simplification
+        using multiple threads.
+
+        The parallel equivalent of compute_areal_displacement. The points of the simplification
+        are matched to the original polyline first, like compute_positional_errors2_parallel
+        does. The segments are then divided into ranges of about the same number of original
+        points, one per thread. The result equals that of compute_areal_displacement up to
+        rounding.
+
+        \sa compute_areal_displacement
+
+        \param[in] original_first   the first coordinate of the first polyline point
+        \param[in] original_last    one beyond the last coordinate of the last polyline point
+        \param[in] simplified_first the first coordinate of the first simplified polyline point
+        \param[in] simplified_last  one beyond the last coordinate of the last simplified polyline point
+        \param[out] valid           [optional] indicates if the computed area is valid
+        \param[in] thread_count     the maximum number of threads to use, 0 means one per hardware thread
+        \param[in,out] stats        [optional] collects the work done, see with_counters
+        \return                     the total area between the polyline and its simplification
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator,
+        typename ForwardIterator,
+        typename Counters = util::no_counters
+    >
+    double compute_areal_displacement_parallel (
+        RandomAccessIterator original_first,
+        RandomAccessIterator original_last,
+        ForwardIterator simplified_first,
+        ForwardIterator simplified_last,
+        bool* valid=0,
+        unsigned thread_count = 0,
+        Counters stats = Counters ())
+    {
+        return error::areal_parallel
+            <
+                DIM,
+                RandomAccessIterator,
+                ForwardIterator,
+                Counters
             >::compute (original_first, original_last,
                         simplified_first, simplified_last,
-                        valid);
+                        valid, thread_count, stats);
+    }
+
+    /*!
+        \brief Computes the total areal displacement of each polyline of a batch of 2d polylines
+        and their simplifications.
+
+        The batch of polylines is defined like for simplify_douglas_peucker_batch: polyline i
+        consists of the coordinates [original_first + original_offsets [i], original_first +
+        original_offsets [i+1]), and its simplification of the coordinates [simplified_first +
+        simplified_offsets [i], simplified_first + simplified_offsets [i+1]). The output of
+        the batch simplification routines can thus be measured directly. The total area of
+        each polyline is copied to the output range starting at result.
+
+        Pairs that do not meet the requirements of compute_areal_displacement get an area of 0,
+        and set the valid flag to false.
+
+        \sa compute_areal_displacement, simplify_douglas_peucker_batch
+
+        \param[in] original_first           the first coordinate of the batch
+        \param[in] original_offsets_first   the first coord offset of the batch
+        \param[in] original_offsets_last    one beyond the last coord offset of the batch
+        \param[in] simplified_first         the first coordinate of the simplified batch
+        \param[in] simplified_offsets_first the first coord offset of the simplified batch
+        \param[in] result                   destination of the area of each polyline
+        \param[out] valid                   [optional] indicates if all computed areas are valid
+        \return                             one beyond the last computed area
+    */
+    template
+    <
+        unsigned DIM,
+        typename RandomAccessIterator1,
+        typename OffsetIterator1,
+        typename RandomAccessIterator2,
+        typename OffsetIterator2,
+        typename OutputIterator
+    >
+    OutputIterator compute_areal_displacement_batch (
+        RandomAccessIterator1 original_first,
+        OffsetIterator1 original_offsets_first,
+        OffsetIterator1 original_offsets_last,
+        RandomAccessIterator2 simplified_first,
+        OffsetIterator2 simplified_offsets_first,
+        OutputIterator result,
+        bool* valid=0)
+    {
+        typedef util::output_counters <OutputIterator> policy;
+
+        return error::areal_batch
+            <
+                DIM,
+                RandomAccessIterator1,
+                OffsetIterator1,
+                RandomAccessIterator2,
+                OffsetIterator2,
+                OutputIterator,
+                typename policy::type
+            >::compute (original_first, original_offsets_first, original_offsets_last,
+                        simplified_first, simplified_offsets_first,
+                        result, valid, policy::get (result));
     }
 }
 
@@ -0,0 +1,309 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+#ifndef PSIMPL_BENCH_ALLOC
+#define PSIMPL_BENCH_ALLOC
+
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+
+namespace psimpl {
+    namespace bench
+{
+    namespace alloc_detail
+    {
+        /*!
+            \brief Process wide heap usage, as seen by the global operator new and delete.
+
+            Only allocations made while tracking are counted, so that the hooks cost nothing
+            more than a read of the tracking flag during timed runs. Each allocation remembers
+            if it was counted, so that live bytes stay exact when tracking is switched.
+        */
+        struct heap
+        {
+            static inline std::atomic <int> tracking {0};           //!< number of active scopes
+            static inline std::atomic <std::uint64_t> calls {0};    //!< number of allocations
+            static inline std::atomic <std::uint64_t> bytes {0};    //!< number of bytes allocated
+            static inline std::atomic <std::int64_t> live {0};      //!< number of counted bytes in use
+            static inline std::atomic <std::int64_t> peak {0};      //!< highest number of live bytes
+        };
+    }
+
+    /*!
+        \brief Allocation statistics of a section of code.
+    */
+    struct allocation_stats
+    {
+        std::uint64_t calls;    //!< number of allocations
+        std::uint64_t bytes;    //!< number of bytes allocated
+        std::int64_t peak;      //!< highest number of bytes allocated at once
+    };
+
+    /*!
+        \brief Counts the heap usage of the process from construction until stats.
+
+        Allocations of all threads are counted, including the worker threads of the parallel
+        algorithms. Only counts when the allocation hooks are installed, see
+        PSIMPL_BENCH_ALLOCATION_HOOKS.
+    */
+    class allocation_scope
+    {
+    public:
+        allocation_scope () {
+            using alloc_detail::heap;
+            mOuterPeak = heap::peak.load ();
+            mCalls = heap::calls.load ();
+            mBytes = heap::bytes.load ();
+            mLive = heap::live.load ();
+            heap::peak.store (mLive);
+            heap::tracking.fetch_add (1);
+        }
+
+        ~allocation_scope () {
+            using alloc_detail::heap;
+            heap::tracking.fetch_sub (1);
+            std::int64_t peak = heap::peak.load ();
+            while (peak < mOuterPeak && !heap::peak.compare_exchange_weak (peak, mOuterPeak)) {}
+        }
+
+        //! \brief Returns the heap usage since construction.
+        allocation_stats stats () const {
+            using alloc_detail::heap;
+            allocation_stats result;
+            result.calls = heap::calls.load () - mCalls;
+            result.bytes = heap::bytes.load () - mBytes;
+            result.peak = heap::peak.load () - mLive;
+            return result;
+        }
+
+    private:
+        allocation_scope (const allocation_scope&);
+        allocation_scope& operator= (const allocation_scope&);
+
+        std::uint64_t mCalls;       //!< allocation count at construction
+        std::uint64_t mBytes;       //!< allocated bytes at construction
+        std::int64_t mLive;         //!< live bytes at construction
+        std::int64_t mOuterPeak;    //!< peak before construction
+    };
+
+    /*!
+        \brief Runs f, and returns how much it allocated.
+    */
+    template <typename Function>
+    allocation_stats count_allocations (Function f) {
+        allocation_scope scope;
+        f ();
+        return scope.stats ();
+    }
+
+    /*!
+        \brief Asserts that no allocations are made during its lifetime.
+
+        For code paths that claim to be allocation free. A violation is reported on stderr
+        together with the given name, and then aborts, so that it cannot go unnoticed.
+    */
+    class zero_allocation_guard
+    {
+    public:
+        explicit zero_allocation_guard (const char* name) :
+            mName (name)
+        {}
+
+        ~zero_allocation_guard () {
+            allocation_stats stats = mScope.stats ();
+            if (stats.calls) {
+                std::fprintf (stderr, "%s claims to be allocation free, but made %llu allocations of %llu bytes\n",
+                              mName, static_cast <unsigned long long> (stats.calls),
+                              static_cast <unsigned long long> (stats.bytes));
+                std::abort ();
+            }
+        }
+
+    private:
+        zero_allocation_guard (const zero_allocation_guard&);
+        zero_allocation_guard& operator= (const zero_allocation_guard&);
+
+        const char* mName;
+        allocation_scope mScope;
+    };
+
+    // ---------------------------------------------------------------------------------------------
+
+    /*!
+        \brief Resets the peak resident set size of the process to its current size.
+
+        Returns false when not supported (requires Linux 4.0).
+    */
+    inline bool reset_peak_rss () {
+        std::FILE* file = std::fopen ("/proc/self/clear_refs", "w");
+        if (!file) {
+            return false;
+        }
+        bool ok = std::fputs ("5", file) >= 0;
+        return std::fclose (file) == 0 && ok;
+    }
+
+    //! \brief Returns the peak resident set size of the process in kilobytes, or -1 if unknown.
+    inline long peak_rss_kb () {
+        std::FILE* file = std::fopen ("/proc/self/status", "r");
+        if (!file) {
+            return -1;
+        }
+        long result = -1;
+        char line [256];
+        while (std::fgets (line, sizeof (line), file)) {
+            if (std::strncmp (line, "VmHWM:", 6) == 0) {
+                result = std::strtol (line + 6, 0, 10);
+                break;
+            }
+        }
+        std::fclose (file);
+        return result;
+    }
+
+    namespace alloc_detail
+    {
+        //! Header in front of each allocation, keeps the alignment of malloc.
+        union header
+        {
+            struct {
+                std::size_t size;
+                bool counted;
+            } info;
+            std::max_align_t align;
+        };
+
+        inline void* allocate (std::size_t size) {
+            header* h = static_cast <header*> (std::malloc (sizeof (header) + size));
+            if (!h) {
+                return 0;
+            }
+            h->info.size = size;
+            h->info.counted = heap::tracking.load (std::memory_order_relaxed) != 0;
+            if (h->info.counted) {
+                heap::calls.fetch_add (1, std::memory_order_relaxed);
+                heap::bytes.fetch_add (size, std::memory_order_relaxed);
+                std::int64_t live = heap::live.fetch_add (static_cast <std::int64_t> (size), std::memory_order_relaxed) + static_cast <std::int64_t> (size);
+                std::int64_t peak = heap::peak.load (std::memory_order_relaxed);
+                while (peak < live && !heap::peak.compare_exchange_weak (peak, live, std::memory_order_relaxed)) {}
+            }
+            return h + 1;
+        }
+
+        inline void* allocate_or_throw (std::size_t size) {
+            for (;;) {
+                void* p = allocate (size);
+                if (p) {
+                    return p;
+                }
+                std::new_handler handler = std::get_new_handler ();
+                if (!handler) {
+                    throw std::bad_alloc ();
+                }
+                handler ();
+            }
+        }
+
+        inline void deallocate (void* p) {
+            if (!p) {
+                return;
+            }
+            header* h = static_cast <header*> (p) - 1;
+            if (h->info.counted) {
+                heap::live.fetch_sub (static_cast <std::int64_t> (h->info.size), std::memory_order_relaxed);
+            }
+            std::free (h);
+        }
+    }
+}}
+
+
+/*
+    Defining PSIMPL_BENCH_ALLOCATION_HOOKS in exactly one translation unit, before including
+    this file, replaces the global operator new and delete by counting versions. Over-aligned
+    allocations keep using the default operators and are not counted.
+*/
+#ifdef PSIMPL_BENCH_ALLOCATION_HOOKS
+
+void* operator new (std::size_t size) {
+    return psimpl::bench::alloc_detail::allocate_or_throw (size);
+}
+
+void* operator new [] (std::size_t size) {
+    return psimpl::bench::alloc_detail::allocate_or_throw (size);
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept {
+    return psimpl::bench::alloc_detail::allocate (size);
+}
+
+void* operator new [] (std::size_t size, const std::nothrow_t&) noexcept {
+    return psimpl::bench::alloc_detail::allocate (size);
+}
+
+void operator delete (void* p) noexcept {
+    psimpl::bench::alloc_detail::deallocate (p);
+}
+
+void operator delete [] (void* p) noexcept {
+    psimpl::bench::alloc_detail::deallocate (p);
+}
+
+void operator delete (void* p, std::size_t) noexcept {
+    psimpl::bench::alloc_detail::deallocate (p);
+}
+
+void operator delete [] (void* p, std::size_t) noexcept {
+    psimpl::bench::alloc_detail::deallocate (p);
+}
+
+void operator delete (void* p, const std::nothrow_t&) noexcept {
+    psimpl::bench::alloc_detail::deallocate (p);
+}
+
+void operator delete [] (void* p, const std::nothrow_t&) noexcept {
+    psimpl::bench::alloc_detail::deallocate (p);
+}
+
+#endif // PSIMPL_BENCH_ALLOCATION_HOOKS
+
+
+#endif // PSIMPL_BENCH_ALLOC
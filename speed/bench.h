@@ -0,0 +1,650 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+#ifndef PSIMPL_BENCH
+#define PSIMPL_BENCH
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include "psimpl.h"
+
+
+namespace psimpl {
+    namespace bench
+{
+    //! \brief Returns a monotonic timestamp in nanoseconds.
+    inline std::int64_t now_ns () {
+        return std::chrono::duration_cast <std::chrono::nanoseconds> (
+            std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+    }
+
+    /*!
+        \brief Pins the calling thread to a single cpu, so that it is not migrated between
+        measurements. Returns false when pinning is not supported or fails.
+    */
+    inline bool pin_to_cpu (int cpu) {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO (&set);
+        CPU_SET (cpu, &set);
+        return sched_setaffinity (0, sizeof (set), &set) == 0;
+#else
+        (void) cpu;
+        return false;
+#endif
+    }
+
+    //! \brief Prevents the compiler from optimizing away the computation of a value.
+    template <typename T>
+    inline void keep (const T& value) {
+#if defined(__GNUC__)
+        asm volatile ("" : : "g" (&value) : "memory");
+#else
+        static volatile const T* sink;
+        sink = &value;
+#endif
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    //! \brief Hardware events counted around each measured run.
+    enum event
+    {
+        cycles,
+        instructions,
+        l1d_misses,         //!< level 1 data cache read misses
+        llc_misses,         //!< last level cache misses
+        branch_misses,
+        event_count
+    };
+
+    //! \brief Returns the name of an event, as used in the CSV and JSON output.
+    inline const char* event_name (unsigned e) {
+        static const char* names [event_count] = {
+            "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+        };
+        return e < event_count ? names [e] : "";
+    }
+
+    /*!
+        \brief Hardware performance counters of the calling thread, read with perf_event_open.
+
+        Each event is opened separately, so that a missing event (common for cache events in
+        virtual machines) does not disable the others. Only user space is counted, which is
+        allowed at the default perf_event_paranoid level. When the kernel multiplexes the
+        counters, the counts are scaled by the fraction of time they were running. Events that
+        cannot be opened, and all events on other platforms, are reported as NaN.
+    */
+    class perf_counters
+    {
+    public:
+        //! \brief Opens the counters, or none when enable is false.
+        explicit perf_counters (bool enable = true) {
+            for (unsigned e = 0; e < event_count; ++e) {
+                mFd [e] = enable ? open (e) : -1;
+            }
+        }
+
+        ~perf_counters () {
+#if defined(__linux__)
+            for (unsigned e = 0; e < event_count; ++e) {
+                if (mFd [e] >= 0) {
+                    close (mFd [e]);
+                }
+            }
+#endif
+        }
+
+        //! \brief Returns true if event e is counted.
+        bool available (unsigned e) const {
+            return e < event_count && mFd [e] >= 0;
+        }
+
+        //! \brief Returns true if any event is counted.
+        bool any () const {
+            for (unsigned e = 0; e < event_count; ++e) {
+                if (available (e)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //! \brief Resets and starts all counters.
+        void start () {
+#if defined(__linux__)
+            for (unsigned e = 0; e < event_count; ++e) {
+                if (mFd [e] >= 0) {
+                    ioctl (mFd [e], PERF_EVENT_IOC_RESET, 0);
+                    ioctl (mFd [e], PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        //! \brief Stops all counters.
+        void stop () {
+#if defined(__linux__)
+            for (unsigned e = 0; e < event_count; ++e) {
+                if (mFd [e] >= 0) {
+                    ioctl (mFd [e], PERF_EVENT_IOC_DISABLE, 0);
+                }
+            }
+#endif
+        }
+
+        //! \brief Reads the count of each event since the last start, NaN if unavailable.
+        void read (double* counts) const {
+            for (unsigned e = 0; e < event_count; ++e) {
+                counts [e] = std::numeric_limits <double>::quiet_NaN ();
+#if defined(__linux__)
+                std::uint64_t values [3];   // value, time enabled, time running
+                // a counter that was never scheduled has no meaningful count
+                if (mFd [e] >= 0 && ::read (mFd [e], values, sizeof (values)) == sizeof (values) && values [2]) {
+                    counts [e] = static_cast <double> (values [0]);
+                    if (values [2] < values [1]) {
+                        counts [e] *= static_cast <double> (values [1]) / static_cast <double> (values [2]);
+                    }
+                }
+#endif
+            }
+        }
+
+    private:
+        perf_counters (const perf_counters&);
+        perf_counters& operator= (const perf_counters&);
+
+        //! \brief Opens a disabled counter for event e, returns -1 on failure.
+        static int open (unsigned e) {
+#if defined(__linux__)
+            perf_event_attr attr;
+            std::memset (&attr, 0, sizeof (attr));
+            attr.size = sizeof (attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            switch (e) {
+            case cycles:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case instructions:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case l1d_misses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1D
+                    | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            case llc_misses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CACHE_MISSES;
+                break;
+            case branch_misses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            default:
+                return -1;
+            }
+            long fd = syscall (SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            return fd < 0 ? -1 : static_cast <int> (fd);
+#else
+            (void) e;
+            return -1;
+#endif
+        }
+
+        int mFd [event_count];      //!< file descriptor of each counter, -1 if unavailable
+    };
+
+    // ---------------------------------------------------------------------------------------------
+
+    /*!
+        \brief Robust summary of a series of timings.
+    */
+    struct summary
+    {
+        summary () :
+            count (0),
+            rejected (0),
+            min (0),
+            median (0),
+            p90 (0),
+            mean (0)
+        {}
+
+        std::size_t count;      //!< number of samples that were kept
+        std::size_t rejected;   //!< number of slow outliers that were rejected
+        double min;
+        double median;
+        double p90;             //!< 90th percentile
+        double mean;            //!< mean of the kept samples
+    };
+
+    //! \brief Returns quantile q of sorted samples, interpolating linearly between ranks.
+    inline double quantile (const std::vector <double>& sorted, double q) {
+        if (sorted.empty ()) {
+            return 0;
+        }
+        double rank = q * static_cast <double> (sorted.size () - 1);
+        std::size_t below = static_cast <std::size_t> (std::floor (rank));
+        std::size_t above = std::min (below + 1, sorted.size () - 1);
+        return sorted [below] + (rank - static_cast <double> (below)) * (sorted [above] - sorted [below]);
+    }
+
+    /*!
+        \brief Summarizes a series of timings.
+
+        Timings only suffer from positive noise (interrupts, migrations, page faults), so only
+        slow outliers are rejected: samples beyond Tukey's far out fence Q3 + 3 * IQR.
+    */
+    inline summary summarize (std::vector <double> samples) {
+        summary result;
+        if (samples.empty ()) {
+            return result;
+        }
+        std::sort (samples.begin (), samples.end ());
+        double q1 = quantile (samples, 0.25);
+        double q3 = quantile (samples, 0.75);
+        double fence = q3 + 3 * (q3 - q1);
+        std::size_t kept = static_cast <std::size_t> (
+            std::upper_bound (samples.begin (), samples.end (), fence) - samples.begin ());
+        result.rejected = samples.size () - kept;
+        samples.resize (kept);
+
+        result.count = kept;
+        result.min = samples.front ();
+        result.median = quantile (samples, 0.5);
+        result.p90 = quantile (samples, 0.9);
+        double sum = 0;
+        for (std::size_t i = 0; i < kept; ++i) {
+            sum += samples [i];
+        }
+        result.mean = sum / static_cast <double> (kept);
+        return result;
+    }
+
+    /*!
+        \brief One sided Wilcoxon signed rank test: returns the p-value of the hypothesis that the
+        paired differences d are not larger than zero, using the normal approximation with
+        tie correction.
+
+        A small p-value means that the differences are significantly positive. The test makes no
+        assumption about the distribution of the differences, only about its symmetry, which
+        holds well for the logarithm of timing ratios.
+    */
+    inline double signed_rank_greater (const std::vector <double>& d) {
+        // rank the absolute non-zero differences, giving ties their average rank
+        std::vector <std::pair <double, bool> > ranked;     // |d|, d > 0
+        for (std::size_t i = 0; i < d.size (); ++i) {
+            if (d [i] != 0) {
+                ranked.push_back (std::make_pair (std::fabs (d [i]), d [i] > 0));
+            }
+        }
+        if (ranked.empty ()) {
+            return 1;
+        }
+        std::sort (ranked.begin (), ranked.end ());
+        double positive = 0;        // rank sum of positive differences
+        double tieSum = 0;          // sum of t^3 - t over groups of t ties
+        for (std::size_t i = 0; i < ranked.size (); ) {
+            std::size_t j = i;
+            while (j < ranked.size () && ranked [j].first == ranked [i].first) {
+                ++j;
+            }
+            double rank = static_cast <double> (i + 1 + j) / 2;
+            for (std::size_t k = i; k < j; ++k) {
+                if (ranked [k].second) {
+                    positive += rank;
+                }
+            }
+            double t = static_cast <double> (j - i);
+            tieSum += t * t * t - t;
+            i = j;
+        }
+        double n = static_cast <double> (ranked.size ());
+        double mean = n * (n + 1) / 4;
+        double variance = n * (n + 1) * (2 * n + 1) / 24 - tieSum / 48;
+        // continuity correction
+        double z = (positive - mean - 0.5) / std::sqrt (variance);
+        return 0.5 * std::erfc (z / std::sqrt (2.0));
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    /*!
+        \brief Defines how often a measured function is run.
+    */
+    struct options
+    {
+        options () :
+            warmup (2),
+            repeat (15)
+        {}
+
+        unsigned warmup;        //!< number of untimed runs, to warm up caches and branch predictors
+        unsigned repeat;        //!< number of timed runs
+    };
+
+    /*!
+        \brief Runs f warmup times, and then times repeat runs of f.
+
+        \param[in] f        the function to measure
+        \param[in] opts     the number of warmup and timed runs
+        \return             the duration of each timed run in nanoseconds
+    */
+    template <typename Function>
+    std::vector <double> measure (Function f, const options& opts) {
+        for (unsigned i = 0; i < opts.warmup; ++i) {
+            f ();
+        }
+        std::vector <double> samples;
+        samples.reserve (opts.repeat);
+        for (unsigned i = 0; i < opts.repeat; ++i) {
+            std::int64_t start = now_ns ();
+            f ();
+            samples.push_back (static_cast <double> (now_ns () - start));
+        }
+        return samples;
+    }
+
+    /*!
+        \brief Times iterations consecutive runs of f, and counts their hardware events.
+
+        The counters are started before and stopped after the timer is read, so that the
+        timings do not include the system calls that control the counters.
+
+        \param[in] f            the function to measure
+        \param[in] iterations   the number of runs
+        \param[in] counters     the hardware counters to read around the runs
+        \param[out] events      the count per run of each event, NaN if unavailable
+        \return                 the duration per run in nanoseconds
+    */
+    template <typename Function>
+    double measure_once (Function f, unsigned iterations, perf_counters& counters, double* events) {
+        counters.start ();
+        std::int64_t start = now_ns ();
+        for (unsigned i = 0; i < iterations; ++i) {
+            f ();
+        }
+        std::int64_t stop = now_ns ();
+        counters.stop ();
+        counters.read (events);
+        for (unsigned e = 0; e < event_count; ++e) {
+            events [e] /= iterations;
+        }
+        return static_cast <double> (stop - start) / iterations;
+    }
+
+    /*!
+        \brief Returns the number of consecutive runs of f that take at least minimum nanoseconds,
+        so that timings of short runs are not dominated by the timer and the counters.
+    */
+    template <typename Function>
+    unsigned calibrate (Function f, double minimum) {
+        std::int64_t start = now_ns ();
+        f ();
+        double once = static_cast <double> (now_ns () - start);
+        return once >= minimum ? 1 : static_cast <unsigned> (std::ceil (minimum / std::max (once, 1.0)));
+    }
+
+    /*!
+        \brief Returns the median of each event over a series of runs, NaN if unavailable.
+
+        \param[in] counts   the counts of each event, one per run
+        \param[out] events  the median count of each event
+    */
+    inline void median_events (std::vector <double> (&counts) [event_count], double* events) {
+        for (unsigned e = 0; e < event_count; ++e) {
+            std::sort (counts [e].begin (), counts [e].end ());
+            events [e] = counts [e].empty () || std::isnan (counts [e].front ())
+                ? std::numeric_limits <double>::quiet_NaN ()
+                : quantile (counts [e], 0.5);
+        }
+    }
+
+    /*!
+        \brief Runs f warmup times, and then times and counts repeat runs of f.
+
+        \param[in] f        the function to measure
+        \param[in] opts     the number of warmup and timed runs
+        \param[in] counters the hardware counters to read around each run
+        \param[out] events  the median count per run of each event, NaN if unavailable
+        \return             the duration of each timed run in nanoseconds
+    */
+    template <typename Function>
+    std::vector <double> measure (Function f, const options& opts, perf_counters& counters, double* events) {
+        for (unsigned i = 0; i < opts.warmup; ++i) {
+            f ();
+        }
+        std::vector <double> samples;
+        std::vector <double> counts [event_count];
+        samples.reserve (opts.repeat);
+        for (unsigned i = 0; i < opts.repeat; ++i) {
+            double run [event_count];
+            samples.push_back (measure_once (f, 1, counters, run));
+            for (unsigned e = 0; e < event_count; ++e) {
+                counts [e].push_back (run [e]);
+            }
+        }
+        median_events (counts, events);
+        return samples;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    /*!
+        \brief The measurements of one algorithm, for one variant, container and polyline.
+    */
+    struct record
+    {
+        record () :
+            points (0),
+            kept (0),
+            matches (-1),
+            allocations (std::numeric_limits <double>::quiet_NaN ()),
+            allocated_bytes (std::numeric_limits <double>::quiet_NaN ()),
+            peak_heap_bytes (std::numeric_limits <double>::quiet_NaN ()),
+            peak_rss_kb (std::numeric_limits <double>::quiet_NaN ())
+        {
+            for (unsigned e = 0; e < event_count; ++e) {
+                events [e] = std::numeric_limits <double>::quiet_NaN ();
+            }
+        }
+
+        //! \brief Returns the median count of event e per polyline point, NaN if unavailable.
+        double per_point (unsigned e) const {
+            return points ? events [e] / static_cast <double> (points)
+                          : std::numeric_limits <double>::quiet_NaN ();
+        }
+
+        std::string input;          //!< name of the polyline
+        std::string container;      //!< container type holding the polyline
+        std::string algorithm;      //!< name of the measured algorithm
+        std::string variant;        //!< implementation: psimpl, prev, reference or baseline
+        std::string params;         //!< algorithm parameters, separated by ';'
+        std::size_t points;         //!< number of polyline points
+        std::size_t kept;           //!< number of points of the simplification
+        summary time;                   //!< timings in nanoseconds
+        std::vector <double> samples;   //!< timing of each run in nanoseconds, in measurement order
+        int matches;                    //!< 1 if the simplification equals that of psimpl, 0 if not, -1 if not compared
+        double events [event_count];    //!< median hardware event counts per run, NaN if unavailable
+        double allocations;             //!< heap allocations per run, NaN if not tracked
+        double allocated_bytes;         //!< bytes allocated per run, NaN if not tracked
+        double peak_heap_bytes;         //!< highest heap usage during a run, NaN if not tracked
+        double peak_rss_kb;             //!< peak resident set size of the process, NaN if not tracked
+        error::statistics error;    //!< positional error statistics of the simplification
+    };
+
+    //! \brief Writes a string as a quoted JSON string.
+    inline void write_json_string (std::ostream& out, const std::string& value) {
+        out << '"';
+        for (std::size_t i = 0; i < value.size (); ++i) {
+            char c = value [i];
+            if (c == '"' || c == '\\') {
+                out << '\\' << c;
+            }
+            else if (static_cast <unsigned char> (c) < 0x20) {
+                out << ' ';
+            }
+            else {
+                out << c;
+            }
+        }
+        out << '"';
+    }
+
+    //! \brief Writes a value, or nothing when it is NaN.
+    inline void write_csv_value (std::ostream& out, double value) {
+        if (!std::isnan (value)) {
+            out << value;
+        }
+    }
+
+    //! \brief Writes a value, or null when it is NaN.
+    inline void write_json_value (std::ostream& out, double value) {
+        if (std::isnan (value)) {
+            out << "null";
+        }
+        else {
+            out << value;
+        }
+    }
+
+    //! \brief Writes the CSV header line.
+    inline void write_csv_header (std::ostream& out) {
+        out << "input,container,algorithm,variant,params,points,kept,runs,rejected,"
+               "min_ns,median_ns,p90_ns,mean_ns,median_ns_per_point,"
+               "error_mean,error_std,error_max";
+        for (unsigned e = 0; e < event_count; ++e) {
+            out << ',' << event_name (e) << "_per_point";
+        }
+        out << ",allocations,allocated_bytes,peak_heap_bytes,peak_rss_kb\n";
+    }
+
+    //! \brief Writes one record as a CSV line.
+    inline void write_csv (std::ostream& out, const record& r) {
+        double perPoint = r.points ? r.time.median / static_cast <double> (r.points) : 0;
+        out << r.input << ',' << r.container << ',' << r.algorithm << ',' << r.variant << ','
+            << r.params << ',' << r.points << ',' << r.kept << ','
+            << r.time.count << ',' << r.time.rejected << ','
+            << r.time.min << ',' << r.time.median << ',' << r.time.p90 << ',' << r.time.mean << ','
+            << perPoint << ','
+            << r.error.mean << ',' << r.error.std << ',' << r.error.max;
+        for (unsigned e = 0; e < event_count; ++e) {
+            out << ',';
+            write_csv_value (out, r.per_point (e));
+        }
+        out << ',';
+        write_csv_value (out, r.allocations);
+        out << ',';
+        write_csv_value (out, r.allocated_bytes);
+        out << ',';
+        write_csv_value (out, r.peak_heap_bytes);
+        out << ',';
+        write_csv_value (out, r.peak_rss_kb);
+        out << '\n';
+    }
+
+    //! \brief Writes all records as a JSON array of objects.
+    inline void write_json (std::ostream& out, const std::vector <record>& records) {
+        out << "[\n";
+        for (std::size_t i = 0; i < records.size (); ++i) {
+            const record& r = records [i];
+            out << "  {\"input\": ";
+            write_json_string (out, r.input);
+            out << ", \"container\": ";
+            write_json_string (out, r.container);
+            out << ", \"algorithm\": ";
+            write_json_string (out, r.algorithm);
+            out << ", \"variant\": ";
+            write_json_string (out, r.variant);
+            out << ", \"params\": ";
+            write_json_string (out, r.params);
+            out << ", \"points\": " << r.points
+                << ", \"kept\": " << r.kept
+                << ", \"time_ns\": {\"runs\": " << r.time.count
+                << ", \"rejected\": " << r.time.rejected
+                << ", \"min\": " << r.time.min
+                << ", \"median\": " << r.time.median
+                << ", \"p90\": " << r.time.p90
+                << ", \"mean\": " << r.time.mean << "}"
+                << ", \"error\": {\"mean\": " << r.error.mean
+                << ", \"std\": " << r.error.std
+                << ", \"max\": " << r.error.max << "}";
+            for (int perPoint = 0; perPoint < 2; ++perPoint) {
+                out << (perPoint ? ", \"events_per_point\": {" : ", \"events\": {");
+                for (unsigned e = 0; e < event_count; ++e) {
+                    out << (e ? ", \"" : "\"") << event_name (e) << "\": ";
+                    write_json_value (out, perPoint ? r.per_point (e) : r.events [e]);
+                }
+                out << "}";
+            }
+            out << ", \"memory\": {\"allocations\": ";
+            write_json_value (out, r.allocations);
+            out << ", \"allocated_bytes\": ";
+            write_json_value (out, r.allocated_bytes);
+            out << ", \"peak_heap_bytes\": ";
+            write_json_value (out, r.peak_heap_bytes);
+            out << ", \"peak_rss_kb\": ";
+            write_json_value (out, r.peak_rss_kb);
+            out << "}";
+            out << (i + 1 < records.size () ? "},\n" : "}\n");
+        }
+        out << "]\n";
+    }
+}}
+
+
+#endif // PSIMPL_BENCH
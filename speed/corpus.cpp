@@ -0,0 +1,211 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning.
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl, and is hosted at SourceForge:
+    http://sourceforge.net/projects/psimpl/
+*/
+
+
+#include "corpus.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace bench = psimpl::bench;
+
+// -----------------------------------------------------------------------------
+
+//! Writes points to a file through a large buffer, as text or raw binary
+class Writer
+{
+public:
+    Writer (std::FILE* file, unsigned dim, bool integer, bool binary) :
+        mFile (file),
+        mDim (dim),
+        mInteger (integer),
+        mBinary (binary),
+        mFailed (false)
+    {
+        mBuffer.reserve (1 << 20);
+    }
+
+    ~Writer () {
+        Flush ();
+    }
+
+    void operator() (const double* point) {
+        char* out = Reserve (mDim * 32);
+        for (unsigned d = 0; d < mDim; ++d) {
+            if (mBinary && mInteger) {
+                std::int32_t value = static_cast <std::int32_t> (point [d]);
+                std::memcpy (out, &value, sizeof (value));
+                out += sizeof (value);
+            }
+            else if (mBinary) {
+                std::memcpy (out, &point [d], sizeof (double));
+                out += sizeof (double);
+            }
+            else {
+                if (d) {
+                    *out++ = ',';
+                }
+                // shortest representation that round trips, much faster than printf
+                out = mInteger
+                    ? std::to_chars (out, out + 32, static_cast <long long> (point [d])).ptr
+                    : std::to_chars (out, out + 32, point [d]).ptr;
+            }
+        }
+        if (!mBinary) {
+            *out++ = '\n';
+        }
+        mBuffer.resize (static_cast <std::size_t> (out - mBuffer.data ()));
+    }
+
+    //! Writes all buffered points, returns false if any write failed
+    bool Flush () {
+        if (!mBuffer.empty ()) {
+            mFailed |= std::fwrite (mBuffer.data (), 1, mBuffer.size (), mFile) != mBuffer.size ();
+            mBuffer.clear ();
+        }
+        return !mFailed;
+    }
+
+private:
+    //! Returns a pointer to at least size free bytes at the end of the buffer
+    char* Reserve (std::size_t size) {
+        if (mBuffer.size () + size > mBuffer.capacity ()) {
+            Flush ();
+        }
+        std::size_t used = mBuffer.size ();
+        mBuffer.resize (used + size);
+        return mBuffer.data () + used;
+    }
+
+    std::FILE* mFile;
+    unsigned mDim;
+    bool mInteger;
+    bool mBinary;
+    bool mFailed;
+    std::vector <char> mBuffer;
+};
+
+// -----------------------------------------------------------------------------
+
+void Usage ()
+{
+    std::cerr <<
+        "usage: psimpl-corpus [options] kind count\n"
+        "\n"
+        "Streams count points of a deterministic synthetic polyline to stdout or a file. The\n"
+        "same kind, count and seed always give the same polyline. Text output has one point\n"
+        "per line with comma separated coordinates, as read by psimpl-bench from .poly files.\n"
+        "Binary output has the raw coordinates: doubles, or 32 bit integers for integer kinds.\n"
+        "\n"
+        "  --seed N       seed of the random generator (default 1)\n"
+        "  --binary       write binary instead of text\n"
+        "  --out FILE     write to FILE instead of stdout\n"
+        "\n"
+        "kinds:\n";
+    for (const bench::corpus_kind* kind = bench::corpus_kinds (); kind->name; ++kind) {
+        std::fprintf (stderr, "  %-14s %ud%s, %s\n", kind->name, kind->dim,
+                      kind->integer ? " integer" : "", kind->description);
+    }
+}
+
+int main (int argc, char* argv [])
+{
+    std::uint64_t seed = 1;
+    bool binary = false;
+    std::string outPath;
+    std::vector <std::string> positional;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv [i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seed" && hasValue) {
+            seed = std::strtoull (argv [++i], 0, 10);
+        }
+        else if (arg == "--binary") {
+            binary = true;
+        }
+        else if (arg == "--out" && hasValue) {
+            outPath = argv [++i];
+        }
+        else if (arg.size () > 1 && arg [0] == '-') {
+            Usage ();
+            return 2;
+        }
+        else {
+            positional.push_back (arg);
+        }
+    }
+    if (positional.size () != 2) {
+        Usage ();
+        return 2;
+    }
+    const bench::corpus_kind* kind = bench::find_corpus_kind (positional [0].c_str ());
+    if (!kind) {
+        std::cerr << "unknown kind " << positional [0] << std::endl;
+        Usage ();
+        return 2;
+    }
+    // accept counts like 1e9
+    double count = std::strtod (positional [1].c_str (), 0);
+    if (!(count >= 0 && count < 1e19)) {
+        std::cerr << "invalid count " << positional [1] << std::endl;
+        return 2;
+    }
+
+    std::FILE* file = outPath.empty () ? stdout : std::fopen (outPath.c_str (), binary ? "wb" : "w");
+    if (!file) {
+        std::cerr << "unable to open " << outPath << std::endl;
+        return 1;
+    }
+    bool ok;
+    {
+        Writer writer (file, kind->dim, kind->integer, binary);
+        bench::generate (kind->name, static_cast <std::uint64_t> (count), seed, writer);
+        ok = writer.Flush ();
+    }
+    ok = std::fflush (file) == 0 && ok;
+    if (file != stdout) {
+        ok = std::fclose (file) == 0 && ok;
+    }
+    if (!ok) {
+        std::cerr << "FAILED writing " << (outPath.empty () ? "stdout" : outPath) << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,505 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+#ifndef PSIMPL_BENCH_CORPUS
+#define PSIMPL_BENCH_CORPUS
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+namespace psimpl {
+    namespace bench
+{
+    /*!
+        \brief Deterministic pseudo random generator (splitmix64).
+
+        Unlike the distributions of <random>, the generated sequences are fully specified here,
+        so a seed gives the same corpus with every standard library.
+    */
+    class random
+    {
+    public:
+        explicit random (std::uint64_t seed) :
+            mState (seed),
+            mHasSpare (false),
+            mSpare (0)
+        {}
+
+        //! \brief Returns the next 64 random bits.
+        std::uint64_t next () {
+            std::uint64_t z = (mState += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        //! \brief Returns a uniform value in [0, 1).
+        double uniform () {
+            return static_cast <double> (next () >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        //! \brief Returns a uniform value in [a, b).
+        double uniform (double a, double b) {
+            return a + (b - a) * uniform ();
+        }
+
+        //! \brief Returns a standard normal value (Box-Muller).
+        double normal () {
+            if (mHasSpare) {
+                mHasSpare = false;
+                return mSpare;
+            }
+            double u = 1.0 - uniform ();    // (0, 1]
+            double v = uniform ();
+            double r = std::sqrt (-2.0 * std::log (u));
+            double a = 2.0 * 3.14159265358979323846 * v;
+            mSpare = r * std::sin (a);
+            mHasSpare = true;
+            return r * std::cos (a);
+        }
+
+    private:
+        std::uint64_t mState;
+        bool mHasSpare;
+        double mSpare;
+    };
+
+    // ---------------------------------------------------------------------------------------------
+
+    /*!
+        \brief GPS-like vehicle track: a smooth path with a persistent heading and varying speed,
+        occasional sharp turns, and measurement noise on every fix. Units are meters.
+    */
+    class gps_track
+    {
+    public:
+        static const unsigned DIM = 2;
+
+        explicit gps_track (std::uint64_t seed, double noise = 3.0) :
+            mRandom (seed),
+            mNoise (noise),
+            mHeading (0),
+            mSpeed (10)
+        {
+            mPosition [0] = mPosition [1] = 0;
+        }
+
+        //! \brief Writes the next point.
+        void operator() (double* point) {
+            point [0] = mPosition [0] + mNoise * mRandom.normal ();
+            point [1] = mPosition [1] + mNoise * mRandom.normal ();
+
+            // one fix per second
+            mHeading += 0.05 * mRandom.normal ();
+            if (mRandom.uniform () < 0.01) {
+                mHeading += mRandom.uniform (-1.5, 1.5);
+            }
+            mSpeed = std::min (30.0, std::max (0.5, mSpeed + 0.5 * mRandom.normal ()));
+            mPosition [0] += mSpeed * std::cos (mHeading);
+            mPosition [1] += mSpeed * std::sin (mHeading);
+        }
+
+    private:
+        random mRandom;
+        double mNoise;          //!< standard deviation of the measurement noise
+        double mHeading;        //!< direction of travel in radians
+        double mSpeed;          //!< meters per fix
+        double mPosition [2];   //!< true position
+    };
+
+    /*!
+        \brief Fractal coastline, generated by random midpoint displacement.
+
+        The subdivision is traversed depth first, so that points are produced in order while only
+        O(log n) segments are kept in memory. The displacement of a midpoint is proportional to
+        the length of its segment, which makes the line self-similar at every scale.
+    */
+    class coastline
+    {
+    public:
+        static const unsigned DIM = 2;
+
+        coastline (std::uint64_t seed, std::uint64_t count, double roughness = 0.25) :
+            mRandom (seed),
+            mRoughness (roughness),
+            mDepth (0),
+            mFirst (true)
+        {
+            while (count > 1 && (std::uint64_t (1) << mDepth) < count - 1) {
+                ++mDepth;
+            }
+            segment root = {{0, 0}, {1e6, 0}, 0};
+            mStack.push_back (root);
+        }
+
+        //! \brief Writes the next point; at most 2^depth + 1 points are generated.
+        void operator() (double* point) {
+            if (mFirst) {
+                mFirst = false;
+                point [0] = mStack.back ().a [0];
+                point [1] = mStack.back ().a [1];
+                return;
+            }
+            for (;;) {
+                segment s = mStack.back ();
+                mStack.pop_back ();
+                if (s.level == mDepth) {
+                    point [0] = s.b [0];
+                    point [1] = s.b [1];
+                    return;
+                }
+                // displace the midpoint perpendicular to the segment
+                double dx = s.b [0] - s.a [0];
+                double dy = s.b [1] - s.a [1];
+                double offset = mRoughness * mRandom.normal ();
+                segment left = {{s.a [0], s.a [1]}, {s.a [0] + dx / 2 - dy * offset, s.a [1] + dy / 2 + dx * offset}, s.level + 1};
+                segment right = {{left.b [0], left.b [1]}, {s.b [0], s.b [1]}, s.level + 1};
+                mStack.push_back (right);
+                mStack.push_back (left);
+            }
+        }
+
+    private:
+        struct segment {
+            double a [2];
+            double b [2];
+            unsigned level;
+        };
+
+        random mRandom;
+        double mRoughness;              //!< displacement relative to the segment length
+        unsigned mDepth;                //!< subdivision depth of the leaves
+        bool mFirst;                    //!< indicates if the first point is next
+        std::vector <segment> mStack;   //!< pending segments, depth first
+    };
+
+    /*!
+        \brief Sawtooth with growing teeth, a worst case for Douglas-Peucker.
+
+        Every other point is a tooth that is higher than all teeth before it, so that each key
+        search only splits off a few points at one end of the sub polyline, and the recursion
+        depth grows linearly with the number of points. Each coordinate is jittered slightly.
+    */
+    class sawtooth
+    {
+    public:
+        static const unsigned DIM = 2;
+
+        explicit sawtooth (std::uint64_t seed) :
+            mRandom (seed),
+            mIndex (0)
+        {}
+
+        //! \brief Writes the next point.
+        void operator() (double* point) {
+            point [0] = static_cast <double> (mIndex) + 0.01 * mRandom.uniform ();
+            point [1] = (mIndex % 2 ? static_cast <double> (mIndex) : 0.0) + 0.01 * mRandom.uniform ();
+            ++mIndex;
+        }
+
+    private:
+        random mRandom;
+        std::uint64_t mIndex;
+    };
+
+    /*!
+        \brief Archimedean spiral, winding inwards; a worst case for Douglas-Peucker.
+
+        The outer turns enclose all inner turns, so the farthest point from a chord lies near
+        its ends and most key searches peel off a single turn.
+    */
+    class spiral
+    {
+    public:
+        static const unsigned DIM = 2;
+
+        spiral (std::uint64_t seed, std::uint64_t count, unsigned pointsPerTurn = 64) :
+            mRandom (seed),
+            mCount (static_cast <double> (count)),
+            mStep (2 * 3.14159265358979323846 / pointsPerTurn),
+            mIndex (0)
+        {}
+
+        //! \brief Writes the next point.
+        void operator() (double* point) {
+            double angle = mStep * static_cast <double> (mIndex);
+            double radius = mCount - static_cast <double> (mIndex) + 1;
+            point [0] = radius * std::cos (angle) + 0.01 * mRandom.normal ();
+            point [1] = radius * std::sin (angle) + 0.01 * mRandom.normal ();
+            ++mIndex;
+        }
+
+    private:
+        random mRandom;
+        double mCount;          //!< total number of points, the initial radius
+        double mStep;           //!< angle between successive points
+        std::uint64_t mIndex;
+    };
+
+    /*!
+        \brief Dense clusters connected by sparse legs, stressing radial distance.
+
+        Like a GPS track that dwells in one place for a while: many points jitter around a
+        centroid, after which a few points travel to the next centroid.
+    */
+    class clusters
+    {
+    public:
+        static const unsigned DIM = 2;
+
+        explicit clusters (std::uint64_t seed) :
+            mRandom (seed),
+            mRemaining (0),
+            mDwelling (false)
+        {
+            mCenter [0] = mCenter [1] = 0;
+            mStep [0] = mStep [1] = 0;
+        }
+
+        //! \brief Writes the next point.
+        void operator() (double* point) {
+            if (!mRemaining) {
+                mDwelling = !mDwelling;
+                if (mDwelling) {
+                    mRemaining = 50 + mRandom.next () % 451;
+                }
+                else {
+                    mRemaining = 10 + mRandom.next () % 41;
+                    double distance = mRandom.uniform (100, 1000);
+                    double angle = mRandom.uniform (0, 2 * 3.14159265358979323846);
+                    mStep [0] = distance * std::cos (angle) / static_cast <double> (mRemaining);
+                    mStep [1] = distance * std::sin (angle) / static_cast <double> (mRemaining);
+                }
+            }
+            --mRemaining;
+            if (mDwelling) {
+                point [0] = mCenter [0] + 0.5 * mRandom.normal ();
+                point [1] = mCenter [1] + 0.5 * mRandom.normal ();
+            }
+            else {
+                mCenter [0] += mStep [0];
+                mCenter [1] += mStep [1];
+                point [0] = mCenter [0];
+                point [1] = mCenter [1];
+            }
+        }
+
+    private:
+        random mRandom;
+        std::uint64_t mRemaining;   //!< points left in the current dwell or leg
+        bool mDwelling;             //!< indicates if the current points form a cluster
+        double mCenter [2];         //!< centroid of the cluster, or position along the leg
+        double mStep [2];           //!< displacement per point along the leg
+    };
+
+    /*!
+        \brief 3d flight trajectory: a GPS-like track in the horizontal plane, with climb, cruise
+        and descent phases in altitude.
+    */
+    class trajectory
+    {
+    public:
+        static const unsigned DIM = 3;
+
+        explicit trajectory (std::uint64_t seed) :
+            mTrack (seed, 5.0),
+            mRandom (seed ^ 0x5bd1e995ull),
+            mAltitude (0),
+            mClimb (5),
+            mPhase (600)
+        {}
+
+        //! \brief Writes the next point.
+        void operator() (double* point) {
+            mTrack (point);
+            point [2] = mAltitude + 2.0 * mRandom.normal ();
+
+            if (!--mPhase) {
+                mPhase = 300 + mRandom.next () % 3000;
+                mClimb = mRandom.uniform (-8, 8);
+            }
+            mAltitude = std::max (0.0, mAltitude + mClimb);
+        }
+
+    private:
+        gps_track mTrack;
+        random mRandom;
+        double mAltitude;           //!< true altitude in meters
+        double mClimb;              //!< altitude change per point
+        std::uint64_t mPhase;       //!< points left in the current phase
+    };
+
+    /*!
+        \brief Sum of sines, the polyline generated by the demo application.
+    */
+    class sines
+    {
+    public:
+        static const unsigned DIM = 2;
+
+        sines (std::uint64_t seed, std::uint64_t count) :
+            mStep (2 * 3.14159265358979323846 / static_cast <double> (std::max <std::uint64_t> (count, 1))),
+            mScale (static_cast <double> (count)),
+            mIndex (0)
+        {
+            random r (seed);
+            mA = 1 + static_cast <int> (r.next () % 2);
+            mB = 2 + static_cast <int> (r.next () % 3);
+            mC = 3 + static_cast <int> (r.next () % 7);
+        }
+
+        //! \brief Writes the next point.
+        void operator() (double* point) {
+            double t = mStep * static_cast <double> (mIndex);
+            point [0] = static_cast <double> (mIndex);
+            point [1] = mScale * (std::cos (t * mA) / 3 + std::sin (t * mB) / 5 + std::sin (t * mC) / 10);
+            ++mIndex;
+        }
+
+    private:
+        double mStep;
+        double mScale;
+        std::uint64_t mIndex;
+        int mA, mB, mC;
+    };
+
+    // ---------------------------------------------------------------------------------------------
+
+    /*!
+        \brief Describes one kind of corpus polyline.
+    */
+    struct corpus_kind
+    {
+        const char* name;
+        unsigned dim;           //!< dimension of the points
+        bool integer;           //!< indicates if the coordinates are integers
+        const char* description;
+    };
+
+    //! \brief Returns the list of corpus kinds, terminated by an entry without name.
+    inline const corpus_kind* corpus_kinds () {
+        static const corpus_kind kinds [] = {
+            {"gps", 2, false, "noisy vehicle track, meters"},
+            {"gps_int", 2, true, "noisy vehicle track, integer centimeters"},
+            {"coastline", 2, false, "fractal coastline by midpoint displacement"},
+            {"sawtooth", 2, false, "sawtooth with growing teeth, a DP worst case"},
+            {"spiral", 2, false, "inward spiral, a DP worst case"},
+            {"clusters", 2, false, "dense clusters joined by sparse legs, for RD"},
+            {"trajectory", 3, false, "flight trajectory with altitude, meters"},
+            {"sines", 2, false, "sum of sines, as generated by the demo"},
+            {0, 0, false, 0}
+        };
+        return kinds;
+    }
+
+    //! \brief Returns the corpus kind with the given name, or 0 if there is none.
+    inline const corpus_kind* find_corpus_kind (const char* name) {
+        for (const corpus_kind* kind = corpus_kinds (); kind->name; ++kind) {
+            if (std::strcmp (kind->name, name) == 0) {
+                return kind;
+            }
+        }
+        return 0;
+    }
+
+    //! \brief Streams count points of a generator to sink.
+    template <typename Generator, typename Sink>
+    void stream (Generator generator, std::uint64_t count, Sink& sink) {
+        double point [Generator::DIM];
+        for (std::uint64_t i = 0; i < count; ++i) {
+            generator (point);
+            sink (point);
+        }
+    }
+
+    /*!
+        \brief Generates count points of a corpus kind, and streams them to sink.
+
+        The sink is called once per point with a pointer to its kind->dim coordinates. The
+        coordinates of integer kinds are integral values. The same kind, count and seed always
+        give the same points, and the points of a smaller count are a prefix of those of a
+        larger count, except for coastline and spiral whose shape depends on count.
+
+        \return false if the kind is unknown
+    */
+    template <typename Sink>
+    bool generate (const char* kind, std::uint64_t count, std::uint64_t seed, Sink& sink) {
+        std::string name = kind;
+        if (name == "gps") {
+            stream (gps_track (seed), count, sink);
+        }
+        else if (name == "gps_int") {
+            struct rounding {
+                Sink& sink;
+                void operator() (double* point) {
+                    point [0] = std::floor (point [0] * 100 + 0.5);
+                    point [1] = std::floor (point [1] * 100 + 0.5);
+                    sink (point);
+                }
+            } round = {sink};
+            stream (gps_track (seed), count, round);
+        }
+        else if (name == "coastline") {
+            stream (coastline (seed, count), count, sink);
+        }
+        else if (name == "sawtooth") {
+            stream (sawtooth (seed), count, sink);
+        }
+        else if (name == "spiral") {
+            stream (spiral (seed, count), count, sink);
+        }
+        else if (name == "clusters") {
+            stream (clusters (seed), count, sink);
+        }
+        else if (name == "trajectory") {
+            stream (trajectory (seed), count, sink);
+        }
+        else if (name == "sines") {
+            stream (sines (seed, count), count, sink);
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+}}
+
+
+#endif // PSIMPL_BENCH_CORPUS
@@ -0,0 +1,338 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning.
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl, and is hosted at SourceForge:
+    http://sourceforge.net/projects/psimpl/
+*/
+
+
+
+#include "bench.h"
+#include "corpus.h"
+
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <list>
+#include <string>
+#include <vector>
+
+
+namespace bench = psimpl::bench;
+
+// -----------------------------------------------------------------------------
+
+/*
+    The measured kernels. Each is called with three consecutive points (a, b, p) of a polyline,
+    the way the algorithms call them: point_distance2 measures a to b, the others measure p to
+    the line, ray or segment through a and b.
+*/
+struct PointDistance
+{
+    static const char* Name () { return "point_distance2"; }
+
+    template <unsigned DIM, typename Iterator>
+    static typename psimpl::util::select_calculation_type <Iterator>::type Apply (Iterator a, Iterator b, Iterator) {
+        return psimpl::math::point_distance2 <DIM> (a, b);
+    }
+};
+
+struct LineDistance
+{
+    static const char* Name () { return "line_distance2"; }
+
+    template <unsigned DIM, typename Iterator>
+    static typename psimpl::util::select_calculation_type <Iterator>::type Apply (Iterator a, Iterator b, Iterator p) {
+        return psimpl::math::line_distance2 <DIM> (a, b, p);
+    }
+};
+
+struct RayDistance
+{
+    static const char* Name () { return "ray_distance2"; }
+
+    template <unsigned DIM, typename Iterator>
+    static typename psimpl::util::select_calculation_type <Iterator>::type Apply (Iterator a, Iterator b, Iterator p) {
+        return psimpl::math::ray_distance2 <DIM> (a, b, p);
+    }
+};
+
+struct SegmentDistance
+{
+    static const char* Name () { return "segment_distance2"; }
+
+    template <unsigned DIM, typename Iterator>
+    static typename psimpl::util::select_calculation_type <Iterator>::type Apply (Iterator a, Iterator b, Iterator p) {
+        return psimpl::math::segment_distance2 <DIM> (a, b, p);
+    }
+};
+
+//! Type names, as written to the CSV
+template <typename T> const char* TypeName ();
+template <> const char* TypeName <float> () { return "float"; }
+template <> const char* TypeName <double> () { return "double"; }
+template <> const char* TypeName <int> () { return "int"; }
+
+// -----------------------------------------------------------------------------
+
+//! Measurements of one kernel, for one dimension, value type and iterator type
+struct Result
+{
+    std::string kernel;
+    unsigned dim;
+    std::string type;
+    std::string container;
+    std::uint64_t calls;        //!< kernel calls per run
+    double median;              //!< median duration of a run in nanoseconds
+    double cycles;              //!< median cycles of a run, NaN if unknown
+};
+
+//! Settings and state shared by all measurements
+struct Context
+{
+    Context () :
+        points (4096),
+        ghz (0),
+        counters (0)
+    {}
+
+    bench::options opts;
+    std::uint64_t points;               //!< points per run
+    double ghz;                         //!< clock frequency to derive cycles from, when not counted
+    std::string filter;                 //!< only measure kernels whose label contains filter
+    bench::perf_counters* counters;
+    std::vector <Result> results;
+};
+
+void WriteCsv (std::ostream& out, const std::vector <Result>& results)
+{
+    out << "kernel,dim,type,container,calls,median_ns,ns_per_point,points_per_cycle\n";
+    for (const Result& r : results) {
+        out << r.kernel << ',' << r.dim << ',' << r.type << ',' << r.container << ','
+            << r.calls << ',' << r.median << ',' << r.median / r.calls << ',';
+        bench::write_csv_value (out, r.calls / r.cycles);
+        out << '\n';
+    }
+}
+
+/*
+    Slides a window of three consecutive points over the polyline at first, and calls the
+    kernel for each window. Advancing the iterators is part of the cost, as it is for the
+    algorithms; for lists it usually dominates.
+*/
+template <unsigned DIM, typename Kernel, typename Iterator>
+double Sweep (Iterator first, std::uint64_t points)
+{
+    Iterator a = first;
+    Iterator b = a;
+    std::advance (b, DIM);
+    Iterator p = b;
+    std::advance (p, DIM);
+
+    double sum = 0;
+    for (std::uint64_t i = 2; i < points; ++i) {
+        sum += Kernel::template Apply <DIM> (a, b, p);
+        a = b;
+        b = p;
+        std::advance (p, DIM);
+    }
+    return sum;
+}
+
+//! Measures one kernel for the polyline at first
+template <unsigned DIM, typename Kernel, typename Iterator>
+void Run (Context& ctx, const char* type, const char* container, Iterator first)
+{
+    Result r;
+    r.kernel = Kernel::Name ();
+    r.dim = DIM;
+    r.type = type;
+    r.container = container;
+    r.calls = ctx.points - 2;
+
+    std::string label = r.kernel + "/" + std::to_string (DIM) + "/" + type + "/" + container;
+    if (label.find (ctx.filter) == std::string::npos) {
+        return;
+    }
+
+    auto run = [&] { bench::keep (Sweep <DIM, Kernel> (first, ctx.points)); };
+    for (unsigned i = 0; i < ctx.opts.warmup; ++i) {
+        run ();
+    }
+    // batch runs so that the timer and counter overhead is negligible
+    unsigned iterations = bench::calibrate (run, 2e5);
+    std::vector <double> samples;
+    std::vector <double> counts [bench::event_count];
+    for (unsigned i = 0; i < ctx.opts.repeat; ++i) {
+        double events [bench::event_count];
+        samples.push_back (bench::measure_once (run, iterations, *ctx.counters, events));
+        for (unsigned e = 0; e < bench::event_count; ++e) {
+            counts [e].push_back (events [e]);
+        }
+    }
+    double events [bench::event_count];
+    bench::median_events (counts, events);
+
+    r.median = bench::summarize (samples).median;
+    r.cycles = events [bench::cycles];
+    if (std::isnan (r.cycles) && ctx.ghz > 0) {
+        r.cycles = r.median * ctx.ghz;
+    }
+    ctx.results.push_back (r);
+    std::cerr << "  " << label << ": " << r.median / r.calls << " ns/point, "
+              << r.calls / r.cycles << " points/cycle" << std::endl;
+}
+
+//! Returns the coordinates of count random points, in [-1000, 1000)
+template <typename T>
+std::vector <T> Coordinates (std::uint64_t count, unsigned dim)
+{
+    bench::random random (dim);
+    std::vector <T> coords (count * dim);
+    for (T& coord : coords) {
+        coord = static_cast <T> (random.uniform (-1000, 1000));
+    }
+    return coords;
+}
+
+//! Measures all kernels for one dimension and value type, with each iterator type
+template <unsigned DIM, typename T>
+void RunType (Context& ctx)
+{
+    std::vector <T> coords = Coordinates <T> (ctx.points, DIM);
+    std::deque <T> deque (coords.begin (), coords.end ());
+    std::list <T> list (coords.begin (), coords.end ());
+
+    #define PSIMPL_RUN_KERNEL(Kernel)                                                   \
+        Run <DIM, Kernel> (ctx, TypeName <T> (), "pointer", coords.data ());            \
+        Run <DIM, Kernel> (ctx, TypeName <T> (), "vector", coords.cbegin ());           \
+        Run <DIM, Kernel> (ctx, TypeName <T> (), "deque", deque.cbegin ());             \
+        Run <DIM, Kernel> (ctx, TypeName <T> (), "list", list.cbegin ());
+
+    PSIMPL_RUN_KERNEL(PointDistance)
+    PSIMPL_RUN_KERNEL(LineDistance)
+    PSIMPL_RUN_KERNEL(RayDistance)
+    PSIMPL_RUN_KERNEL(SegmentDistance)
+
+    #undef PSIMPL_RUN_KERNEL
+}
+
+//! Measures all kernels for one dimension
+template <unsigned DIM>
+void RunDim (Context& ctx)
+{
+    RunType <DIM, float> (ctx);
+    RunType <DIM, double> (ctx);
+    RunType <DIM, int> (ctx);
+}
+
+// -----------------------------------------------------------------------------
+
+void Usage ()
+{
+    std::cerr <<
+        "usage: psimpl-kernels [options]\n"
+        "\n"
+        "Measures the distance kernels of psimpl (point_distance2, line_distance2,\n"
+        "ray_distance2 and segment_distance2) in isolation, for 1 to 4 dimensions, float,\n"
+        "double and int coordinates, and pointer, vector, deque and list iterators.\n"
+        "Writes ns per point and points per cycle as CSV. Cycles are counted by the hardware;\n"
+        "where that is not possible they are derived from --ghz, or left empty.\n"
+        "\n"
+        "  --points N        points per run, chosen to stay in cache (default 4096)\n"
+        "  --filter S        only kernels whose kernel/dim/type/container label contains S,\n"
+        "                    e.g. segment_distance2/2/double\n"
+        "  --repeat N        number of timed runs (default 15)\n"
+        "  --warmup N        number of untimed runs before timing (default 2)\n"
+        "  --ghz F           clock frequency, for points per cycle without hardware counters\n"
+        "  --no-counters     do not count hardware events\n"
+        "  --csv FILE        write CSV to FILE instead of stdout\n";
+}
+
+int main (int argc, char* argv [])
+{
+    Context ctx;
+    bool counters = true;
+    std::string csvPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv [i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--points" && hasValue) {
+            ctx.points = static_cast <std::uint64_t> (std::strtod (argv [++i], 0));
+        }
+        else if (arg == "--filter" && hasValue) {
+            ctx.filter = argv [++i];
+        }
+        else if (arg == "--repeat" && hasValue) {
+            ctx.opts.repeat = static_cast <unsigned> (std::max (1, std::atoi (argv [++i])));
+        }
+        else if (arg == "--warmup" && hasValue) {
+            ctx.opts.warmup = static_cast <unsigned> (std::max (0, std::atoi (argv [++i])));
+        }
+        else if (arg == "--ghz" && hasValue) {
+            ctx.ghz = std::strtod (argv [++i], 0);
+        }
+        else if (arg == "--no-counters") {
+            counters = false;
+        }
+        else if (arg == "--csv" && hasValue) {
+            csvPath = argv [++i];
+        }
+        else {
+            Usage ();
+            return 2;
+        }
+    }
+    if (ctx.points < 3) {
+        std::cerr << "need at least 3 points" << std::endl;
+        return 2;
+    }
+
+    bench::perf_counters perf (counters);
+    ctx.counters = &perf;
+    if (!perf.available (bench::cycles) && ctx.ghz <= 0) {
+        std::cerr << "cycles are not counted, points per cycle needs --ghz" << std::endl;
+    }
+
+    RunDim <1> (ctx);
+    RunDim <2> (ctx);
+    RunDim <3> (ctx);
+    RunDim <4> (ctx);
+
+    std::ofstream csvFile;
+    if (!csvPath.empty ()) {
+        csvFile.open (csvPath);
+    }
+    std::ostream& csv = csvPath.empty () ? std::cout : csvFile;
+    csv.precision (6);
+    WriteCsv (csv, ctx.results);
+    return 0;
+}
@@ -31,533 +31,750 @@
     http://sourceforge.net/projects/psimpl/
 */
 
-#include "psimpl.h"
-// cheat!
+
+#include "bench.h"
+#define PSIMPL_BENCH_ALLOCATION_HOOKS
+#include "alloc.h"
 #include "../demo/psimpl_reference.h"
 #include "prev/psimpl.h"
-#include "clocktic.h"
 
-#include <iostream>
-#include <vector>
+#include <cmath>
+#include <cstdlib>
 #include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
 #include <list>
-#include <QDirIterator>
-#include <QFileInfo>
-#include <QStringList>
-#include <QPair>
-#include <QVector>
-#include <QTextStream>
-
-
-using Setting = QPair <QString, QStringList>;
-using Settings = QVector <Setting> ;
+#include <map>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 
 const unsigned DIM = 2;
-      unsigned repeat = 5;
+
+namespace bench = psimpl::bench;
 
 // -----------------------------------------------------------------------------
 
-class BenchmarkController
+//! An algorithm and its parameters, as read from one line of an .algo file
+struct Setting
 {
-public:
-    BenchmarkController (unsigned& result) :
-        mResult (result),
-        mRepeat (repeat)
-    {
-        mTicks = clock_tics ();
+    std::string algorithm;
+    std::vector <std::string> params;
+
+    double Real (std::size_t i) const {
+        return i < params.size () ? std::atof (params [i].c_str ()) : 0;
     }
 
-    ~BenchmarkController () {
-        const auto index = repeat / 2;
-        qSort (mMeasurements);
-        mResult = mMeasurements [index];
+    unsigned Count (std::size_t i) const {
+        return i < params.size () ? static_cast <unsigned> (std::strtoul (params [i].c_str (), 0, 10)) : 0;
     }
-    BenchmarkController(const BenchmarkController&) = default;
-    BenchmarkController& operator = (const BenchmarkController&) = default;
-    BenchmarkController(BenchmarkController&&) = default;
-    BenchmarkController& operator = (BenchmarkController&&) = default;
 
-    void StartMeasurement () {
-        const auto measurement = clock_tics () - mTicks;
-        mMeasurements.push_back (measurement);
-        --mRepeat;
-        mTicks = clock_tics ();
+    std::string Joined () const {
+        std::string result;
+        for (std::size_t i = 0; i < params.size (); ++i) {
+            result += (i ? ";" : "") + params [i];
+        }
+        return result;
     }
+};
 
-    bool IsDone () {
-        return mRepeat == 0;
+/*
+    Returns true if the psimpl implementation of an algorithm claims to be allocation free.
+    Checked when allocations are tracked.
+*/
+bool ClaimsNoAllocations (const std::string& algorithm)
+{
+    static const char* claims [] = {
+        "simplify_nth_point",
+        "simplify_radial_distance",
+        "simplify_reumann_witkam",
+        "simplify_opheim",
+        "simplify_lang",
+        "simplify_sleeve_fitting",
+        0
+    };
+    for (const char** claim = claims; *claim; ++claim) {
+        if (algorithm == *claim) {
+            return true;
+        }
     }
+    return false;
+}
 
-private:
-    unsigned& mResult;
-    unsigned mRepeat;
-    unsigned long mTicks;
-    QVector <unsigned> mMeasurements;
-};
+//! A measured implementation: writes the simplification to result and returns its end
+using Run = std::function <double* (double*)>;
 
-#define BENCHMARK(elapsed) for (BenchmarkController ctrl (elapsed); !ctrl.IsDone (); ctrl.StartMeasurement ())
+//! An implementation variant and how to run it
+using Variant = std::pair <std::string, Run>;
 
 // -----------------------------------------------------------------------------
 
+/*
+    Returns the runs for a setting: psimpl itself, followed by what it is compared against.
+    Algorithms that require random access iterators are skipped for other containers.
+*/
 template <class Iterator>
-void Benchmark_Ran (
-    const std::string& container,
-    const Iterator& first,
-    const Iterator& last,
-    const Settings& settings)
+std::vector <Variant> Variants (const Setting& s, Iterator first, Iterator last)
 {
-    // benchmark all algorithms that support at least random iterators
-    const auto polylineSize = std::distance (first, last);
-    unsigned newElapsed = 0;
-    unsigned oldElapsed = 0;
-
-    for (const Setting& setting : settings)
-    {
-        psimpl::util::scoped_array <double> newSimplification (polylineSize);
-        psimpl::error::statistics newStats;
-        int newSimplificationSize = 0;
-
-        psimpl::util::scoped_array <double> oldSimplification (polylineSize);
-        psimpl::error::statistics oldStats;
-        int oldSimplificationSize = 0;
-
-        if (setting.first == "simplify_nth_point") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_nth_point <DIM> (first, last, setting.second [0].toUInt (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_nth_point <DIM> (first, last, setting.second [0].toUInt (), oldSimplification.get ()));
-            }
+    constexpr bool random = std::is_base_of <std::random_access_iterator_tag,
+        typename std::iterator_traits <Iterator>::iterator_category>::value;
+
+    std::vector <Variant> variants;
+    const std::string& a = s.algorithm;
+
+    if (a == "simplify_nth_point") {
+        variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_nth_point <DIM> (first, last, s.Count (0), r); });
+        variants.emplace_back ("prev", [=] (double* r) { return psimpl_prev::simplify_nth_point <DIM> (first, last, s.Count (0), r); });
+    }
+    else if (a == "simplify_radial_distance") {
+        variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_radial_distance <DIM> (first, last, s.Real (0), r); });
+        variants.emplace_back ("prev", [=] (double* r) { return psimpl_prev::simplify_radial_distance <DIM> (first, last, s.Real (0), r); });
+    }
+    else if (a == "simplify_perpendicular_distance") {
+        variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_perpendicular_distance <DIM> (first, last, s.Real (0), s.Count (1), r); });
+        variants.emplace_back ("prev", [=] (double* r) { return psimpl_prev::simplify_perpendicular_distance <DIM> (first, last, s.Real (0), s.Count (1), r); });
+    }
+    else if (a == "simplify_reumann_witkam") {
+        variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_reumann_witkam <DIM> (first, last, s.Real (0), r); });
+        variants.emplace_back ("prev", [=] (double* r) { return psimpl_prev::simplify_reumann_witkam <DIM> (first, last, s.Real (0), r); });
+    }
+    else if (a == "simplify_opheim") {
+        variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_opheim <DIM> (first, last, s.Real (0), s.Real (1), r); });
+        variants.emplace_back ("prev", [=] (double* r) { return psimpl_prev::simplify_opheim <DIM> (first, last, s.Real (0), s.Real (1), r); });
+    }
+    else if (a == "simplify_lang") {
+        variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_lang <DIM> (first, last, s.Real (0), s.Count (1), r); });
+        variants.emplace_back ("prev", [=] (double* r) { return psimpl_prev::simplify_lang <DIM> (first, last, s.Real (0), s.Count (1), r); });
+    }
+    else if (a == "simplify_douglas_peucker") {
+        variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_douglas_peucker <DIM> (first, last, s.Real (0), r); });
+        variants.emplace_back ("prev", [=] (double* r) { return psimpl_prev::simplify_douglas_peucker <DIM> (first, last, s.Real (0), r); });
+    }
+    // sleeve fitting is compared against reumann witkam, which uses the same tolerance type
+    else if (a == "simplify_sleeve_fitting") {
+        variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_sleeve_fitting <DIM> (first, last, s.Real (0), r); });
+        variants.emplace_back ("baseline", [=] (double* r) { return psimpl::simplify_reumann_witkam <DIM> (first, last, s.Real (0), r); });
+    }
+    // optimal routines are compared against douglas peucker, which uses the same tolerance type
+    else if (a == "simplify_optimal") {
+        variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_optimal <DIM> (first, last, s.Real (0), r); });
+        variants.emplace_back ("baseline", [=] (double* r) { return psimpl::simplify_douglas_peucker <DIM> (first, last, s.Real (0), r); });
+    }
+    else if (a == "simplify_optimal_windowed") {
+        variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_optimal_windowed <DIM> (first, last, s.Real (0), s.Count (1), r); });
+        variants.emplace_back ("baseline", [=] (double* r) { return psimpl::simplify_douglas_peucker <DIM> (first, last, s.Real (0), r); });
+    }
+    else if constexpr (random) {
+        if (a == "simplify_douglas_peucker_classic") {
+            variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_douglas_peucker_classic <DIM> (first, last, s.Real (0), r); });
         }
-        else if (setting.first == "simplify_radial_distance") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_radial_distance <DIM> (first, last, setting.second [0].toDouble (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_radial_distance <DIM> (first, last, setting.second [0].toDouble (), oldSimplification.get ()));
-            }
+        else if (a == "simplify_douglas_peucker_pruned") {
+            variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_douglas_peucker_pruned <DIM> (first, last, s.Real (0), r); });
+            variants.emplace_back ("baseline", [=] (double* r) { return psimpl::simplify_douglas_peucker_classic <DIM> (first, last, s.Real (0), r); });
         }
-        else if (setting.first == "simplify_perpendicular_distance") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_perpendicular_distance <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toUInt (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_perpendicular_distance <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toUInt (), oldSimplification.get ()));
-            }
+        else if (a == "simplify_douglas_peucker_n") {
+            variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_douglas_peucker_n <DIM> (first, last, s.Count (0), r); });
+            variants.emplace_back ("prev", [=] (double* r) { return psimpl_prev::simplify_douglas_peucker_n <DIM> (first, last, s.Count (0), r); });
         }
-        else if (setting.first == "simplify_reumann_witkam") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                   psimpl::simplify_reumann_witkam <DIM> (first, last, setting.second [0].toDouble (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                   psimpl_prev::simplify_reumann_witkam <DIM> (first, last, setting.second [0].toDouble (), oldSimplification.get ()));
-            }
+        // parallel routines are compared against their serial equivalents
+        else if (a == "simplify_nth_point_parallel") {
+            variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_nth_point_parallel <DIM> (first, last, s.Count (0), r); });
+            variants.emplace_back ("baseline", [=] (double* r) { return psimpl::simplify_nth_point <DIM> (first, last, s.Count (0), r); });
         }
-        else if (setting.first == "simplify_opheim") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_opheim <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toDouble (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_opheim <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toDouble (), oldSimplification.get ()));
-            }
+        else if (a == "simplify_radial_distance_parallel") {
+            variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_radial_distance_parallel <DIM> (first, last, s.Real (0), r); });
+            variants.emplace_back ("baseline", [=] (double* r) { return psimpl::simplify_radial_distance <DIM> (first, last, s.Real (0), r); });
         }
-        else if (setting.first == "simplify_lang") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_lang <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toUInt (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_lang <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toUInt (), oldSimplification.get ()));
-            }
+        else if (a == "simplify_reumann_witkam_parallel") {
+            variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_reumann_witkam_parallel <DIM> (first, last, s.Real (0), r); });
+            variants.emplace_back ("baseline", [=] (double* r) { return psimpl::simplify_reumann_witkam <DIM> (first, last, s.Real (0), r); });
         }
-        else if (setting.first == "simplify_douglas_peucker_classic") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_douglas_peucker_classic <DIM> (first, last, setting.second [0].toDouble (), newSimplification.get ()));
-            }
+        else if (a == "simplify_opheim_parallel") {
+            variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_opheim_parallel <DIM> (first, last, s.Real (0), s.Real (1), r); });
+            variants.emplace_back ("baseline", [=] (double* r) { return psimpl::simplify_opheim <DIM> (first, last, s.Real (0), s.Real (1), r); });
         }
-        else if (setting.first == "simplify_douglas_peucker") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_douglas_peucker <DIM> (first, last, setting.second [0].toDouble (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_douglas_peucker <DIM> (first, last, setting.second [0].toDouble (), oldSimplification.get ()));
-            }
+        else if (a == "simplify_lang_parallel") {
+            variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_lang_parallel <DIM> (first, last, s.Real (0), s.Count (1), r); });
+            variants.emplace_back ("baseline", [=] (double* r) { return psimpl::simplify_lang <DIM> (first, last, s.Real (0), s.Count (1), r); });
         }
-        else if (setting.first == "simplify_douglas_peucker_n") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_douglas_peucker_n <DIM> (first, last, setting.second [0].toUInt (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_douglas_peucker_n <DIM> (first, last, setting.second [0].toUInt (), oldSimplification.get ()));
-            }
+        else if (a == "simplify_douglas_peucker_n_parallel") {
+            variants.emplace_back ("psimpl", [=] (double* r) { return psimpl::simplify_douglas_peucker_n_parallel <DIM> (first, last, s.Count (0), r); });
+            variants.emplace_back ("baseline", [=] (double* r) { return psimpl::simplify_douglas_peucker_n <DIM> (first, last, s.Count (0), r); });
         }
-        else {
-            continue;
-        }
-
-        newStats = psimpl::compute_positional_error_statistics <DIM> (first, last, newSimplification.get (), newSimplification.get () + newSimplificationSize);
-        oldStats = psimpl::compute_positional_error_statistics <DIM> (first, last, oldSimplification.get (), oldSimplification.get () + oldSimplificationSize);
+    }
+    return variants;
+}
 
-        std::cout << container << ",";
-        QTextStream(stdout) << setting.first << ",";
-        std::cout << newSimplificationSize / DIM << "," << (int) (((float) newSimplificationSize / (float) polylineSize) * 100.f) << "%,";
-        std::cout << newElapsed << "," << newStats.mean << "," << newStats.std << "," << newStats.max << "," << newStats.sum << ",";
-        if (oldElapsed) {
-            std::cout << oldElapsed << "," << oldStats.mean << "," << oldStats.std << "," << oldStats.max << "," << oldStats.sum << ",";
-            std::cout << (int) ((((float) oldElapsed - (float) newElapsed) / (float) oldElapsed) * 100.f) << "%";
-        }
-        std::cout << std::endl;
+/*
+    Returns the run of the reference Douglas-Peucker implementation. The conversion of the
+    polyline to and from reference::Point is done outside of the measured run.
+*/
+Variant Reference (const Setting& s, const std::vector <double>& polyline)
+{
+    struct Buffers {
+        std::vector <psimpl::reference::Point> points;
+        std::vector <psimpl::reference::Point> simplified;
+    };
+    auto buffers = std::make_shared <Buffers> ();
+    for (std::size_t i = 0; i + 1 < polyline.size (); i += DIM) {
+        psimpl::reference::Point p;
+        p.x = polyline [i];
+        p.y = polyline [i + 1];
+        buffers->points.push_back (p);
     }
+    buffers->simplified.resize (buffers->points.size ());
+
+    return Variant ("reference", [=] (double* r) {
+        int count = psimpl::reference::poly_simplify (
+            s.Real (0), &buffers->points [0], static_cast <int> (buffers->points.size ()), &buffers->simplified [0]);
+        for (int i = 0; i < count; ++i) {
+            *r++ = buffers->simplified [i].x;
+            *r++ = buffers->simplified [i].y;
+        }
+        return r;
+    });
 }
 
 // -----------------------------------------------------------------------------
 
+/*
+    Measures all settings for one container, and appends a record per variant.
+
+    The variants of a setting are timed in interleaved rounds, so that slow drifts in the speed
+    of the machine affect them alike, and the ratios of their timings in the same round can be
+    compared as pairs. Short runs are repeated until a sample takes at least 0.2 ms.
+*/
 template <class Iterator>
-void Benchmark_Bid (
+void Benchmark (
+    const std::string& input,
     const std::string& container,
-    const Iterator& first,
-    const Iterator& last,
-    const Settings& settings)
+    Iterator first,
+    Iterator last,
+    const std::vector <double>& polyline,
+    const std::vector <Setting>& settings,
+    const bench::options& opts,
+    bench::perf_counters& counters,
+    bool trackAllocations,
+    std::vector <bench::record>& records,
+    int& failed)
 {
-    // benchmark all algorithms that support at least bidirectional iterators
-    const auto polylineSize = std::distance (first, last);
-    unsigned newElapsed = 0;
-    unsigned oldElapsed = 0;
-
-    for (const Setting& setting : settings)
-    {
-        psimpl::util::scoped_array <double> newSimplification (polylineSize);
-        psimpl::error::statistics newStats;
-        int newSimplificationSize = 0;
-
-        psimpl::util::scoped_array <double> oldSimplification (polylineSize);
-        psimpl::error::statistics oldStats;
-        int oldSimplificationSize = 0;
-
-        if (setting.first == "simplify_nth_point") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_nth_point <DIM> (first, last, setting.second [0].toUInt (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_nth_point <DIM> (first, last, setting.second [0].toUInt (), oldSimplification.get ()));
-            }
+    std::vector <double> simplification (polyline.size ());
+    std::vector <double> expected;      // simplification by psimpl, compared against prev
+
+    for (const Setting& setting : settings) {
+        std::vector <Variant> variants = Variants (setting, first, last);
+        if (setting.algorithm == "simplify_douglas_peucker" && container == "double []") {
+            variants.push_back (Reference (setting, polyline));
         }
-        else if (setting.first == "simplify_radial_distance") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_radial_distance <DIM> (first, last, setting.second [0].toDouble (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_radial_distance <DIM> (first, last, setting.second [0].toDouble (), oldSimplification.get ()));
-            }
+
+        struct Timing {
+            std::function <void ()> run;
+            unsigned iterations;
+            std::vector <double> samples;
+            std::vector <double> counts [bench::event_count];
+        };
+        std::vector <Timing> timings (variants.size ());
+        for (std::size_t v = 0; v < variants.size (); ++v) {
+            Timing& timing = timings [v];
+            const Run& run = variants [v].second;
+            timing.run = [&] { bench::keep (run (&simplification [0])); };
+            for (unsigned i = 0; i < opts.warmup; ++i) {
+                timing.run ();
+            }
+            timing.iterations = bench::calibrate (timing.run, 2e5);
         }
-        else if (setting.first == "simplify_perpendicular_distance") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_perpendicular_distance <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toUInt (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_perpendicular_distance <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toUInt (), oldSimplification.get ()));
+        for (unsigned i = 0; i < opts.repeat; ++i) {
+            for (Timing& timing : timings) {
+                double events [bench::event_count];
+                timing.samples.push_back (bench::measure_once (timing.run, timing.iterations, counters, events));
+                for (unsigned e = 0; e < bench::event_count; ++e) {
+                    timing.counts [e].push_back (events [e]);
+                }
             }
         }
-        else if (setting.first == "simplify_reumann_witkam") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                   psimpl::simplify_reumann_witkam <DIM> (first, last, setting.second [0].toDouble (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                   psimpl_prev::simplify_reumann_witkam <DIM> (first, last, setting.second [0].toDouble (), oldSimplification.get ()));
-            }
+
+        for (std::size_t v = 0; v < variants.size (); ++v) {
+            const Variant& variant = variants [v];
+            bench::record r;
+            r.samples = timings [v].samples;
+            r.time = bench::summarize (r.samples);
+            bench::median_events (timings [v].counts, r.events);
+
+            // one more, untimed run for the simplification and its heap usage
+            double* end = 0;
+            bench::reset_peak_rss ();
+            bench::allocation_stats stats = bench::count_allocations ([&] {
+                end = variant.second (&simplification [0]);
+            });
+            if (trackAllocations) {
+                long rss = bench::peak_rss_kb ();
+                r.allocations = static_cast <double> (stats.calls);
+                r.allocated_bytes = static_cast <double> (stats.bytes);
+                r.peak_heap_bytes = static_cast <double> (stats.peak);
+                r.peak_rss_kb = rss < 0 ? r.peak_rss_kb : static_cast <double> (rss);
+                if (stats.calls && variant.first == "psimpl" && ClaimsNoAllocations (setting.algorithm)) {
+                    std::cerr << "FAILED " << setting.algorithm << " claims to be allocation free, but made "
+                              << stats.calls << " allocations on " << container << std::endl;
+                    ++failed;
+                }
+            }
+
+            if (variant.first == "psimpl") {
+                expected.assign (&simplification [0], end);
+            }
+            else if (variant.first == "prev") {
+                r.matches = std::equal (expected.begin (), expected.end (), &simplification [0], end);
+                if (!r.matches) {
+                    std::cerr << "  " << container << " " << setting.algorithm << " (" << setting.Joined ()
+                              << ") differs from the previous version" << std::endl;
+                }
+            }
+
+            r.input = input;
+            r.container = container;
+            r.algorithm = setting.algorithm;
+            r.variant = variant.first;
+            r.params = setting.Joined ();
+            r.points = polyline.size () / DIM;
+            r.kept = static_cast <std::size_t> (end - &simplification [0]) / DIM;
+            bench::allocation_stats errorStats = bench::count_allocations ([&] {
+                r.error = psimpl::compute_positional_error_statistics <DIM> (
+                    polyline.begin (), polyline.end (), &simplification [0], end);
+            });
+            records.push_back (r);
+
+            std::cerr << "  " << container << " " << setting.algorithm << " (" << variant.first << "): "
+                      << r.time.median / 1e6 << " ms";
+            if (counters.available (bench::cycles)) {
+                std::cerr << ", " << r.per_point (bench::cycles) << " cycles/point";
+            }
+            if (trackAllocations) {
+                std::cerr << ", " << r.allocations << " allocations (error statistics: "
+                          << errorStats.calls << ")";
+            }
+            std::cerr << std::endl;
         }
-        else if (setting.first == "simplify_opheim") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_opheim <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toDouble (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_opheim <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toDouble (), oldSimplification.get ()));
-            }
+    }
+}
+
+//! Reads a polyline of "x,y" lines
+bool ReadPolyline (const std::filesystem::path& path, std::vector <double>& polyline)
+{
+    std::ifstream in (path);
+    std::string line;
+    while (std::getline (in, line)) {
+        if (line.empty ()) {
+            continue;
         }
-        else if (setting.first == "simplify_lang") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_lang <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toUInt (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_lang <DIM> (first, last, setting.second [0].toDouble (), setting.second [1].toUInt (), oldSimplification.get ()));
-            }
+        std::istringstream fields (line);
+        std::string x, y;
+        if (!std::getline (fields, x, ',') || !std::getline (fields, y, ',')) {
+            std::cerr << "invalid line read from " << path << std::endl;
+            return false;
         }
-        else if (setting.first == "simplify_douglas_peucker") {
-            BENCHMARK(newElapsed) {
-                newSimplificationSize =  std::distance (newSimplification.get (),
-                    psimpl::simplify_douglas_peucker <DIM> (first, last, setting.second [0].toDouble (), newSimplification.get ()));
-            }
-            BENCHMARK(oldElapsed) {
-                oldSimplificationSize =  std::distance (oldSimplification.get (),
-                    psimpl_prev::simplify_douglas_peucker <DIM> (first, last, setting.second [0].toDouble (), oldSimplification.get ()));
+        polyline.push_back (std::atof (x.c_str ()));
+        polyline.push_back (std::atof (y.c_str ()));
+    }
+    return in.eof () && !polyline.empty ();
+}
+
+//! Reads settings of "algorithm,param,param..." lines
+bool ReadSettings (const std::filesystem::path& path, std::vector <Setting>& settings)
+{
+    std::ifstream in (path);
+    std::string line;
+    while (std::getline (in, line)) {
+        if (line.empty ()) {
+            continue;
+        }
+        std::istringstream fields (line);
+        Setting setting;
+        std::string field;
+        std::getline (fields, setting.algorithm, ',');
+        while (std::getline (fields, field, ',')) {
+            if (!field.empty ()) {
+                setting.params.push_back (field);
             }
         }
-        else {
-            continue;
+        if (setting.algorithm.empty () || setting.params.empty ()) {
+            std::cerr << "invalid line read from " << path << std::endl;
+            return false;
         }
+        settings.push_back (setting);
+    }
+    return in.eof ();
+}
 
-        newStats = psimpl::compute_positional_error_statistics <DIM> (first, last, newSimplification.get (), newSimplification.get () + newSimplificationSize);
-        oldStats = psimpl::compute_positional_error_statistics <DIM> (first, last, oldSimplification.get (), oldSimplification.get () + oldSimplificationSize);
+// -----------------------------------------------------------------------------
 
-        std::cout << container << ",";
-        QTextStream(stdout) << setting.first << ",";
-        std::cout << newSimplificationSize / DIM << "," << (int) (((float) newSimplificationSize / (float) polylineSize) * 100.f) << "%,";
-        std::cout << newElapsed << "," << newStats.mean << "," << newStats.std << "," << newStats.max << "," << newStats.sum << ",";
-        std::cout << oldElapsed << "," << oldStats.mean << "," << oldStats.std << "," << oldStats.max << "," << oldStats.sum << ",";
-        std::cout << (int) ((((float) oldElapsed - (float) newElapsed) / (float) oldElapsed) * 100.f) << "%" << std::endl;
+//! Identifies a measurement across runs: input, container, algorithm, params and size
+std::string Key (const bench::record& r)
+{
+    return r.input + "," + r.container + "," + r.algorithm + "," + r.params + "," + std::to_string (r.points);
+}
+
+//! A psimpl record and the record of the implementation it is compared against
+using Comparison = std::pair <const bench::record*, const bench::record*>;
+
+//! Returns the ratio of the psimpl timing to the reference timing of each round
+std::vector <double> Ratios (const Comparison& c)
+{
+    std::vector <double> ratios;
+    for (std::size_t i = 0; i < c.first->samples.size () && i < c.second->samples.size (); ++i) {
+        ratios.push_back (c.first->samples [i] / c.second->samples [i]);
     }
+    return ratios;
 }
 
-// -----------------------------------------------------------------------------
+//! Returns the median of the ratios of a comparison
+double MedianRatio (const Comparison& c)
+{
+    std::vector <double> ratios = Ratios (c);
+    std::sort (ratios.begin (), ratios.end ());
+    return bench::quantile (ratios, 0.5);
+}
 
-template <class Iterator>
-void Benchmark_Ref (
-    const std::string& container,
-    const Iterator& first,
-    const Iterator& last,
-    const Settings& settings)
+/*
+    Pairs each psimpl record with the previous version of the algorithm, or otherwise with its
+    baseline. Timings are only compared within a run, as ratios, so that the stored baselines
+    do not depend on the speed of the machine.
+*/
+std::vector <Comparison> Comparisons (const std::vector <bench::record>& records)
 {
-    // benchmark all reference algorithms
-    const auto polylineSize = std::distance (first, last);
-    const auto pointCount = polylineSize / DIM;
-    int simplificationPointCount = 0;
-    unsigned elapsed = 0;
-
-    for (const Setting& setting : settings)
-    {
-        if (setting.first != "simplify_douglas_peucker_reference") {
+    std::map <std::string, const bench::record*> prev;
+    std::map <std::string, const bench::record*> baseline;
+    for (const bench::record& r : records) {
+        if (r.variant == "prev") {
+            prev [Key (r)] = &r;
+        }
+        else if (r.variant == "baseline") {
+            baseline [Key (r)] = &r;
+        }
+    }
+    std::vector <Comparison> comparisons;
+    for (const bench::record& r : records) {
+        if (r.variant != "psimpl") {
             continue;
         }
+        auto it = prev.find (Key (r));
+        if (it == prev.end ()) {
+            it = baseline.find (Key (r));
+            if (it == baseline.end ()) {
+                continue;
+            }
+        }
+        comparisons.emplace_back (&r, it->second);
+    }
+    return comparisons;
+}
 
-        psimpl::util::scoped_array <double> simplification (polylineSize);
-        int simplificationSize = 0;
-        psimpl::error::statistics newStats;
+//! The stored result of a comparison
+struct Baseline
+{
+    double ratio;       //!< median time of psimpl divided by that of the reference
+    int matches;        //!< 1 if the reference gave the same simplification, 0 if not, -1 if not compared
+};
 
-        psimpl::util::scoped_array <psimpl::reference::Point> polylinePoints (pointCount);
-        psimpl::util::scoped_array <psimpl::reference::Point> simplifiedPoints (pointCount);
+//! Writes each comparison as "input,container,algorithm,params,points,reference,ratio,matches"
+bool WriteBaseline (const std::string& path, const std::vector <Comparison>& comparisons)
+{
+    std::ofstream out (path);
+    out.precision (6);
+    out << "input,container,algorithm,params,points,reference,ratio,matches\n";
+    for (const Comparison& c : comparisons) {
+        out << Key (*c.first) << "," << c.second->variant << ","
+            << MedianRatio (c) << "," << c.second->matches << "\n";
+    }
+    return static_cast <bool> (out);
+}
 
-        // convert polyline coords to points
-        Iterator curr = first;
-        for (size_t i=0; i<pointCount; i++) {
-            polylinePoints [i].x = *curr++;
-            polylinePoints [i].y = *curr++;
+//! Reads the comparisons written by WriteBaseline, keyed by measurement and reference
+bool ReadBaseline (const std::string& path, std::map <std::string, Baseline>& baselines)
+{
+    std::ifstream in (path);
+    std::string line;
+    if (!std::getline (in, line)) {
+        std::cerr << "unable to read " << path << std::endl;
+        return false;
+    }
+    while (std::getline (in, line)) {
+        std::size_t last = line.rfind (',');
+        std::size_t comma = last == std::string::npos || last == 0 ? std::string::npos : line.rfind (',', last - 1);
+        if (comma == std::string::npos) {
+            continue;
         }
+        Baseline baseline;
+        baseline.ratio = std::atof (line.c_str () + comma + 1);
+        baseline.matches = std::atoi (line.c_str () + last + 1);
+        baselines [line.substr (0, comma)] = baseline;
+    }
+    return true;
+}
 
-        BENCHMARK(elapsed) {
-            simplificationPointCount =
-                psimpl::reference::poly_simplify (
-                        setting.second [0].toDouble (),
-                        polylinePoints.get (),
-                        pointCount,
-                        simplifiedPoints.get ());
+/*
+    Compares each measurement against its stored baseline, and returns the number of
+    regressions.
+
+    Within a run, a measurement is slower when the ratios of its psimpl timings to the
+    reference timings of the same rounds are significantly (one sided Wilcoxon signed rank
+    test, p < 0.01) larger than the baseline ratio plus the threshold. Such a measurement is
+    reported, but on a shared machine single measurements also shift between runs, with the
+    memory layout of the process. An algorithm therefore only regresses when the median ratios
+    of its measurements over all containers, sizes and parameters are significantly larger
+    than their baselines plus the threshold, by the same test. Any measurement whose output no
+    longer equals that of the previous version is a regression.
+*/
+int CheckBaseline (const std::map <std::string, Baseline>& baselines, const std::vector <Comparison>& comparisons, double threshold)
+{
+    int regressions = 0;
+    int checked = 0;
+    std::map <std::string, std::vector <double> > algorithms;   // excess log ratio per measurement
+    for (const Comparison& c : comparisons) {
+        auto it = baselines.find (Key (*c.first) + "," + c.second->variant);
+        if (it == baselines.end ()) {
+            std::cerr << "no baseline for " << Key (*c.first) << std::endl;
+            continue;
         }
-
-        // convert simplification points to soords
-        simplificationSize = simplificationPointCount * DIM;
-        for (int j=0; j<simplificationPointCount; j++) {
-            simplification [j*2] = simplifiedPoints [j].x;
-            simplification [j*2+1] = simplifiedPoints [j].y;
+        ++checked;
+        const Baseline& baseline = it->second;
+        if (baseline.matches == 1 && c.second->matches == 0) {
+            std::cerr << "FAILED " << Key (*c.first) << " no longer equals the " << c.second->variant
+                      << " simplification" << std::endl;
+            ++regressions;
         }
-
-        newStats = psimpl::compute_positional_error_statistics <DIM> (
-                first,
-                last,
-                simplification.get (),
-                simplification.get () + simplificationSize);
-
-        std::cout << container << ",";
-        QTextStream(stdout) << setting.first << ",";
-        std::cout << simplificationPointCount << "," << (int) (((float) simplificationPointCount / (float) pointCount) * 100.f) << "%," << elapsed << ",";
-        std::cout << newStats.mean << "," << newStats.std << "," << newStats.max << "," << newStats.sum << std::endl;
+        double allowed = std::log (baseline.ratio * (1 + threshold));
+        std::vector <double> differences = Ratios (c);
+        for (double& d : differences) {
+            d = std::log (d) - allowed;
+        }
+        double ratio = MedianRatio (c);
+        double p = bench::signed_rank_greater (differences);
+        if (p < 0.01) {
+            std::cerr << "slower " << Key (*c.first) << ": " << ratio << " times " << c.second->variant
+                      << ", baseline " << baseline.ratio << " (p = " << p << ")" << std::endl;
+        }
+        algorithms [c.first->algorithm].push_back (std::log (ratio) - allowed);
     }
+    for (const auto& algorithm : algorithms) {
+        double p = bench::signed_rank_greater (algorithm.second);
+        if (p < 0.01) {
+            std::vector <double> excess = algorithm.second;
+            std::sort (excess.begin (), excess.end ());
+            std::cerr << "FAILED " << algorithm.first << " regressed: median ratio " << std::exp (bench::quantile (excess, 0.5)) * (1 + threshold)
+                      << " times its baseline over " << excess.size () << " measurements (p = " << p << ")" << std::endl;
+            ++regressions;
+        }
+    }
+    std::cerr << "checked " << checked << " measurements of " << algorithms.size () << " algorithms against the baseline, "
+              << regressions << " regressions" << std::endl;
+    return regressions;
 }
 
 // -----------------------------------------------------------------------------
 
-//////template <class Iterator>
-//////void Benchmark_Boost (const std::string& container, Iterator first, Iterator last, const Settings& settings)
-//////{
-//////    // benchmark all boost algorithms
-//////    int polylineSize = std::distance (first, last);
-//////    int pointCount = polylineSize / DIM;
-//////    unsigned elapsed = 0;
-//////
-//////    for (const Setting& setting : settings)
-//////    {
-//////        if (setting.first != "simplify_douglas_peucker_boost") {
-//////            continue;
-//////        }
-//////
-//////        psimpl::util::scoped_array <double> simplification (polylineSize);
-//////        int simplificationSize = 0;
-//////        psimpl::error::statistics newStats;
-//////
-//////        std::cout << container << "," << setting.first.toStdString () << ",";
-//////
-//////        // convert polyline coords to points
-//////        // benchmark
-//////        // convert result from points to coords
-//////
-//////        newStats = psimpl::compute_positional_error_statistics <DIM> (first, last, simplification.get (), simplification.get () + simplificationSize);
-//////
-//////        std::cout << simplificationPointCount << "," << (int) (((float) simplificationPointCount / (float) pointCount) * 100.f) << "%," << elapsed << ",";
-//////        std::cout << newStats.mean << "," << newStats.std << "," << newStats.max << "," << newStats.sum << std::endl;
-//////    }
-//////}
-
-// -----------------------------------------------------------------------------
+void Usage ()
+{
+    std::cerr <<
+        "usage: psimpl-bench [options] [file.algo ...]\n"
+        "\n"
+        "Benchmarks the algorithms listed in each .algo file on the polyline in the .poly file\n"
+        "with the same base name. Without .algo files, all .algo files in the current directory\n"
+        "are used.\n"
+        "\n"
+        "  --repeat N     number of timed runs (default 15)\n"
+        "  --warmup N     number of untimed runs before timing (default 2)\n"
+        "  --cpu K        pin the benchmark to cpu K\n"
+        "  --csv FILE     write CSV to FILE instead of stdout\n"
+        "  --json FILE    also write JSON to FILE\n"
+        "  --no-counters  do not read hardware performance counters\n"
+        "  --allocations  count heap allocations, bytes and peak memory of one extra run, and\n"
+        "                 fail when an allocation free algorithm allocates\n"
+        "  --sizes N,...  benchmark the first N points of each polyline, for each N\n"
+        "  --write-baseline FILE\n"
+        "                 write the median time ratio of psimpl to the previous version (or\n"
+        "                 baseline) of each algorithm, container and size to FILE\n"
+        "  --check FILE   fail when a ratio is significantly worse than in baseline FILE, or\n"
+        "                 when a simplification no longer equals that of the previous version\n"
+        "  --threshold X  relative slowdown tolerated by --check (default 0.15)\n"
+        "\n"
+        "Where Linux perf_event_open permits, cycles, instructions, L1 data and last level cache\n"
+        "misses and branch misses are counted around each timed run and reported per point.\n"
+        "Unavailable counters are left empty in the CSV, and null in the JSON output.\n"
+        "\n"
+        "The simplifications of psimpl and the previous version are always compared, and each\n"
+        "difference is reported. Known differences are recorded in the baseline.\n";
+}
 
-void Benchmark (
-    const QString& polylinePath,
-    const QString& settingsPath)
+int main (int argc, char* argv [])
 {
-    QVector <double> polyline;
-    Settings settings;
-
-    // load polyline
-    {
-        QFile polylineFile (polylinePath);
-        if (!polylineFile.open (QIODevice::ReadOnly | QIODevice::Text)) {
-            QTextStream(stderr) << "unable to read " << polylinePath << endl;
-            return;
-        }
-        QTextStream in (&polylineFile);
-        while (!in.atEnd ()) {
-            const auto& line = in.readLine ();
-            const auto& list = line.split (',', QString::SkipEmptyParts);
-            if (list.size () < 2) {
-                QTextStream(stderr) << "invalid line read from " << polylinePath << endl;
-                return;
+    bench::options opts;
+    std::string csvPath;
+    std::string jsonPath;
+    bool useCounters = true;
+    bool trackAllocations = false;
+    std::vector <std::size_t> sizes;
+    std::string baselinePath;
+    std::string checkPath;
+    double threshold = 0.15;
+    std::vector <std::filesystem::path> algoPaths;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv [i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--repeat" && hasValue) {
+            opts.repeat = static_cast <unsigned> (std::max (1, std::atoi (argv [++i])));
+        }
+        else if (arg == "--warmup" && hasValue) {
+            opts.warmup = static_cast <unsigned> (std::max (0, std::atoi (argv [++i])));
+        }
+        else if (arg == "--cpu" && hasValue) {
+            int cpu = std::atoi (argv [++i]);
+            if (!bench::pin_to_cpu (cpu)) {
+                std::cerr << "unable to pin to cpu " << cpu << ", continuing unpinned" << std::endl;
             }
-            polyline.push_back (list [0].toDouble ());
-            polyline.push_back (list [1].toDouble ());
-        }
-        std::cout << ", " << polyline.size () / DIM << " points";
-    }
-    // load settings
-    {
-        QFile settingsFile (settingsPath);
-        if (!settingsFile.open (QIODevice::ReadOnly | QIODevice::Text)) {
-            QTextStream(stderr) << "unable to read " << settingsPath << endl;
-            return;
-        }
-        QTextStream in (&settingsFile);
-        while (!in.atEnd ()) {
-            const auto& line = in.readLine ();
-            const auto& algo = line.section (',', 0, 0);
-            const auto& params = line.section (',', 1).split (',', QString::SkipEmptyParts);
-            if (0 == algo.size () || 0 == params.size ()) {
-                QTextStream(stderr) << "invalid line read from " << settingsPath << endl;
-                return;
+        }
+        else if (arg == "--csv" && hasValue) {
+            csvPath = argv [++i];
+        }
+        else if (arg == "--json" && hasValue) {
+            jsonPath = argv [++i];
+        }
+        else if (arg == "--no-counters") {
+            useCounters = false;
+        }
+        else if (arg == "--allocations") {
+            trackAllocations = true;
+        }
+        else if (arg == "--sizes" && hasValue) {
+            std::istringstream fields (argv [++i]);
+            std::string field;
+            while (std::getline (fields, field, ',')) {
+                sizes.push_back (static_cast <std::size_t> (std::strtod (field.c_str (), 0)));
             }
-            settings.push_back (qMakePair (algo, params));
-            if (algo == "simplify_douglas_peucker") {
-                settings.push_back (qMakePair (QString ("simplify_douglas_peucker_reference"), params));
+        }
+        else if (arg == "--write-baseline" && hasValue) {
+            baselinePath = argv [++i];
+        }
+        else if (arg == "--check" && hasValue) {
+            checkPath = argv [++i];
+        }
+        else if (arg == "--threshold" && hasValue) {
+            threshold = std::atof (argv [++i]);
+        }
+        else if (arg.size () > 1 && arg [0] == '-') {
+            Usage ();
+            return 2;
+        }
+        else {
+            algoPaths.push_back (arg);
+        }
+    }
+    if (algoPaths.empty ()) {
+        for (const auto& entry : std::filesystem::directory_iterator (".")) {
+            if (entry.is_regular_file () && entry.path ().extension () == ".algo") {
+                algoPaths.push_back (entry.path ());
             }
-            else if (algo == "simplify_douglas_peucker_classic") {
-                settings.push_back (qMakePair (QString ("simplify_douglas_peucker_boost"), params));
+        }
+        std::sort (algoPaths.begin (), algoPaths.end ());
+    }
+    if (algoPaths.empty ()) {
+        std::cerr << "no .algo files to process" << std::endl;
+        return 1;
+    }
+
+    bench::perf_counters counters (useCounters);
+    if (useCounters) {
+        std::cerr << "hardware counters:";
+        for (unsigned e = 0; e < bench::event_count; ++e) {
+            if (counters.available (e)) {
+                std::cerr << " " << bench::event_name (e);
             }
         }
-        std::cout << ", " << settings.size () << " algorithms" << std::endl;
-    }
-    std::cout << "--------------------------------------------------------------------------------" << std::endl;
-    std::cout << "cont,algo,size,ratio,ticks,error mean,error std,error max,error sum,ticks,error mean,error std,error max,error sum,diff" << std::endl;
-    // test with double[]
-    {
-        const auto poly = polyline.constData ();
-        Benchmark_Ran ("double []", poly, poly + polyline.size (), settings);
-    }
-    // test with std::vector <double>
-    {
-        std::vector <double> poly (polyline.constBegin (), polyline.constEnd ());
-        Benchmark_Ran ("std::vector <double>", poly.begin (), poly.end (), settings);
-    }
-    // test with std::deque <double>
-    {
-        std::deque <double> poly (polyline.constBegin (), polyline.constEnd ());
-        Benchmark_Ran ("std::deque <double>", poly.begin (), poly.end (), settings);
-    }
-    // test with std::list <double>
-    {
-        std::list <double> poly (polyline.constBegin (), polyline.constEnd ());
-        Benchmark_Bid ("std::list <double>", poly.begin (), poly.end (), settings);
-    }
-    // test with reference::Point[]
-    {
-        const auto* poly = polyline.constData ();
-        Benchmark_Ref ("reference::Point[]", poly, poly + polyline.size (), settings);
-    }
-    //////// test with boost
-    //////{
-    //////    std::list <double> poly (polyline.constBegin (), polyline.constEnd ());
-    //////    Benchmark_Boost ("boost", poly.begin (), poly.end (), settings);
-    //////}
-}
+        std::cerr << (counters.any () ? "" : " unavailable, reporting timings only") << std::endl;
+    }
 
-// -----------------------------------------------------------------------------
+    std::vector <bench::record> records;
+    int failed = 0;
+    for (const auto& algoPath : algoPaths) {
+        std::filesystem::path polyPath = algoPath;
+        polyPath.replace_extension (".poly");
+
+        std::vector <double> polyline;
+        std::vector <Setting> settings;
+        if (!ReadPolyline (polyPath, polyline) || !ReadSettings (algoPath, settings)) {
+            std::cerr << "FAILED " << polyPath.string () << " specified by " << algoPath.string () << std::endl;
+            ++failed;
+            continue;
+        }
+        std::string input = algoPath.stem ().string ();
+        std::vector <std::size_t> counts = sizes;
+        if (counts.empty ()) {
+            counts.push_back (polyline.size () / DIM);
+        }
+        for (std::size_t count : counts) {
+            if (count < 2 || count > polyline.size () / DIM) {
+                std::cerr << "skipping " << count << " points of " << input << std::endl;
+                continue;
+            }
+            std::vector <double> part (polyline.begin (), polyline.begin () + count * DIM);
+            std::cerr << "benchmarking " << input << ": " << count << " points, "
+                      << settings.size () << " algorithms" << std::endl;
+
+            Benchmark (input, "double []", part.data (), part.data () + part.size (),
+                       part, settings, opts, counters, trackAllocations, records, failed);
+            {
+                std::vector <double> poly (part.begin (), part.end ());
+                Benchmark (input, "std::vector <double>", poly.begin (), poly.end (),
+                           part, settings, opts, counters, trackAllocations, records, failed);
+            }
+            {
+                std::deque <double> poly (part.begin (), part.end ());
+                Benchmark (input, "std::deque <double>", poly.begin (), poly.end (),
+                           part, settings, opts, counters, trackAllocations, records, failed);
+            }
+            {
+                std::list <double> poly (part.begin (), part.end ());
+                Benchmark (input, "std::list <double>", poly.begin (), poly.end (),
+                           part, settings, opts, counters, trackAllocations, records, failed);
+            }
+        }
+    }
 
-int main (int argc, char* argv [])
-{
-    std::cout << "================================================================================" << std::endl;
-    std::cout << "Starting psimpl benchmark" << std::endl;
-    if (argc == 2) {
-        repeat = QString (argv [1]).toUInt ();
-        std::cout << "Setting repeat count to " << repeat << std::endl;
-    }
-
-    QDirIterator it (".", QStringList () << "*.algo", QDir::Files | QDir::Readable);
-    std::cout << "Processing *.algo files" << std::endl;
-    int num_processed = 0;
-    while (it.hasNext ()) {
-        num_processed++;
-        it.next ();
-        const auto& settings = it.fileInfo ();
-        QFileInfo polyline (settings.dir (), settings.completeBaseName ().append (".poly"));
-        if (polyline.exists () && polyline.isFile () && polyline.isReadable ()) {
-            std::cout << "================================================================================" << std::endl;
-            QTextStream(stdout) << num_processed << " benchmarking : " << settings.canonicalFilePath() ;
-            Benchmark (polyline.absoluteFilePath (), settings.absoluteFilePath ());
+    std::vector <Comparison> comparisons = Comparisons (records);
+    if (!baselinePath.empty () && !WriteBaseline (baselinePath, comparisons)) {
+        std::cerr << "FAILED writing " << baselinePath << std::endl;
+        ++failed;
+    }
+    if (!checkPath.empty ()) {
+        std::map <std::string, Baseline> baselines;
+        if (!ReadBaseline (checkPath, baselines)) {
+            ++failed;
         }
         else {
-            QTextStream(stderr) << num_processed << " FAILED " << polyline.canonicalFilePath() << endl;
-            QTextStream(stderr) << " specified in " << settings.canonicalFilePath() << endl;
+            failed += CheckBaseline (baselines, comparisons, threshold);
         }
     }
-    if (!num_processed) {
-        std::cout << "WARNING - no *.algo files to process" << std::endl;
-    }
-
-    std::cout << "Completed" << std::endl
-    << "================================================================================" << std::endl;
 
-    return 0;
+    std::ofstream csvFile;
+    if (!csvPath.empty ()) {
+        csvFile.open (csvPath);
+    }
+    std::ostream& csv = csvPath.empty () ? std::cout : csvFile;
+    csv.precision (10);
+    bench::write_csv_header (csv);
+    for (const bench::record& r : records) {
+        bench::write_csv (csv, r);
+    }
+    if (!jsonPath.empty ()) {
+        std::ofstream json (jsonPath);
+        json.precision (10);
+        bench::write_json (json, records);
+    }
+    return failed ? 1 : 0;
 }
@@ -1,18 +1,23 @@
-TARGET = psimpl-speed
+TARGET = psimpl-bench
 TEMPLATE = app
 CONFIG += \
     console \
-    qtestlib
+    c++17 \
+    thread
+CONFIG -= qt
+
+INCLUDEPATH += \
+    ../lib
 
 SOURCES += \
     main.cpp
 
 HEADERS += \
+    alloc.h \
+    bench.h \
     ../lib/psimpl.h \
     ../demo/psimpl_reference.h \
-    cycle_p.h \
     prev/psimpl.h \
-    ../lib/old_psimpl.h \
     ../lib/detail/util.h \
     ../lib/detail/math.h \
     ../lib/detail/algo.h
@@ -0,0 +1,440 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning.
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl, and is hosted at SourceForge:
+    http://sourceforge.net/projects/psimpl/
+*/
+
+
+#include "bench.h"
+#include "corpus.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+const unsigned DIM = 2;
+
+namespace bench = psimpl::bench;
+
+// -----------------------------------------------------------------------------
+
+//! Polylines stored back to back, as for the batch routines
+struct Workload
+{
+    std::vector <double> coords;
+    std::vector <std::ptrdiff_t> offsets;           //!< coordinate offset of each polyline, and of the end
+    std::vector <double> simplified;                //!< RD simplification of each polyline, for the error routines
+    std::vector <std::ptrdiff_t> simplifiedOffsets;
+    std::vector <double> result;                    //!< output of the measured routine
+    std::vector <std::ptrdiff_t> resultOffsets;
+    std::vector <double> errors;                    //!< squared positional error of each point
+};
+
+//! Appends count points of a GPS-like track to coords
+void AppendTrack (std::vector <double>& coords, std::uint64_t count, std::uint64_t seed)
+{
+    struct Sink {
+        std::vector <double>& coords;
+        void operator() (const double* point) {
+            coords.insert (coords.end (), point, point + DIM);
+        }
+    } sink = {coords};
+    bench::generate ("gps", count, seed, sink);
+}
+
+//! Creates a workload of polylines with length points each
+Workload CreateWorkload (unsigned polylines, std::uint64_t length, std::uint64_t seed)
+{
+    Workload w;
+    w.coords.reserve (polylines * length * DIM);
+    w.offsets.push_back (0);
+    for (unsigned i = 0; i < polylines; ++i) {
+        AppendTrack (w.coords, length, seed * 1000003 + i);
+        w.offsets.push_back (static_cast <std::ptrdiff_t> (w.coords.size ()));
+    }
+    w.simplified.resize (w.coords.size ());
+    w.simplifiedOffsets.resize (w.offsets.size ());
+    psimpl::simplify_douglas_peucker_batch <DIM> (w.coords.data (), w.offsets.begin (), w.offsets.end (),
+        10.0, w.simplified.data (), w.simplifiedOffsets.begin ());
+    w.result.resize (w.coords.size ());
+    w.resultOffsets.resize (w.offsets.size ());
+    w.errors.resize (w.coords.size () / DIM);
+    return w;
+}
+
+// -----------------------------------------------------------------------------
+
+//! Simplifies or evaluates one polyline, serially
+using Serial = std::function <void (Workload& w, std::size_t i)>;
+
+//! Simplifies or evaluates the first polyline of a workload, using at most the given number of threads
+using Parallel = std::function <void (Workload& w, unsigned threads)>;
+
+/*
+    Returns the serial routines, for weak scaling: each thread runs them on its own polylines.
+    Tolerances are in meters, for the GPS-like tracks.
+*/
+std::vector <std::pair <std::string, Serial> > SerialRoutines ()
+{
+    // the coordinates of polyline i, and where its simplification goes
+    #define POLYLINE w.coords.data () + w.offsets [i], w.coords.data () + w.offsets [i + 1]
+    #define RESULT w.result.data () + w.offsets [i]
+    #define SIMPLIFIED w.simplified.data () + w.simplifiedOffsets [i], w.simplified.data () + w.simplifiedOffsets [i + 1]
+
+    std::vector <std::pair <std::string, Serial> > routines;
+    routines.emplace_back ("simplify_nth_point", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_nth_point <DIM> (POLYLINE, 10, RESULT); });
+    routines.emplace_back ("simplify_radial_distance", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_radial_distance <DIM> (POLYLINE, 10.0, RESULT); });
+    routines.emplace_back ("simplify_perpendicular_distance", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_perpendicular_distance <DIM> (POLYLINE, 5.0, 1, RESULT); });
+    routines.emplace_back ("simplify_reumann_witkam", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_reumann_witkam <DIM> (POLYLINE, 5.0, RESULT); });
+    routines.emplace_back ("simplify_opheim", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_opheim <DIM> (POLYLINE, 5.0, 50.0, RESULT); });
+    routines.emplace_back ("simplify_lang", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_lang <DIM> (POLYLINE, 5.0, 16, RESULT); });
+    routines.emplace_back ("simplify_douglas_peucker", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_douglas_peucker <DIM> (POLYLINE, 5.0, RESULT); });
+    routines.emplace_back ("simplify_douglas_peucker_classic", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_douglas_peucker_classic <DIM> (POLYLINE, 5.0, RESULT); });
+    routines.emplace_back ("simplify_douglas_peucker_pruned", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_douglas_peucker_pruned <DIM> (POLYLINE, 5.0, RESULT); });
+    routines.emplace_back ("simplify_douglas_peucker_n", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_douglas_peucker_n <DIM> (POLYLINE, (w.offsets [i + 1] - w.offsets [i]) / DIM / 10, RESULT); });
+    routines.emplace_back ("simplify_sleeve_fitting", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_sleeve_fitting <DIM> (POLYLINE, 5.0, RESULT); });
+    routines.emplace_back ("simplify_optimal_windowed", [] (Workload& w, std::size_t i) {
+        psimpl::simplify_optimal_windowed <DIM> (POLYLINE, 5.0, 256, RESULT); });
+    routines.emplace_back ("compute_positional_errors2", [] (Workload& w, std::size_t i) {
+        psimpl::compute_positional_errors2 <DIM> (POLYLINE, SIMPLIFIED, w.errors.data () + w.offsets [i] / DIM); });
+    routines.emplace_back ("compute_positional_error_statistics", [] (Workload& w, std::size_t i) {
+        bench::keep (psimpl::compute_positional_error_statistics <DIM> (POLYLINE, SIMPLIFIED)); });
+    routines.emplace_back ("compute_areal_displacement", [] (Workload& w, std::size_t i) {
+        bench::keep (psimpl::compute_areal_displacement <DIM> (POLYLINE, SIMPLIFIED)); });
+
+    #undef POLYLINE
+    #undef RESULT
+    #undef SIMPLIFIED
+    return routines;
+}
+
+/*
+    Returns the batch routines, for weak scaling: each thread runs them on its own batch. They
+    process a whole workload at once, so the polyline index is ignored.
+*/
+std::vector <std::pair <std::string, Serial> > BatchRoutines ()
+{
+    std::vector <std::pair <std::string, Serial> > routines;
+    routines.emplace_back ("simplify_douglas_peucker_batch", [] (Workload& w, std::size_t) {
+        psimpl::simplify_douglas_peucker_batch <DIM> (w.coords.data (), w.offsets.begin (), w.offsets.end (),
+            5.0, w.result.data (), w.resultOffsets.begin ()); });
+    return routines;
+}
+
+/*
+    Returns the parallel routines, for strong scaling: they split one huge polyline over the
+    threads. Algorithms without a parallel equivalent only appear in the weak scaling results.
+*/
+std::vector <std::pair <std::string, Parallel> > ParallelRoutines ()
+{
+    #define POLYLINE w.coords.data (), w.coords.data () + w.offsets [1]
+    #define SIMPLIFIED w.simplified.data (), w.simplified.data () + w.simplifiedOffsets [1]
+
+    std::vector <std::pair <std::string, Parallel> > routines;
+    routines.emplace_back ("simplify_nth_point_parallel", [] (Workload& w, unsigned threads) {
+        psimpl::simplify_nth_point_parallel <DIM> (POLYLINE, 10, w.result.data (), threads); });
+    routines.emplace_back ("simplify_radial_distance_parallel", [] (Workload& w, unsigned threads) {
+        psimpl::simplify_radial_distance_parallel <DIM> (POLYLINE, 10.0, w.result.data (), threads); });
+    routines.emplace_back ("simplify_reumann_witkam_parallel", [] (Workload& w, unsigned threads) {
+        psimpl::simplify_reumann_witkam_parallel <DIM> (POLYLINE, 5.0, w.result.data (), threads); });
+    routines.emplace_back ("simplify_opheim_parallel", [] (Workload& w, unsigned threads) {
+        psimpl::simplify_opheim_parallel <DIM> (POLYLINE, 5.0, 50.0, w.result.data (), threads); });
+    routines.emplace_back ("simplify_lang_parallel", [] (Workload& w, unsigned threads) {
+        psimpl::simplify_lang_parallel <DIM> (POLYLINE, 5.0, 16, w.result.data (), threads); });
+    routines.emplace_back ("simplify_douglas_peucker_n_parallel", [] (Workload& w, unsigned threads) {
+        psimpl::simplify_douglas_peucker_n_parallel <DIM> (POLYLINE, w.offsets [1] / DIM / 10, w.result.data (), threads); });
+    routines.emplace_back ("compute_positional_errors2_parallel", [] (Workload& w, unsigned threads) {
+        psimpl::compute_positional_errors2_parallel <DIM> (POLYLINE, SIMPLIFIED, w.errors.data (), 0, threads); });
+    routines.emplace_back ("compute_positional_error_statistics_parallel", [] (Workload& w, unsigned threads) {
+        bench::keep (psimpl::compute_positional_error_statistics_parallel <DIM> (POLYLINE, SIMPLIFIED, 0, threads)); });
+    routines.emplace_back ("compute_areal_displacement_parallel", [] (Workload& w, unsigned threads) {
+        bench::keep (psimpl::compute_areal_displacement_parallel <DIM> (POLYLINE, SIMPLIFIED, 0, threads)); });
+
+    #undef POLYLINE
+    #undef SIMPLIFIED
+    return routines;
+}
+
+// -----------------------------------------------------------------------------
+
+//! One point of a scaling curve
+struct Result
+{
+    std::string mode;           //!< strong or weak
+    std::string algorithm;
+    unsigned threads;
+    std::uint64_t points;       //!< total number of points processed per run
+    double median;              //!< median duration of a run in nanoseconds
+    double speedup;             //!< strong: t(1) / t(n), weak: n * t(1) / t(n)
+    double efficiency;          //!< speedup / n
+};
+
+void WriteCsv (std::ostream& out, const std::vector <Result>& results)
+{
+    out << "mode,algorithm,threads,points,median_ns,speedup,efficiency\n";
+    for (const Result& r : results) {
+        out << r.mode << ',' << r.algorithm << ',' << r.threads << ',' << r.points << ','
+            << static_cast <long long> (r.median) << ',' << r.speedup << ',' << r.efficiency << '\n';
+    }
+}
+
+//! Appends the result for n threads, given the median time for a single thread
+void AddResult (std::vector <Result>& results, const std::string& mode, const std::string& algorithm,
+                unsigned threads, std::uint64_t points, double median, double single)
+{
+    Result r;
+    r.mode = mode;
+    r.algorithm = algorithm;
+    r.threads = threads;
+    r.points = points;
+    r.median = median;
+    r.speedup = mode == "strong" ? single / median : threads * single / median;
+    r.efficiency = r.speedup / threads;
+    results.push_back (r);
+    std::cerr << "  " << mode << " " << algorithm << ", " << threads << " threads: " << median / 1e6
+              << " ms, speedup " << r.speedup << ", efficiency " << r.efficiency << std::endl;
+}
+
+/*
+    Strong scaling: the same huge polyline is processed by a parallel routine with an
+    increasing number of threads.
+*/
+void Strong (Workload& w, const std::vector <unsigned>& threads, const bench::options& opts, std::vector <Result>& results)
+{
+    std::uint64_t points = static_cast <std::uint64_t> (w.offsets [1] / DIM);
+    for (const auto& routine : ParallelRoutines ()) {
+        double single = 0;
+        for (unsigned n : threads) {
+            double median = bench::summarize (bench::measure ([&] { routine.second (w, n); }, opts)).median;
+            if (n == threads.front ()) {
+                single = median * n;    // assumes perfect scaling when the sweep does not start at 1
+            }
+            AddResult (results, "strong", routine.first, n, points, median, single);
+        }
+    }
+}
+
+/*
+    Weak scaling: each thread processes its own polylines, so the total work grows with the
+    number of threads. Threads are started for each run, which is negligible compared to the
+    work per thread.
+*/
+void Weak (std::vector <Workload>& loads, const std::vector <unsigned>& threads, const bench::options& opts, std::vector <Result>& results)
+{
+    std::vector <std::pair <std::string, Serial> > routines = SerialRoutines ();
+    std::size_t serialCount = routines.size ();
+    for (auto& batch : BatchRoutines ()) {
+        routines.push_back (batch);
+    }
+    std::uint64_t points = static_cast <std::uint64_t> (loads [0].coords.size () / DIM);
+
+    for (std::size_t k = 0; k < routines.size (); ++k) {
+        const Serial& routine = routines [k].second;
+        std::size_t polylines = k < serialCount ? loads [0].offsets.size () - 1 : 1;
+        auto work = [&] (Workload& w) {
+            for (std::size_t i = 0; i < polylines; ++i) {
+                routine (w, i);
+            }
+        };
+        double single = 0;
+        for (unsigned n : threads) {
+            double median = bench::summarize (bench::measure ([&] {
+                std::vector <std::thread> pool;
+                for (unsigned t = 1; t < n; ++t) {
+                    pool.emplace_back (work, std::ref (loads [t]));
+                }
+                work (loads [0]);
+                for (std::thread& thread : pool) {
+                    thread.join ();
+                }
+            }, opts)).median;
+            if (n == threads.front ()) {
+                single = median;
+            }
+            AddResult (results, "weak", routines [k].first, n, points * n, median, single);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void Usage ()
+{
+    std::cerr <<
+        "usage: psimpl-scaling [options]\n"
+        "\n"
+        "Measures how the psimpl routines scale with the number of threads, on GPS-like tracks\n"
+        "from the benchmark corpus, and writes speedup and efficiency per thread count as CSV.\n"
+        "\n"
+        "Strong scaling runs each parallel routine on one huge polyline, with an increasing\n"
+        "number of threads: speedup = t(1) / t(n). Weak scaling runs every serial and batch\n"
+        "routine on separate polylines in each thread: speedup = n * t(1) / t(n).\n"
+        "Efficiency is speedup / n for both.\n"
+        "\n"
+        "  --threads N,...   thread counts (default 1, 2, 4, ... up to all hardware threads)\n"
+        "  --points N        points of the strong scaling polyline (default 4e6)\n"
+        "  --polylines N     polylines per thread for weak scaling (default 16)\n"
+        "  --length N        points per weak scaling polyline (default 10000)\n"
+        "  --mode M          strong, weak or both (default both)\n"
+        "  --repeat N        number of timed runs (default 7)\n"
+        "  --warmup N        number of untimed runs before timing (default 1)\n"
+        "  --csv FILE        write CSV to FILE instead of stdout\n"
+        "  --trace FILE      record the stages of the measured routines per thread, and write\n"
+        "                    them to FILE as Chrome trace-event JSON\n";
+}
+
+int main (int argc, char* argv [])
+{
+    bench::options opts;
+    opts.repeat = 7;
+    opts.warmup = 1;
+    std::vector <unsigned> threads;
+    std::uint64_t points = 4000000;
+    unsigned polylines = 16;
+    std::uint64_t length = 10000;
+    std::string mode = "both";
+    std::string csvPath;
+    std::string tracePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv [i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) {
+            std::istringstream fields (argv [++i]);
+            std::string field;
+            while (std::getline (fields, field, ',')) {
+                threads.push_back (static_cast <unsigned> (std::max (1, std::atoi (field.c_str ()))));
+            }
+        }
+        else if (arg == "--points" && hasValue) {
+            points = static_cast <std::uint64_t> (std::strtod (argv [++i], 0));
+        }
+        else if (arg == "--polylines" && hasValue) {
+            polylines = static_cast <unsigned> (std::max (1, std::atoi (argv [++i])));
+        }
+        else if (arg == "--length" && hasValue) {
+            length = static_cast <std::uint64_t> (std::strtod (argv [++i], 0));
+        }
+        else if (arg == "--mode" && hasValue) {
+            mode = argv [++i];
+        }
+        else if (arg == "--repeat" && hasValue) {
+            opts.repeat = static_cast <unsigned> (std::max (1, std::atoi (argv [++i])));
+        }
+        else if (arg == "--warmup" && hasValue) {
+            opts.warmup = static_cast <unsigned> (std::max (0, std::atoi (argv [++i])));
+        }
+        else if (arg == "--csv" && hasValue) {
+            csvPath = argv [++i];
+        }
+        else if (arg == "--trace" && hasValue) {
+            tracePath = argv [++i];
+        }
+        else {
+            Usage ();
+            return 2;
+        }
+    }
+    if (mode != "strong" && mode != "weak" && mode != "both") {
+        Usage ();
+        return 2;
+    }
+    if (points < 2 || length < 2) {
+        std::cerr << "polylines need at least 2 points" << std::endl;
+        return 2;
+    }
+    if (threads.empty ()) {
+        unsigned cores = std::max (1u, std::thread::hardware_concurrency ());
+        for (unsigned n = 1; n < cores; n *= 2) {
+            threads.push_back (n);
+        }
+        threads.push_back (cores);
+    }
+    std::sort (threads.begin (), threads.end ());
+    threads.erase (std::unique (threads.begin (), threads.end ()), threads.end ());
+
+    // only the measured routines are traced, not the creation of the workloads
+    psimpl::trace_recorder recorder;
+    psimpl::trace_sink* sink = tracePath.empty () ? 0 : &recorder;
+
+    std::vector <Result> results;
+    if (mode != "weak") {
+        std::cerr << "strong scaling: " << points << " points" << std::endl;
+        Workload w = CreateWorkload (1, points, 1);
+        psimpl::set_trace_sink (sink);
+        Strong (w, threads, opts, results);
+        psimpl::set_trace_sink (0);
+    }
+    if (mode != "strong") {
+        std::cerr << "weak scaling: " << polylines << " polylines of " << length << " points per thread" << std::endl;
+        std::vector <Workload> loads;
+        for (unsigned t = 0; t < threads.back (); ++t) {
+            loads.push_back (CreateWorkload (polylines, length, t + 1));
+        }
+        psimpl::set_trace_sink (sink);
+        Weak (loads, threads, opts, results);
+        psimpl::set_trace_sink (0);
+    }
+
+    std::ofstream csvFile;
+    if (!csvPath.empty ()) {
+        csvFile.open (csvPath);
+    }
+    std::ostream& csv = csvPath.empty () ? std::cout : csvFile;
+    csv.precision (6);
+    WriteCsv (csv, results);
+
+    if (sink) {
+        std::ofstream traceFile (tracePath);
+        recorder.write (traceFile);
+        if (!traceFile) {
+            std::cerr << "unable to write " << tracePath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
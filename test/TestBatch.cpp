@@ -0,0 +1,258 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+#include "TestBatch.h"
+#include "helper.h"
+#include "psimpl.h"
+#include <iterator>
+#include <vector>
+#include <deque>
+
+
+namespace psimpl {
+    namespace test
+{
+    //! \brief generates a batch of count polylines with 3 to 20 points each
+    template <unsigned DIM, typename T>
+    void GenerateBatch (unsigned count, T stepSize, std::vector <T>& coords, std::vector <int>& offsets) {
+        offsets.push_back (static_cast <int> (coords.size ()));
+        for (unsigned i=0; i<count; ++i) {
+            unsigned pointCount = 3 + (i * 7) % 18;
+            std::generate_n (std::back_inserter (coords), pointCount*DIM, RandomWalkLine <T, DIM> (stepSize, i + 1));
+            offsets.push_back (static_cast <int> (coords.size ()));
+        }
+    }
+
+    //! \brief simplifies each polyline of a batch using simplify_douglas_peucker
+    template <unsigned DIM, typename T, typename Distance>
+    void DouglasPeuckerLoop (const std::vector <T>& coords, const std::vector <int>& offsets, Distance tol, std::vector <T>& result, std::vector <int>& resultOffsets) {
+        resultOffsets.push_back (0);
+        for (size_t i=0; i+1<offsets.size (); ++i) {
+            psimpl::simplify_douglas_peucker <DIM> (
+                coords.begin () + offsets [i], coords.begin () + offsets [i+1], tol,
+                std::back_inserter (result));
+            resultOffsets.push_back (static_cast <int> (result.size ()));
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestDouglasPeuckerBatch::TestDouglasPeuckerBatch () {
+        TEST_RUN("empty batch", TestEmptyBatch ());
+        TEST_RUN("invalid polylines", TestInvalidPolylines ());
+        TEST_RUN("invalid tol", TestInvalidTol ());
+        TEST_RUN("loop", TestLoop ());
+        TEST_RUN("small batch", TestSmallBatch ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    // no polylines: offset count < 2
+    void TestDouglasPeuckerBatch::TestEmptyBatch () {
+        const unsigned DIM = 2;
+        const float tol = 2.f;
+
+        std::vector <float> coords, result;
+        std::vector <int> offsets, resultOffsets;
+
+        psimpl::simplify_douglas_peucker_batch <DIM> (
+            coords.begin (), offsets.begin (), offsets.end (), tol,
+            std::back_inserter (result), std::back_inserter (resultOffsets));
+
+        VERIFY_TRUE(result.empty ());
+        ASSERT_TRUE(resultOffsets.size () == 1);
+        VERIFY_TRUE(resultOffsets [0] == 0);
+    }
+
+    // incomplete points and too few points are copied, the others are simplified
+    void TestDouglasPeuckerBatch::TestInvalidPolylines () {
+        const unsigned DIM = 2;
+        const float tol = 2.5f;
+
+        std::vector <float> coords, result, expected;
+        std::vector <int> offsets, resultOffsets, expectedOffsets;
+
+        offsets.push_back (0);
+        std::generate_n (std::back_inserter (coords), 10*DIM, SawToothLine <float, DIM> ());
+        offsets.push_back (static_cast <int> (coords.size ()));
+        std::generate_n (std::back_inserter (coords), 4*DIM-1, StraightLine <float, DIM> ());
+        offsets.push_back (static_cast <int> (coords.size ()));
+        std::generate_n (std::back_inserter (coords), 2*DIM, StraightLine <float, DIM> ());
+        offsets.push_back (static_cast <int> (coords.size ()));
+        std::generate_n (std::back_inserter (coords), 10*DIM, StraightLine <float, DIM> ());
+        offsets.push_back (static_cast <int> (coords.size ()));
+
+        psimpl::simplify_douglas_peucker_batch <DIM> (
+            coords.begin (), offsets.begin (), offsets.end (), tol,
+            std::back_inserter (result), std::back_inserter (resultOffsets));
+
+        DouglasPeuckerLoop <DIM> (coords, offsets, tol, expected, expectedOffsets);
+
+        VERIFY_TRUE(result == expected);
+        VERIFY_TRUE(resultOffsets == expectedOffsets);
+    }
+
+    // invalid: tol == 0
+    void TestDouglasPeuckerBatch::TestInvalidTol () {
+        const unsigned DIM = 3;
+
+        std::vector <float> coords, result;
+        std::vector <int> offsets, resultOffsets;
+        GenerateBatch <DIM> (10, 1.f, coords, offsets);
+
+        psimpl::simplify_douglas_peucker_batch <DIM> (
+            coords.begin (), offsets.begin (), offsets.end (), 0.f,
+            std::back_inserter (result), std::back_inserter (resultOffsets));
+
+        VERIFY_TRUE(result == coords);
+        VERIFY_TRUE(resultOffsets == offsets);
+    }
+
+    // the same result as simplifying each polyline separately
+    void TestDouglasPeuckerBatch::TestLoop () {
+        {
+            const unsigned DIM = 2;
+            const float tol = 1.5f;
+
+            std::vector <float> coords, expected;
+            std::vector <int> offsets, expectedOffsets;
+            GenerateBatch <DIM> (101, 1.f, coords, offsets);
+            DouglasPeuckerLoop <DIM> (coords, offsets, tol, expected, expectedOffsets);
+
+            std::vector <float> result;
+            std::vector <int> resultOffsets;
+            psimpl::simplify_douglas_peucker_batch <DIM> (
+                coords.begin (), offsets.begin (), offsets.end (), tol,
+                std::back_inserter (result), std::back_inserter (resultOffsets));
+
+            VERIFY_TRUE(expected.size () < coords.size ());
+            VERIFY_TRUE(result == expected);
+            VERIFY_TRUE(resultOffsets == expectedOffsets);
+        }
+        {
+            const unsigned DIM = 3;
+            const double tol = 0.8;
+
+            std::vector <double> coords, expected;
+            std::vector <int> offsets, expectedOffsets;
+            GenerateBatch <DIM> (37, 1., coords, offsets);
+            DouglasPeuckerLoop <DIM> (coords, offsets, tol, expected, expectedOffsets);
+
+            std::deque <double> result;
+            std::vector <int> resultOffsets;
+            psimpl::simplify_douglas_peucker_batch <DIM> (
+                &coords [0], offsets.begin (), offsets.end (), tol,
+                std::back_inserter (result), std::back_inserter (resultOffsets));
+
+            VERIFY_TRUE(std::vector <double> (result.begin (), result.end ()) == expected);
+            VERIFY_TRUE(resultOffsets == expectedOffsets);
+        }
+        {
+            // long and short polylines alternate, so the reused buffers shrink and grow
+            const unsigned DIM = 2;
+            const double tol = 1.;
+
+            std::vector <double> coords, expected, result;
+            std::vector <int> offsets (1, 0), expectedOffsets, resultOffsets;
+            for (unsigned i=0; i<6; ++i) {
+                unsigned pointCount = i % 2 ? 4 : 500;
+                std::generate_n (std::back_inserter (coords), pointCount*DIM, RandomWalkLine <double, DIM> (1., i + 1));
+                offsets.push_back (static_cast <int> (coords.size ()));
+            }
+            DouglasPeuckerLoop <DIM> (coords, offsets, tol, expected, expectedOffsets);
+
+            psimpl::simplify_douglas_peucker_batch <DIM> (
+                coords.begin (), offsets.begin (), offsets.end (), tol,
+                std::back_inserter (result), std::back_inserter (resultOffsets));
+
+            VERIFY_TRUE(result == expected);
+            VERIFY_TRUE(resultOffsets == expectedOffsets);
+        }
+    }
+
+    // batches of a few polylines
+    void TestDouglasPeuckerBatch::TestSmallBatch () {
+        const unsigned DIM = 2;
+        const double tol = 1.5;
+
+        for (unsigned count=1; count<8; ++count) {
+            std::vector <double> coords, expected, result;
+            std::vector <int> offsets, expectedOffsets, resultOffsets;
+            GenerateBatch <DIM> (count, 1., coords, offsets);
+            DouglasPeuckerLoop <DIM> (coords, offsets, tol, expected, expectedOffsets);
+
+            psimpl::simplify_douglas_peucker_batch <DIM> (
+                coords.begin (), offsets.begin (), offsets.end (), tol,
+                std::back_inserter (result), std::back_inserter (resultOffsets));
+
+            VERIFY_TRUE(result == expected);
+            VERIFY_TRUE(resultOffsets == expectedOffsets);
+        }
+    }
+
+    void TestDouglasPeuckerBatch::TestIntegers () {
+        const unsigned DIM = 2;
+        const int tol = 3;
+
+        std::vector <int> coords, result, expected;
+        std::vector <int> offsets, resultOffsets, expectedOffsets;
+        GenerateBatch <DIM> (50, 4, coords, offsets);
+        DouglasPeuckerLoop <DIM> (coords, offsets, tol, expected, expectedOffsets);
+
+        psimpl::simplify_douglas_peucker_batch <DIM> (
+            coords.begin (), offsets.begin (), offsets.end (), tol,
+            std::back_inserter (result), std::back_inserter (resultOffsets));
+
+        VERIFY_TRUE(result == expected);
+        VERIFY_TRUE(resultOffsets == expectedOffsets);
+    }
+
+    void TestDouglasPeuckerBatch::TestReturnValue () {
+        const unsigned DIM = 2;
+
+        std::vector <float> coords;
+        std::vector <int> offsets, resultOffsets;
+        GenerateBatch <DIM> (20, 1.f, coords, offsets);
+        std::vector <float> result (coords.size ());
+
+        VERIFY_TRUE (
+            std::distance (
+                result.begin (),
+                psimpl::simplify_douglas_peucker_batch <DIM> (
+                    coords.begin (), offsets.begin (), offsets.end (), 1.f,
+                    result.begin (), std::back_inserter (resultOffsets)))
+            == resultOffsets.back ());
+    }
+
+}}
@@ -0,0 +1,383 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+
+#include "TestCounters.h"
+#include "helper.h"
+#include "psimpl.h"
+#include <iterator>
+#include <list>
+#include <vector>
+#include <algorithm>
+
+
+namespace psimpl {
+    namespace test
+{
+    TestCounters::TestCounters () {
+        TEST_RUN("bucket", TestBucket ());
+        TEST_RUN("reset/merge", TestResetMerge ());
+        TEST_RUN("same result", TestSameResult ());
+        TEST_RUN("output", TestOutput ());
+        TEST_RUN("distances", TestDistances ());
+        TEST_RUN("key searches", TestKeySearches ());
+        TEST_RUN("backtracks", TestBacktracks ());
+        TEST_RUN("accumulate", TestAccumulate ());
+        TEST_RUN("parallel and batch", TestParallelBatch ());
+        TEST_RUN("errors", TestErrors ());
+    }
+
+    // sub polyline sizes are counted in log2 buckets
+    void TestCounters::TestBucket () {
+        VERIFY_TRUE(counters::bucket (0) == 0);
+        VERIFY_TRUE(counters::bucket (1) == 0);
+        VERIFY_TRUE(counters::bucket (2) == 1);
+        VERIFY_TRUE(counters::bucket (3) == 1);
+        VERIFY_TRUE(counters::bucket (4) == 2);
+        VERIFY_TRUE(counters::bucket (1023) == 9);
+        VERIFY_TRUE(counters::bucket (1024) == 10);
+        VERIFY_TRUE(counters::bucket (~0ull) == counters::histogram_size - 1);
+    }
+
+    void TestCounters::TestResetMerge () {
+        counters a, b;
+        VERIFY_TRUE(a.distances == 0 && a.key_searches == 0 && a.max_depth == 0 &&
+                    a.backtracks == 0 && a.output == 0 && a.sub_polylines [3] == 0);
+
+        a.distances = 10; a.key_searches = 2; a.max_depth = 3; a.backtracks = 1; a.output = 5;
+        a.sub_polylines [3] = 2;
+        b.distances = 1; b.key_searches = 1; b.max_depth = 7; b.backtracks = 0; b.output = 2;
+        b.sub_polylines [3] = 1;
+        a.merge (b);
+        VERIFY_TRUE(a.distances == 11);
+        VERIFY_TRUE(a.key_searches == 3);
+        VERIFY_TRUE(a.max_depth == 7);
+        VERIFY_TRUE(a.backtracks == 1);
+        VERIFY_TRUE(a.output == 7);
+        VERIFY_TRUE(a.sub_polylines [3] == 3);
+
+        a.reset ();
+        VERIFY_TRUE(a.distances == 0 && a.key_searches == 0 && a.max_depth == 0 &&
+                    a.backtracks == 0 && a.output == 0 && a.sub_polylines [3] == 0);
+    }
+
+    // counting does not change the simplification
+    void TestCounters::TestSameResult () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 500*DIM, RandomWalkLine <double, DIM> (1., 7));
+        std::list <double> list (polyline.begin (), polyline.end ());
+        double tol = 2.;
+
+        #define COMPARE(CALL, ...)                                                              \
+        {                                                                                       \
+            std::vector <double> expected, result;                                              \
+            counters stats;                                                                     \
+            psimpl::CALL <DIM> (__VA_ARGS__, std::back_inserter (expected));                     \
+            psimpl::CALL <DIM> (__VA_ARGS__, with_counters (std::back_inserter (result), stats)); \
+            VERIFY_TRUE(result == expected);                                                    \
+            VERIFY_TRUE(stats.output == result.size ());                                        \
+        }
+
+        COMPARE(simplify_nth_point, polyline.begin (), polyline.end (), 4)
+        COMPARE(simplify_radial_distance, list.begin (), list.end (), tol)
+        COMPARE(simplify_perpendicular_distance, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_perpendicular_distance, polyline.begin (), polyline.end (), tol, 3)
+        COMPARE(simplify_reumann_witkam, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_opheim, polyline.begin (), polyline.end (), tol, 4 * tol)
+        COMPARE(simplify_lang, list.begin (), list.end (), tol, 8)
+        COMPARE(simplify_sleeve_fitting, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_optimal, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_optimal_windowed, polyline.begin (), polyline.end (), tol, 32)
+        COMPARE(simplify_douglas_peucker_classic, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_douglas_peucker_pruned, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_douglas_peucker, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_douglas_peucker_n, polyline.begin (), polyline.end (), 40)
+        COMPARE(simplify_douglas_peucker_to_count, polyline.begin (), polyline.end (), 40)
+        COMPARE(simplify_douglas_peucker_to_error, polyline.begin (), polyline.end (), 0.5)
+
+        #undef COMPARE
+
+        // with a prebuilt tree, and the found tolerance
+        std::vector <double> expected, result;
+        counters stats;
+        spatial::box_tree <DIM, double> tree (polyline.begin (), 500);
+        psimpl::simplify_douglas_peucker_pruned <DIM> (polyline.begin (), polyline.end (), tol, tree, std::back_inserter (expected));
+        psimpl::simplify_douglas_peucker_pruned <DIM> (polyline.begin (), polyline.end (), tol, tree, with_counters (std::back_inserter (result), stats));
+        VERIFY_TRUE(result == expected);
+        VERIFY_TRUE(0 < stats.key_searches);
+
+        double tol1 = 0, tol2 = 0;
+        expected.clear ();
+        result.clear ();
+        psimpl::simplify_douglas_peucker_to_count <DIM> (polyline.begin (), polyline.end (), 40, std::back_inserter (expected), &tol1);
+        psimpl::simplify_douglas_peucker_to_count <DIM> (polyline.begin (), polyline.end (), 40, with_counters (std::back_inserter (result), stats), &tol2);
+        VERIFY_TRUE(result == expected);
+        VERIFY_TRUE(tol1 == tol2 && 0 < tol1);
+    }
+
+    // output coordinates are counted, also when the input is copied
+    void TestCounters::TestOutput () {
+        const unsigned DIM = 3;
+        std::vector <float> polyline, result;
+        std::generate_n (std::back_inserter (polyline), 20*DIM, SawToothLine <float, DIM> ());
+
+        counters stats;
+        float* end = psimpl::simplify_radial_distance <DIM> (&polyline [0], &polyline [0] + polyline.size (), 0.f, with_counters (&*result.insert (result.end (), polyline.size (), 0.f), stats)).base ();
+        VERIFY_TRUE(end == &result [0] + polyline.size ());
+        VERIFY_TRUE(stats.output == 20 * DIM);
+        VERIFY_TRUE(stats.distances == 0);
+
+        stats.reset ();
+        result.clear ();
+        psimpl::simplify_nth_point <DIM> (polyline.begin (), polyline.end (), 5, with_counters (std::back_inserter (result), stats));
+        VERIFY_TRUE(stats.output == 5 * DIM);
+        VERIFY_TRUE(result.size () == 5 * DIM);
+    }
+
+    // the distance evaluations of the single pass routines
+    void TestCounters::TestDistances () {
+        const unsigned DIM = 2;
+        const unsigned count = 100;
+        std::vector <double> polyline, result;
+        std::generate_n (std::back_inserter (polyline), count*DIM, RandomWalkLine <double, DIM> (1., 3));
+
+        // each internal point is tested once
+        counters rd;
+        psimpl::simplify_radial_distance <DIM> (polyline.begin (), polyline.end (), 1.5, with_counters (std::back_inserter (result), rd));
+        VERIFY_TRUE(rd.distances == count - 2);
+
+        counters rw;
+        psimpl::simplify_reumann_witkam <DIM> (polyline.begin (), polyline.end (), 1.5, with_counters (std::back_inserter (result), rw));
+        VERIFY_TRUE(rw.distances == count - 2);
+
+        // each segment test moves up one or two points
+        counters pd;
+        psimpl::simplify_perpendicular_distance <DIM> (polyline.begin (), polyline.end (), 1.5, with_counters (std::back_inserter (result), pd));
+        VERIFY_TRUE((count - 2) / 2 <= pd.distances && pd.distances <= count - 2);
+
+        // one or two distances per internal point
+        counters op;
+        psimpl::simplify_opheim <DIM> (polyline.begin (), polyline.end (), 1.5, 6., with_counters (std::back_inserter (result), op));
+        VERIFY_TRUE(count - 2 <= op.distances && op.distances <= 2 * (count - 2));
+
+        // no key searches outside of Douglas-Peucker
+        VERIFY_TRUE(rd.key_searches == 0 && rw.key_searches == 0 && pd.key_searches == 0 && op.key_searches == 0);
+        VERIFY_TRUE(rd.max_depth == 0);
+    }
+
+    // each key splits a sub polyline in two, and each sub polyline is searched once
+    void TestCounters::TestKeySearches () {
+        const unsigned DIM = 2;
+        const unsigned count = 300;
+        std::vector <double> polyline, result;
+        std::generate_n (std::back_inserter (polyline), count*DIM, RandomWalkLine <double, DIM> (1., 5));
+
+        counters dpc;
+        psimpl::simplify_douglas_peucker_classic <DIM> (polyline.begin (), polyline.end (), 2., with_counters (std::back_inserter (result), dpc));
+        unsigned long long keys = result.size () / DIM;
+        VERIFY_TRUE(dpc.output == result.size ());
+        VERIFY_TRUE(dpc.key_searches == 2 * (keys - 2) + 1);
+        VERIFY_TRUE(1 < dpc.max_depth && dpc.max_depth < keys);
+
+        unsigned long long searches = 0;
+        for (unsigned k = 0; k < counters::histogram_size; ++k) {
+            searches += dpc.sub_polylines [k];
+        }
+        VERIFY_TRUE(searches == dpc.key_searches);
+        // the complete polyline is searched once
+        VERIFY_TRUE(dpc.sub_polylines [counters::bucket (count)] >= 1);
+        VERIFY_TRUE(dpc.distances >= count - 2);
+
+        // pruning gives the same keys with fewer distance evaluations
+        counters pruned;
+        result.clear ();
+        psimpl::simplify_douglas_peucker_pruned <DIM> (polyline.begin (), polyline.end (), 2., with_counters (std::back_inserter (result), pruned));
+        VERIFY_TRUE(pruned.key_searches == dpc.key_searches);
+        VERIFY_TRUE(pruned.max_depth == dpc.max_depth);
+
+        // DPn searches both halves of each split, except for its last key
+        counters dpn;
+        result.clear ();
+        psimpl::simplify_douglas_peucker_n <DIM> (polyline.begin (), polyline.end (), 20, with_counters (std::back_inserter (result), dpn));
+        VERIFY_TRUE(dpn.output == 20 * DIM);
+        VERIFY_TRUE(dpn.key_searches == 2 * 17 + 1);
+        VERIFY_TRUE(0 < dpn.max_depth && dpn.max_depth <= 19);
+    }
+
+    // Lang reduces its look ahead on each failed segment
+    void TestCounters::TestBacktracks () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline, result;
+
+        // all points within tolerance
+        std::generate_n (std::back_inserter (polyline), 50*DIM, StraightLine <double, DIM> ());
+        counters straight;
+        psimpl::simplify_lang <DIM> (polyline.begin (), polyline.end (), 1., 8, with_counters (std::back_inserter (result), straight));
+        VERIFY_TRUE(straight.backtracks == 0);
+        VERIFY_TRUE(0 < straight.distances);
+
+        polyline.clear ();
+        result.clear ();
+        std::generate_n (std::back_inserter (polyline), 50*DIM, SawToothLine <double, DIM> ());
+        counters saw;
+        psimpl::simplify_lang <DIM> (polyline.begin (), polyline.end (), 1., 8, with_counters (std::back_inserter (result), saw));
+        VERIFY_TRUE(0 < saw.backtracks);
+        VERIFY_TRUE(saw.output == result.size ());
+    }
+
+    // the counters are not cleared between calls
+    void TestCounters::TestAccumulate () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline, result;
+        std::generate_n (std::back_inserter (polyline), 100*DIM, RandomWalkLine <double, DIM> (1., 9));
+
+        counters once, twice;
+        psimpl::simplify_douglas_peucker_classic <DIM> (polyline.begin (), polyline.end (), 2., with_counters (std::back_inserter (result), once));
+        psimpl::simplify_douglas_peucker_classic <DIM> (polyline.begin (), polyline.end (), 2., with_counters (std::back_inserter (result), twice));
+        psimpl::simplify_douglas_peucker_classic <DIM> (polyline.begin (), polyline.end (), 2., with_counters (std::back_inserter (result), twice));
+        VERIFY_TRUE(twice.distances == 2 * once.distances);
+        VERIFY_TRUE(twice.key_searches == 2 * once.key_searches);
+        VERIFY_TRUE(twice.output == 2 * once.output);
+        VERIFY_TRUE(twice.max_depth == once.max_depth);
+    }
+
+    // the parallel, batch and multi level routines count like their serial equivalents
+    void TestCounters::TestParallelBatch () {
+        const unsigned DIM = 2;
+        const unsigned count = 100000;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), count*DIM, RandomWalkLine <double, DIM> (1., 11));
+
+        // the seams are re-run, so the threads evaluate at least as many distances
+        #define COMPARE(CALL, ...)                                                              \
+        {                                                                                       \
+            std::vector <double> expected, result;                                              \
+            counters serial, parallel;                                                          \
+            psimpl::CALL <DIM> (__VA_ARGS__, with_counters (std::back_inserter (expected), serial)); \
+            psimpl::CALL##_parallel <DIM> (__VA_ARGS__, with_counters (std::back_inserter (result), parallel), 4); \
+            VERIFY_TRUE(result == expected);                                                    \
+            VERIFY_TRUE(parallel.output == serial.output);                                      \
+            VERIFY_TRUE(serial.distances <= parallel.distances);                                \
+        }
+
+        COMPARE(simplify_radial_distance, polyline.begin (), polyline.end (), 2.)
+        COMPARE(simplify_reumann_witkam, polyline.begin (), polyline.end (), 2.)
+        COMPARE(simplify_opheim, polyline.begin (), polyline.end (), 2., 10.)
+        COMPARE(simplify_lang, polyline.begin (), polyline.end (), 2., 8)
+
+        #undef COMPARE
+
+        // several tolerances at once test each point against each level
+        {
+            double tols [] = {1., 2., 4.};
+            std::vector <double> levels [3];
+            std::back_insert_iterator <std::vector <double> > outputs [3] = {
+                std::back_inserter (levels [0]), std::back_inserter (levels [1]), std::back_inserter (levels [2])
+            };
+            counters stats;
+            psimpl::simplify_radial_distance_multi <DIM> (
+                polyline.begin (), polyline.end (), tols, tols + 3, outputs, with_counters (stats));
+            VERIFY_TRUE(stats.distances == 3 * (count - 2));
+        }
+        // a batch counts the work of all its polylines
+        {
+            std::vector <double> result;
+            std::vector <std::size_t> offsets, result_offsets;
+            for (std::size_t offset = 0; offset <= 2000*DIM; offset += 100*DIM) {
+                offsets.push_back (offset);
+            }
+            counters batch, loop;
+            psimpl::simplify_douglas_peucker_batch <DIM> (
+                polyline.begin (), offsets.begin (), offsets.end (), 2.,
+                with_counters (std::back_inserter (result), batch), std::back_inserter (result_offsets));
+            for (std::size_t i = 1; i < offsets.size (); ++i) {
+                std::vector <double> single;
+                psimpl::simplify_douglas_peucker <DIM> (
+                    polyline.begin () + offsets [i-1], polyline.begin () + offsets [i], 2.,
+                    with_counters (std::back_inserter (single), loop));
+            }
+            VERIFY_TRUE(batch.output == result.size ());
+            VERIFY_TRUE(batch.distances == loop.distances);
+            VERIFY_TRUE(batch.key_searches == loop.key_searches);
+        }
+    }
+
+    // the error routines count one evaluation per original point
+    void TestCounters::TestErrors () {
+        const unsigned DIM = 2;
+        const unsigned count = 50000;
+        std::vector <double> polyline, simplification;
+        std::vector <std::size_t> keys;
+        std::generate_n (std::back_inserter (polyline), count*DIM, RandomWalkLine <double, DIM> (1., 13));
+        psimpl::simplify_douglas_peucker <DIM> (
+            polyline.begin (), polyline.end (), 2., std::back_inserter (simplification));
+        for (std::size_t i = 0, k = 0; i < count && k < simplification.size (); ++i) {
+            if (polyline [i*DIM] == simplification [k] && polyline [i*DIM+1] == simplification [k+1]) {
+                keys.push_back (i);
+                k += DIM;
+            }
+        }
+        std::vector <double> errors (count);
+
+        counters indexed;
+        psimpl::compute_positional_errors2_indexed <DIM> (
+            polyline.begin (), polyline.end (), keys.begin (), keys.end (),
+            with_counters (errors.begin (), indexed));
+        VERIFY_TRUE(indexed.distances == count);
+        VERIFY_TRUE(indexed.output == count);
+
+        counters statistics, parallel;
+        psimpl::compute_positional_error_statistics_indexed <DIM> (
+            polyline.begin (), polyline.end (), keys.begin (), keys.end (), 0, with_counters (statistics));
+        psimpl::compute_positional_errors2_indexed_parallel <DIM> (
+            polyline.begin (), polyline.end (), keys.begin (), keys.end (), errors.begin (), 0, 4,
+            with_counters (parallel));
+        VERIFY_TRUE(statistics.distances == count);
+        VERIFY_TRUE(parallel.distances == count);
+
+        // the areas of the segments are written, each internal point is added once
+        counters areal, areal_parallel;
+        std::vector <double> areas;
+        psimpl::compute_areal_displacements <DIM> (
+            polyline.begin (), polyline.end (), simplification.begin (), simplification.end (),
+            with_counters (std::back_inserter (areas), areal));
+        psimpl::compute_areal_displacement_parallel <DIM> (
+            polyline.begin (), polyline.end (), simplification.begin (), simplification.end (), 0, 4,
+            with_counters (areal_parallel));
+        VERIFY_TRUE(areal.output == keys.size () - 1);
+        VERIFY_TRUE(areal.distances == count - keys.size ());
+        VERIFY_TRUE(areal_parallel.distances == areal.distances);
+    }
+}}
@@ -0,0 +1,537 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+#include "TestDistance.h"
+#include "helper.h"
+#include "psimpl.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+
+namespace psimpl {
+    namespace test
+{
+    //! \brief squared distance from point p to the segments of polyline, O(m)
+    template <unsigned DIM, typename T>
+    double BruteDistance2 (const std::vector <T>& polyline, const double* p) {
+        size_t m = polyline.size () / DIM;
+        double nearest = std::numeric_limits <double>::infinity ();
+        for (size_t j=0; j+1<std::max (m, size_t (2)); ++j) {
+            double a [DIM], b [DIM];
+            for (unsigned d=0; d<DIM; ++d) {
+                a [d] = polyline [j*DIM+d];
+                b [d] = polyline [std::min (j+1, m-1)*DIM+d];
+            }
+            nearest = std::min (nearest, static_cast <double> (psimpl::math::segment_distance2 <DIM> (a, b, p)));
+        }
+        return nearest;
+    }
+
+    //! \brief largest distance from a point of polyline1 to the segments of polyline2, sampling
+    //! each segment of polyline1 at samples + 1 points, O(n * m * samples); as the distance
+    //! changes by at most the distance travelled, upper receives an upper bound of the result
+    template <unsigned DIM, typename T>
+    double BruteDirectedHausdorff (const std::vector <T>& polyline1, const std::vector <T>& polyline2,
+                                   unsigned samples, double& upper) {
+        size_t n = polyline1.size () / DIM;
+        double result = 0;
+        upper = 0;
+        for (size_t i=0; i<std::max (n, size_t (2))-1; ++i) {
+            double p [DIM], q [DIM], length2 = 0;
+            for (unsigned d=0; d<DIM; ++d) {
+                p [d] = polyline1 [i*DIM+d];
+                q [d] = polyline1 [std::min (i+1, n-1)*DIM+d];
+                length2 += (q [d] - p [d]) * (q [d] - p [d]);
+            }
+            double step = std::sqrt (length2) / samples;
+            double previous = 0;
+            for (unsigned k=0; k<=samples; ++k) {
+                double x [DIM];
+                for (unsigned d=0; d<DIM; ++d) {
+                    x [d] = p [d] + (q [d] - p [d]) * k / samples;
+                }
+                double distance = std::sqrt (BruteDistance2 <DIM> (polyline2, x));
+                result = std::max (result, distance);
+                if (k) {
+                    upper = std::max (upper, (previous + distance + step) / 2);
+                }
+                previous = distance;
+            }
+        }
+        upper = std::max (upper, result);
+        return result;
+    }
+
+    //! \brief discrete Frechet distance using the full n * m table
+    template <unsigned DIM, typename T>
+    double BruteFrechet (const std::vector <T>& polyline1, const std::vector <T>& polyline2) {
+        size_t n = polyline1.size () / DIM, m = polyline2.size () / DIM;
+        std::vector <double> table (n * m);
+        for (size_t i=0; i<n; ++i) {
+            for (size_t j=0; j<m; ++j) {
+                double d = psimpl::math::point_distance2 <DIM> (polyline1.begin () + i*DIM, polyline2.begin () + j*DIM);
+                double reach = 0;
+                if (i && j) {
+                    reach = std::min (table [(i-1)*m+j-1], std::min (table [(i-1)*m+j], table [i*m+j-1]));
+                }
+                else if (i) {
+                    reach = table [(i-1)*m+j];
+                }
+                else if (j) {
+                    reach = table [j-1];
+                }
+                table [i*m+j] = std::max (d, reach);
+            }
+        }
+        return std::sqrt (table.back ());
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestHausdorffDistance::TestHausdorffDistance () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("known distance", TestKnownDistance ());
+        TEST_RUN("symmetry", TestSymmetry ());
+        TEST_RUN("brute force", TestBruteForce ());
+        TEST_RUN("segment interior", TestSegmentInterior ());
+        TEST_RUN("large coordinates", TestLargeCoordinates ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+    }
+
+    void TestHausdorffDistance::TestInvalidInput () {
+        const unsigned DIM = 2;
+        float polyline [] = {0.f, 0.f, 1.f, 1.f, 2.f};
+        bool valid = true;
+
+        // incomplete point
+        psimpl::compute_hausdorff_distance <DIM> (polyline, polyline + 5, polyline, polyline + 4, &valid);
+        VERIFY_FALSE(valid);
+
+        // no points
+        valid = true;
+        psimpl::compute_hausdorff_distance <DIM> (polyline, polyline + 4, polyline, polyline, &valid);
+        VERIFY_FALSE(valid);
+
+        // a single point is valid
+        valid = false;
+        VERIFY_TRUE(psimpl::compute_hausdorff_distance <DIM> (polyline, polyline + 2, polyline + 2, polyline + 4, &valid) == std::sqrt (2.));
+        VERIFY_TRUE(valid);
+    }
+
+    void TestHausdorffDistance::TestKnownDistance () {
+        const unsigned DIM = 2;
+
+        // a polyline does not need to share points with its approximation
+        double original [] = {0, 0, 1, 1, 2, 0, 3, -2, 4, 0};
+        double approximation [] = {0, 0.5, 4, 0.5};
+        bool valid = false;
+        double distance = psimpl::compute_hausdorff_distance <DIM> (
+            original, original + 10, approximation, approximation + 4, &valid);
+        VERIFY_TRUE(valid);
+        VERIFY_TRUE(CompareValue (distance, 2.5));
+
+        // identical polylines
+        VERIFY_TRUE(psimpl::compute_hausdorff_distance <DIM> (original, original + 10, original, original + 10) == 0);
+
+        // a vertex subset only has a distance from the original to the subset
+        double subset [] = {0, 0, 2, 0, 4, 0};
+        VERIFY_TRUE(CompareValue (psimpl::compute_hausdorff_distance <DIM> (original, original + 10, subset, subset + 6), 2.));
+    }
+
+    void TestHausdorffDistance::TestSymmetry () {
+        const unsigned DIM = 3;
+
+        std::vector <double> polyline1, polyline2;
+        std::generate_n (std::back_inserter (polyline1), 500*DIM, RandomWalkLine <double, DIM> (1., 3));
+        std::generate_n (std::back_inserter (polyline2), 300*DIM, RandomWalkLine <double, DIM> (1., 4));
+
+        double d12 = psimpl::compute_hausdorff_distance <DIM> (polyline1.begin (), polyline1.end (), polyline2.begin (), polyline2.end ());
+        double d21 = psimpl::compute_hausdorff_distance <DIM> (polyline2.begin (), polyline2.end (), polyline1.begin (), polyline1.end ());
+        VERIFY_TRUE(d12 == d21);
+    }
+
+    // simplifications of a random walk, compared to an exhaustive search
+    void TestHausdorffDistance::TestBruteForce () {
+        const unsigned DIM = 2;
+
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 1000*DIM, RandomWalkLine <double, DIM> ());
+
+        const double tolerances [] = {0.5, 2, 10};
+        for (unsigned t=0; t<3; ++t) {
+            std::vector <double> simplification;
+            psimpl::simplify_douglas_peucker <DIM> (polyline.begin (), polyline.end (), tolerances [t], std::back_inserter (simplification));
+
+            // a shifted copy, so that the polylines do not share points
+            for (size_t i=0; i<simplification.size (); ++i) {
+                simplification [i] += 0.25;
+            }
+            double upper12, upper21;
+            double lower = std::max (BruteDirectedHausdorff <DIM> (polyline, simplification, 16, upper12),
+                                     BruteDirectedHausdorff <DIM> (simplification, polyline, 16, upper21));
+            double distance = psimpl::compute_hausdorff_distance <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end ());
+            VERIFY_TRUE(lower <= distance + double_epsilon);
+            VERIFY_TRUE(distance <= std::max (upper12, upper21) + double_epsilon);
+        }
+    }
+
+    // the largest distance lies inside a segment, where its nearest segment changes
+    void TestHausdorffDistance::TestSegmentInterior () {
+        const unsigned DIM = 2;
+
+        // (4, 5) on the second segment of polyline1 lies 3 away from both segments of polyline2,
+        // while each point lies at most sqrt (2) away from the other polyline
+        double polyline1 [] = {7, 8, 7, 2, 2, 7};
+        double polyline2 [] = {3, 8, 7, 8, 7, 2};
+        VERIFY_TRUE(CompareValue (psimpl::compute_hausdorff_distance <DIM> (
+            polyline1, polyline1 + 6, polyline2, polyline2 + 6), 3.));
+        VERIFY_TRUE(CompareValue (psimpl::compute_hausdorff_distance <DIM> (
+            polyline2, polyline2 + 6, polyline1, polyline1 + 6), 3.));
+
+        // small random polylines, compared to a dense sampling
+        RandomWalkLine <double, DIM> walk (4.);
+        for (unsigned i=0; i<200; ++i) {
+            std::vector <double> p1, p2;
+            std::generate_n (std::back_inserter (p1), (2 + i % 4)*DIM, walk);
+            std::generate_n (std::back_inserter (p2), (2 + i % 5)*DIM, walk);
+            double upper12, upper21;
+            double lower = std::max (BruteDirectedHausdorff <DIM> (p1, p2, 1000, upper12),
+                                     BruteDirectedHausdorff <DIM> (p2, p1, 1000, upper21));
+            double distance = psimpl::compute_hausdorff_distance <DIM> (p1.begin (), p1.end (), p2.begin (), p2.end ());
+            VERIFY_TRUE(lower <= distance + double_epsilon);
+            VERIFY_TRUE(distance <= std::max (upper12, upper21) + double_epsilon);
+        }
+    }
+
+    // far from the origin distances are rounded, which must neither stall nor change the result
+    void TestHausdorffDistance::TestLargeCoordinates () {
+        const unsigned DIM = 2;
+
+        const double offsets [] = {5e6, 1e9};
+        for (unsigned i=0; i<120; ++i) {
+            std::vector <double> polyline, simplification;
+            std::generate_n (std::back_inserter (polyline), (200 + i*10)*DIM, RandomWalkLine <double, DIM> (1., i + 1));
+            psimpl::simplify_douglas_peucker <DIM> (polyline.begin (), polyline.end (), 1., std::back_inserter (simplification));
+            // small offsets, so that the simplification does not share points with the polyline
+            for (size_t j=0; j<simplification.size (); ++j) {
+                simplification [j] += 0.01 * ((j * 7919 + i) % 101) / 101;
+            }
+            double distance = psimpl::compute_hausdorff_distance <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end ());
+
+            for (unsigned o=0; o<2; ++o) {
+                std::vector <double> far1 (polyline), far2 (simplification);
+                for (size_t j=0; j<far1.size (); ++j) {
+                    far1 [j] += offsets [o];
+                }
+                for (size_t j=0; j<far2.size (); ++j) {
+                    far2 [j] += offsets [o];
+                }
+                double farDistance = psimpl::compute_hausdorff_distance <DIM> (
+                    far1.begin (), far1.end (), far2.begin (), far2.end ());
+                VERIFY_TRUE(std::abs (farDistance - distance) <= double_epsilon);
+            }
+        }
+    }
+
+    void TestHausdorffDistance::TestIntegers () {
+        const unsigned DIM = 2;
+        int polyline1 [] = {0, 0, 10, 0, 20, 0};
+        unsigned polyline2 [] = {0, 3, 20, 4};
+
+        VERIFY_TRUE(CompareValue (psimpl::compute_hausdorff_distance <DIM> (
+            polyline1, polyline1 + 6, polyline2, polyline2 + 4), 4.));
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestFrechetDistance::TestFrechetDistance () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("known distance", TestKnownDistance ());
+        TEST_RUN("order", TestOrder ());
+        TEST_RUN("brute force", TestBruteForce ());
+        TEST_RUN("band", TestBand ());
+    }
+
+    void TestFrechetDistance::TestInvalidInput () {
+        const unsigned DIM = 2;
+        float polyline [] = {0.f, 0.f, 1.f, 1.f, 2.f};
+        bool valid = true;
+
+        psimpl::compute_discrete_frechet_distance <DIM> (polyline, polyline + 5, polyline, polyline + 4, &valid);
+        VERIFY_FALSE(valid);
+
+        valid = true;
+        psimpl::compute_discrete_frechet_distance <DIM> (polyline, polyline, polyline, polyline + 4, &valid);
+        VERIFY_FALSE(valid);
+
+        valid = true;
+        psimpl::compute_discrete_frechet_distance_banded <DIM> (polyline, polyline + 4, polyline, polyline + 4, -1, &valid);
+        VERIFY_FALSE(valid);
+
+        valid = false;
+        VERIFY_TRUE(psimpl::compute_discrete_frechet_distance <DIM> (polyline, polyline + 4, polyline, polyline + 2, &valid) == std::sqrt (2.));
+        VERIFY_TRUE(valid);
+    }
+
+    void TestFrechetDistance::TestKnownDistance () {
+        const unsigned DIM = 2;
+        double polyline1 [] = {0, 0, 1, 0, 2, 0, 3, 0};
+        double polyline2 [] = {0, 1, 3, 1};
+        bool valid = false;
+
+        // (1,0) and (2,0) are each coupled to an end point of polyline2
+        VERIFY_TRUE(CompareValue (psimpl::compute_discrete_frechet_distance <DIM> (
+            polyline1, polyline1 + 8, polyline2, polyline2 + 4, &valid), std::sqrt (2.)));
+        VERIFY_TRUE(valid);
+        VERIFY_TRUE(psimpl::compute_discrete_frechet_distance <DIM> (polyline1, polyline1 + 8, polyline1, polyline1 + 8) == 0);
+    }
+
+    // unlike the Hausdorff distance, the Frechet distance sees a reversed polyline
+    void TestFrechetDistance::TestOrder () {
+        const unsigned DIM = 2;
+        double forward [] = {0, 0, 1, 0, 2, 0};
+        double backward [] = {2, 0, 1, 0, 0, 0};
+
+        VERIFY_TRUE(psimpl::compute_hausdorff_distance <DIM> (forward, forward + 6, backward, backward + 6) == 0);
+        VERIFY_TRUE(CompareValue (psimpl::compute_discrete_frechet_distance <DIM> (forward, forward + 6, backward, backward + 6), 2.));
+    }
+
+    void TestFrechetDistance::TestBruteForce () {
+        const unsigned DIM = 2;
+
+        std::vector <double> polyline1, polyline2;
+        std::generate_n (std::back_inserter (polyline1), 400*DIM, RandomWalkLine <double, DIM> (1., 5));
+        std::generate_n (std::back_inserter (polyline2), 150*DIM, RandomWalkLine <double, DIM> (1., 6));
+
+        double expected = BruteFrechet <DIM> (polyline1, polyline2);
+        VERIFY_TRUE(psimpl::compute_discrete_frechet_distance <DIM> (
+            polyline1.begin (), polyline1.end (), polyline2.begin (), polyline2.end ()) == expected);
+        VERIFY_TRUE(psimpl::compute_discrete_frechet_distance <DIM> (
+            polyline2.begin (), polyline2.end (), polyline1.begin (), polyline1.end ()) == expected);
+
+        // a band wider than the polylines is exact
+        VERIFY_TRUE(psimpl::compute_discrete_frechet_distance_banded <DIM> (
+            polyline1.begin (), polyline1.end (), polyline2.begin (), polyline2.end (), 1000) == expected);
+    }
+
+    void TestFrechetDistance::TestBand () {
+        const unsigned DIM = 2;
+
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 2000*DIM, RandomWalkLine <double, DIM> ());
+        std::vector <double> simplification;
+        psimpl::simplify_nth_point <DIM> (polyline.begin (), polyline.end (), 4, std::back_inserter (simplification));
+
+        double expected = BruteFrechet <DIM> (polyline, simplification);
+
+        // a narrow band is an upper bound, that becomes exact when it is wide enough
+        double previous = std::numeric_limits <double>::infinity ();
+        const int bands [] = {1, 2, 5, 50};
+        for (unsigned b=0; b<4; ++b) {
+            double banded = psimpl::compute_discrete_frechet_distance_banded <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end (), bands [b]);
+            VERIFY_TRUE(expected <= banded);
+            VERIFY_TRUE(banded <= previous);
+            previous = banded;
+        }
+        VERIFY_TRUE(previous == expected);
+
+        // the same with the polylines swapped
+        VERIFY_TRUE(psimpl::compute_discrete_frechet_distance_banded <DIM> (
+            simplification.begin (), simplification.end (), polyline.begin (), polyline.end (), 50) == expected);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestArealDisplacement::TestArealDisplacement () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("known area", TestKnownArea ());
+        TEST_RUN("crossings", TestCrossings ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+        TEST_RUN("parallel", TestParallel ());
+        TEST_RUN("batch", TestBatch ());
+    }
+
+    void TestArealDisplacement::TestInvalidInput () {
+        const unsigned DIM = 2;
+        double polyline [] = {0, 0, 1, 1, 2, 0, 3};
+        double simplification [] = {0, 0, 2, 0};
+        bool valid = true;
+
+        // incomplete point
+        psimpl::compute_areal_displacement <DIM> (polyline, polyline + 7, simplification, simplification + 4, &valid);
+        VERIFY_FALSE(valid);
+
+        // not enough points
+        valid = true;
+        psimpl::compute_areal_displacement <DIM> (polyline, polyline + 6, simplification, simplification + 2, &valid);
+        VERIFY_FALSE(valid);
+
+        // a simplification that does not match
+        double other [] = {0, 0, 5, 5};
+        valid = true;
+        psimpl::compute_areal_displacement <DIM> (polyline, polyline + 6, other, other + 4, &valid);
+        VERIFY_FALSE(valid);
+        valid = true;
+        psimpl::compute_areal_displacement_parallel <DIM> (polyline, polyline + 6, other, other + 4, &valid, 4);
+        VERIFY_FALSE(valid);
+    }
+
+    void TestArealDisplacement::TestKnownArea () {
+        const unsigned DIM = 2;
+        //                    -- triangle ---  -- square, on the other side --
+        double polyline [] = {0, 0, 1, 1, 2, 0, 2, -2, 4, -2, 4, 0, 5, 0};
+        double simplification [] = {0, 0, 2, 0, 4, 0, 5, 0};
+        bool valid = false;
+
+        std::vector <double> areas;
+        psimpl::compute_areal_displacements <DIM> (
+            polyline, polyline + 14, simplification, simplification + 8, std::back_inserter (areas), &valid);
+        VERIFY_TRUE(valid);
+        ASSERT_TRUE(areas.size () == 3);
+        VERIFY_TRUE(CompareValue (areas [0], 1.));
+        VERIFY_TRUE(CompareValue (areas [1], 4.));
+        VERIFY_TRUE(CompareValue (areas [2], 0.));
+
+        VERIFY_TRUE(CompareValue (psimpl::compute_areal_displacement <DIM> (
+            polyline, polyline + 14, simplification, simplification + 8), 5.));
+
+        // the polyline itself
+        VERIFY_TRUE(psimpl::compute_areal_displacement <DIM> (polyline, polyline + 14, polyline, polyline + 14) == 0);
+    }
+
+    // areas on opposite sides of a segment do not cancel out
+    void TestArealDisplacement::TestCrossings () {
+        const unsigned DIM = 2;
+
+        // crosses the segment at (1.5, 0)
+        double zigzag [] = {0, 0, 1, 1, 2, -1, 3, 0};
+        double segment [] = {0, 0, 3, 0};
+        VERIFY_TRUE(CompareValue (psimpl::compute_areal_displacement <DIM> (zigzag, zigzag + 8, segment, segment + 4), 1.5));
+
+        // touches the segment at (2, 0)
+        double touch [] = {0, 0, 1, 1, 2, 0, 3, -1, 4, 0};
+        double segment2 [] = {0, 0, 4, 0};
+        VERIFY_TRUE(CompareValue (psimpl::compute_areal_displacement <DIM> (touch, touch + 10, segment2, segment2 + 4), 2.));
+
+        // a segment that is not axis aligned: the zigzag rotated by 90 degrees and scaled by 2
+        double rotated [] = {0, 0, -2, 2, 2, 4, 0, 6};
+        double segment3 [] = {0, 0, 0, 6};
+        VERIFY_TRUE(CompareValue (psimpl::compute_areal_displacement <DIM> (rotated, rotated + 8, segment3, segment3 + 4), 6.));
+    }
+
+    void TestArealDisplacement::TestIntegers () {
+        const unsigned DIM = 2;
+        int polyline [] = {0, 0, 1, 1, 2, 0};
+        unsigned upolyline [] = {0, 0, 1, 1, 2, 0};
+        int simplification [] = {0, 0, 2, 0};
+
+        VERIFY_TRUE(CompareValue (psimpl::compute_areal_displacement <DIM> (polyline, polyline + 6, simplification, simplification + 4), 1.));
+        VERIFY_TRUE(CompareValue (psimpl::compute_areal_displacement <DIM> (upolyline, upolyline + 6, simplification, simplification + 4), 1.));
+    }
+
+    void TestArealDisplacement::TestParallel () {
+        const unsigned DIM = 2;
+        const unsigned pointCount = 100000;
+
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), pointCount*DIM, RandomWalkLine <double, DIM> ());
+
+        const double tolerances [] = {1, 20, 1000};
+        for (unsigned t=0; t<3; ++t) {
+            std::vector <double> simplification;
+            psimpl::simplify_douglas_peucker <DIM> (polyline.begin (), polyline.end (), tolerances [t], std::back_inserter (simplification));
+
+            double expected = psimpl::compute_areal_displacement <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end ());
+            VERIFY_TRUE(expected > 0);
+
+            const unsigned threadCounts [] = {0, 1, 2, 3, 7};
+            for (unsigned i=0; i<5; ++i) {
+                bool valid = false;
+                double area = psimpl::compute_areal_displacement_parallel <DIM> (
+                    polyline.begin (), polyline.end (), simplification.begin (), simplification.end (), &valid, threadCounts [i]);
+                VERIFY_TRUE(valid);
+                VERIFY_TRUE(std::fabs (area - expected) <= 1e-9 * expected);
+            }
+        }
+    }
+
+    void TestArealDisplacement::TestBatch () {
+        const unsigned DIM = 2;
+
+        std::vector <double> batch;
+        std::vector <int> offsets (1, 0);
+        for (unsigned i=0; i<50; ++i) {
+            std::generate_n (std::back_inserter (batch), (3 + i % 20) * DIM, RandomWalkLine <double, DIM> (1., i + 1));
+            offsets.push_back (static_cast <int> (batch.size ()));
+        }
+        std::vector <double> simplified (batch.size ());
+        std::vector <int> simplifiedOffsets (offsets.size ());
+        psimpl::simplify_douglas_peucker_batch <DIM> (
+            batch.begin (), offsets.begin (), offsets.end (), 0.5, simplified.begin (), simplifiedOffsets.begin ());
+
+        std::vector <double> areas;
+        bool valid = false;
+        psimpl::compute_areal_displacement_batch <DIM> (
+            batch.begin (), offsets.begin (), offsets.end (),
+            simplified.begin (), simplifiedOffsets.begin (), std::back_inserter (areas), &valid);
+        VERIFY_TRUE(valid);
+        ASSERT_TRUE(areas.size () == 50);
+
+        bool equal = true;
+        for (unsigned i=0; i<50; ++i) {
+            double expected = psimpl::compute_areal_displacement <DIM> (
+                batch.begin () + offsets [i], batch.begin () + offsets [i+1],
+                simplified.begin () + simplifiedOffsets [i], simplified.begin () + simplifiedOffsets [i+1]);
+            equal = equal && areas [i] == expected;
+        }
+        VERIFY_TRUE(equal);
+
+        // an incomplete polyline
+        offsets [1] -= 1;
+        areas.clear ();
+        psimpl::compute_areal_displacement_batch <DIM> (
+            batch.begin (), offsets.begin (), offsets.end (),
+            simplified.begin (), simplifiedOffsets.begin (), std::back_inserter (areas), &valid);
+        VERIFY_FALSE(valid);
+        VERIFY_TRUE(areas.size () == 50 && areas [0] == 0);
+    }
+
+}}
@@ -0,0 +1,94 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+#ifndef PSIMPL_TEST_DISTANCE
+#define PSIMPL_TEST_DISTANCE
+
+
+#include "test.h"
+
+
+namespace psimpl {
+    namespace test
+{
+    //! Tests function psimpl::compute_hausdorff_distance
+    class TestHausdorffDistance
+    {
+    public:
+        TestHausdorffDistance ();
+
+    private:
+        void TestInvalidInput ();
+        void TestKnownDistance ();
+        void TestSymmetry ();
+        void TestBruteForce ();
+        void TestSegmentInterior ();
+        void TestLargeCoordinates ();
+        void TestIntegers ();
+    };
+
+    //! Tests functions psimpl::compute_discrete_frechet_distance and
+    //! psimpl::compute_discrete_frechet_distance_banded
+    class TestFrechetDistance
+    {
+    public:
+        TestFrechetDistance ();
+
+    private:
+        void TestInvalidInput ();
+        void TestKnownDistance ();
+        void TestOrder ();
+        void TestBruteForce ();
+        void TestBand ();
+    };
+
+    //! Tests functions psimpl::compute_areal_displacements, psimpl::compute_areal_displacement
+    //! and its parallel and batch variants
+    class TestArealDisplacement
+    {
+    public:
+        TestArealDisplacement ();
+
+    private:
+        void TestInvalidInput ();
+        void TestKnownArea ();
+        void TestCrossings ();
+        void TestIntegers ();
+        void TestParallel ();
+        void TestBatch ();
+    };
+}}
+
+
+#endif // PSIMPL_TEST_DISTANCE
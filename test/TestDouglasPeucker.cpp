@@ -36,6 +36,7 @@
 #include "helper.h"
 #include "test_helpers.h"  // Include the new test helpers
 #include "psimpl.h"
+#include <chrono>
 #include <iterator>
 #include <vector>
 #include <deque>
@@ -1016,4 +1017,490 @@ namespace psimpl {
         );
     }
 
+    // ---------------------------------------------------------------------------------------------
+
+    TestDouglasPeuckerNRefiner::TestDouglasPeuckerNRefiner () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("matches douglas peucker n", TestMatchesDouglasPeuckerN ());
+        TEST_RUN("refine until", TestRefineUntil ());
+        TEST_RUN("refine last", TestRefineLast ());
+        TEST_RUN("key indices", TestKeyIndices ());
+    }
+
+    // invalid input is fully refined, and copied
+    void TestDouglasPeuckerNRefiner::TestInvalidInput () {
+        const unsigned DIM = 2;
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), 10*DIM-1, StraightLine <float, DIM> ());
+
+        typedef psimpl::algo::douglas_peucker_n_refiner <DIM, std::vector <float>::const_iterator> refiner_type;
+        refiner_type incomplete (polyline.begin (), polyline.end ());
+        VERIFY_TRUE(incomplete.done ());
+        VERIFY_TRUE(incomplete.refine (5) == 0);
+
+        std::vector <float> result;
+        incomplete.copy_keys (std::back_inserter (result));
+        VERIFY_TRUE(polyline == result);
+
+        polyline.assign (2*DIM, 1.f);
+        refiner_type small (polyline.begin (), polyline.end ());
+        std::vector <int> indices;
+        small.copy_key_indices (std::back_inserter (indices));
+        VERIFY_TRUE(small.done () && small.key_count () == 2);
+        VERIFY_TRUE(indices.size () == 2 && indices [0] == 0 && indices [1] == 1);
+    }
+
+    // refining step by step gives the result of DPn for each count
+    void TestDouglasPeuckerNRefiner::TestMatchesDouglasPeuckerN () {
+        const unsigned DIM = 2;
+        const unsigned count = 1000;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), count*DIM, RandomWalkLine <double, DIM> ());
+
+        psimpl::algo::douglas_peucker_n_refiner <DIM, std::vector <double>::const_iterator> refiner (
+            polyline.begin (), polyline.end ());
+        VERIFY_TRUE(refiner.key_count () == 2);
+
+        const unsigned steps [] = {0, 1, 7, 40, 300, 500};
+        for (unsigned s=0; s<6; ++s) {
+            refiner.refine (steps [s]);
+
+            std::vector <double> result, expected;
+            refiner.copy_keys (std::back_inserter (result));
+            psimpl::simplify_douglas_peucker_n <DIM> (
+                polyline.begin (), polyline.end (), refiner.key_count (), std::back_inserter (expected));
+            VERIFY_TRUE(result == expected);
+            VERIFY_TRUE(result.size () == refiner.key_count () * DIM);
+            VERIFY_TRUE(0 < refiner.max_distance2 ());
+        }
+
+        // refine to the end
+        refiner.refine (count);
+        VERIFY_TRUE(refiner.done ());
+        VERIFY_TRUE(refiner.key_count () == count);
+        VERIFY_TRUE(refiner.max_distance2 () == 0);
+        VERIFY_TRUE(refiner.refine (1) == 0);
+    }
+
+    void TestDouglasPeuckerNRefiner::TestRefineUntil () {
+        const unsigned DIM = 3;
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), 2000*DIM, RandomWalkLine <float, DIM> ());
+
+        psimpl::algo::douglas_peucker_n_refiner <DIM, const float*> refiner (
+            &polyline [0], &polyline [0] + polyline.size ());
+
+        // a passed deadline adds nothing
+        VERIFY_TRUE(refiner.refine_until (std::chrono::steady_clock::now () - std::chrono::seconds (1)) == 0);
+        VERIFY_TRUE(refiner.key_count () == 2);
+
+        // a distant deadline refines completely
+        std::size_t added = refiner.refine_until (std::chrono::steady_clock::now () + std::chrono::hours (1));
+        VERIFY_TRUE(refiner.done ());
+        VERIFY_TRUE(added + 2 == refiner.key_count ());
+    }
+
+    // the last key is the next key, after which the refiner is done
+    void TestDouglasPeuckerNRefiner::TestRefineLast () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 1000*DIM, RandomWalkLine <double, DIM> ());
+
+        typedef psimpl::algo::douglas_peucker_n_refiner <DIM, std::vector <double>::const_iterator> refiner_type;
+        refiner_type last (polyline.begin (), polyline.end ());
+        refiner_type next (polyline.begin (), polyline.end ());
+        last.refine (20);
+        next.refine (21);
+        VERIFY_TRUE(last.refine_last () == 1);
+        VERIFY_TRUE(last.done ());
+        VERIFY_TRUE(last.key_count () == next.key_count ());
+        VERIFY_TRUE(last.refine_last () == 0);
+
+        std::vector <double> result, expected;
+        last.copy_keys (std::back_inserter (result));
+        next.copy_keys (std::back_inserter (expected));
+        VERIFY_TRUE(result == expected);
+    }
+
+    // the indices select the same points as the coordinates
+    void TestDouglasPeuckerNRefiner::TestKeyIndices () {
+        const unsigned DIM = 2;
+        std::vector <int> polyline;
+        std::generate_n (std::back_inserter (polyline), 500*DIM, RandomWalkLine <int, DIM> (10));
+
+        psimpl::algo::douglas_peucker_n_refiner <DIM, std::vector <int>::const_iterator> refiner (
+            polyline.begin (), polyline.end ());
+        refiner.refine (50);
+
+        std::vector <int> result, indices;
+        refiner.copy_keys (std::back_inserter (result));
+        refiner.copy_key_indices (std::back_inserter (indices));
+        VERIFY_TRUE(indices.size () == 52);
+        VERIFY_TRUE(result.size () == 52*DIM);
+        VERIFY_TRUE(ComparePoints <DIM> (polyline.begin (), result.begin (), indices));
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    //! \brief compares simplify_douglas_peucker_pruned to simplify_douglas_peucker_classic
+    template <unsigned DIM, typename T>
+    bool DouglasPeuckerPrunedMatches (const std::vector <T>& polyline, double tol, std::ptrdiff_t leafSize) {
+        std::vector <T> expected, result;
+        psimpl::simplify_douglas_peucker_classic <DIM> (
+            polyline.begin (), polyline.end (), tol, std::back_inserter (expected));
+
+        psimpl::spatial::box_tree <DIM, double> tree (polyline.begin (), polyline.size () / DIM, leafSize);
+        psimpl::simplify_douglas_peucker_pruned <DIM> (
+            polyline.begin (), polyline.end (), tol, tree, std::back_inserter (result));
+        return result == expected;
+    }
+
+    TestDouglasPeuckerPruned::TestDouglasPeuckerPruned () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("matches classic", TestMatchesClassic ());
+        TEST_RUN("precomputed tree", TestPrecomputedTree ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    // invalid input is copied
+    void TestDouglasPeuckerPruned::TestInvalidInput () {
+        const unsigned DIM = 2;
+        std::vector <float> polyline, result;
+
+        // incomplete point
+        std::generate_n (std::back_inserter (polyline), 10*DIM-1, StraightLine <float, DIM> ());
+        psimpl::simplify_douglas_peucker_pruned <DIM> (polyline.begin (), polyline.end (), 1.f, std::back_inserter (result));
+        VERIFY_TRUE(polyline == result);
+
+        // not enough points
+        polyline.assign (2*DIM, 1.f);
+        result.clear ();
+        psimpl::simplify_douglas_peucker_pruned <DIM> (polyline.begin (), polyline.end (), 1.f, std::back_inserter (result));
+        VERIFY_TRUE(polyline == result);
+
+        // invalid tolerance
+        polyline.clear ();
+        std::generate_n (std::back_inserter (polyline), 10*DIM, SawToothLine <float, DIM> ());
+        result.clear ();
+        psimpl::simplify_douglas_peucker_pruned <DIM> (polyline.begin (), polyline.end (), 0.f, std::back_inserter (result));
+        VERIFY_TRUE(polyline == result);
+    }
+
+    void TestDouglasPeuckerPruned::TestMatchesClassic () {
+        {
+            const unsigned DIM = 2;
+            std::vector <double> polyline;
+            std::generate_n (std::back_inserter (polyline), 20000*DIM, RandomWalkLine <double, DIM> ());
+
+            VERIFY_TRUE(DouglasPeuckerPrunedMatches <DIM> (polyline, 0.1, 8));
+            VERIFY_TRUE(DouglasPeuckerPrunedMatches <DIM> (polyline, 2., 8));
+            VERIFY_TRUE(DouglasPeuckerPrunedMatches <DIM> (polyline, 25., 8));
+            VERIFY_TRUE(DouglasPeuckerPrunedMatches <DIM> (polyline, 2., 1));
+            VERIFY_TRUE(DouglasPeuckerPrunedMatches <DIM> (polyline, 2., 100));
+        }
+        {
+            const unsigned DIM = 3;
+            std::vector <double> polyline;
+            std::generate_n (std::back_inserter (polyline), 5000*DIM, RandomWalkLine <double, DIM> (1., 9));
+
+            VERIFY_TRUE(DouglasPeuckerPrunedMatches <DIM> (polyline, 1., 8));
+            VERIFY_TRUE(DouglasPeuckerPrunedMatches <DIM> (polyline, 10., 4));
+        }
+        {
+            // many points with an equal distance
+            const unsigned DIM = 2;
+            std::vector <double> polyline;
+            std::generate_n (std::back_inserter (polyline), 2000*DIM, SquareToothLine <double, DIM> ());
+            VERIFY_TRUE(DouglasPeuckerPrunedMatches <DIM> (polyline, 0.5, 8));
+            VERIFY_TRUE(DouglasPeuckerPrunedMatches <DIM> (polyline, 3., 8));
+
+            polyline.clear ();
+            std::generate_n (std::back_inserter (polyline), 2000*DIM, StraightLine <double, DIM> ());
+            VERIFY_TRUE(DouglasPeuckerPrunedMatches <DIM> (polyline, 0.5, 8));
+        }
+    }
+
+    // one tree for several tolerances
+    void TestDouglasPeuckerPruned::TestPrecomputedTree () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), 5000*DIM, RandomWalkLine <float, DIM> ());
+        psimpl::spatial::box_tree <DIM, float> tree (polyline.begin (), 5000);
+
+        const float tolerances [] = {0.5f, 1.f, 4.f, 16.f};
+        for (unsigned t=0; t<4; ++t) {
+            std::vector <float> expected, result;
+            psimpl::simplify_douglas_peucker_classic <DIM> (
+                polyline.begin (), polyline.end (), tolerances [t], std::back_inserter (expected));
+            psimpl::simplify_douglas_peucker_pruned <DIM> (
+                polyline.begin (), polyline.end (), tolerances [t], tree, std::back_inserter (result));
+            VERIFY_TRUE(result == expected);
+        }
+
+        // a float tree over double coordinates that do not convert exactly
+        std::vector <double> far;
+        std::generate_n (std::back_inserter (far), 5000*DIM, RandomWalkLine <double, DIM> (0.01));
+        for (size_t i=0; i<far.size (); ++i) {
+            far [i] += 4.5e6;
+        }
+        psimpl::spatial::box_tree <DIM, float> farTree (far.begin (), 5000);
+        const double farTolerances [] = {0.005, 0.01, 0.05};
+        for (unsigned t=0; t<3; ++t) {
+            std::vector <double> expected, result;
+            psimpl::simplify_douglas_peucker_classic <DIM> (
+                far.begin (), far.end (), farTolerances [t], std::back_inserter (expected));
+            psimpl::simplify_douglas_peucker_pruned <DIM> (
+                far.begin (), far.end (), farTolerances [t], farTree, std::back_inserter (result));
+            VERIFY_TRUE(result == expected);
+        }
+
+        // a tree over a different polyline is refused
+        std::vector <float> result;
+        psimpl::simplify_douglas_peucker_pruned <DIM> (
+            polyline.begin (), polyline.end () - DIM, 1.f, tree, std::back_inserter (result));
+        VERIFY_TRUE(result.size () == polyline.size () - DIM);
+    }
+
+    void TestDouglasPeuckerPruned::TestIntegers () {
+        const unsigned DIM = 2;
+
+        std::vector <int> polyline;
+        std::generate_n (std::back_inserter (polyline), 3000*DIM, RandomWalkLine <int, DIM> (10));
+        std::vector <int> expected, result;
+        psimpl::simplify_douglas_peucker_classic <DIM> (
+            polyline.begin (), polyline.end (), 7, std::back_inserter (expected));
+        psimpl::simplify_douglas_peucker_pruned <DIM> (
+            polyline.begin (), polyline.end (), 7, std::back_inserter (result));
+        VERIFY_TRUE(result == expected);
+
+        std::vector <unsigned> upolyline, uexpected, uresult;
+        std::generate_n (std::back_inserter (upolyline), 3000*DIM, SawToothLine <unsigned, DIM> ());
+        psimpl::simplify_douglas_peucker_classic <DIM> (
+            upolyline.begin (), upolyline.end (), 7, std::back_inserter (uexpected));
+        psimpl::simplify_douglas_peucker_pruned <DIM> (
+            upolyline.begin (), upolyline.end (), 7, std::back_inserter (uresult));
+        VERIFY_TRUE(uresult == uexpected);
+    }
+
+    void TestDouglasPeuckerPruned::TestReturnValue () {
+        const unsigned DIM = 3;
+        const unsigned count = 11;
+
+        float polyline [count*DIM];
+        float result [count*DIM];
+        std::generate_n (polyline, count*DIM, StraightLine <float, DIM> ());
+
+        // invalid input
+        VERIFY_TRUE(
+            std::distance (
+                result,
+                psimpl::simplify_douglas_peucker_pruned <DIM> (
+                    polyline, polyline + count*DIM, 0.f,
+                    result))
+            == count*DIM);
+
+        // valid input
+        VERIFY_TRUE(
+            std::distance (
+                result,
+                psimpl::simplify_douglas_peucker_pruned <DIM> (
+                    polyline, polyline + count*DIM, 10.f,
+                    result))
+            == 2*DIM);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestDouglasPeuckerSolver::TestDouglasPeuckerSolver () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("count", TestCount ());
+        TEST_RUN("error", TestError ());
+        TEST_RUN("error rounding", TestErrorRounding ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    // invalid input is copied, and the tolerance is 0
+    void TestDouglasPeuckerSolver::TestInvalidInput () {
+        const unsigned DIM = 2;
+        std::vector <float> polyline, result;
+        double tol = 1;
+
+        // incomplete point
+        std::generate_n (std::back_inserter (polyline), 10*DIM-1, SawToothLine <float, DIM> ());
+        psimpl::simplify_douglas_peucker_to_count <DIM> (polyline.begin (), polyline.end (), 4, std::back_inserter (result), &tol);
+        VERIFY_TRUE(polyline == result && tol == 0);
+
+        // count too small or too large
+        polyline.push_back (0.f);
+        for (int count = 0; count < 20; count += 19) {
+            tol = 1;
+            result.clear ();
+            psimpl::simplify_douglas_peucker_to_count <DIM> (polyline.begin (), polyline.end (), count, std::back_inserter (result), &tol);
+            VERIFY_TRUE(polyline == result && tol == 0);
+        }
+
+        // negative error
+        tol = 1;
+        result.clear ();
+        psimpl::simplify_douglas_peucker_to_error <DIM> (polyline.begin (), polyline.end (), -1., std::back_inserter (result), &tol);
+        VERIFY_TRUE(polyline == result && tol == 0);
+    }
+
+    // the smallest tolerance that keeps at most count points
+    void TestDouglasPeuckerSolver::TestCount () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 5000*DIM, RandomWalkLine <double, DIM> ());
+
+        const int counts [] = {2, 3, 10, 100, 1000, 4999};
+        for (unsigned c=0; c<6; ++c) {
+            std::vector <double> result, expected, larger;
+            double tol = 0;
+            psimpl::simplify_douglas_peucker_to_count <DIM> (
+                polyline.begin (), polyline.end (), counts [c], std::back_inserter (result), &tol);
+            VERIFY_TRUE(result.size () <= counts [c] * DIM);
+
+            psimpl::simplify_douglas_peucker_classic <DIM> (
+                polyline.begin (), polyline.end (), tol, std::back_inserter (expected));
+            VERIFY_TRUE(result == expected);
+
+            // a smaller tolerance keeps too many points
+            if (counts [c] > 2) {
+                psimpl::simplify_douglas_peucker_classic <DIM> (
+                    polyline.begin (), polyline.end (), tol * (1 - 1e-6), std::back_inserter (larger));
+                VERIFY_TRUE(larger.size () > counts [c] * DIM);
+            }
+        }
+
+        // internal points on a straight line have (almost) no importance
+        polyline.clear ();
+        std::generate_n (std::back_inserter (polyline), 100*DIM, StraightLine <double, DIM> ());
+        std::vector <double> result, expected;
+        double tol = 0;
+        psimpl::simplify_douglas_peucker_to_count <DIM> (
+            polyline.begin (), polyline.end (), 50, std::back_inserter (result), &tol);
+        psimpl::simplify_douglas_peucker_classic <DIM> (
+            polyline.begin (), polyline.end (), tol, std::back_inserter (expected));
+        VERIFY_TRUE(0 < tol);
+        VERIFY_TRUE(result.size () <= 50*DIM);
+        VERIFY_TRUE(result == expected);
+    }
+
+    // the largest tolerance with a small enough mean positional error
+    void TestDouglasPeuckerSolver::TestError () {
+        const unsigned DIM = 3;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 3000*DIM, RandomWalkLine <double, DIM> (1., 3));
+
+        const double errors [] = {0., 0.1, 0.5, 2., 1e9};
+        size_t previous = polyline.size () + 1;
+        for (unsigned e=0; e<5; ++e) {
+            std::vector <double> result, expected;
+            double tol = 0;
+            psimpl::simplify_douglas_peucker_to_error <DIM> (
+                polyline.begin (), polyline.end (), errors [e], std::back_inserter (result), &tol);
+            VERIFY_TRUE(0 < tol);
+
+            psimpl::simplify_douglas_peucker_classic <DIM> (
+                polyline.begin (), polyline.end (), tol, std::back_inserter (expected));
+            VERIFY_TRUE(result == expected);
+
+            psimpl::error::statistics stats = psimpl::compute_positional_error_statistics <DIM> (
+                polyline.begin (), polyline.end (), result.begin (), result.end ());
+            VERIFY_TRUE(stats.mean <= errors [e] + 1e-9);
+
+            // a larger error allows fewer points
+            VERIFY_TRUE(result.size () < previous);
+            previous = result.size ();
+        }
+        VERIFY_TRUE(previous == 2*DIM);
+    }
+
+    // on a lattice many importances are equal up to an ulp, and the rounded tolerance must not
+    // drop keys whose error deltas were counted
+    void TestDouglasPeuckerSolver::TestErrorRounding () {
+        const unsigned DIM = 2;
+
+        for (unsigned seed=1; seed<250; ++seed) {
+            // a walk with increasing x, so that no point is visited twice
+            std::vector <double> polyline;
+            unsigned state = seed;
+            int x = 0, y = 0;
+            for (unsigned i=0; i<200; ++i) {
+                state = state * 1103515245u + 12345u;
+                x += 1 + (state >> 16) % 2;
+                state = state * 1103515245u + 12345u;
+                y += static_cast <int> ((state >> 16) % 5) - 2;
+                polyline.push_back (x * 0.1);
+                polyline.push_back (y * 0.1);
+            }
+            for (unsigned e=1; e<=20; ++e) {
+                double error = e * 0.005;
+                std::vector <double> result;
+                psimpl::simplify_douglas_peucker_to_error <DIM> (
+                    polyline.begin (), polyline.end (), error, std::back_inserter (result));
+                psimpl::error::statistics stats = psimpl::compute_positional_error_statistics <DIM> (
+                    polyline.begin (), polyline.end (), result.begin (), result.end ());
+                VERIFY_TRUE(stats.mean <= error + 1e-12);
+            }
+        }
+    }
+
+    void TestDouglasPeuckerSolver::TestIntegers () {
+        const unsigned DIM = 2;
+        std::vector <int> polyline;
+        std::generate_n (std::back_inserter (polyline), 2000*DIM, RandomWalkLine <int, DIM> (10));
+
+        std::vector <int> result, expected;
+        double tol = 0;
+        psimpl::simplify_douglas_peucker_to_count <DIM> (
+            polyline.begin (), polyline.end (), 200, std::back_inserter (result), &tol);
+        psimpl::simplify_douglas_peucker_classic <DIM> (
+            polyline.begin (), polyline.end (), tol, std::back_inserter (expected));
+        VERIFY_TRUE(result.size () <= 200*DIM);
+        VERIFY_TRUE(result == expected);
+
+        std::vector <unsigned> upolyline, uresult, uexpected;
+        std::generate_n (std::back_inserter (upolyline), 2000*DIM, SawToothLine <unsigned, DIM> ());
+        psimpl::simplify_douglas_peucker_to_error <DIM> (
+            upolyline.begin (), upolyline.end (), 5., std::back_inserter (uresult), &tol);
+        psimpl::simplify_douglas_peucker_classic <DIM> (
+            upolyline.begin (), upolyline.end (), tol, std::back_inserter (uexpected));
+        VERIFY_TRUE(uresult == uexpected);
+    }
+
+    void TestDouglasPeuckerSolver::TestReturnValue () {
+        const unsigned DIM = 3;
+        const unsigned count = 11;
+
+        float polyline [count*DIM];
+        float result [count*DIM];
+        std::generate_n (polyline, count*DIM, SawToothLine <float, DIM> ());
+
+        // invalid input
+        VERIFY_TRUE(
+            std::distance (
+                result,
+                psimpl::simplify_douglas_peucker_to_count <DIM> (
+                    polyline, polyline + count*DIM, count, result))
+            == count*DIM);
+
+        // valid input
+        VERIFY_TRUE(
+            std::distance (
+                result,
+                psimpl::simplify_douglas_peucker_to_count <DIM> (
+                    polyline, polyline + count*DIM, 4, result))
+            <= 4*DIM);
+        VERIFY_TRUE(
+            std::distance (
+                result,
+                psimpl::simplify_douglas_peucker_to_error <DIM> (
+                    polyline, polyline + count*DIM, 1e9, result))
+            == 2*DIM);
+    }
+
 }}
@@ -94,6 +94,49 @@ namespace psimpl {
         void TestReturnValue ();
         void TestIntegers ();
     };
+
+    //! Tests class psimpl::algo::douglas_peucker_n_refiner
+    class TestDouglasPeuckerNRefiner
+    {
+    public:
+        TestDouglasPeuckerNRefiner ();
+
+    private:
+        void TestInvalidInput ();
+        void TestMatchesDouglasPeuckerN ();
+        void TestRefineUntil ();
+        void TestRefineLast ();
+        void TestKeyIndices ();
+    };
+
+    //! Tests function psimpl::simplify_douglas_peucker_pruned
+    class TestDouglasPeuckerPruned
+    {
+    public:
+        TestDouglasPeuckerPruned ();
+
+    private:
+        void TestInvalidInput ();
+        void TestMatchesClassic ();
+        void TestPrecomputedTree ();
+        void TestIntegers ();
+        void TestReturnValue ();
+    };
+
+    //! Tests functions psimpl::simplify_douglas_peucker_to_count/error
+    class TestDouglasPeuckerSolver
+    {
+    public:
+        TestDouglasPeuckerSolver ();
+
+    private:
+        void TestInvalidInput ();
+        void TestCount ();
+        void TestError ();
+        void TestErrorRounding ();
+        void TestIntegers ();
+        void TestReturnValue ();
+    };
 }}
 
 
@@ -37,6 +37,8 @@
 
 
 #include "test.h"
+#include "TestDistance.h"
+#include "TestParallel.h"
 #include "TestPositionalError.h"
 
 
@@ -49,6 +51,11 @@ namespace psimpl {
         TestError () {
             TEST_RUN("positional error", TestPositionalError ());
             TEST_RUN("positional error statistics", TestPositionalErrorStatistics ());
+            TEST_RUN("positional error indexed", TestPositionalErrorIndexed ());
+            TEST_RUN("positional error parallel", TestPositionalErrorParallel ());
+            TEST_RUN("hausdorff distance", TestHausdorffDistance ());
+            TEST_RUN("discrete frechet distance", TestFrechetDistance ());
+            TEST_RUN("areal displacement", TestArealDisplacement ());
         }
     };
 }}
@@ -53,6 +53,7 @@ namespace psimpl {
         TEST_RUN("invalid look ahead", TestInvalidLookAhead ());
         TEST_RUN("valid look ahead", TestValidLookAhead ());
         TEST_RUN("basic sanity", TestBasicSanity ());
+        TEST_RUN("backtrack", TestBacktrack ());
         TEST_RUN("random iterator", TestRandomIterator ());
         TEST_RUN("bidirectional iterator", TestBidirectionalIterator ());
         TEST_RUN("return value", TestReturnValue ());
@@ -435,6 +436,24 @@ namespace psimpl {
         }
     }
 
+    // backing up from the look ahead window does not lose the remaining points
+    void TestLang::TestBacktrack () {
+        const unsigned DIM = 2;
+        const double tol = 0.5;
+        const unsigned lookAhead = 4;
+
+        double polyline [] = {0, 0, 1, 0, 2, 0, 3, 0, 4, 5};
+        double expected [] = {0, 0, 3, 0, 4, 5};
+        std::vector <double> result;
+
+        psimpl::simplify_lang <DIM> (
+            polyline, polyline + 10, tol, lookAhead,
+            std::back_inserter (result));
+
+        ASSERT_TRUE(result.size () == 6);
+        VERIFY_TRUE(std::equal (result.begin (), result.end (), expected));
+    }
+
     // different random access iterators, different value types, different dimensions
     void TestLang::TestRandomIterator () {
         const unsigned count = 13;
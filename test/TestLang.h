@@ -56,6 +56,7 @@ namespace psimpl {
         void TestInvalidLookAhead ();
         void TestValidLookAhead ();
         void TestBasicSanity ();
+        void TestBacktrack ();
         void TestRandomIterator ();
         void TestBidirectionalIterator ();
         void TestReturnValue ();
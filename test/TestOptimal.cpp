@@ -0,0 +1,327 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+#include "TestOptimal.h"
+#include "helper.h"
+#include "psimpl.h"
+#include <iterator>
+#include <vector>
+#include <forward_list>
+#include <algorithm>
+
+
+namespace psimpl {
+    namespace test
+{
+    /*!
+        \brief checks that the simplification is an ordered subset of the polyline, and that
+        each removed point lies within tol of the segment between its surrounding keys
+
+        Keys are matched by value, so the polyline should not contain duplicate points.
+    */
+    template <class T>
+    bool CheckSegments (const std::vector <T>& polyline, const std::vector <T>& result, double tol) {
+        const unsigned DIM = 2;
+        if (result.size () < 2*DIM || result.size () % DIM) {
+            return false;
+        }
+        size_t key = 0;
+        size_t resultKey = 0;
+        if (!ComparePoint <DIM> (polyline.begin (), result.begin ())) {
+            return false;
+        }
+        for (size_t i = DIM; i < polyline.size (); i += DIM) {
+            if (resultKey + DIM < result.size () &&
+                ComparePoint <DIM> (polyline.begin () + i, result.begin () + resultKey + DIM))
+            {
+                for (size_t j = key + DIM; j < i; j += DIM) {
+                    double d2 = math::segment_distance2 <DIM> (
+                        polyline.begin () + key, polyline.begin () + i, polyline.begin () + j);
+                    if (d2 > tol * tol * (1 + 1e-9)) {
+                        return false;
+                    }
+                }
+                key = i;
+                resultKey += DIM;
+            }
+        }
+        return resultKey + DIM == result.size () && key + DIM == polyline.size ();
+    }
+
+    //! \brief O(n^3) minimum number of points within tol, for reference
+    template <class T>
+    size_t MinimalPointCount (const std::vector <T>& polyline, double tol) {
+        const unsigned DIM = 2;
+        size_t count = polyline.size () / DIM;
+        std::vector <size_t> hops (count, count);
+        hops [0] = 1;
+        for (size_t j = 1; j < count; ++j) {
+            for (size_t i = 0; i < j; ++i) {
+                bool valid = true;
+                for (size_t k = i + 1; k < j && valid; ++k) {
+                    valid = math::segment_distance2 <DIM> (
+                        polyline.begin () + i*DIM, polyline.begin () + j*DIM,
+                        polyline.begin () + k*DIM) <= tol * tol;
+                }
+                if (valid) {
+                    hops [j] = std::min (hops [j], hops [i] + 1);
+                }
+            }
+        }
+        return hops [count - 1];
+    }
+
+    TestOptimal::TestOptimal () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("basic sanity", TestBasicSanity ());
+        TEST_RUN("tolerance", TestTolerance ());
+        TEST_RUN("minimal", TestMinimal ());
+        TEST_RUN("douglas peucker", TestDouglasPeucker ());
+        TEST_RUN("windowed", TestWindowed ());
+        TEST_RUN("forward iterator", TestForwardIterator ());
+        TEST_RUN("return value", TestReturnValue ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+    }
+
+    // invalid input is copied
+    void TestOptimal::TestInvalidInput () {
+        const unsigned DIM = 2;
+
+        // incomplete point
+        std::vector <float> polyline, result;
+        std::generate_n (std::back_inserter (polyline), 10*DIM-1, StraightLine <float, DIM> ());
+        psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), 2.f, std::back_inserter (result));
+        VERIFY_TRUE(polyline == result);
+
+        // not enough points
+        polyline.clear ();
+        result.clear ();
+        std::generate_n (std::back_inserter (polyline), 2*DIM, StraightLine <float, DIM> ());
+        psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), 2.f, std::back_inserter (result));
+        VERIFY_TRUE(polyline == result);
+
+        // invalid tol
+        polyline.clear ();
+        result.clear ();
+        std::generate_n (std::back_inserter (polyline), 10*DIM, StraightLine <float, DIM> ());
+        psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), 0.f, std::back_inserter (result));
+        VERIFY_TRUE(polyline == result);
+
+        // invalid window
+        result.clear ();
+        psimpl::simplify_optimal_windowed <DIM> (polyline.begin (), polyline.end (), 2.f, 2, std::back_inserter (result));
+        VERIFY_TRUE(polyline == result);
+    }
+
+    void TestOptimal::TestBasicSanity () {
+        const unsigned DIM = 2;
+        {
+            // straight line
+            std::vector <float> polyline, result;
+            std::generate_n (std::back_inserter (polyline), 10*DIM, StraightLine <float, DIM> ());
+
+            psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), 0.5f, std::back_inserter (result));
+
+            ASSERT_TRUE(result.size () == 2*DIM);
+            VERIFY_TRUE(CompareEndPoints <DIM> (polyline.begin (), polyline.end (), result.begin (), result.end ()));
+        }
+        {
+            // a right angle: (0,0) (1,0) (2,0) (3,0) (3,1) (3,2) (3,3)
+            float coords [] = {0,0, 1,0, 2,0, 3,0, 3,1, 3,2, 3,3};
+            std::vector <float> polyline (coords, coords + 14), result;
+
+            psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), 0.1f, std::back_inserter (result));
+
+            ASSERT_TRUE(result.size () == 3*DIM);
+            int keys [] = {0, 3, 6};
+            VERIFY_TRUE(ComparePoints <DIM> (polyline.begin (), result.begin (), std::vector <int> (keys, keys + 3)));
+        }
+        {
+            // a point beyond the end of a segment is not within tolerance of that segment
+            float coords [] = {0,0, 8,0, 4,0.5f, 0,0.5f};
+            std::vector <float> polyline (coords, coords + 8), result;
+
+            psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), 1.f, std::back_inserter (result));
+
+            ASSERT_TRUE(result.size () == 3*DIM);
+            int keys [] = {0, 1, 3};
+            VERIFY_TRUE(ComparePoints <DIM> (polyline.begin (), result.begin (), std::vector <int> (keys, keys + 3)));
+        }
+    }
+
+    // every removed point lies within tolerance of its segment
+    void TestOptimal::TestTolerance () {
+        const unsigned DIM = 2;
+
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 5000*DIM, RandomWalkLine <double, DIM> ());
+
+        double tols [] = {0.1, 0.5, 1., 3., 10.};
+        for (unsigned i = 0; i < 5; ++i) {
+            std::vector <double> result;
+            psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), tols [i], std::back_inserter (result));
+
+            VERIFY_TRUE(result.size () < polyline.size ());
+            VERIFY_TRUE(CheckSegments (polyline, result, tols [i]));
+        }
+    }
+
+    // compares against a brute force search
+    void TestOptimal::TestMinimal () {
+        const unsigned DIM = 2;
+
+        for (unsigned seed = 1; seed < 20; ++seed) {
+            std::vector <double> polyline;
+            std::generate_n (std::back_inserter (polyline), 60*DIM, RandomWalkLine <double, DIM> (1., seed));
+
+            double tols [] = {0.2, 0.7, 1.5};
+            for (unsigned i = 0; i < 3; ++i) {
+                std::vector <double> result;
+                psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), tols [i], std::back_inserter (result));
+
+                VERIFY_TRUE(result.size () / DIM == MinimalPointCount (polyline, tols [i]));
+            }
+        }
+    }
+
+    // douglas peucker also keeps each point within tolerance of its segment, so never needs fewer points
+    void TestOptimal::TestDouglasPeucker () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), 5000*DIM, RandomWalkLine <float, DIM> ());
+
+        float tols [] = {0.1f, 0.5f, 1.f, 3.f, 10.f};
+        for (unsigned i = 0; i < 5; ++i) {
+            std::vector <float> result, expected;
+            psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), tols [i], std::back_inserter (result));
+            psimpl::simplify_douglas_peucker_classic <DIM> (polyline.begin (), polyline.end (), tols [i], std::back_inserter (expected));
+
+            VERIFY_TRUE(result.size () <= expected.size ());
+        }
+    }
+
+    void TestOptimal::TestWindowed () {
+        const unsigned DIM = 2;
+
+        std::vector <double> polyline, expected;
+        std::generate_n (std::back_inserter (polyline), 3000*DIM, RandomWalkLine <double, DIM> ());
+        psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), 1., std::back_inserter (expected));
+
+        // a window that covers the polyline gives the optimal result
+        {
+            std::vector <double> result;
+            psimpl::simplify_optimal_windowed <DIM> (polyline.begin (), polyline.end (), 1., 3000, std::back_inserter (result));
+            VERIFY_TRUE(result == expected);
+        }
+        // smaller windows stay within tolerance, and need at least as many points
+        unsigned windows [] = {3, 4, 10, 100, 999};
+        for (unsigned i = 0; i < 5; ++i) {
+            std::vector <double> result;
+            psimpl::simplify_optimal_windowed <DIM> (polyline.begin (), polyline.end (), 1., windows [i], std::back_inserter (result));
+
+            VERIFY_TRUE(CheckSegments (polyline, result, 1.));
+            VERIFY_TRUE(expected.size () <= result.size ());
+        }
+        // a straight line fits any window with a single segment
+        {
+            std::vector <double> line, result;
+            std::generate_n (std::back_inserter (line), 100*DIM, StraightLine <double, DIM> ());
+            psimpl::simplify_optimal_windowed <DIM> (line.begin (), line.end (), 1., 10, std::back_inserter (result));
+            VERIFY_TRUE(CheckSegments (line, result, 1.));
+        }
+    }
+
+    // single pass forward iterator
+    void TestOptimal::TestForwardIterator () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline, expected;
+        std::generate_n (std::back_inserter (polyline), 1000*DIM, RandomWalkLine <float, DIM> ());
+        psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), 1.5f, std::back_inserter (expected));
+
+        std::forward_list <float> list (polyline.begin (), polyline.end ());
+        std::vector <float> result;
+        psimpl::simplify_optimal <DIM> (list.begin (), list.end (), 1.5f, std::back_inserter (result));
+
+        VERIFY_TRUE(result == expected);
+    }
+
+    void TestOptimal::TestReturnValue () {
+        const unsigned DIM = 2;
+        const unsigned count = 15;
+
+        float polyline [count*DIM];
+        std::generate_n (polyline, count*DIM, StraightLine <float, DIM> ());
+        float result [count*DIM];
+
+        // invalid input
+        VERIFY_TRUE (
+            std::distance (
+                result,
+                psimpl::simplify_optimal <DIM> (
+                    polyline, polyline + count*DIM, 0.f,
+                    result))
+            == count*DIM);
+
+        // valid input
+        VERIFY_TRUE (
+            std::distance (
+                result,
+                psimpl::simplify_optimal_windowed <DIM> (
+                    polyline, polyline + count*DIM, 1.5f, count,
+                    result))
+            == 2*DIM);
+    }
+
+    void TestOptimal::TestIntegers () {
+        const unsigned DIM = 2;
+        const double tol = 4;
+
+        std::vector <int> polyline, result;
+        std::generate_n (std::back_inserter (polyline), 2000*DIM, RandomWalkLine <int, DIM> (5));
+        // unique points, so that CheckSegments can match the keys
+        for (size_t i = 0; i < polyline.size (); i += DIM) {
+            polyline [i] = static_cast <int> (i);
+        }
+        psimpl::simplify_optimal <DIM> (polyline.begin (), polyline.end (), tol, std::back_inserter (result));
+        VERIFY_TRUE(CheckSegments (polyline, result, tol));
+
+        std::vector <unsigned> upolyline, uresult;
+        std::generate_n (std::back_inserter (upolyline), 500*DIM, SawToothLine <unsigned, DIM> ());
+        psimpl::simplify_optimal <DIM> (upolyline.begin (), upolyline.end (), tol, std::back_inserter (uresult));
+        VERIFY_TRUE(CheckSegments (upolyline, uresult, tol));
+    }
+
+}}
@@ -0,0 +1,894 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+#include "TestParallel.h"
+#include "helper.h"
+#include "psimpl.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <vector>
+#include <deque>
+
+
+namespace psimpl {
+    namespace test
+{
+    //! \brief enough points for several chunks; smaller polylines are simplified serially
+    static const unsigned parallelPointCount = 100000;
+
+    //! \brief thread counts to compare against the serial result
+    static const unsigned threadCounts [] = {0, 1, 2, 3, 4, 7};
+    static const unsigned threadCountsSize = sizeof (threadCounts) / sizeof (threadCounts [0]);
+
+    //! \brief compares simplify_nth_point_parallel to simplify_nth_point for each thread count
+    template <unsigned DIM, typename T>
+    bool NthPointThreads (const std::vector <T>& polyline, unsigned n) {
+        std::vector <T> expected;
+        psimpl::simplify_nth_point <DIM> (
+            polyline.begin (), polyline.end (), n, std::back_inserter (expected));
+
+        for (unsigned i=0; i<threadCountsSize; ++i) {
+            std::vector <T> result;
+            psimpl::simplify_nth_point_parallel <DIM> (
+                polyline.begin (), polyline.end (), n, std::back_inserter (result), threadCounts [i]);
+            if (result != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! \brief compares simplify_radial_distance_parallel to simplify_radial_distance for each thread count
+    template <unsigned DIM, typename T, typename Distance>
+    bool RadialDistanceThreads (const std::vector <T>& polyline, Distance tol) {
+        std::vector <T> expected;
+        psimpl::simplify_radial_distance <DIM> (
+            polyline.begin (), polyline.end (), tol, std::back_inserter (expected));
+
+        for (unsigned i=0; i<threadCountsSize; ++i) {
+            std::vector <T> result;
+            psimpl::simplify_radial_distance_parallel <DIM> (
+                polyline.begin (), polyline.end (), tol, std::back_inserter (result), threadCounts [i]);
+            if (result != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! \brief compares simplify_reumann_witkam_parallel to simplify_reumann_witkam for each thread count
+    template <unsigned DIM, typename T, typename Distance>
+    bool ReumannWitkamThreads (const std::vector <T>& polyline, Distance tol) {
+        std::vector <T> expected;
+        psimpl::simplify_reumann_witkam <DIM> (
+            polyline.begin (), polyline.end (), tol, std::back_inserter (expected));
+
+        for (unsigned i=0; i<threadCountsSize; ++i) {
+            std::vector <T> result;
+            psimpl::simplify_reumann_witkam_parallel <DIM> (
+                polyline.begin (), polyline.end (), tol, std::back_inserter (result), threadCounts [i]);
+            if (result != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! \brief compares simplify_opheim_parallel to simplify_opheim for each thread count
+    template <unsigned DIM, typename T, typename Distance>
+    bool OpheimThreads (const std::vector <T>& polyline, Distance minTol, Distance maxTol) {
+        std::vector <T> expected;
+        psimpl::simplify_opheim <DIM> (
+            polyline.begin (), polyline.end (), minTol, maxTol, std::back_inserter (expected));
+
+        for (unsigned i=0; i<threadCountsSize; ++i) {
+            std::vector <T> result;
+            psimpl::simplify_opheim_parallel <DIM> (
+                polyline.begin (), polyline.end (), minTol, maxTol, std::back_inserter (result), threadCounts [i]);
+            if (result != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! \brief compares simplify_lang_parallel to simplify_lang for each thread count
+    template <unsigned DIM, typename T, typename Distance>
+    bool LangThreads (const std::vector <T>& polyline, Distance tol, unsigned lookAhead) {
+        std::vector <T> expected;
+        psimpl::simplify_lang <DIM> (
+            polyline.begin (), polyline.end (), tol, lookAhead, std::back_inserter (expected));
+
+        for (unsigned i=0; i<threadCountsSize; ++i) {
+            std::vector <T> result;
+            psimpl::simplify_lang_parallel <DIM> (
+                polyline.begin (), polyline.end (), tol, lookAhead, std::back_inserter (result), threadCounts [i]);
+            if (result != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! \brief compares simplify_douglas_peucker_n_parallel to simplify_douglas_peucker_n for each thread count
+    template <unsigned DIM, typename T>
+    bool DouglasPeuckerNThreads (const std::vector <T>& polyline, unsigned count) {
+        std::vector <T> expected;
+        psimpl::simplify_douglas_peucker_n <DIM> (
+            polyline.begin (), polyline.end (), count, std::back_inserter (expected));
+
+        for (unsigned i=0; i<threadCountsSize; ++i) {
+            std::vector <T> result;
+            psimpl::simplify_douglas_peucker_n_parallel <DIM> (
+                polyline.begin (), polyline.end (), count, std::back_inserter (result), threadCounts [i]);
+            if (result != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestNthPointParallel::TestNthPointParallel () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("threads", TestThreads ());
+        TEST_RUN("large n", TestLargeN ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    // invalid input is copied, also when using multiple threads
+    void TestNthPointParallel::TestInvalidInput () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline, result;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM-1, StraightLine <float, DIM> ());
+
+        psimpl::simplify_nth_point_parallel <DIM> (
+            polyline.begin (), polyline.end (), 10, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+
+        polyline.push_back (1.f);
+        result.clear ();
+        psimpl::simplify_nth_point_parallel <DIM> (
+            polyline.begin (), polyline.end (), 1, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+    }
+
+    void TestNthPointParallel::TestThreads () {
+        const unsigned DIM = 3;
+
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <double, DIM> ());
+
+        VERIFY_TRUE(NthPointThreads <DIM> (polyline, 2));
+        VERIFY_TRUE(NthPointThreads <DIM> (polyline, 7));
+        VERIFY_TRUE(NthPointThreads <DIM> (polyline, 1000));
+    }
+
+    // n larger than a single chunk
+    void TestNthPointParallel::TestLargeN () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+
+        VERIFY_TRUE(NthPointThreads <DIM> (polyline, 40000));
+        VERIFY_TRUE(NthPointThreads <DIM> (polyline, parallelPointCount - 1));
+        VERIFY_TRUE(NthPointThreads <DIM> (polyline, parallelPointCount + 1));
+    }
+
+    void TestNthPointParallel::TestReturnValue () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+        std::vector <float> result (polyline.size ());
+
+        VERIFY_TRUE (
+            std::distance (
+                result.begin (),
+                psimpl::simplify_nth_point_parallel <DIM> (
+                    polyline.begin (), polyline.end (), 10, result.begin (), 4))
+            == static_cast <int> ((parallelPointCount / 10 + 1) * DIM));
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestRadialDistanceParallel::TestRadialDistanceParallel () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("threads", TestThreads ());
+        TEST_RUN("seams", TestSeams ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    // invalid input is copied, also when using multiple threads
+    void TestRadialDistanceParallel::TestInvalidInput () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline, result;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM-1, StraightLine <float, DIM> ());
+
+        psimpl::simplify_radial_distance_parallel <DIM> (
+            polyline.begin (), polyline.end (), 2.f, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+
+        polyline.push_back (1.f);
+        result.clear ();
+        psimpl::simplify_radial_distance_parallel <DIM> (
+            polyline.begin (), polyline.end (), 0.f, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+    }
+
+    void TestRadialDistanceParallel::TestThreads () {
+        {
+            const unsigned DIM = 2;
+            std::vector <float> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+
+            VERIFY_TRUE(RadialDistanceThreads <DIM> (polyline, 0.5f));
+            VERIFY_TRUE(RadialDistanceThreads <DIM> (polyline, 2.f));
+            VERIFY_TRUE(RadialDistanceThreads <DIM> (polyline, 25.f));
+        }
+        {
+            const unsigned DIM = 3;
+            std::vector <double> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <double, DIM> (1., 7));
+
+            VERIFY_TRUE(RadialDistanceThreads <DIM> (polyline, 1.5));
+        }
+    }
+
+    // keys that are evenly spaced along a straight line never agree with the guessed keys, so
+    // each chunk is re-run entirely
+    void TestRadialDistanceParallel::TestSeams () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, StraightLine <float, DIM> ());
+
+        VERIFY_TRUE(RadialDistanceThreads <DIM> (polyline, 1001.f));
+        VERIFY_TRUE(RadialDistanceThreads <DIM> (polyline, 1e6f));
+    }
+
+    void TestRadialDistanceParallel::TestIntegers () {
+        const unsigned DIM = 2;
+
+        std::vector <int> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <int, DIM> (5));
+        VERIFY_TRUE(RadialDistanceThreads <DIM> (polyline, 7));
+
+        std::vector <unsigned> upolyline;
+        std::generate_n (std::back_inserter (upolyline), parallelPointCount*DIM, SawToothLine <unsigned, DIM> ());
+        VERIFY_TRUE(RadialDistanceThreads <DIM> (upolyline, 3));
+    }
+
+    void TestRadialDistanceParallel::TestReturnValue () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, StraightLine <float, DIM> ());
+        std::vector <float> result (polyline.size ());
+
+        // keys at 0, 10, 20, ... and the last point
+        VERIFY_TRUE (
+            std::distance (
+                result.begin (),
+                psimpl::simplify_radial_distance_parallel <DIM> (
+                    polyline.begin (), polyline.end (), 10.f, result.begin (), 4))
+            == static_cast <int> ((parallelPointCount / 10 + 1) * DIM));
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestReumannWitkamParallel::TestReumannWitkamParallel () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("threads", TestThreads ());
+        TEST_RUN("seams", TestSeams ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    // invalid input is copied, also when using multiple threads
+    void TestReumannWitkamParallel::TestInvalidInput () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline, result;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM-1, StraightLine <float, DIM> ());
+
+        psimpl::simplify_reumann_witkam_parallel <DIM> (
+            polyline.begin (), polyline.end (), 2.f, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+
+        polyline.push_back (1.f);
+        result.clear ();
+        psimpl::simplify_reumann_witkam_parallel <DIM> (
+            polyline.begin (), polyline.end (), 0.f, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+    }
+
+    void TestReumannWitkamParallel::TestThreads () {
+        {
+            const unsigned DIM = 2;
+            std::vector <float> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+
+            VERIFY_TRUE(ReumannWitkamThreads <DIM> (polyline, 0.5f));
+            VERIFY_TRUE(ReumannWitkamThreads <DIM> (polyline, 2.f));
+            VERIFY_TRUE(ReumannWitkamThreads <DIM> (polyline, 25.f));
+        }
+        {
+            const unsigned DIM = 3;
+            std::vector <double> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <double, DIM> (1., 7));
+
+            VERIFY_TRUE(ReumannWitkamThreads <DIM> (polyline, 1.5));
+        }
+    }
+
+    // a straight line has no keys besides its end points, so each chunk is re-run entirely
+    void TestReumannWitkamParallel::TestSeams () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, StraightLine <float, DIM> ());
+
+        VERIFY_TRUE(ReumannWitkamThreads <DIM> (polyline, 1.f));
+    }
+
+    void TestReumannWitkamParallel::TestIntegers () {
+        const unsigned DIM = 2;
+
+        std::vector <int> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <int, DIM> (5));
+        VERIFY_TRUE(ReumannWitkamThreads <DIM> (polyline, 7));
+
+        std::vector <unsigned> upolyline;
+        std::generate_n (std::back_inserter (upolyline), parallelPointCount*DIM, SawToothLine <unsigned, DIM> ());
+        VERIFY_TRUE(ReumannWitkamThreads <DIM> (upolyline, 3));
+    }
+
+    void TestReumannWitkamParallel::TestReturnValue () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, StraightLine <float, DIM> ());
+        std::vector <float> result (polyline.size ());
+
+        VERIFY_TRUE (
+            std::distance (
+                result.begin (),
+                psimpl::simplify_reumann_witkam_parallel <DIM> (
+                    polyline.begin (), polyline.end (), 1.f, result.begin (), 4))
+            == 2 * DIM);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestOpheimParallel::TestOpheimParallel () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("threads", TestThreads ());
+        TEST_RUN("seams", TestSeams ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    // invalid input is copied, also when using multiple threads
+    void TestOpheimParallel::TestInvalidInput () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline, result;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM-1, StraightLine <float, DIM> ());
+
+        psimpl::simplify_opheim_parallel <DIM> (
+            polyline.begin (), polyline.end (), 2.f, 5.f, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+
+        polyline.push_back (1.f);
+        result.clear ();
+        psimpl::simplify_opheim_parallel <DIM> (
+            polyline.begin (), polyline.end (), 2.f, 0.f, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+    }
+
+    void TestOpheimParallel::TestThreads () {
+        {
+            const unsigned DIM = 2;
+            std::vector <float> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+
+            VERIFY_TRUE(OpheimThreads <DIM> (polyline, 0.5f, 3.f));
+            VERIFY_TRUE(OpheimThreads <DIM> (polyline, 2.f, 20.f));
+            VERIFY_TRUE(OpheimThreads <DIM> (polyline, 25.f, 25.f));
+        }
+        {
+            const unsigned DIM = 3;
+            std::vector <double> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <double, DIM> (1., 7));
+
+            VERIFY_TRUE(OpheimThreads <DIM> (polyline, 1.5, 10.));
+        }
+    }
+
+    // keys that are evenly spaced along a straight line never agree with the guessed keys, so
+    // each chunk is re-run entirely
+    void TestOpheimParallel::TestSeams () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, StraightLine <float, DIM> ());
+
+        VERIFY_TRUE(OpheimThreads <DIM> (polyline, 1.f, 1000.5f));
+    }
+
+    void TestOpheimParallel::TestIntegers () {
+        const unsigned DIM = 2;
+
+        std::vector <int> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <int, DIM> (5));
+        VERIFY_TRUE(OpheimThreads <DIM> (polyline, 7, 30));
+
+        std::vector <unsigned> upolyline;
+        std::generate_n (std::back_inserter (upolyline), parallelPointCount*DIM, SawToothLine <unsigned, DIM> ());
+        VERIFY_TRUE(OpheimThreads <DIM> (upolyline, 3, 10));
+    }
+
+    void TestOpheimParallel::TestReturnValue () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, StraightLine <float, DIM> ());
+        std::vector <float> result (polyline.size ());
+
+        VERIFY_TRUE (
+            std::distance (
+                result.begin (),
+                psimpl::simplify_opheim_parallel <DIM> (
+                    polyline.begin (), polyline.end (), 1.f, 1e6f, result.begin (), 4))
+            == 2 * DIM);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestLangParallel::TestLangParallel () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("threads", TestThreads ());
+        TEST_RUN("seams", TestSeams ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    // invalid input is copied, also when using multiple threads
+    void TestLangParallel::TestInvalidInput () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline, result;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM-1, StraightLine <float, DIM> ());
+
+        psimpl::simplify_lang_parallel <DIM> (
+            polyline.begin (), polyline.end (), 2.f, 7, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+
+        polyline.push_back (1.f);
+        result.clear ();
+        psimpl::simplify_lang_parallel <DIM> (
+            polyline.begin (), polyline.end (), 2.f, 1, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+    }
+
+    void TestLangParallel::TestThreads () {
+        {
+            const unsigned DIM = 2;
+            std::vector <float> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+
+            VERIFY_TRUE(LangThreads <DIM> (polyline, 0.5f, 5));
+            VERIFY_TRUE(LangThreads <DIM> (polyline, 2.f, 10));
+            VERIFY_TRUE(LangThreads <DIM> (polyline, 25.f, 40));
+        }
+        {
+            const unsigned DIM = 3;
+            std::vector <double> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <double, DIM> (1., 7));
+
+            VERIFY_TRUE(LangThreads <DIM> (polyline, 1.5, 8));
+        }
+    }
+
+    // keys that are evenly spaced along a straight line never agree with the guessed keys, so
+    // each chunk is re-run entirely
+    void TestLangParallel::TestSeams () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, StraightLine <float, DIM> ());
+
+        VERIFY_TRUE(LangThreads <DIM> (polyline, 1.f, 7));
+    }
+
+    void TestLangParallel::TestIntegers () {
+        const unsigned DIM = 2;
+
+        std::vector <int> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <int, DIM> (5));
+        VERIFY_TRUE(LangThreads <DIM> (polyline, 7, 10));
+
+        std::vector <unsigned> upolyline;
+        std::generate_n (std::back_inserter (upolyline), parallelPointCount*DIM, SawToothLine <unsigned, DIM> ());
+        VERIFY_TRUE(LangThreads <DIM> (upolyline, 3, 10));
+    }
+
+    void TestLangParallel::TestReturnValue () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, StraightLine <float, DIM> ());
+        std::deque <float> result;
+
+        // keys at 0, 10, 20, ... and the last point
+        psimpl::simplify_lang_parallel <DIM> (
+            &polyline [0], &polyline [0] + polyline.size (), 1.f, 10, std::back_inserter (result), 4);
+        VERIFY_TRUE(result.size () == (parallelPointCount / 10 + 1) * DIM);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    TestDouglasPeuckerNParallel::TestDouglasPeuckerNParallel () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("threads", TestThreads ());
+        TEST_RUN("ties", TestTies ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    // invalid input is copied, also when using multiple threads
+    void TestDouglasPeuckerNParallel::TestInvalidInput () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline, result;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM-1, StraightLine <float, DIM> ());
+
+        psimpl::simplify_douglas_peucker_n_parallel <DIM> (
+            polyline.begin (), polyline.end (), 100, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+
+        polyline.push_back (1.f);
+        result.clear ();
+        psimpl::simplify_douglas_peucker_n_parallel <DIM> (
+            polyline.begin (), polyline.end (), 1, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+
+        result.clear ();
+        psimpl::simplify_douglas_peucker_n_parallel <DIM> (
+            polyline.begin (), polyline.end (), parallelPointCount, std::back_inserter (result), 4);
+        VERIFY_TRUE(polyline == result);
+    }
+
+    void TestDouglasPeuckerNParallel::TestThreads () {
+        {
+            const unsigned DIM = 2;
+            std::vector <float> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+
+            VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 2));
+            VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 3));
+            VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 100));
+            VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 5000));
+            VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 60000));
+        }
+        {
+            const unsigned DIM = 3;
+            std::vector <double> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <double, DIM> (1., 7));
+
+            VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 2500));
+        }
+    }
+
+    // many keys with an equal distance; the order in which they are taken must still match
+    void TestDouglasPeuckerNParallel::TestTies () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, SquareToothLine <float, DIM> ());
+
+        VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 77));
+        VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 1001));
+
+        // a straight line: every point has distance 0
+        polyline.clear ();
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, StraightLine <float, DIM> ());
+
+        VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 50));
+        VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 3333));
+    }
+
+    void TestDouglasPeuckerNParallel::TestIntegers () {
+        const unsigned DIM = 2;
+
+        std::vector <int> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <int, DIM> (5));
+        VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (polyline, 1000));
+
+        std::vector <unsigned> upolyline;
+        std::generate_n (std::back_inserter (upolyline), parallelPointCount*DIM, SawToothLine <unsigned, DIM> ());
+        VERIFY_TRUE(DouglasPeuckerNThreads <DIM> (upolyline, 1000));
+    }
+
+    void TestDouglasPeuckerNParallel::TestReturnValue () {
+        const unsigned DIM = 2;
+        const unsigned count = 777;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+        std::deque <float> result;
+
+        psimpl::simplify_douglas_peucker_n_parallel <DIM> (
+            &polyline [0], &polyline [0] + polyline.size (), count, std::back_inserter (result), 4);
+        VERIFY_TRUE(result.size () == count * DIM);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    //! \brief indices of a simplification with irregular segment lengths, from 0 to pointCount - 1
+    inline std::vector <unsigned> ParallelKeys (unsigned pointCount, unsigned step) {
+        std::vector <unsigned> keys;
+        for (unsigned i=0, gap=1; i < pointCount - 1; i += gap, gap = 1 + (gap * 7 + 3) % step) {
+            keys.push_back (i);
+        }
+        keys.push_back (pointCount - 1);
+        return keys;
+    }
+
+    //! \brief the points of polyline at the given indices
+    template <unsigned DIM, typename T>
+    std::vector <T> ParallelSimplification (const std::vector <T>& polyline, const std::vector <unsigned>& keys) {
+        std::vector <T> simplification;
+        for (size_t i=0; i<keys.size (); ++i) {
+            simplification.insert (simplification.end (), polyline.begin () + keys [i] * DIM,
+                                   polyline.begin () + (keys [i] + 1) * DIM);
+        }
+        return simplification;
+    }
+
+    //! \brief compares the parallel positional errors to the serial ones for each thread count;
+    //! both parallel routines use the indexed kernel, so their results are identical to it
+    template <unsigned DIM, typename T>
+    bool PositionalErrorThreads (const std::vector <T>& polyline, const std::vector <unsigned>& keys) {
+        std::vector <T> simplification = ParallelSimplification <DIM> (polyline, keys);
+        std::vector <double> expected;
+        psimpl::compute_positional_errors2_indexed <DIM> (
+            polyline.begin (), polyline.end (), keys.begin (), keys.end (),
+            std::back_inserter (expected));
+        bool valid = false;
+
+        for (unsigned i=0; i<threadCountsSize; ++i) {
+            std::vector <double> result (polyline.size () / DIM, -1);
+            valid = false;
+            psimpl::compute_positional_errors2_parallel <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end (),
+                result.begin (), &valid, threadCounts [i]);
+            if (!valid || result != expected) {
+                return false;
+            }
+            std::fill (result.begin (), result.end (), -1);
+            valid = false;
+            psimpl::compute_positional_errors2_indexed_parallel <DIM> (
+                polyline.begin (), polyline.end (), keys.begin (), keys.end (),
+                result.begin (), &valid, threadCounts [i]);
+            if (!valid || result != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! \brief compares two statistics up to rounding
+    inline bool CompareStatistics (const psimpl::error::statistics& a, const psimpl::error::statistics& b) {
+        const double e = 1e-9;
+        return std::fabs (a.max - b.max) <= e * (1 + a.max) &&
+               std::fabs (a.sum - b.sum) <= e * (1 + a.sum) &&
+               std::fabs (a.mean - b.mean) <= e * (1 + a.mean) &&
+               std::fabs (a.std - b.std) <= e * (1 + a.std);
+    }
+
+    TestPositionalErrorParallel::TestPositionalErrorParallel () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("threads", TestThreads ());
+        TEST_RUN("long segments", TestLongSegments ());
+        TEST_RUN("statistics", TestStatistics ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    void TestPositionalErrorParallel::TestInvalidInput () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+        std::vector <double> result (parallelPointCount, -1);
+        bool valid = true;
+
+        // indices that do not end at the last point
+        std::vector <unsigned> keys = ParallelKeys (parallelPointCount - 1, 50);
+        VERIFY_TRUE(psimpl::compute_positional_errors2_indexed_parallel <DIM> (
+            polyline.begin (), polyline.end (), keys.begin (), keys.end (), result.begin (), &valid, 4) == result.begin ());
+        VERIFY_FALSE(valid);
+        VERIFY_TRUE(result [0] == -1);
+
+        valid = true;
+        psimpl::compute_positional_error_statistics_indexed_parallel <DIM> (
+            polyline.begin (), polyline.end (), keys.begin (), keys.end (), &valid, 4);
+        VERIFY_FALSE(valid);
+
+        // indices that are not strictly increasing
+        keys = ParallelKeys (parallelPointCount, 50);
+        keys [keys.size () / 2] = keys [keys.size () / 2 - 1];
+        valid = true;
+        psimpl::compute_positional_errors2_indexed_parallel <DIM> (
+            polyline.begin (), polyline.end (), keys.begin (), keys.end (), result.begin (), &valid, 4);
+        VERIFY_FALSE(valid);
+
+        // a simplification that cannot be matched is handled by the serial routine
+        keys = ParallelKeys (parallelPointCount, 50);
+        std::vector <float> simplification = ParallelSimplification <DIM> (polyline, keys);
+        simplification [simplification.size () / 2] += 1000.f;
+
+        std::vector <double> expected;
+        bool expectedValid = true;
+        psimpl::compute_positional_errors2 <DIM> (
+            polyline.begin (), polyline.end (), simplification.begin (), simplification.end (),
+            std::back_inserter (expected), &expectedValid);
+        std::vector <double> serial (parallelPointCount, -1);
+        valid = true;
+        psimpl::compute_positional_errors2_parallel <DIM> (
+            polyline.begin (), polyline.end (), simplification.begin (), simplification.end (),
+            serial.begin (), &valid, 4);
+        VERIFY_FALSE(expectedValid);
+        VERIFY_FALSE(valid);
+        VERIFY_TRUE(std::equal (expected.begin (), expected.end (), serial.begin ()));
+
+        valid = true;
+        psimpl::compute_positional_error_statistics_parallel <DIM> (
+            polyline.begin (), polyline.end (), simplification.begin (), simplification.end (), &valid, 4);
+        VERIFY_FALSE(valid);
+    }
+
+    void TestPositionalErrorParallel::TestThreads () {
+        {
+            const unsigned DIM = 2;
+            std::vector <float> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+
+            VERIFY_TRUE(PositionalErrorThreads <DIM> (polyline, ParallelKeys (parallelPointCount, 2)));
+            VERIFY_TRUE(PositionalErrorThreads <DIM> (polyline, ParallelKeys (parallelPointCount, 40)));
+            VERIFY_TRUE(PositionalErrorThreads <DIM> (polyline, ParallelKeys (parallelPointCount, 3000)));
+        }
+        {
+            const unsigned DIM = 3;
+            std::vector <double> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <double, DIM> (1., 7));
+
+            VERIFY_TRUE(PositionalErrorThreads <DIM> (polyline, ParallelKeys (parallelPointCount, 100)));
+        }
+        {
+            const unsigned DIM = 2;
+            // unique points, so that matching the simplification finds the same indices
+            std::vector <int> polyline;
+            std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, SawToothLine <int, DIM> ());
+
+            VERIFY_TRUE(PositionalErrorThreads <DIM> (polyline, ParallelKeys (parallelPointCount, 100)));
+        }
+    }
+
+    // chunks that start and end inside a single segment
+    void TestPositionalErrorParallel::TestLongSegments () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+
+        std::vector <unsigned> keys;
+        keys.push_back (0);
+        keys.push_back (parallelPointCount - 1);
+        VERIFY_TRUE(PositionalErrorThreads <DIM> (polyline, keys));
+
+        keys.insert (keys.begin () + 1, 1);
+        keys.insert (keys.begin () + 2, parallelPointCount / 2);
+        keys.insert (keys.begin () + 3, parallelPointCount - 2);
+        VERIFY_TRUE(PositionalErrorThreads <DIM> (polyline, keys));
+    }
+
+    void TestPositionalErrorParallel::TestStatistics () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+        std::vector <unsigned> keys = ParallelKeys (parallelPointCount, 60);
+        std::vector <float> simplification = ParallelSimplification <DIM> (polyline, keys);
+
+        // the parallel routines use the indexed kernel, which computes in double precision
+        psimpl::error::quantile_sketch expectedSketch;
+        psimpl::error::statistics expected = psimpl::compute_positional_error_statistics_indexed <DIM> (
+            polyline.begin (), polyline.end (), keys.begin (), keys.end (), expectedSketch);
+
+        for (unsigned i=0; i<threadCountsSize; ++i) {
+            bool valid = false;
+            psimpl::error::quantile_sketch sketch;
+            psimpl::error::statistics stats = psimpl::compute_positional_error_statistics_parallel <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end (),
+                sketch, &valid, threadCounts [i]);
+            VERIFY_TRUE(valid);
+            VERIFY_TRUE(CompareStatistics (expected, stats));
+            VERIFY_TRUE(sketch.count () == expectedSketch.count ());
+            VERIFY_TRUE(sketch.buckets () == expectedSketch.buckets ());
+            VERIFY_TRUE(sketch.quantile (0.5) == expectedSketch.quantile (0.5));
+            VERIFY_TRUE(sketch.quantile (0.99) == expectedSketch.quantile (0.99));
+
+            valid = false;
+            stats = psimpl::compute_positional_error_statistics_indexed_parallel <DIM> (
+                polyline.begin (), polyline.end (), keys.begin (), keys.end (), &valid, threadCounts [i]);
+            VERIFY_TRUE(valid);
+            VERIFY_TRUE(CompareStatistics (expected, stats));
+        }
+
+        // the sketch keeps the values it already had
+        psimpl::error::quantile_sketch sketch;
+        sketch.add (1e6);
+        psimpl::compute_positional_error_statistics_indexed_parallel <DIM> (
+            polyline.begin (), polyline.end (), keys.begin (), keys.end (), sketch, 0, 4);
+        VERIFY_TRUE(sketch.count () == parallelPointCount + 1);
+        VERIFY_TRUE(sketch.quantile (1) == 1e6);
+    }
+
+    void TestPositionalErrorParallel::TestReturnValue () {
+        const unsigned DIM = 3;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), parallelPointCount*DIM, RandomWalkLine <float, DIM> ());
+        std::vector <unsigned> keys = ParallelKeys (parallelPointCount, 20);
+        std::vector <float> simplification = ParallelSimplification <DIM> (polyline, keys);
+        std::vector <float> result (parallelPointCount);
+
+        VERIFY_TRUE(psimpl::compute_positional_errors2_parallel <DIM> (
+            &polyline [0], &polyline [0] + polyline.size (),
+            simplification.begin (), simplification.end (),
+            result.begin (), 0, 4) == result.end ());
+        VERIFY_TRUE(psimpl::compute_positional_errors2_indexed_parallel <DIM> (
+            polyline.begin (), polyline.end (), &keys [0], &keys [0] + keys.size (),
+            &result [0], 0, 4) == &result [0] + result.size ());
+    }
+
+}}
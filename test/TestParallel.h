@@ -0,0 +1,146 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+
+#ifndef PSIMPL_TEST_PARALLEL
+#define PSIMPL_TEST_PARALLEL
+
+
+#include "test.h"
+
+
+namespace psimpl {
+    namespace test
+{
+    //! Tests function psimpl::simplify_nth_point_parallel
+    class TestNthPointParallel
+    {
+    public:
+        TestNthPointParallel ();
+
+    private:
+        void TestInvalidInput ();
+        void TestThreads ();
+        void TestLargeN ();
+        void TestReturnValue ();
+    };
+
+    //! Tests function psimpl::simplify_radial_distance_parallel
+    class TestRadialDistanceParallel
+    {
+    public:
+        TestRadialDistanceParallel ();
+
+    private:
+        void TestInvalidInput ();
+        void TestThreads ();
+        void TestSeams ();
+        void TestIntegers ();
+        void TestReturnValue ();
+    };
+
+    //! Tests function psimpl::simplify_reumann_witkam_parallel
+    class TestReumannWitkamParallel
+    {
+    public:
+        TestReumannWitkamParallel ();
+
+    private:
+        void TestInvalidInput ();
+        void TestThreads ();
+        void TestSeams ();
+        void TestIntegers ();
+        void TestReturnValue ();
+    };
+
+    //! Tests function psimpl::simplify_opheim_parallel
+    class TestOpheimParallel
+    {
+    public:
+        TestOpheimParallel ();
+
+    private:
+        void TestInvalidInput ();
+        void TestThreads ();
+        void TestSeams ();
+        void TestIntegers ();
+        void TestReturnValue ();
+    };
+
+    //! Tests function psimpl::simplify_lang_parallel
+    class TestLangParallel
+    {
+    public:
+        TestLangParallel ();
+
+    private:
+        void TestInvalidInput ();
+        void TestThreads ();
+        void TestSeams ();
+        void TestIntegers ();
+        void TestReturnValue ();
+    };
+
+    //! Tests function psimpl::simplify_douglas_peucker_n_parallel
+    class TestDouglasPeuckerNParallel
+    {
+    public:
+        TestDouglasPeuckerNParallel ();
+
+    private:
+        void TestInvalidInput ();
+        void TestThreads ();
+        void TestTies ();
+        void TestIntegers ();
+        void TestReturnValue ();
+    };
+
+    //! Tests functions psimpl::compute_positional_errors2_parallel and
+    //! psimpl::compute_positional_error_statistics_parallel, and their indexed variants
+    class TestPositionalErrorParallel
+    {
+    public:
+        TestPositionalErrorParallel ();
+
+    private:
+        void TestInvalidInput ();
+        void TestThreads ();
+        void TestLongSegments ();
+        void TestStatistics ();
+        void TestReturnValue ();
+    };
+}}
+
+
+#endif // PSIMPL_TEST_PARALLEL
@@ -36,6 +36,8 @@
 #include "helper.h"
 #include "psimpl.h"
 #include <numeric>
+#include <algorithm>
+#include <cmath>
 #include <iterator>
 #include <vector>
 #include <deque>
@@ -516,6 +518,11 @@ namespace psimpl {
         TEST_RUN("bidirectional iterator", TestBidirectionalIterator ());
         TEST_DISABLED("forward iterator", TestForwardIterator ());
         TEST_RUN("mixed iterators", TestMixedIterators ());
+        TEST_RUN("errors", TestErrors ());
+        TEST_RUN("accumulator", TestAccumulator ());
+        TEST_RUN("quantile sketch", TestQuantileSketch ());
+        TEST_RUN("quantile sketch merge", TestQuantileSketchMerge ());
+        TEST_RUN("percentiles", TestPercentiles ());
     }
 
     // incomplete point: coord count % DIM > 1
@@ -876,4 +883,420 @@ namespace psimpl {
         }
     }
 
+    // statistics match those of the errors computed by compute_positional_errors2
+    void TestPositionalErrorStatistics::TestErrors () {
+        const unsigned DIM = 2;
+
+        std::vector <double> polyline, simplification, errors;
+        std::generate_n (std::back_inserter (polyline), 10000*DIM, RandomWalkLine <double, DIM> ());
+        psimpl::simplify_douglas_peucker <DIM> (
+            polyline.begin (), polyline.end (), 2.0, std::back_inserter (simplification));
+        psimpl::compute_positional_errors2 <DIM> (
+            polyline.begin (), polyline.end (),
+            simplification.begin (), simplification.end (),
+            std::back_inserter (errors));
+
+        double max = 0, sum = 0, sum2 = 0;
+        for (size_t i = 0; i < errors.size (); ++i) {
+            double error = std::sqrt (errors [i]);
+            max = std::max (max, error);
+            sum += error;
+        }
+        double mean = sum / errors.size ();
+        for (size_t i = 0; i < errors.size (); ++i) {
+            double error = std::sqrt (errors [i]);
+            sum2 += (error - mean) * (error - mean);
+        }
+
+        bool valid = false;
+        error::statistics stats = psimpl::compute_positional_error_statistics <DIM> (
+            polyline.begin (), polyline.end (),
+            simplification.begin (), simplification.end (),
+            &valid);
+
+        VERIFY_TRUE(valid);
+        VERIFY_TRUE(CompareValue (max, stats.max));
+        VERIFY_TRUE(std::fabs (sum - stats.sum) < 1e-9 * sum);
+        VERIFY_TRUE(CompareValue (mean, stats.mean));
+        VERIFY_TRUE(CompareValue (std::sqrt (sum2 / errors.size ()), stats.std));
+    }
+
+    // merging partial accumulators equals accumulating all values at once
+    void TestPositionalErrorStatistics::TestAccumulator () {
+        std::vector <double> values;
+        std::generate_n (std::back_inserter (values), 1000, RandomWalkLine <double, 1> (10., 3));
+
+        error::accumulator all;
+        for (size_t i = 0; i < values.size (); ++i) {
+            all.add (values [i]);
+        }
+        ASSERT_TRUE(all.count () == values.size ());
+
+        // uneven chunks, including empty ones
+        size_t bounds [] = {0, 0, 1, 17, 500, 500, 999, 1000};
+        error::accumulator merged;
+        for (unsigned c = 0; c + 1 < 8; ++c) {
+            error::accumulator chunk;
+            for (size_t i = bounds [c]; i < bounds [c+1]; ++i) {
+                chunk.add (values [i]);
+            }
+            merged.merge (chunk);
+        }
+        ASSERT_TRUE(merged.count () == values.size ());
+
+        error::statistics expected = all.result ();
+        error::statistics result = merged.result ();
+        VERIFY_TRUE(CompareValue (expected.max, result.max));
+        VERIFY_TRUE(CompareValue (expected.sum, result.sum));
+        VERIFY_TRUE(CompareValue (expected.mean, result.mean));
+        VERIFY_TRUE(CompareValue (expected.std, result.std));
+
+        // blocks
+        error::accumulator blocks;
+        blocks.add (values.begin (), values.begin () + 300);
+        blocks.add (values.begin () + 300, values.begin () + 300);
+        blocks.add (values.begin () + 300, values.end ());
+        ASSERT_TRUE(blocks.count () == values.size ());
+        result = blocks.result ();
+        VERIFY_TRUE(CompareValue (expected.max, result.max));
+        VERIFY_TRUE(CompareValue (expected.sum, result.sum));
+        VERIFY_TRUE(CompareValue (expected.mean, result.mean));
+        VERIFY_TRUE(CompareValue (expected.std, result.std));
+
+        // negative values
+        error::accumulator negative;
+        negative.add (-3.0);
+        negative.add (-1.0);
+        VERIFY_TRUE(-1.0 == negative.result ().max);
+        VERIFY_TRUE(-2.0 == negative.result ().mean);
+        VERIFY_TRUE(1.0 == negative.result ().std);
+
+        // empty
+        error::statistics empty = error::accumulator ().result ();
+        VERIFY_TRUE(0.0 == empty.max && 0.0 == empty.sum && 0.0 == empty.mean && 0.0 == empty.std);
+    }
+
+    //! \brief checks a quantile estimate against the exact value of the sorted values
+    inline bool CompareQuantile (const std::vector <double>& sorted, double q, double estimate, double accuracy) {
+        double exact = sorted [static_cast <size_t> (q * (sorted.size () - 1))];
+        return std::fabs (estimate - exact) <= accuracy * exact + 1e-12;
+    }
+
+    void TestPositionalErrorStatistics::TestQuantileSketch () {
+        // empty
+        error::quantile_sketch empty;
+        VERIFY_TRUE(0.0 == empty.quantile (0.5));
+
+        // values spanning several orders of magnitude, including zeros
+        std::vector <double> values;
+        std::generate_n (std::back_inserter (values), 10000, RandomWalkLine <double, 1> (1., 5));
+        for (size_t i = 0; i < values.size (); ++i) {
+            values [i] = i % 10 ? std::exp (values [i] / 10) : 0.0;
+        }
+        error::quantile_sketch sketch (0.01);
+        for (size_t i = 0; i < values.size (); ++i) {
+            sketch.add (values [i]);
+        }
+        std::sort (values.begin (), values.end ());
+        ASSERT_TRUE(sketch.count () == values.size ());
+
+        double qs [] = {0.0, 0.05, 0.1, 0.5, 0.9, 0.99, 0.999, 1.0};
+        for (unsigned i = 0; i < 8; ++i) {
+            VERIFY_TRUE(CompareQuantile (values, qs [i], sketch.quantile (qs [i]), 0.01));
+        }
+        VERIFY_TRUE(values.back () == sketch.quantile (1.0));
+
+        // bounded memory: only the smallest values lose accuracy
+        error::quantile_sketch small (0.01, 64);
+        for (size_t i = 0; i < values.size (); ++i) {
+            small.add (values [i]);
+        }
+        VERIFY_TRUE(small.buckets () <= 64);
+        VERIFY_TRUE(CompareQuantile (values, 0.99, small.quantile (0.99), 0.01));
+        VERIFY_TRUE(CompareQuantile (values, 0.999, small.quantile (0.999), 0.01));
+    }
+
+    // merged sketches equal a single sketch over all values
+    void TestPositionalErrorStatistics::TestQuantileSketchMerge () {
+        std::vector <double> values;
+        std::generate_n (std::back_inserter (values), 5000, RandomWalkLine <double, 1> (1., 9));
+
+        error::quantile_sketch all;
+        error::quantile_sketch parts [3];
+        for (size_t i = 0; i < values.size (); ++i) {
+            double value = std::fabs (values [i]);
+            all.add (value);
+            parts [i * 3 / values.size ()].add (value);
+        }
+        error::quantile_sketch merged;
+        merged.merge (parts [2]);
+        merged.merge (error::quantile_sketch ());
+        merged.merge (parts [0]);
+        merged.merge (parts [1]);
+
+        ASSERT_TRUE(merged.count () == all.count ());
+        double qs [] = {0.0, 0.5, 0.9, 0.99, 0.999, 1.0};
+        for (unsigned i = 0; i < 6; ++i) {
+            VERIFY_TRUE(merged.quantile (qs [i]) == all.quantile (qs [i]));
+        }
+    }
+
+    // percentiles of the positional errors of a simplification
+    void TestPositionalErrorStatistics::TestPercentiles () {
+        const unsigned DIM = 2;
+
+        std::vector <double> polyline, simplification, errors;
+        std::generate_n (std::back_inserter (polyline), 10000*DIM, RandomWalkLine <double, DIM> ());
+        psimpl::simplify_douglas_peucker <DIM> (
+            polyline.begin (), polyline.end (), 2.0, std::back_inserter (simplification));
+        psimpl::compute_positional_errors2 <DIM> (
+            polyline.begin (), polyline.end (),
+            simplification.begin (), simplification.end (),
+            std::back_inserter (errors));
+        for (size_t i = 0; i < errors.size (); ++i) {
+            errors [i] = std::sqrt (errors [i]);
+        }
+        std::sort (errors.begin (), errors.end ());
+
+        bool valid = false;
+        error::quantile_sketch sketch (0.005);
+        error::statistics stats = psimpl::compute_positional_error_statistics <DIM> (
+            polyline.begin (), polyline.end (),
+            simplification.begin (), simplification.end (),
+            sketch, &valid);
+
+        VERIFY_TRUE(valid);
+        VERIFY_TRUE(CompareValue (errors.back (), stats.max));
+        ASSERT_TRUE(sketch.count () == errors.size ());
+
+        error::percentiles p = sketch.result ();
+        VERIFY_TRUE(CompareQuantile (errors, 0.5, p.p50, 0.005));
+        VERIFY_TRUE(CompareQuantile (errors, 0.9, p.p90, 0.005));
+        VERIFY_TRUE(CompareQuantile (errors, 0.99, p.p99, 0.005));
+        VERIFY_TRUE(CompareQuantile (errors, 0.999, p.p999, 0.005));
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    //! \brief returns the index of each simplified point, matched in order against the polyline
+    template <unsigned DIM, class T>
+    std::vector <size_t> KeyIndices (const std::vector <T>& polyline, const std::vector <T>& simplification) {
+        std::vector <size_t> keys;
+        size_t s = 0;
+        for (size_t i = 0; i < polyline.size () && s < simplification.size (); i += DIM) {
+            if (ComparePoint <DIM> (polyline.begin () + i, simplification.begin () + s)) {
+                keys.push_back (i / DIM);
+                s += DIM;
+            }
+        }
+        return keys;
+    }
+
+    TestPositionalErrorIndexed::TestPositionalErrorIndexed () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("matches coordinates", TestMatchesCoordinates ());
+        TEST_RUN("duplicate points", TestDuplicatePoints ());
+        TEST_RUN("mask", TestMask ());
+        TEST_RUN("statistics", TestStatistics ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+    }
+
+    // invalid input: nothing is written
+    void TestPositionalErrorIndexed::TestInvalidInput () {
+        const unsigned DIM = 2;
+        bool valid = true;
+
+        std::vector <float> polyline, errors;
+        std::generate_n (std::back_inserter (polyline), 5*DIM, StraightLine <float, DIM> ());
+
+        int first [] = {1, 4};
+        int last [] = {0, 3};
+        int order [] = {0, 3, 2, 4};
+        int range [] = {0, 5};
+        int single [] = {0};
+
+        psimpl::compute_positional_errors2_indexed <DIM> (polyline.begin (), polyline.end (), first, first + 2, std::back_inserter (errors), &valid);
+        VERIFY_FALSE(valid);
+        valid = true;
+        psimpl::compute_positional_errors2_indexed <DIM> (polyline.begin (), polyline.end (), last, last + 2, std::back_inserter (errors), &valid);
+        VERIFY_FALSE(valid);
+        valid = true;
+        psimpl::compute_positional_errors2_indexed <DIM> (polyline.begin (), polyline.end (), order, order + 4, std::back_inserter (errors), &valid);
+        VERIFY_FALSE(valid);
+        valid = true;
+        psimpl::compute_positional_errors2_indexed <DIM> (polyline.begin (), polyline.end (), range, range + 2, std::back_inserter (errors), &valid);
+        VERIFY_FALSE(valid);
+        valid = true;
+        psimpl::compute_positional_errors2_indexed <DIM> (polyline.begin (), polyline.end (), single, single, std::back_inserter (errors), &valid);
+        VERIFY_FALSE(valid);
+        VERIFY_TRUE(errors.empty ());
+
+        // incomplete point
+        polyline.pop_back ();
+        valid = true;
+        psimpl::compute_positional_errors2_indexed <DIM> (polyline.begin (), polyline.end (), range, range + 2, std::back_inserter (errors), &valid);
+        VERIFY_FALSE(valid);
+        VERIFY_TRUE(errors.empty ());
+    }
+
+    // same errors as when matching coordinates
+    void TestPositionalErrorIndexed::TestMatchesCoordinates () {
+        {
+            const unsigned DIM = 2;
+            std::vector <double> polyline, simplification, expected, errors;
+            std::generate_n (std::back_inserter (polyline), 10000*DIM, RandomWalkLine <double, DIM> ());
+            psimpl::simplify_douglas_peucker <DIM> (
+                polyline.begin (), polyline.end (), 1.5, std::back_inserter (simplification));
+            psimpl::compute_positional_errors2 <DIM> (
+                polyline.begin (), polyline.end (),
+                simplification.begin (), simplification.end (),
+                std::back_inserter (expected));
+
+            std::vector <size_t> keys = KeyIndices <DIM> (polyline, simplification);
+            bool valid = false;
+            psimpl::compute_positional_errors2_indexed <DIM> (
+                polyline.begin (), polyline.end (), keys.begin (), keys.end (),
+                std::back_inserter (errors), &valid);
+
+            VERIFY_TRUE(valid);
+            ASSERT_TRUE(errors.size () == expected.size ());
+            bool equal = true;
+            for (size_t i = 0; i < errors.size (); ++i) {
+                equal = equal && CompareValue (expected [i], errors [i]);
+            }
+            VERIFY_TRUE(equal);
+        }
+        {
+            const unsigned DIM = 3;
+            std::vector <float> polyline, simplification, expected, errors;
+            std::generate_n (std::back_inserter (polyline), 1000*DIM, RandomWalkLine <float, DIM> (1.f, 3));
+            psimpl::simplify_douglas_peucker_n <DIM> (
+                polyline.begin (), polyline.end (), 100, std::back_inserter (simplification));
+            psimpl::compute_positional_errors2 <DIM> (
+                polyline.begin (), polyline.end (),
+                simplification.begin (), simplification.end (),
+                std::back_inserter (expected));
+
+            std::vector <size_t> keys = KeyIndices <DIM> (polyline, simplification);
+            psimpl::compute_positional_errors2_indexed <DIM> (
+                &polyline [0], &polyline [0] + polyline.size (), keys.begin (), keys.end (),
+                std::back_inserter (errors));
+
+            ASSERT_TRUE(errors.size () == expected.size ());
+            bool equal = true;
+            for (size_t i = 0; i < errors.size (); ++i) {
+                equal = equal && CompareValue (expected [i], errors [i]);
+            }
+            VERIFY_TRUE(equal);
+        }
+    }
+
+    // a polyline that revisits its first point cannot be matched by coordinates
+    void TestPositionalErrorIndexed::TestDuplicatePoints () {
+        const unsigned DIM = 2;
+
+        // (0,0) (1,1) (2,0) (1,1) (0,0) (1,-1) (0,-2)
+        double polyline [] = {0,0, 1,1, 2,0, 1,1, 0,0, 1,-1, 0,-2};
+        int keys [] = {0, 2, 4, 6};
+        std::vector <double> errors;
+        bool valid = false;
+
+        psimpl::compute_positional_errors2_indexed <DIM> (
+            polyline, polyline + 14, keys, keys + 4, std::back_inserter (errors), &valid);
+
+        VERIFY_TRUE(valid);
+        ASSERT_TRUE(errors.size () == 7);
+        double expected [] = {0, 1, 0, 1, 0, 1, 0};
+        VERIFY_TRUE(std::equal (errors.begin (), errors.end (), expected));
+    }
+
+    // a mask gives the same result as the indices
+    void TestPositionalErrorIndexed::TestMask () {
+        const unsigned DIM = 2;
+
+        double polyline [] = {0,0, 1,1, 2,0, 1,1, 0,0, 1,-1, 0,-2};
+        bool mask [] = {true, false, true, false, true, false, true};
+        std::vector <double> errors;
+        bool valid = false;
+
+        psimpl::compute_positional_errors2_masked <DIM> (
+            polyline, polyline + 14, mask, std::back_inserter (errors), &valid);
+
+        VERIFY_TRUE(valid);
+        double expected [] = {0, 1, 0, 1, 0, 1, 0};
+        ASSERT_TRUE(errors.size () == 7);
+        VERIFY_TRUE(std::equal (errors.begin (), errors.end (), expected));
+
+        // the last point must be kept
+        mask [6] = false;
+        errors.clear ();
+        psimpl::compute_positional_errors2_masked <DIM> (
+            polyline, polyline + 14, mask, std::back_inserter (errors), &valid);
+        VERIFY_FALSE(valid);
+        VERIFY_TRUE(errors.empty ());
+    }
+
+    void TestPositionalErrorIndexed::TestStatistics () {
+        const unsigned DIM = 2;
+
+        std::vector <double> polyline, simplification;
+        std::generate_n (std::back_inserter (polyline), 10000*DIM, RandomWalkLine <double, DIM> ());
+        psimpl::simplify_douglas_peucker <DIM> (
+            polyline.begin (), polyline.end (), 2.0, std::back_inserter (simplification));
+
+        error::quantile_sketch expectedSketch;
+        error::statistics expected = psimpl::compute_positional_error_statistics <DIM> (
+            polyline.begin (), polyline.end (),
+            simplification.begin (), simplification.end (), expectedSketch);
+
+        std::vector <size_t> keys = KeyIndices <DIM> (polyline, simplification);
+        bool valid = false;
+        error::quantile_sketch sketch;
+        error::statistics stats = psimpl::compute_positional_error_statistics_indexed <DIM> (
+            polyline.begin (), polyline.end (), keys.begin (), keys.end (), sketch, &valid);
+
+        VERIFY_TRUE(valid);
+        VERIFY_TRUE(CompareValue (expected.max, stats.max));
+        VERIFY_TRUE(CompareValue (expected.mean, stats.mean));
+        VERIFY_TRUE(CompareValue (expected.std, stats.std));
+        VERIFY_TRUE(std::fabs (expected.sum - stats.sum) < 1e-9 * expected.sum);
+        VERIFY_TRUE(sketch.count () == expectedSketch.count ());
+
+        std::vector <unsigned char> mask (polyline.size () / DIM, 0);
+        for (size_t i = 0; i < keys.size (); ++i) {
+            mask [keys [i]] = 1;
+        }
+        error::quantile_sketch maskedSketch;
+        stats = psimpl::compute_positional_error_statistics_masked <DIM> (
+            polyline.begin (), polyline.end (), mask.begin (), maskedSketch, &valid);
+
+        VERIFY_TRUE(valid);
+        VERIFY_TRUE(CompareValue (expected.mean, stats.mean));
+        VERIFY_TRUE(maskedSketch.count () == expectedSketch.count ());
+    }
+
+    void TestPositionalErrorIndexed::TestIntegers () {
+        const unsigned DIM = 2;
+
+        std::vector <int> polyline;
+        std::generate_n (std::back_inserter (polyline), 100*DIM, SawToothLine <int, DIM> ());
+        std::vector <double> expected, errors;
+        int keys [] = {0, 99};
+        int simplification [] = {polyline [0], polyline [1], polyline [198], polyline [199]};
+
+        psimpl::compute_positional_errors2 <DIM> (
+            polyline.begin (), polyline.end (), simplification, simplification + 4,
+            std::back_inserter (expected));
+        psimpl::compute_positional_errors2_indexed <DIM> (
+            polyline.begin (), polyline.end (), keys, keys + 2,
+            std::back_inserter (errors));
+
+        ASSERT_TRUE(errors.size () == expected.size ());
+        bool equal = true;
+        for (size_t i = 0; i < errors.size (); ++i) {
+            equal = equal && CompareValue (expected [i], errors [i]);
+        }
+        VERIFY_TRUE(equal);
+    }
+
 }}
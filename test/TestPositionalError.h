@@ -75,6 +75,27 @@ namespace psimpl {
         void TestBidirectionalIterator ();
         void TestForwardIterator ();
         void TestMixedIterators ();
+        void TestErrors ();
+        void TestAccumulator ();
+        void TestQuantileSketch ();
+        void TestQuantileSketchMerge ();
+        void TestPercentiles ();
+    };
+
+    //! Tests the functions psimpl::compute_positional_errors2_indexed/masked and
+    //! psimpl::compute_positional_error_statistics_indexed/masked
+    class TestPositionalErrorIndexed
+    {
+    public:
+        TestPositionalErrorIndexed ();
+
+    private:
+        void TestInvalidInput ();
+        void TestMatchesCoordinates ();
+        void TestDuplicatePoints ();
+        void TestMask ();
+        void TestStatistics ();
+        void TestIntegers ();
     };
 }}
 
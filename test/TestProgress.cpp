@@ -0,0 +1,449 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+
+
+#include "TestProgress.h"
+#include "helper.h"
+#include "psimpl.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <vector>
+
+
+namespace psimpl {
+    namespace test
+{
+    //! \brief stops the routine once a given amount of work was reported
+    class StopAt : public progress
+    {
+    public:
+        StopAt (unsigned long long limit, unsigned long long interval) :
+            progress (interval),
+            limit (limit),
+            updates (0)
+        {}
+
+    protected:
+        virtual bool update (unsigned long long work) {
+            ++updates;
+            return work < limit;
+        }
+
+    public:
+        unsigned long long limit;
+        unsigned updates;
+    };
+
+    // -----------------------------------------------------------------------------------------
+
+    TestProgress::TestProgress () {
+        TEST_RUN("advance", TestAdvance ());
+        TEST_RUN("same result", TestSameResult ());
+        TEST_RUN("cancel", TestCancel ());
+        TEST_RUN("update", TestUpdate ());
+        TEST_RUN("blocks", TestBlocks ());
+        TEST_RUN("deadline", TestDeadline ());
+        TEST_RUN("errors", TestErrors ());
+        TEST_RUN("parallel", TestParallel ());
+        TEST_RUN("refiner", TestRefiner ());
+    }
+
+    // update is only called once an interval has passed
+    void TestProgress::TestAdvance () {
+        StopAt monitor (25, 10);
+        monitor.advance (9);
+        VERIFY_TRUE(monitor.updates == 0);
+        monitor.advance (1);
+        VERIFY_TRUE(monitor.updates == 1);
+        monitor.advance (5);
+        VERIFY_TRUE(monitor.updates == 1);
+        monitor.advance (20);
+        VERIFY_TRUE(monitor.updates == 2);
+        VERIFY_TRUE(monitor.work () == 35);
+        VERIFY_TRUE(monitor.stopped ());
+
+        // once stopped, update is no longer called
+        monitor.advance (100);
+        VERIFY_TRUE(monitor.updates == 2);
+
+        monitor.reset ();
+        VERIFY_TRUE(monitor.work () == 0);
+        VERIFY_TRUE(!monitor.stopped ());
+    }
+
+    // a monitor that does not stop, does not change the simplification
+    void TestProgress::TestSameResult () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 2000*DIM, RandomWalkLine <double, DIM> (1., 3));
+        double tol = 2.;
+
+        #define COMPARE(CALL, ...)                                                              \
+        {                                                                                       \
+            std::vector <double> expected, result;                                              \
+            progress monitor (16);                                                              \
+            psimpl::CALL <DIM> (__VA_ARGS__, std::back_inserter (expected));                    \
+            psimpl::CALL <DIM> (__VA_ARGS__, with_counters (std::back_inserter (result), monitor)); \
+            VERIFY_TRUE(result == expected);                                                    \
+            VERIFY_TRUE(!monitor.stopped ());                                                   \
+            VERIFY_TRUE(monitor.work () > 0);                                                   \
+        }
+
+        COMPARE(simplify_radial_distance, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_perpendicular_distance, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_perpendicular_distance, polyline.begin (), polyline.end (), tol, 3)
+        COMPARE(simplify_reumann_witkam, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_opheim, polyline.begin (), polyline.end (), tol, 5*tol)
+        COMPARE(simplify_lang, polyline.begin (), polyline.end (), tol, 8)
+        COMPARE(simplify_sleeve_fitting, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_optimal, polyline.begin (), polyline.begin () + 200*DIM, tol)
+        COMPARE(simplify_optimal_windowed, polyline.begin (), polyline.end (), tol, 32)
+        COMPARE(simplify_douglas_peucker_classic, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_douglas_peucker_pruned, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_douglas_peucker, polyline.begin (), polyline.end (), tol)
+        COMPARE(simplify_douglas_peucker_n, polyline.begin (), polyline.end (), 100)
+        COMPARE(simplify_douglas_peucker_to_count, polyline.begin (), polyline.end (), 100)
+        COMPARE(simplify_douglas_peucker_to_error, polyline.begin (), polyline.end (), tol)
+
+        #undef COMPARE
+    }
+
+    // a cancelled monitor stops the routine at its first check
+    void TestProgress::TestCancel () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 2000*DIM, RandomWalkLine <double, DIM> (1., 5));
+
+        progress monitor (1);
+        monitor.cancel ();
+        VERIFY_TRUE(!monitor.stopped ());
+
+        std::vector <double> result;
+        psimpl::simplify_douglas_peucker_n <DIM> (
+            polyline.begin (), polyline.end (), 100, with_counters (std::back_inserter (result), monitor));
+        VERIFY_TRUE(monitor.stopped ());
+        VERIFY_TRUE(result.empty ());
+
+        // after a reset the monitor can be used again
+        monitor.reset ();
+        std::vector <double> expected;
+        psimpl::simplify_douglas_peucker_n <DIM> (
+            polyline.begin (), polyline.end (), 100, std::back_inserter (expected));
+        psimpl::simplify_douglas_peucker_n <DIM> (
+            polyline.begin (), polyline.end (), 100, with_counters (std::back_inserter (result), monitor));
+        VERIFY_TRUE(!monitor.stopped ());
+        VERIFY_TRUE(result == expected);
+    }
+
+    // update returning false stops the routine long before it would be done
+    void TestProgress::TestUpdate () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 5000*DIM, RandomWalkLine <double, DIM> (1., 9));
+        double tol = 1.;
+
+        #define STOP(CALL, ...)                                                                 \
+        {                                                                                       \
+            progress full;                                                                      \
+            StopAt monitor (1000, 100);                                                         \
+            std::vector <double> result;                                                        \
+            psimpl::CALL <DIM> (__VA_ARGS__, with_counters (std::back_inserter (result), full)); \
+            psimpl::CALL <DIM> (__VA_ARGS__, with_counters (std::back_inserter (result), monitor)); \
+            VERIFY_TRUE(monitor.stopped ());                                                    \
+            VERIFY_TRUE(monitor.updates == 10);                                                 \
+            VERIFY_TRUE(monitor.work () < full.work () / 2);                                    \
+        }
+
+        STOP(simplify_perpendicular_distance, polyline.begin (), polyline.end (), tol)
+        STOP(simplify_opheim, polyline.begin (), polyline.end (), tol, 5*tol)
+        STOP(simplify_lang, polyline.begin (), polyline.end (), tol, 8)
+        STOP(simplify_sleeve_fitting, polyline.begin (), polyline.end (), tol)
+        STOP(simplify_optimal_windowed, polyline.begin (), polyline.end (), tol, 32)
+        STOP(simplify_douglas_peucker_pruned, polyline.begin (), polyline.end (), tol)
+
+        #undef STOP
+    }
+
+    // the single pass routines are checked after each block of points
+    void TestProgress::TestBlocks () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 50000*DIM, RandomWalkLine <double, DIM> (1., 7));
+        double tol = 1.;
+
+        #define STOP(CALL)                                                                      \
+        {                                                                                       \
+            progress full;                                                                      \
+            StopAt monitor (1, 1);                                                              \
+            std::vector <double> result;                                                        \
+            psimpl::CALL <DIM> (polyline.begin (), polyline.end (), tol,                        \
+                                with_counters (std::back_inserter (result), full));             \
+            psimpl::CALL <DIM> (polyline.begin (), polyline.end (), tol,                        \
+                                with_counters (std::back_inserter (result), monitor));          \
+            VERIFY_TRUE(!full.stopped ());                                                      \
+            VERIFY_TRUE(full.work () == 50000 - 2);                                             \
+            VERIFY_TRUE(monitor.stopped ());                                                    \
+            VERIFY_TRUE(monitor.updates == 1);                                                  \
+            VERIFY_TRUE(monitor.work () < full.work () / 2);                                    \
+        }
+
+        STOP(simplify_radial_distance)
+        STOP(simplify_reumann_witkam)
+
+        #undef STOP
+
+        // several tolerances at once are checked after each block as well
+        {
+            double tols [] = {1., 2.};
+            std::vector <double> levels [2];
+            std::back_insert_iterator <std::vector <double> > outputs [2] = {
+                std::back_inserter (levels [0]), std::back_inserter (levels [1])
+            };
+            StopAt monitor (1, 1);
+            psimpl::simplify_radial_distance_multi <DIM> (
+                polyline.begin (), polyline.end (), tols, tols + 2, outputs, with_counters (monitor));
+            VERIFY_TRUE(monitor.stopped ());
+            VERIFY_TRUE(monitor.updates == 1);
+            VERIFY_TRUE(monitor.work () < 50000);
+        }
+        // a batch is checked after each polyline
+        {
+            std::vector <double> result;
+            std::vector <std::size_t> offsets, result_offsets;
+            for (std::size_t offset = 0; offset <= 50000*DIM; offset += 1000*DIM) {
+                offsets.push_back (offset);
+            }
+            progress monitor (1);
+            monitor.cancel ();
+            psimpl::simplify_douglas_peucker_batch <DIM> (
+                polyline.begin (), offsets.begin (), offsets.end (), tol,
+                with_counters (std::back_inserter (result), monitor), std::back_inserter (result_offsets));
+            VERIFY_TRUE(monitor.stopped ());
+            VERIFY_TRUE(result_offsets.size () == 2);
+        }
+        // nth point evaluates no distances, and cannot be stopped
+        {
+            progress monitor (1);
+            monitor.cancel ();
+            std::vector <double> result;
+            psimpl::simplify_nth_point <DIM> (
+                polyline.begin (), polyline.end (), 10, with_counters (std::back_inserter (result), monitor));
+            VERIFY_TRUE(!monitor.stopped ());
+            VERIFY_TRUE(monitor.work () == 0);
+            VERIFY_TRUE(result.size () == 5001*DIM);
+        }
+    }
+
+    // a deadline that has passed stops the routine at its first check
+    void TestProgress::TestDeadline () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 2000*DIM, RandomWalkLine <double, DIM> (1., 11));
+
+        typedef std::chrono::steady_clock::time_point time_point;
+        deadline_progress <time_point> past (std::chrono::steady_clock::now (), 1);
+        std::vector <double> result;
+        psimpl::simplify_lang <DIM> (
+            polyline.begin (), polyline.end (), 1., 16, with_counters (std::back_inserter (result), past));
+        VERIFY_TRUE(past.stopped ());
+        VERIFY_TRUE(past.work () <= 16);
+
+        past.reset ();
+        psimpl::simplify_perpendicular_distance <DIM> (
+            polyline.begin (), polyline.end (), 1., with_counters (std::back_inserter (result), past));
+        VERIFY_TRUE(past.stopped ());
+
+        deadline_progress <time_point> future (std::chrono::steady_clock::now () + std::chrono::hours (1), 1);
+        psimpl::simplify_lang <DIM> (
+            polyline.begin (), polyline.end (), 1., 16, with_counters (std::back_inserter (result), future));
+        VERIFY_TRUE(!future.stopped ());
+    }
+
+    // the error routines report their work, and can be stopped
+    void TestProgress::TestErrors () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline, simplification;
+        std::generate_n (std::back_inserter (polyline), 1000*DIM, RandomWalkLine <double, DIM> (1., 13));
+        psimpl::simplify_douglas_peucker <DIM> (
+            polyline.begin (), polyline.end (), 2., std::back_inserter (simplification));
+
+        {
+            progress monitor;
+            std::vector <double> expected, result;
+            bool valid = false;
+            psimpl::compute_positional_errors2 <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end (),
+                std::back_inserter (expected));
+            psimpl::compute_positional_errors2 <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end (),
+                with_counters (std::back_inserter (result), monitor), &valid);
+            VERIFY_TRUE(valid);
+            VERIFY_TRUE(result == expected);
+            // the last point matches the end of the simplification without a distance
+            VERIFY_TRUE(monitor.work () == result.size () - 1);
+        }
+        {
+            progress monitor;
+            double expected = psimpl::compute_hausdorff_distance <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end ());
+            double result = psimpl::compute_hausdorff_distance <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end (), 0, with_counters (monitor));
+            VERIFY_TRUE(result == expected);
+            VERIFY_TRUE(monitor.work () > 0);
+        }
+        {
+            progress full;
+            StopAt monitor (1000, 100);
+            psimpl::compute_discrete_frechet_distance <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end (), 0, with_counters (full));
+            psimpl::compute_discrete_frechet_distance <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end (), 0, with_counters (monitor));
+            VERIFY_TRUE(!full.stopped ());
+            VERIFY_TRUE(monitor.stopped ());
+            VERIFY_TRUE(monitor.work () < full.work () / 2);
+        }
+        {
+            // the indexed errors are checked after each block of errors
+            std::vector <std::size_t> keys;
+            for (std::size_t i = 0; i < 1000; i += 10) {
+                keys.push_back (i);
+            }
+            keys.push_back (999);
+            StopAt monitor (300, 100);
+            std::vector <double> result;
+            psimpl::compute_positional_errors2_indexed <DIM> (
+                polyline.begin (), polyline.end (), keys.begin (), keys.end (),
+                with_counters (std::back_inserter (result), monitor));
+            VERIFY_TRUE(monitor.stopped ());
+            VERIFY_TRUE(result.size () < 1000);
+        }
+        {
+            // the areal displacement is checked after each segment
+            progress monitor (1);
+            monitor.cancel ();
+            std::vector <double> result;
+            psimpl::compute_areal_displacements <DIM> (
+                polyline.begin (), polyline.end (), simplification.begin (), simplification.end (),
+                with_counters (std::back_inserter (result), monitor));
+            VERIFY_TRUE(monitor.stopped ());
+            VERIFY_TRUE(result.empty ());
+        }
+    }
+
+    // the parallel routines report their work from the calling thread
+    void TestProgress::TestParallel () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 100000*DIM, RandomWalkLine <double, DIM> (1., 15));
+
+        std::vector <double> expected, result;
+        progress full;
+        psimpl::simplify_douglas_peucker_n <DIM> (
+            polyline.begin (), polyline.end (), 5000, std::back_inserter (expected));
+        psimpl::simplify_douglas_peucker_n_parallel <DIM> (
+            polyline.begin (), polyline.end (), 5000, with_counters (std::back_inserter (result), full), 4);
+        VERIFY_TRUE(result == expected);
+        VERIFY_TRUE(!full.stopped ());
+        VERIFY_TRUE(full.work () >= 100000 - 2);
+
+        StopAt monitor (full.work () / 4, 1000);
+        result.clear ();
+        psimpl::simplify_douglas_peucker_n_parallel <DIM> (
+            polyline.begin (), polyline.end (), 5000, with_counters (std::back_inserter (result), monitor), 4);
+        VERIFY_TRUE(monitor.stopped ());
+        VERIFY_TRUE(monitor.work () < full.work () / 2);
+        VERIFY_TRUE(result.empty ());
+
+        // polylines too small for threads are simplified by the serial routine
+        progress serial (1);
+        serial.cancel ();
+        psimpl::simplify_douglas_peucker_n_parallel <DIM> (
+            polyline.begin (), polyline.begin () + 1000*DIM, 100, with_counters (std::back_inserter (result), serial), 4);
+        VERIFY_TRUE(serial.stopped ());
+        VERIFY_TRUE(result.empty ());
+
+        // the chunk parallel routines are checked after their speculative run, and after each seam
+        #define STOP(CALL, ...)                                                                 \
+        {                                                                                       \
+            progress cancelled (1);                                                             \
+            cancelled.cancel ();                                                                \
+            std::vector <double> keys;                                                          \
+            psimpl::CALL <DIM> (polyline.begin (), polyline.end (), __VA_ARGS__,                \
+                                with_counters (std::back_inserter (keys), cancelled), 4);       \
+            VERIFY_TRUE(cancelled.stopped ());                                                  \
+            VERIFY_TRUE(keys.empty ());                                                         \
+        }
+
+        STOP(simplify_radial_distance_parallel, 1.)
+        STOP(simplify_reumann_witkam_parallel, 1.)
+        STOP(simplify_opheim_parallel, 1., 5.)
+        STOP(simplify_lang_parallel, 1., 8)
+
+        #undef STOP
+    }
+
+    // a stopped refiner keeps its keys, and continues after a reset
+    void TestProgress::TestRefiner () {
+        const unsigned DIM = 2;
+        const unsigned count = 1000;
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), count*DIM, RandomWalkLine <double, DIM> (1., 17));
+
+        progress monitor (1);
+        psimpl::algo::douglas_peucker_n_refiner
+            <DIM, std::vector <double>::const_iterator, util::progress_ref> refiner (
+                polyline.begin (), polyline.end (), util::progress_ref (monitor));
+        VERIFY_TRUE(refiner.refine (10) == 10);
+
+        monitor.cancel ();
+        std::size_t added = refiner.refine (count);
+        VERIFY_TRUE(monitor.stopped ());
+        VERIFY_TRUE(added <= 1);
+        VERIFY_TRUE(refiner.refine (count) == 0);
+        VERIFY_TRUE(!refiner.done ());
+
+        std::vector <double> result, expected;
+        refiner.copy_keys (std::back_inserter (result));
+        psimpl::simplify_douglas_peucker_n <DIM> (
+            polyline.begin (), polyline.end (), refiner.key_count (), std::back_inserter (expected));
+        VERIFY_TRUE(result == expected);
+
+        monitor.reset ();
+        refiner.refine (count);
+        VERIFY_TRUE(refiner.done ());
+        VERIFY_TRUE(refiner.key_count () == count);
+    }
+}}
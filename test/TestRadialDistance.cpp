@@ -327,4 +327,141 @@ namespace psimpl {
         );
     }
 
+    // ---------------------------------------------------------------------------------------------
+
+    TestRadialDistanceMulti::TestRadialDistanceMulti () {
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("matches single", TestMatchesSingle ());
+        TEST_RUN("indices", TestIndices ());
+        TEST_RUN("bidirectional iterator", TestBidirectionalIterator ());
+        TEST_RUN("return value", TestReturnValue ());
+    }
+
+    // incomplete point or not enough points: each level is a copy
+    void TestRadialDistanceMulti::TestInvalidInput () {
+        const unsigned DIM = 2;
+        const float tols [] = {1.f, 2.f};
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), 10*DIM+1, StraightLine <float, DIM> ());
+
+        std::vector <float> level0, level1;
+        std::back_insert_iterator <std::vector <float> > outputs [] = {
+            std::back_inserter (level0), std::back_inserter (level1)};
+        psimpl::simplify_radial_distance_multi <DIM> (
+            polyline.begin (), polyline.end (), tols, tols + 2, outputs);
+
+        VERIFY_TRUE(level0 == polyline);
+        VERIFY_TRUE(level1 == polyline);
+
+        polyline.assign (2*DIM, 1.f);
+        std::vector <int> indices0, indices1;
+        std::back_insert_iterator <std::vector <int> > index_outputs [] = {
+            std::back_inserter (indices0), std::back_inserter (indices1)};
+        psimpl::simplify_radial_distance_multi_indices <DIM> (
+            polyline.begin (), polyline.end (), tols, tols + 2, index_outputs);
+
+        VERIFY_TRUE(indices0.size () == 2 && indices0 [0] == 0 && indices0 [1] == 1);
+        VERIFY_TRUE(indices1 == indices0);
+    }
+
+    // each level equals simplify_radial_distance, including a level with tol == 0
+    void TestRadialDistanceMulti::TestMatchesSingle () {
+        const unsigned DIM = 3;
+        const double tols [] = {0., 0.5, 2., 1., 10.};
+        const unsigned levels = 5;
+
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 5000*DIM, RandomWalkLine <double, DIM> ());
+
+        std::vector <double> results [levels];
+        double* outputs [levels];
+        for (unsigned l=0; l<levels; ++l) {
+            results [l].resize (polyline.size ());
+            outputs [l] = &results [l][0];
+        }
+        psimpl::simplify_radial_distance_multi <DIM> (
+            polyline.begin (), polyline.end (), tols, tols + levels, outputs);
+
+        for (unsigned l=0; l<levels; ++l) {
+            results [l].resize (static_cast <size_t> (outputs [l] - &results [l][0]));
+
+            std::vector <double> expected;
+            psimpl::simplify_radial_distance <DIM> (
+                polyline.begin (), polyline.end (), tols [l], std::back_inserter (expected));
+            VERIFY_TRUE(results [l] == expected);
+        }
+    }
+
+    // the indices select the same points as the coordinates
+    void TestRadialDistanceMulti::TestIndices () {
+        const unsigned DIM = 2;
+        std::vector <int> tols;
+        tols.push_back (3);
+        tols.push_back (12);
+
+        std::vector <int> polyline;
+        std::generate_n (std::back_inserter (polyline), 2000*DIM, RandomWalkLine <int, DIM> (5));
+
+        std::vector <std::vector <int> > indices (tols.size ());
+        std::vector <std::back_insert_iterator <std::vector <int> > > outputs;
+        for (size_t l=0; l<tols.size (); ++l) {
+            outputs.push_back (std::back_inserter (indices [l]));
+        }
+        psimpl::simplify_radial_distance_multi_indices <DIM> (
+            polyline.begin (), polyline.end (), tols.begin (), tols.end (), outputs.begin ());
+
+        for (size_t l=0; l<tols.size (); ++l) {
+            std::vector <int> expected;
+            psimpl::simplify_radial_distance <DIM> (
+                polyline.begin (), polyline.end (), tols [l], std::back_inserter (expected));
+
+            VERIFY_TRUE(indices [l].size () * DIM == expected.size ());
+            VERIFY_TRUE(ComparePoints <DIM> (polyline.begin (), expected.begin (), indices [l]));
+        }
+    }
+
+    void TestRadialDistanceMulti::TestBidirectionalIterator () {
+        const unsigned DIM = 2;
+        const float tols [] = {1.f, 3.f};
+
+        std::list <float> polyline;
+        std::generate_n (std::back_inserter (polyline), 500*DIM, RandomWalkLine <float, DIM> ());
+
+        std::list <float> level0, level1;
+        std::back_insert_iterator <std::list <float> > outputs [] = {
+            std::back_inserter (level0), std::back_inserter (level1)};
+        psimpl::simplify_radial_distance_multi <DIM> (
+            polyline.begin (), polyline.end (), tols, tols + 2, outputs);
+
+        std::list <float> expected0, expected1;
+        psimpl::simplify_radial_distance <DIM> (
+            polyline.begin (), polyline.end (), tols [0], std::back_inserter (expected0));
+        psimpl::simplify_radial_distance <DIM> (
+            polyline.begin (), polyline.end (), tols [1], std::back_inserter (expected1));
+
+        VERIFY_TRUE(level0 == expected0);
+        VERIFY_TRUE(level1 == expected1);
+    }
+
+    void TestRadialDistanceMulti::TestReturnValue () {
+        const unsigned DIM = 3;
+        const unsigned count = 11;
+        const float tols [] = {0.f, 10.f, 20.f};
+
+        float polyline [count*DIM];
+        float level0 [count*DIM], level1 [count*DIM], level2 [count*DIM];
+        std::generate_n (polyline, count*DIM, StraightLine <float, DIM> ());
+
+        float* outputs [] = {level0, level1, level2, 0};
+        VERIFY_TRUE(
+            psimpl::simplify_radial_distance_multi <DIM> (
+                polyline, polyline + count*DIM, tols, tols + 3, outputs)
+            == outputs + 3);
+        VERIFY_TRUE(outputs [0] - level0 == count*DIM);
+        VERIFY_TRUE(outputs [1] - level1 == 2*DIM);
+        VERIFY_TRUE(outputs [2] - level2 == 2*DIM);
+        VERIFY_TRUE(outputs [3] == 0);
+    }
+
 }}
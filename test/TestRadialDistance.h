@@ -59,6 +59,20 @@ namespace psimpl {
         void TestReturnValue ();
         void TestIntegers ();
     };
+
+    //! Tests functions psimpl::simplify_radial_distance_multi(_indices)
+    class TestRadialDistanceMulti
+    {
+    public:
+        TestRadialDistanceMulti ();
+
+    private:
+        void TestInvalidInput ();
+        void TestMatchesSingle ();
+        void TestIndices ();
+        void TestBidirectionalIterator ();
+        void TestReturnValue ();
+    };
 }}
 
 
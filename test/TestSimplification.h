@@ -41,9 +41,16 @@
 #include "TestRadialDistance.h"
 #include "TestPerpendicularDistance.h"
 #include "TestReumannWitkam.h"
+#include "TestSleeveFitting.h"
+#include "TestOptimal.h"
 #include "TestOpheim.h"
 #include "TestLang.h"
 #include "TestDouglasPeucker.h"
+#include "TestBatch.h"
+#include "TestParallel.h"
+#include "TestCounters.h"
+#include "TestTrace.h"
+#include "TestProgress.h"
 
 
 namespace psimpl {
@@ -55,13 +62,29 @@ namespace psimpl {
         TestSimplification () {
             TEST_RUN("nth point", TestNthPoint ());
             TEST_RUN("radial distance", TestRadialDistance ());
+            TEST_RUN("radial distance multi", TestRadialDistanceMulti ());
             TEST_RUN("perpendicular distance", TestPerpendicularDistance ());
             TEST_RUN("reumann witkam", TestReumannWitkam ());
             TEST_RUN("opheim", TestOpheim ());
             TEST_RUN("lang", TestLang ());
+            TEST_RUN("sleeve fitting", TestSleeveFitting ());
+            TEST_RUN("optimal", TestOptimal ());
             TEST_RUN("douglas peucker classic", TestDouglasPeuckerClassic ());
             TEST_RUN("douglas peucker", TestDouglasPeucker ());
             TEST_RUN("douglas peucker n", TestDouglasPeuckerN ());
+            TEST_RUN("douglas peucker n refiner", TestDouglasPeuckerNRefiner ());
+            TEST_RUN("douglas peucker pruned", TestDouglasPeuckerPruned ());
+            TEST_RUN("douglas peucker solver", TestDouglasPeuckerSolver ());
+            TEST_RUN("douglas peucker batch", TestDouglasPeuckerBatch ());
+            TEST_RUN("nth point parallel", TestNthPointParallel ());
+            TEST_RUN("radial distance parallel", TestRadialDistanceParallel ());
+            TEST_RUN("reumann witkam parallel", TestReumannWitkamParallel ());
+            TEST_RUN("opheim parallel", TestOpheimParallel ());
+            TEST_RUN("lang parallel", TestLangParallel ());
+            TEST_RUN("douglas peucker n parallel", TestDouglasPeuckerNParallel ());
+            TEST_RUN("counters", TestCounters ());
+            TEST_RUN("trace", TestTrace ());
+            TEST_RUN("progress", TestProgress ());
         }
     };
 }}
@@ -0,0 +1,375 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+#include "TestSleeveFitting.h"
+#include "helper.h"
+#include "psimpl.h"
+#include <iterator>
+#include <vector>
+#include <forward_list>
+#include <algorithm>
+
+
+namespace psimpl {
+    namespace test
+{
+    /*!
+        \brief checks that the simplification is an ordered subset of the polyline, and that
+        each removed point lies within tol of the segment between its surrounding keys
+
+        Keys are matched by value, so the polyline should not contain duplicate points.
+    */
+    template <class T>
+    bool CheckSleeve (const std::vector <T>& polyline, const std::vector <T>& result, double tol) {
+        const unsigned DIM = 2;
+        if (result.size () < 2*DIM || result.size () % DIM) {
+            return false;
+        }
+        size_t key = 0;
+        size_t resultKey = 0;
+        if (!ComparePoint <DIM> (polyline.begin (), result.begin ())) {
+            return false;
+        }
+        for (size_t i = DIM; i < polyline.size (); i += DIM) {
+            if (resultKey + DIM < result.size () &&
+                ComparePoint <DIM> (polyline.begin () + i, result.begin () + resultKey + DIM))
+            {
+                // all points between the previous key and this key
+                for (size_t j = key + DIM; j < i; j += DIM) {
+                    double d2 = math::segment_distance2 <DIM> (
+                        polyline.begin () + key, polyline.begin () + i, polyline.begin () + j);
+                    if (d2 > tol * tol * (1 + 1e-9)) {
+                        return false;
+                    }
+                }
+                key = i;
+                resultKey += DIM;
+            }
+        }
+        return resultKey + DIM == result.size () && key + DIM == polyline.size ();
+    }
+
+    TestSleeveFitting::TestSleeveFitting () {
+        TEST_RUN("incomplete point", TestIncompletePoint ());
+        TEST_RUN("not enough points", TestNotEnoughPoints ());
+        TEST_RUN("invalid tol", TestInvalidTol ());
+        TEST_RUN("basic sanity", TestBasicSanity ());
+        TEST_RUN("tolerance", TestTolerance ());
+        TEST_RUN("doubling back", TestDoublingBack ());
+        TEST_RUN("forward iterator", TestForwardIterator ());
+        TEST_RUN("stream", TestStream ());
+        TEST_RUN("return value", TestReturnValue ());
+        TEST_RUN("signed/unsigned integers", TestIntegers ());
+    }
+
+    // incomplete point: coord count % DIM > 1
+    void TestSleeveFitting::TestIncompletePoint () {
+        const unsigned DIM = 2;
+        const float tol = 2.f;
+
+        // 4th point incomplete
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), 4*DIM-1, StraightLine <float, DIM> ());
+        std::vector <float> result;
+
+        psimpl::simplify_sleeve_fitting <DIM> (
+            polyline.begin (), polyline.end (), tol,
+            std::back_inserter (result));
+
+        VERIFY_TRUE(polyline == result);
+
+        // 4th point complete
+        polyline.push_back (4.f);
+        result.clear ();
+
+        psimpl::simplify_sleeve_fitting <DIM> (
+            polyline.begin (), polyline.end (), tol,
+            std::back_inserter (result));
+
+        VERIFY_FALSE(polyline == result);
+    }
+
+    // not enough points: point count < 3
+    void TestSleeveFitting::TestNotEnoughPoints () {
+        const unsigned DIM = 2;
+        const float tol = 2.f;
+
+        std::vector <float> polyline;
+        std::vector <float> result;
+
+        for (unsigned count = 0; count < 3; ++count) {
+            result.clear ();
+            psimpl::simplify_sleeve_fitting <DIM> (
+                polyline.begin (), polyline.end (), tol,
+                std::back_inserter (result));
+
+            VERIFY_TRUE(polyline == result);
+
+            polyline.push_back (count * 1.f);
+            polyline.push_back (count * 1.f);
+        }
+
+        // 3 points
+        result.clear ();
+        psimpl::simplify_sleeve_fitting <DIM> (
+            polyline.begin (), polyline.end (), tol,
+            std::back_inserter (result));
+
+        VERIFY_TRUE(polyline != result);
+    }
+
+    // invalid: tol == 0
+    void TestSleeveFitting::TestInvalidTol () {
+        const unsigned DIM = 2;
+        const unsigned count = 10;
+
+        std::vector <float> polyline;
+        std::generate_n (std::back_inserter (polyline), count*DIM, StraightLine <float, DIM> ());
+        std::vector <float> result;
+
+        psimpl::simplify_sleeve_fitting <DIM> (
+            polyline.begin (), polyline.end (), 0.f,
+            std::back_inserter (result));
+
+        VERIFY_TRUE(polyline == result);
+    }
+
+    void TestSleeveFitting::TestBasicSanity () {
+        const unsigned DIM = 2;
+        {
+            // straight line
+            std::vector <float> polyline, result;
+            std::generate_n (std::back_inserter (polyline), 6*DIM, StraightLine <float, DIM> ());
+
+            psimpl::simplify_sleeve_fitting <DIM> (
+                polyline.begin (), polyline.end (), 0.5f,
+                std::back_inserter (result));
+
+            ASSERT_TRUE(result.size () == 2*DIM);
+            VERIFY_TRUE(CompareEndPoints <DIM> (polyline.begin (), polyline.end (), result.begin (), result.end ()));
+        }
+        {
+            // a right angle: (0,0) (1,0) (2,0) (3,0) (3,1) (3,2) (3,3)
+            float coords [] = {0,0, 1,0, 2,0, 3,0, 3,1, 3,2, 3,3};
+            std::vector <float> polyline (coords, coords + 14), result;
+
+            psimpl::simplify_sleeve_fitting <DIM> (
+                polyline.begin (), polyline.end (), 0.1f,
+                std::back_inserter (result));
+
+            ASSERT_TRUE(result.size () == 3*DIM);
+            int keys [] = {0, 3, 6};
+            VERIFY_TRUE(ComparePoints <DIM> (polyline.begin (), result.begin (), std::vector <int> (keys, keys + 3)));
+        }
+        {
+            // a slow curve: Reumann-Witkam fixes its strip along the first segment and
+            // needs a key at (2,0.3), the sleeve turns along with the points
+            float coords [] = {0,0, 1,0, 2,0.3f, 3,0.9f, 4,1.8f};
+            std::vector <float> polyline (coords, coords + 10), result;
+
+            psimpl::simplify_sleeve_fitting <DIM> (
+                polyline.begin (), polyline.end (), 0.5f,
+                std::back_inserter (result));
+
+            ASSERT_TRUE(result.size () == 3*DIM);
+            int keys [] = {0, 3, 4};
+            VERIFY_TRUE(ComparePoints <DIM> (polyline.begin (), result.begin (), std::vector <int> (keys, keys + 3)));
+        }
+    }
+
+    // every removed point lies within tolerance of its segment
+    void TestSleeveFitting::TestTolerance () {
+        const unsigned DIM = 2;
+
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), 10000*DIM, RandomWalkLine <double, DIM> ());
+
+        double tols [] = {0.1, 0.5, 1., 3., 10.};
+        for (unsigned i = 0; i < 5; ++i) {
+            std::vector <double> result;
+            psimpl::simplify_sleeve_fitting <DIM> (
+                polyline.begin (), polyline.end (), tols [i],
+                std::back_inserter (result));
+
+            VERIFY_TRUE(result.size () < polyline.size ());
+            VERIFY_TRUE(CheckSleeve (polyline, result, tols [i]));
+        }
+
+        // square tooth lines contain many duplicate directions
+        polyline.clear ();
+        std::generate_n (std::back_inserter (polyline), 500*DIM, SquareToothLine <double, DIM> ());
+        for (unsigned i = 0; i < 5; ++i) {
+            std::vector <double> result;
+            psimpl::simplify_sleeve_fitting <DIM> (
+                polyline.begin (), polyline.end (), tols [i],
+                std::back_inserter (result));
+
+            VERIFY_TRUE(CheckSleeve (polyline, result, tols [i]));
+        }
+    }
+
+    // points that the polyline passes before it doubles back stay within tolerance of the segment
+    void TestSleeveFitting::TestDoublingBack () {
+        const unsigned DIM = 2;
+        {
+            // (10,0) lies on the ray from (0,0) through (1,0), but 9 beyond the segment
+            double coords [] = {0,0, 10,0, 1,0, 1,5};
+            std::vector <double> polyline (coords, coords + 8), result;
+
+            psimpl::simplify_sleeve_fitting <DIM> (
+                polyline.begin (), polyline.end (), 0.5,
+                std::back_inserter (result));
+
+            VERIFY_TRUE(result == polyline);
+        }
+        {
+            // a shuttle that moves back and forth along the x-axis, drifting slowly forward
+            std::vector <double> polyline;
+            for (unsigned i = 0; i < 200; ++i) {
+                polyline.push_back (i % 2 ? 0.1 * i : 0.1 * i + 7.);
+                polyline.push_back (0.001 * i);
+            }
+            double tols [] = {0.1, 0.5, 1., 3., 10.};
+            for (unsigned i = 0; i < 5; ++i) {
+                std::vector <double> result;
+                psimpl::simplify_sleeve_fitting <DIM> (
+                    polyline.begin (), polyline.end (), tols [i],
+                    std::back_inserter (result));
+
+                VERIFY_TRUE(CheckSleeve (polyline, result, tols [i]));
+            }
+        }
+    }
+
+    // single pass forward iterator
+    void TestSleeveFitting::TestForwardIterator () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline, expected;
+        std::generate_n (std::back_inserter (polyline), 1000*DIM, RandomWalkLine <float, DIM> ());
+        psimpl::simplify_sleeve_fitting <DIM> (
+            polyline.begin (), polyline.end (), 1.5f,
+            std::back_inserter (expected));
+
+        std::forward_list <float> list (polyline.begin (), polyline.end ());
+        std::vector <float> result;
+        psimpl::simplify_sleeve_fitting <DIM> (
+            list.begin (), list.end (), 1.5f,
+            std::back_inserter (result));
+
+        VERIFY_TRUE(result == expected);
+    }
+
+    // pushing points one at a time gives the same result, and the stream can be reused
+    void TestSleeveFitting::TestStream () {
+        const unsigned DIM = 2;
+
+        std::vector <float> polyline, expected;
+        std::generate_n (std::back_inserter (polyline), 1000*DIM, RandomWalkLine <float, DIM> ());
+        psimpl::simplify_sleeve_fitting <DIM> (
+            polyline.begin (), polyline.end (), 2.f,
+            std::back_inserter (expected));
+
+        std::vector <float> result;
+        typedef std::back_insert_iterator <std::vector <float> > output;
+        psimpl::algo::sleeve_fitting_stream <float, output> stream (2.f, std::back_inserter (result));
+
+        for (unsigned pass = 0; pass < 2; ++pass) {
+            result.clear ();
+            for (size_t i = 0; i < polyline.size (); i += DIM) {
+                stream.push (polyline [i], polyline [i+1]);
+            }
+            stream.finish ();
+            VERIFY_TRUE(result == expected);
+        }
+
+        // a single point
+        result.clear ();
+        stream.push (1.f, 2.f);
+        stream.finish ();
+        VERIFY_TRUE(result.size () == DIM);
+    }
+
+    void TestSleeveFitting::TestReturnValue () {
+        const unsigned DIM = 2;
+        const unsigned count = 15;
+
+        float polyline [count*DIM];
+        std::generate_n (polyline, count*DIM, StraightLine <float, DIM> ());
+        float result [count*DIM];
+
+        // invalid input
+        VERIFY_TRUE (
+            std::distance (
+                result,
+                psimpl::simplify_sleeve_fitting <DIM> (
+                    polyline, polyline + count*DIM, 0.f,
+                    result))
+            == count*DIM);
+
+        // valid input
+        VERIFY_TRUE (
+            std::distance (
+                result,
+                psimpl::simplify_sleeve_fitting <DIM> (
+                    polyline, polyline + count*DIM, 1.5f,
+                    result))
+            == 2*DIM);
+    }
+
+    // integer coordinates are unwrapped in the calculation type
+    void TestSleeveFitting::TestIntegers () {
+        const unsigned DIM = 2;
+        const double tol = 4;
+
+        std::vector <int> polyline, result;
+        std::generate_n (std::back_inserter (polyline), 2000*DIM, RandomWalkLine <int, DIM> (5));
+        // unique points, so that CheckSleeve can match the keys
+        for (size_t i = 0; i < polyline.size (); i += DIM) {
+            polyline [i] = static_cast <int> (i);
+        }
+        psimpl::simplify_sleeve_fitting <DIM> (
+            polyline.begin (), polyline.end (), tol,
+            std::back_inserter (result));
+        VERIFY_TRUE(CheckSleeve (polyline, result, tol));
+
+        std::vector <unsigned> upolyline, uresult;
+        std::generate_n (std::back_inserter (upolyline), 500*DIM, SawToothLine <unsigned, DIM> ());
+        psimpl::simplify_sleeve_fitting <DIM> (
+            upolyline.begin (), upolyline.end (), tol,
+            std::back_inserter (uresult));
+        VERIFY_TRUE(CheckSleeve (upolyline, uresult, tol));
+    }
+
+}}
@@ -0,0 +1,313 @@
+/* ***** BEGIN LICENSE BLOCK *****
+ * Version: MPL 1.1
+ *
+ * The contents of this file are subject to the Mozilla Public License Version
+ * 1.1 (the "License"); you may not use this file except in compliance with
+ * the License. You may obtain a copy of the License at
+ * http://www.mozilla.org/MPL/
+ *
+ * Software distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+ * for the specific language governing rights and limitations under the
+ * License.
+ *
+ * The Original Code is
+ * 'psimpl - generic n-dimensional polyline simplification'.
+ *
+ * The Initial Developer of the Original Code is
+ * Elmar de Koning (edekoning@gmail.com).
+ *
+ * Portions created by the Initial Developer are Copyright (C) 2010-2011
+ * the Initial Developer. All Rights Reserved.
+ *
+ * Contributor(s):
+ *
+ * ***** END LICENSE BLOCK ***** */
+
+/*
+    psimpl - generic n-dimensional polyline simplification
+    Copyright (C) 2010-2011 Elmar de Koning, edekoning@gmail.com
+
+    This file is part of psimpl and is hosted at SourceForge:
+    http://psimpl.sf.net/, http://sf.net/projects/psimpl/
+*/
+
+
+#include "TestTrace.h"
+#include "helper.h"
+#include "psimpl.h"
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace psimpl {
+    namespace test
+{
+    //! \brief records the stages of a single thread as text, e.g. "+a +b -b -a"
+    class TextSink : public trace_sink
+    {
+    public:
+        virtual void begin (const char* name) {
+            text += std::string (text.empty () ? "" : " ") + "+" + name;
+        }
+
+        virtual void end (const char* name) {
+            text += std::string (text.empty () ? "" : " ") + "-" + name;
+        }
+
+        std::string text;
+    };
+
+    //! \brief installs a sink for the lifetime of the scope
+    class InstallSink
+    {
+    public:
+        explicit InstallSink (trace_sink& sink) {
+            set_trace_sink (&sink);
+        }
+
+        ~InstallSink () {
+            set_trace_sink (0);
+        }
+    };
+
+    //! \brief checks that each thread ends its stages in reverse order of beginning them
+    static bool Balanced (const std::vector <trace_recorder::event>& events) {
+        std::vector <std::vector <std::string> > stacks;
+        for (size_t e = 0; e < events.size (); ++e) {
+            const trace_recorder::event& ev = events [e];
+            if (stacks.size () <= ev.thread) {
+                stacks.resize (ev.thread + 1);
+            }
+            std::vector <std::string>& stack = stacks [ev.thread];
+            if (ev.phase == 'B') {
+                stack.push_back (ev.name);
+            }
+            else if (ev.phase != 'E' || stack.empty () || stack.back () != ev.name) {
+                return false;
+            }
+            else {
+                stack.pop_back ();
+            }
+        }
+        for (size_t t = 0; t < stacks.size (); ++t) {
+            if (!stacks [t].empty ()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    //! \brief counts the events of a stage
+    static size_t Count (const std::vector <trace_recorder::event>& events, const std::string& name, char phase) {
+        size_t count = 0;
+        for (size_t e = 0; e < events.size (); ++e) {
+            count += name == events [e].name && phase == events [e].phase;
+        }
+        return count;
+    }
+
+    // -----------------------------------------------------------------------------------------
+
+    TestTrace::TestTrace () {
+        TEST_RUN("install", TestInstall ());
+        TEST_RUN("scope", TestScope ());
+        TEST_RUN("douglas peucker", TestDouglasPeucker ());
+        TEST_RUN("invalid input", TestInvalidInput ());
+        TEST_RUN("batch", TestBatch ());
+        TEST_RUN("parallel", TestParallel ());
+        TEST_RUN("write", TestWrite ());
+    }
+
+    // set_trace_sink returns the previous sink, and nothing is reported without a sink
+    void TestTrace::TestInstall () {
+        TextSink first, second;
+        ASSERT_TRUE(set_trace_sink (&first) == 0);
+        VERIFY_TRUE(set_trace_sink (&second) == &first);
+        VERIFY_TRUE(set_trace_sink (0) == &second);
+        VERIFY_TRUE(set_trace_sink (0) == 0);
+
+        std::vector <double> polyline, result;
+        std::generate_n (std::back_inserter (polyline), 100*2, SawToothLine <double, 2> ());
+        psimpl::simplify_douglas_peucker <2> (polyline.begin (), polyline.end (), 0.5, std::back_inserter (result));
+        VERIFY_TRUE(first.text.empty ());
+        VERIFY_TRUE(second.text.empty ());
+    }
+
+    // scopes end in reverse order, next ends the current stage, and end can be called once
+    void TestTrace::TestScope () {
+        TextSink sink;
+        {
+            InstallSink install (sink);
+            util::trace_scope outer ("a");
+            {
+                util::trace_scope inner ("b");
+                inner.next ("c");
+                inner.end ();
+                inner.end ();
+            }
+            util::trace_scope other ("d");
+        }
+        VERIFY_TRUE(sink.text == "+a +b -b +c -c +d -d -a");
+
+        // a scope keeps reporting to the sink it started with
+        TextSink late;
+        {
+            util::trace_scope scope ("e");
+            InstallSink install (late);
+            scope.next ("f");
+        }
+        VERIFY_TRUE(late.text.empty ());
+    }
+
+    // the stages of DP, nested in its RD and DPc stages
+    void TestTrace::TestDouglasPeucker () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline, result;
+        std::generate_n (std::back_inserter (polyline), 1000*DIM, RandomWalkLine <double, DIM> (1., 4));
+
+        TextSink sink;
+        {
+            InstallSink install (sink);
+            psimpl::simplify_douglas_peucker <DIM> (polyline.begin (), polyline.end (), 2., std::back_inserter (result));
+        }
+        VERIFY_TRUE(sink.text ==
+            "+douglas_peucker +radial distance -radial distance "
+            "+douglas_peucker_classic +find keys -find keys +copy keys -copy keys -douglas_peucker_classic "
+            "-douglas_peucker");
+
+        sink.text.clear ();
+        {
+            InstallSink install (sink);
+            psimpl::simplify_douglas_peucker_pruned <DIM> (polyline.begin (), polyline.end (), 2., std::back_inserter (result));
+            psimpl::simplify_douglas_peucker_n <DIM> (polyline.begin (), polyline.end (), 50, std::back_inserter (result));
+            psimpl::simplify_douglas_peucker_to_count <DIM> (polyline.begin (), polyline.end (), 50, std::back_inserter (result));
+        }
+        VERIFY_TRUE(sink.text ==
+            "+build tree -build tree "
+            "+douglas_peucker_pruned +find keys -find keys +copy keys -copy keys -douglas_peucker_pruned "
+            "+douglas_peucker_n +find keys -find keys +copy keys -copy keys -douglas_peucker_n "
+            "+douglas_peucker_to_count +hierarchy -hierarchy +solve -solve +copy keys -copy keys -douglas_peucker_to_count");
+
+        // the simplification is not affected
+        std::vector <double> traced, plain;
+        {
+            InstallSink install (sink);
+            psimpl::simplify_douglas_peucker <DIM> (polyline.begin (), polyline.end (), 2., std::back_inserter (traced));
+        }
+        psimpl::simplify_douglas_peucker <DIM> (polyline.begin (), polyline.end (), 2., std::back_inserter (plain));
+        VERIFY_TRUE(traced == plain);
+    }
+
+    // input that is copied as is reports no stages
+    void TestTrace::TestInvalidInput () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline, result;
+        std::generate_n (std::back_inserter (polyline), 2*DIM, StraightLine <double, DIM> ());
+
+        TextSink sink;
+        {
+            InstallSink install (sink);
+            psimpl::simplify_douglas_peucker <DIM> (polyline.begin (), polyline.end (), 2., std::back_inserter (result));
+            psimpl::simplify_douglas_peucker_classic <DIM> (polyline.begin (), polyline.end (), 2., std::back_inserter (result));
+            psimpl::simplify_douglas_peucker_n <DIM> (polyline.begin (), polyline.end (), 5, std::back_inserter (result));
+        }
+        VERIFY_TRUE(sink.text.empty ());
+        VERIFY_TRUE(result.size () == 3 * polyline.size ());
+    }
+
+    // the batch reports a single stage, not one per polyline
+    void TestTrace::TestBatch () {
+        const unsigned DIM = 2;
+        std::vector <double> coords;
+        std::vector <std::ptrdiff_t> offsets (1, 0);
+        for (unsigned i = 0; i < 10; ++i) {
+            std::generate_n (std::back_inserter (coords), (20 + i)*DIM, RandomWalkLine <double, DIM> (1., i + 1));
+            offsets.push_back (static_cast <std::ptrdiff_t> (coords.size ()));
+        }
+        std::vector <double> result;
+        std::vector <std::ptrdiff_t> resultOffsets;
+
+        TextSink sink;
+        {
+            InstallSink install (sink);
+            psimpl::simplify_douglas_peucker_batch <DIM> (
+                coords.begin (), offsets.begin (), offsets.end (), 1.,
+                std::back_inserter (result), std::back_inserter (resultOffsets));
+        }
+        VERIFY_TRUE(sink.text ==
+            "+douglas_peucker_batch -douglas_peucker_batch");
+    }
+
+    // each thread reports its own nested stages
+    void TestTrace::TestParallel () {
+        const unsigned DIM = 2;
+        std::vector <double> polyline, result;
+        std::generate_n (std::back_inserter (polyline), 100000*DIM, RandomWalkLine <double, DIM> (1., 6));
+
+        trace_recorder recorder;
+        {
+            InstallSink install (recorder);
+            psimpl::simplify_douglas_peucker_n_parallel <DIM> (polyline.begin (), polyline.end (), 500, std::back_inserter (result), 4);
+            psimpl::simplify_radial_distance_parallel <DIM> (polyline.begin (), polyline.end (), 2., std::back_inserter (result), 4);
+        }
+        std::vector <trace_recorder::event> events = recorder.events ();
+        VERIFY_TRUE(Balanced (events));
+        VERIFY_TRUE(Count (events, "douglas_peucker_n_parallel", 'B') == 1);
+        VERIFY_TRUE(Count (events, "speculate", 'B') == 1);
+        VERIFY_TRUE(Count (events, "repair seams", 'B') == 1);
+        VERIFY_TRUE(0 < Count (events, "task", 'B'));
+        VERIFY_TRUE(Count (events, "parallel run", 'B') == Count (events, "wait", 'E'));
+
+        // the calling thread reports first, and the timestamps of each thread increase
+        ASSERT_TRUE(!events.empty ());
+        VERIFY_TRUE(events.front ().thread == 0);
+        bool ordered = true;
+        for (unsigned t = 0; t < 4; ++t) {
+            long long time = 0;
+            for (size_t e = 0; e < events.size (); ++e) {
+                if (events [e].thread == t) {
+                    ordered = ordered && time <= events [e].time;
+                    time = events [e].time;
+                }
+            }
+        }
+        VERIFY_TRUE(ordered);
+
+        recorder.clear ();
+        VERIFY_TRUE(recorder.events ().empty ());
+    }
+
+    // Chrome trace-event JSON, with a name for each thread
+    void TestTrace::TestWrite () {
+        trace_recorder recorder;
+        std::ostringstream empty;
+        recorder.write (empty);
+        VERIFY_TRUE(empty.str () == "{\"traceEvents\":[\n],\"displayTimeUnit\":\"ns\"}\n");
+
+        recorder.begin ("a \"b\"");
+        recorder.end ("a \"b\"");
+        std::vector <trace_recorder::event> events = recorder.events ();
+        ASSERT_TRUE(events.size () == 2);
+        VERIFY_TRUE(events [0].phase == 'B' && events [1].phase == 'E');
+        VERIFY_TRUE(events [0].thread == 0 && events [1].thread == 0);
+        VERIFY_TRUE(0 <= events [0].time && events [0].time <= events [1].time);
+
+        std::ostringstream os;
+        recorder.write (os);
+        std::string json = os.str ();
+        VERIFY_TRUE(json.find ("{\"traceEvents\":[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"thread 0\"}},\n") == 0);
+        VERIFY_TRUE(json.find ("{\"name\":\"a \\\"b\\\"\",\"cat\":\"psimpl\",\"ph\":\"B\",\"ts\":") != std::string::npos);
+        VERIFY_TRUE(json.find ("\"ph\":\"E\"") != std::string::npos);
+        VERIFY_TRUE(json.find ("\n],\"displayTimeUnit\":\"ns\"}\n") == json.size () - 27);
+
+        // microseconds with nanosecond precision
+        std::string::size_type ts = json.find ("\"ts\":");
+        std::string::size_type dot = json.find ('.', ts);
+        std::string::size_type comma = json.find (',', ts);
+        VERIFY_TRUE(dot < comma && comma - dot == 4);
+    }
+}}
@@ -35,7 +35,10 @@
 #include "TestUtil.h"
 #include "test.h"
 #include "psimpl.h"
+#include "helper.h"
 
+#include <algorithm>
+#include <functional>
 #include <list>
 #include <set>
 #include <iterator>
@@ -52,6 +55,8 @@ namespace psimpl {
         TEST_RUN("forward", TestForward ());
         TEST_RUN("backward", TestBackward ());
         TEST_RUN("select_calculation_type", TestSelectCalculationType ());
+        TEST_RUN("dary_heap", TestDaryHeap ());
+        TEST_RUN("box_tree", TestBoxTree ());
     }
 
     // ---------------------------------------------------------------------------------------------
@@ -224,5 +229,121 @@ namespace psimpl {
         VERIFY_TRUE(typeid (CustomType) == typeid (psimpl::util::select_calculation_type <std::set <CustomType>::iterator>::type));
     }
 
+    // ---------------------------------------------------------------------------------------------
+
+    void TestUtil::TestDaryHeap () {
+        psimpl::util::dary_heap <int> heap;
+        VERIFY_TRUE(heap.empty ());
+
+        // pops in descending order, including duplicates
+        std::vector <int> values;
+        for (int i = 0; i < 1000; ++i) {
+            values.push_back ((i * 7919) % 211);
+        }
+        for (size_t i = 0; i < values.size (); ++i) {
+            heap.push (values [i]);
+        }
+        ASSERT_TRUE(heap.size () == values.size ());
+
+        std::sort (values.begin (), values.end (), std::greater <int> ());
+        std::vector <int> popped;
+        while (!heap.empty ()) {
+            popped.push_back (heap.top ());
+            heap.pop ();
+        }
+        VERIFY_TRUE(popped == values);
+
+        // interleaved push and pop
+        psimpl::util::dary_heap <int, 3> heap3;
+        heap3.push (5);
+        heap3.push (9);
+        heap3.push (1);
+        VERIFY_TRUE(heap3.top () == 9);
+        heap3.pop ();
+        heap3.push (7);
+        VERIFY_TRUE(heap3.top () == 7);
+        heap3.pop ();
+        VERIFY_TRUE(heap3.top () == 5);
+        heap3.pop ();
+        VERIFY_TRUE(heap3.top () == 1);
+        heap3.pop ();
+        VERIFY_TRUE(heap3.empty ());
+    }
+
+    void TestUtil::TestBoxTree () {
+        const unsigned DIM = 2;
+        const std::ptrdiff_t pointCount = 1001;
+
+        std::vector <double> polyline;
+        std::generate_n (std::back_inserter (polyline), pointCount*DIM, RandomWalkLine <double, DIM> ());
+        psimpl::spatial::box_tree <DIM, double> tree (polyline.begin (), pointCount, 8);
+
+        // 125 leaves, 63, 32, 16, 8, 4, 2 and 1 node(s)
+        ASSERT_TRUE(tree.levels () == 8);
+        VERIFY_TRUE(tree.nodes (0) == 125);
+        VERIFY_TRUE(tree.nodes (7) == 1);
+        VERIFY_TRUE(tree.last_point (7, 0) == pointCount - 1);
+
+        // each box contains the points it bounds
+        bool inside = true;
+        for (unsigned level = 0; level < tree.levels (); ++level) {
+            for (std::ptrdiff_t node = 0; node < tree.nodes (level); ++node) {
+                const double* box = tree.box (level, node);
+                for (std::ptrdiff_t i = tree.first_point (level, node); i <= tree.last_point (level, node); ++i) {
+                    for (unsigned d = 0; d < DIM; ++d) {
+                        inside = inside && box [d] <= polyline [i*DIM+d] && polyline [i*DIM+d] <= box [DIM+d];
+                    }
+                }
+            }
+        }
+        VERIFY_TRUE(inside);
+
+        // the nearest segment matches a brute force search, from any starting segment
+        bool nearest = true;
+        for (int q = 0; q < 200; ++q) {
+            double p [DIM] = {polyline [(q*5)*DIM] + (q % 7) - 3, polyline [(q*5)*DIM+1] + (q % 5) - 2};
+            double expected = psimpl::math::segment_distance2 <DIM> (&polyline [0], &polyline [DIM], p);
+            for (std::ptrdiff_t i = 1; i + 1 < pointCount; ++i) {
+                expected = std::min (expected, psimpl::math::segment_distance2 <DIM> (
+                    &polyline [i*DIM], &polyline [(i+1)*DIM], p));
+            }
+            std::ptrdiff_t hint = (q * 37) % pointCount;
+            nearest = nearest && psimpl::spatial::nearest_segment_distance2 (tree, polyline.begin (), p, -1., hint) == expected;
+            nearest = nearest && psimpl::math::segment_distance2 <DIM> (
+                &polyline [hint*DIM], &polyline [(hint+1)*DIM], p) == expected;
+
+            // any segment within bound will do
+            double bound = expected + 1;
+            nearest = nearest && psimpl::spatial::nearest_segment_distance2 (tree, polyline.begin (), p, bound, hint) <= bound;
+        }
+        VERIFY_TRUE(nearest);
+
+        // every segment within the distance is collected, unless the limit is exceeded
+        bool within = true;
+        for (int q = 0; q < 50; ++q) {
+            double p [DIM] = {polyline [(q*20)*DIM] + (q % 7) - 3, polyline [(q*20)*DIM+1] + (q % 5) - 2};
+            double dist2 = (q % 4 + 1) * (q % 4 + 1);
+            std::vector <std::ptrdiff_t> segments;
+            within = within && psimpl::spatial::segments_within (tree, p, dist2, segments);
+            for (std::ptrdiff_t i = 0; i + 1 < pointCount; ++i) {
+                bool near = psimpl::math::segment_distance2 <DIM> (&polyline [i*DIM], &polyline [(i+1)*DIM], p) <= dist2;
+                within = within && (!near || std::count (segments.begin (), segments.end (), i) == 1);
+            }
+            std::vector <std::ptrdiff_t> all, limited;
+            within = within && psimpl::spatial::segments_within (tree, p, dist2, all, segments.size ());
+            within = within && (segments.empty () ||
+                                !psimpl::spatial::segments_within (tree, p, dist2, limited, segments.size () - 1));
+        }
+        VERIFY_TRUE(within);
+
+        // a single point
+        psimpl::spatial::box_tree <DIM, double> point (polyline.begin (), 1);
+        double p [DIM] = {polyline [0] + 3, polyline [1] + 4};
+        std::ptrdiff_t hint = 5;
+        VERIFY_TRUE(point.levels () == 1);
+        VERIFY_TRUE(psimpl::spatial::nearest_segment_distance2 (point, polyline.begin (), p, 0., hint) == 25);
+        VERIFY_TRUE(hint == 0);
+    }
+
 }}
 
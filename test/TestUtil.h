@@ -51,6 +51,8 @@ namespace psimpl {
         void TestForward ();
         void TestBackward ();
         void TestSelectCalculationType ();
+        void TestDaryHeap ();
+        void TestBoxTree ();
     };
 }}
 
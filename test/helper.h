@@ -182,6 +182,41 @@ namespace psimpl {
         unsigned mDirection;    //!< direction of the current tooth (0,2=forward, 1=up, 3=down)
     };
 
+    /*!
+        \brief Generates a reproducible random walk, one coordinate at a time
+
+        Each coordinate moves by a random step in [-stepSize, stepSize] relative to the same
+        coordinate of the previous point.
+    */
+    template <typename T, unsigned DIM>
+    class RandomWalkLine {
+    public:
+        RandomWalkLine (T stepSize = 1, unsigned seed = 1) :
+            mStepSize (stepSize),
+            mState (seed),
+            mDimension (0)
+        {
+            for (unsigned d=0; d<DIM; ++d) {
+                mPosition [d] = 0;
+            }
+        }
+
+        T operator () () {
+            mDimension = mDimension % DIM;
+            // linear congruential generator, identical on every platform
+            mState = mState * 1103515245u + 12345u;
+            double random = static_cast <double> ((mState >> 8) & 0xffff) / 0xffff;
+            mPosition [mDimension] += static_cast <T> ((2 * random - 1) * mStepSize);
+            return mPosition [mDimension++];
+        }
+
+    private:
+        T mStepSize;            //!< maximum step along each axis
+        T mPosition [DIM];      //!< coordinates of the current point
+        unsigned mState;        //!< state of the random generator
+        unsigned mDimension;    //!< dimension of the current point (x-axis = 0)
+    };
+
     //! \brief exact compare of two values of the same type
     template <class T>
     inline bool CompareValue (T a, T b) {
@@ -1,6 +1,6 @@
 TARGET = psimpl-test
 TEMPLATE = app
-CONFIG += console
+CONFIG += console thread
 
 HEADERS += \
     TestUtil.h \
@@ -17,9 +17,23 @@ HEADERS += \
     TestLang.h \
     TestDouglasPeucker.h \
     TestReumannWitkam.h \
+    TestBatch.h \
+    TestParallel.h \
+    TestSleeveFitting.h \
+    TestOptimal.h \
+    TestDistance.h \
+    TestCounters.h \
+    TestTrace.h \
+    TestProgress.h \
     ../lib/old_psimpl.h \
     ../lib/psimpl.h \
     ../lib/detail/algo.h \
+    ../lib/detail/batch.h \
+    ../lib/detail/counters.h \
+    ../lib/detail/parallel.h \
+    ../lib/detail/progress.h \
+    ../lib/detail/spatial.h \
+    ../lib/detail/trace.h \
     ../lib/detail/util.h \
     ../lib/detail/math.h
 
@@ -35,4 +49,12 @@ SOURCES += \
     TestPerpendicularDistance.cpp \
     TestOpheim.cpp \
     TestLang.cpp \
-    TestDouglasPeucker.cpp
+    TestDouglasPeucker.cpp \
+    TestBatch.cpp \
+    TestParallel.cpp \
+    TestSleeveFitting.cpp \
+    TestOptimal.cpp \
+    TestDistance.cpp \
+    TestCounters.cpp \
+    TestTrace.cpp \
+    TestProgress.cpp